@@ -0,0 +1,58 @@
+/// Where the time of one connect went (Windows only)
+///
+/// Milestones are milliseconds after the connect request, keyed by name:
+/// configWritten, processStarted, standbyReleased, startupChecked,
+/// managementAttached, then OpenVPN's states resolve, tcpConnect, wait, auth,
+/// getConfig, assignIp, addRoutes and finally connected. Milestones a connect
+/// never reached are missing.
+class ConnectTimings {
+  ///Connects recorded since the plugin started, from 1
+  final int sequence;
+
+  ///When the connect was requested
+  final DateTime startedAt;
+
+  ///Whether a prewarmed process was used
+  final bool prewarmed;
+
+  ///pending, connected, failed or cancelled
+  final String outcome;
+
+  ///Request to outcome; null while pending
+  final Duration? total;
+
+  final Map<String, Duration> milestones;
+
+  const ConnectTimings({
+    required this.sequence,
+    required this.startedAt,
+    required this.prewarmed,
+    required this.outcome,
+    required this.total,
+    required this.milestones,
+  });
+
+  ///Time between two milestones, e.g. phase("addRoutes", "connected") for
+  ///route installation; null unless both were reached
+  Duration? phase(String from, String to) {
+    final start = milestones[from];
+    final end = milestones[to];
+    return start != null && end != null ? end - start : null;
+  }
+
+  ///Builds the timings from the map sent by the native side
+  factory ConnectTimings.fromMap(Map<dynamic, dynamic> map) {
+    final totalMs = (map["totalMs"] as num?)?.toInt() ?? -1;
+    final milestones = (map["milestones"] as Map?) ?? {};
+    return ConnectTimings(
+      sequence: (map["sequence"] as num?)?.toInt() ?? 0,
+      startedAt: DateTime.fromMillisecondsSinceEpoch(
+          (map["startUnixMs"] as num?)?.toInt() ?? 0),
+      prewarmed: map["prewarmed"] == true,
+      outcome: map["outcome"] as String? ?? "pending",
+      total: totalMs >= 0 ? Duration(milliseconds: totalMs) : null,
+      milestones: milestones.map((name, ms) => MapEntry(
+          name as String, Duration(milliseconds: (ms as num).toInt()))),
+    );
+  }
+}
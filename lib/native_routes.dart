@@ -0,0 +1,31 @@
+/// Routes the plugin installed for the default tunnel (Windows only)
+class NativeRoutes {
+  ///Routes in place after the install; 0 when it failed and was undone
+  final int installed;
+
+  ///Routes left out, e.g. through net_gateway or to a hostname
+  final List<String> skipped;
+
+  ///Time spent installing
+  final Duration elapsed;
+
+  ///Why nothing was installed, if so
+  final String? error;
+
+  const NativeRoutes({
+    required this.installed,
+    required this.skipped,
+    required this.elapsed,
+    this.error,
+  });
+
+  ///Builds the report from the map sent by the native side
+  factory NativeRoutes.fromMap(Map<dynamic, dynamic> map) {
+    return NativeRoutes(
+      installed: (map["installed"] as num?)?.toInt() ?? 0,
+      skipped: (map["skipped"] as List<dynamic>?)?.cast<String>() ?? const [],
+      elapsed: Duration(milliseconds: (map["elapsedMs"] as num?)?.toInt() ?? 0),
+      error: map["error"] as String?,
+    );
+  }
+}
@@ -2,6 +2,12 @@ import 'dart:async';
 import 'dart:io';
 
 import 'package:flutter/services.dart';
+import 'package:openvpn_dart/connect_timings.dart';
+import 'package:openvpn_dart/native_routes.dart';
+import 'package:openvpn_dart/route_aggregation.dart';
+import 'package:openvpn_dart/server_switch.dart';
+import 'package:openvpn_dart/tunnel_session.dart';
+import 'package:openvpn_dart/vpn_stats.dart';
 import 'package:openvpn_dart/vpn_status.dart';
 
 class OpenVPNDart {
@@ -18,9 +24,23 @@ class OpenVPNDart {
       MethodChannel(_methodChannelVpnControl);
 
   ///Snapshot of stream that produced by native side
-  static Stream<String> _vpnStatusSnapshot() =>
+  ///
+  ///Carries status strings and, on Windows, typed maps such as traffic stats.
+  ///Shared so status and stats listeners don't replace each other's native
+  ///stream handler. Windows sends events in per-frame lists, flattened here
+  static final Stream<dynamic> _vpnEvents =
       const EventChannel(_eventChannelVPNStatus)
           .receiveBroadcastStream()
+          .expand((event) => event is List ? event : [event]);
+
+  ///Status strings only
+  static Stream<String> _vpnStatusSnapshot() =>
+      _vpnEvents.where((event) => event is String).cast();
+
+  ///Typed map events with the given "type" field
+  static Stream<Map<dynamic, dynamic>> _vpnTypedSnapshot(String type) =>
+      _vpnEvents
+          .where((event) => event is Map && event["type"] == type)
           .cast();
 
   ///To indicate the engine already initialize
@@ -34,13 +54,14 @@ class OpenVPNDart {
   ///Call this during app initialization to check/install the driver
   ///Returns true if driver is installed or successfully installed
   ///Throws exception if installation fails
-  Future<bool> ensureTapDriver() async {
+  Future<bool> ensureTapDriver({Duration? timeout}) async {
     if (!Platform.isWindows) {
       return true; // Not needed on other platforms
     }
 
     try {
-      await _channelControl.invokeMethod("ensureTapDriver");
+      await _channelControl.invokeMethod(
+          "ensureTapDriver", {if (timeout != null) "timeoutMs": timeout.inMilliseconds});
       return true;
     } on PlatformException catch (e) {
       throw Exception("Failed to ensure TAP driver: ${e.message}");
@@ -95,14 +116,41 @@ class OpenVPNDart {
   ///
   ///bypassPackages : exclude some apps to access/use the VPN Connection,
   /// it was List&lt;String&gt; of applications package's name (Android Only)
-  Future<void> connect(String config) async {
+  ///
+  ///statsInterval : seconds between [statsStream] samples, 0 disables them (Windows Only)
+  ///
+  ///logToFile : also write OpenVPN's output to openvpn.log (Windows Only)
+  ///
+  ///nativeRoutes : install the profile's and the server's routes from the
+  /// plugin, in batches, instead of through route.exe; see
+  /// [nativeRoutesStream] (Windows Only, default tunnel only)
+  ///
+  ///timeout : fail with DEADLINE_EXCEEDED if OpenVPN is not started by then,
+  /// counting time spent queued behind other calls (Windows Only)
+  ///
+  ///sessionId : run this config as an additional tunnel next to the default
+  /// one, with its own OpenVPN process; pass the same ID to [disconnect],
+  /// [getVPNStatus] and [statsStream]. 1-32 letters, digits, '_' or '-'
+  /// (Windows Only)
+  Future<void> connect(String config,
+      {int statsInterval = 1,
+      bool logToFile = true,
+      bool nativeRoutes = false,
+      Duration? timeout,
+      String? sessionId}) async {
     if (!initialized) {
       throw StateError("OpenVPN must be initialized before connecting");
     }
 
     try {
-      final result =
-          await _channelControl.invokeMethod("connect", {"config": config});
+      final result = await _channelControl.invokeMethod("connect", {
+        "config": config,
+        "statsInterval": statsInterval,
+        "logToFile": logToFile,
+        "nativeRoutes": nativeRoutes,
+        if (timeout != null) "timeoutMs": timeout.inMilliseconds,
+        if (sessionId != null) "sessionId": sessionId,
+      });
       return result;
     } on PlatformException catch (e) {
       throw ArgumentError("Failed to connect VPN: ${e.message}");
@@ -111,18 +159,162 @@ class OpenVPNDart {
     }
   }
 
-  ///Disconnect from VPN
-  void disconnect() {
-    _channelControl.invokeMethod("disconnect");
+  ///Moves the connection to the server in [config] (Windows only)
+  ///
+  ///While connected, the new tunnel is brought up next to the current one
+  ///and the current one is torn down only once the new one is connected, so
+  ///traffic keeps flowing; [statusStream] stays connected throughout. If the
+  ///new tunnel fails to connect within 60 seconds the call fails and the
+  ///current connection is kept. Without a connected tunnel this is a plain
+  ///[connect]. Also reported as {type: serverSwitch} on the event channel
+  Future<ServerSwitch> switchServer(String config,
+      {int statsInterval = 1, Duration? timeout}) async {
+    if (!Platform.isWindows) {
+      throw UnsupportedError("switchServer is only supported on Windows");
+    }
+    if (!initialized) {
+      throw StateError("OpenVPN must be initialized before switching servers");
+    }
+
+    try {
+      final report = await _channelControl
+          .invokeMethod<Map<dynamic, dynamic>>("switchServer", {
+        "config": config,
+        "statsInterval": statsInterval,
+        if (timeout != null) "timeoutMs": timeout.inMilliseconds,
+      });
+      return ServerSwitch.fromMap(report ?? {});
+    } on PlatformException catch (e) {
+      throw Exception("Failed to switch server: ${e.message}");
+    }
+  }
+
+  ///Starts OpenVPN for [config] ahead of time and parks it before it touches
+  ///the network, so a later [connect] with the same config only releases it
+  ///(Windows only)
+  ///
+  ///A parked process for another config, or one older than 10 minutes, is
+  ///replaced on connect. After a disconnect a new one is parked automatically
+  ///until [cancelPrewarm] is called
+  Future<void> prewarm(String config) async {
+    if (!Platform.isWindows) {
+      return;
+    }
+    if (!initialized) {
+      throw StateError("OpenVPN must be initialized before prewarming");
+    }
+
+    try {
+      await _channelControl.invokeMethod("prewarm", {"config": config});
+    } on PlatformException catch (e) {
+      throw Exception("Failed to prewarm VPN: ${e.message}");
+    }
+  }
+
+  ///Stops the process parked by [prewarm] (Windows only)
+  Future<void> cancelPrewarm() async {
+    if (!Platform.isWindows) {
+      return;
+    }
+    await _channelControl.invokeMethod("cancelPrewarm");
+  }
+
+  ///Newest [count] lines of OpenVPN output, oldest first (Windows only)
+  ///
+  ///Served from memory, so it is cheap to call while connected; empty on
+  ///other platforms and for sessions attached after a restart
+  Future<List<String>> getRecentLogs([int count = 100]) async {
+    if (!Platform.isWindows) {
+      return [];
+    }
+    final lines = await _channelControl
+        .invokeMethod<List<dynamic>>("getRecentLogs", {"count": count});
+    return lines?.cast<String>() ?? [];
+  }
+
+  ///Cancels a pending [connect], [setupTunnel] or [ensureTapDriver] call, or
+  ///all of them if [method] is null; the cancelled calls fail with code
+  ///CANCELLED. Returns how many calls were cancelled (Windows only)
+  Future<int> cancel([String? method]) async {
+    if (!Platform.isWindows) {
+      return 0;
+    }
+    final cancelled = await _channelControl
+        .invokeMethod<int>("cancel", {if (method != null) "method": method});
+    return cancelled ?? 0;
+  }
+
+  ///Per-phase timings of the last 32 connects, oldest first (Windows only)
+  Future<List<ConnectTimings>> getConnectTimings() async {
+    if (!Platform.isWindows) {
+      return [];
+    }
+    final sessions =
+        await _channelControl.invokeMethod<List<dynamic>>("getConnectTimings");
+    return sessions
+            ?.map((session) => ConnectTimings.fromMap(session as Map))
+            .toList() ??
+        [];
+  }
+
+  ///Counters of the native event queue: published, delivered, coalesced,
+  ///batches, queueDepth, maxQueueDepth, eventsPerSecond and batchesPerSecond
+  ///(Windows only)
+  Future<Map<String, num>> getEventMetrics() async {
+    if (!Platform.isWindows) {
+      return {};
+    }
+    final metrics = await _channelControl
+        .invokeMethod<Map<dynamic, dynamic>>("getEventMetrics");
+    return metrics?.cast<String, num>() ?? {};
+  }
+
+  ///Timed spans of recent plugin work as Chrome trace-event JSON, for
+  ///chrome://tracing or Perfetto; [clear] drops them afterwards (Windows only)
+  Future<String?> getTrace({bool clear = false}) async {
+    if (!Platform.isWindows) {
+      return null;
+    }
+    return _channelControl.invokeMethod<String>("getTrace", {"clear": clear});
+  }
+
+  ///Turns span recording for [getTrace] on or off (Windows only)
+  Future<void> setTracing(bool enabled) async {
+    if (!Platform.isWindows) {
+      return;
+    }
+    await _channelControl.invokeMethod("setTracing", enabled);
+  }
+
+  ///Disconnect from VPN, or only the tunnel connected with [sessionId]
+  void disconnect({String? sessionId}) {
+    _channelControl.invokeMethod(
+        "disconnect", sessionId != null ? {"sessionId": sessionId} : null);
+  }
+
+  ///Tunnels connected with a sessionId that are still running, by ID
+  ///(Windows only)
+  Future<List<TunnelSession>> getSessions() async {
+    if (!Platform.isWindows) {
+      return [];
+    }
+    final sessions =
+        await _channelControl.invokeMethod<List<dynamic>>("getSessions");
+    return sessions
+            ?.map((session) => TunnelSession.fromMap(session as Map))
+            .toList() ??
+        [];
   }
 
   ///Check if connected to vpn
   Future<bool> isConnected() async =>
       getVPNStatus().then((value) => value == ConnectionStatus.connected);
 
-  ///Get latest connection status
-  Future<ConnectionStatus> getVPNStatus() async {
-    String? status = await _channelControl.invokeMethod("status");
+  ///Get latest connection status, of the tunnel connected with [sessionId]
+  ///if given
+  Future<ConnectionStatus> getVPNStatus({String? sessionId}) async {
+    String? status = await _channelControl.invokeMethod(
+        "status", sessionId != null ? {"sessionId": sessionId} : null);
     return ConnectionStatus.fromString(status ?? "disconnected");
   }
 
@@ -154,6 +346,35 @@ class OpenVPNDart {
     });
   }
 
+  ///Status changes of the tunnel connected with [sessionId] (Windows only)
+  Stream<ConnectionStatus> sessionStatusStream(String sessionId) {
+    return _vpnTypedSnapshot("sessionStatus")
+        .where((event) => event["sessionId"] == sessionId)
+        .map((event) => _strToStatus(event["status"] as String?));
+  }
+
+  ///Traffic counters and rates while connected (Windows only)
+  ///Samples are produced while anything listens to the plugin's events, such
+  ///as [statusStream], not only this stream. Those of a tunnel connected with
+  ///a sessionId come only with that [sessionId]
+  Stream<VPNStats> statsStream({String? sessionId}) {
+    return _vpnTypedSnapshot("stats")
+        .where((event) => event["sessionId"] == sessionId)
+        .map(VPNStats.fromMap);
+  }
+
+  ///Route counts of each profile before and after merging, sent as it is
+  ///written for OpenVPN (Windows only)
+  Stream<RouteAggregation> routeAggregationStream() {
+    return _vpnTypedSnapshot("routeAggregation").map(RouteAggregation.fromMap);
+  }
+
+  ///Routes installed for a tunnel connected with nativeRoutes, sent each
+  ///time it connects (Windows only)
+  Stream<NativeRoutes> nativeRoutesStream() {
+    return _vpnTypedSnapshot("nativeRoutes").map(NativeRoutes.fromMap);
+  }
+
   Future<bool> checkTunnelConfiguration() async {
     try {
       final result =
@@ -172,9 +393,10 @@ class OpenVPNDart {
     }
   }
 
-  Future<void> setupTunnel() async {
+  Future<void> setupTunnel({Duration? timeout}) async {
     try {
-      await _channelControl.invokeMethod("setupTunnel");
+      await _channelControl.invokeMethod(
+          "setupTunnel", {if (timeout != null) "timeoutMs": timeout.inMilliseconds});
     } on PlatformException catch (e) {
       throw Exception("setupTunnel failed: ${e.message}");
     }
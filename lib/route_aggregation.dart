@@ -0,0 +1,32 @@
+/// Routes in a profile before and after merging (Windows only)
+class RouteAggregation {
+  ///Set for a tunnel connected with a sessionId
+  final String? sessionId;
+
+  ///`route` lines with a numeric network, and what they were merged into
+  final int ipv4Before;
+  final int ipv4After;
+
+  ///`route-ipv6` lines, and what they were merged into
+  final int ipv6Before;
+  final int ipv6After;
+
+  const RouteAggregation({
+    this.sessionId,
+    required this.ipv4Before,
+    required this.ipv4After,
+    required this.ipv6Before,
+    required this.ipv6After,
+  });
+
+  ///Builds the report from the map sent by the native side
+  factory RouteAggregation.fromMap(Map<dynamic, dynamic> map) {
+    return RouteAggregation(
+      sessionId: map["sessionId"] as String?,
+      ipv4Before: (map["ipv4Before"] as num?)?.toInt() ?? 0,
+      ipv4After: (map["ipv4After"] as num?)?.toInt() ?? 0,
+      ipv6Before: (map["ipv6Before"] as num?)?.toInt() ?? 0,
+      ipv6After: (map["ipv6After"] as num?)?.toInt() ?? 0,
+    );
+  }
+}
@@ -0,0 +1,49 @@
+/// How a [OpenVPNDart.switchServer] call went (Windows only)
+class ServerSwitch {
+  ///Whether the new tunnel was connected before the old one went down;
+  ///false when there was no connected tunnel to keep
+  final bool makeBeforeBreak;
+
+  ///Whether the running OpenVPN process was reconnected to the new server
+  ///instead of being replaced, because only its remotes changed
+  final bool inPlace;
+
+  ///Request to the new tunnel reporting connected; null if it had not by
+  ///the time the call returned
+  final Duration? connect;
+
+  ///Time both tunnels were connected
+  final Duration overlap;
+
+  ///Time neither tunnel was connected; null if the new one never connected
+  final Duration? gap;
+
+  ///Teardown of the old tunnel; null if there was none
+  final Duration? teardown;
+
+  const ServerSwitch({
+    required this.makeBeforeBreak,
+    this.inPlace = false,
+    required this.connect,
+    required this.overlap,
+    required this.gap,
+    required this.teardown,
+  });
+
+  ///Builds the report from the map sent by the native side
+  factory ServerSwitch.fromMap(Map<dynamic, dynamic> map) {
+    Duration? optional(String key) {
+      final ms = (map[key] as num?)?.toInt() ?? -1;
+      return ms >= 0 ? Duration(milliseconds: ms) : null;
+    }
+
+    return ServerSwitch(
+      makeBeforeBreak: map["makeBeforeBreak"] == true,
+      inPlace: map["inPlace"] == true,
+      connect: optional("connectMs"),
+      overlap: optional("overlapMs") ?? Duration.zero,
+      gap: optional("gapMs"),
+      teardown: optional("teardownMs"),
+    );
+  }
+}
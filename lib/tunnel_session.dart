@@ -0,0 +1,41 @@
+import 'package:openvpn_dart/vpn_status.dart';
+
+/// A named tunnel running next to the default one (Windows only)
+class TunnelSession {
+  ///The ID it was connected with
+  final String sessionId;
+
+  final ConnectionStatus status;
+
+  ///Process ID of its OpenVPN
+  final int pid;
+
+  ///Total bytes received and sent through the tunnel
+  final int bytesIn;
+  final int bytesOut;
+
+  ///Time since the session was started
+  final Duration duration;
+
+  const TunnelSession({
+    required this.sessionId,
+    required this.status,
+    required this.pid,
+    required this.bytesIn,
+    required this.bytesOut,
+    required this.duration,
+  });
+
+  ///Builds the session from the map sent by the native side
+  factory TunnelSession.fromMap(Map<dynamic, dynamic> map) {
+    return TunnelSession(
+      sessionId: map["sessionId"] as String? ?? "",
+      status: ConnectionStatus.fromString(
+          map["status"] as String? ?? "disconnected"),
+      pid: (map["pid"] as num?)?.toInt() ?? 0,
+      bytesIn: (map["bytesIn"] as num?)?.toInt() ?? 0,
+      bytesOut: (map["bytesOut"] as num?)?.toInt() ?? 0,
+      duration: Duration(milliseconds: (map["durationMs"] as num?)?.toInt() ?? 0),
+    );
+  }
+}
@@ -0,0 +1,38 @@
+/// Traffic sample published on the status event channel while connected
+class VPNStats {
+  ///Total bytes received through the tunnel this session
+  final int bytesIn;
+
+  ///Total bytes sent through the tunnel this session
+  final int bytesOut;
+
+  ///Current receive rate in bytes per second
+  final double rateIn;
+
+  ///Current send rate in bytes per second
+  final double rateOut;
+
+  ///Time since the connection was started
+  final Duration duration;
+
+  const VPNStats({
+    required this.bytesIn,
+    required this.bytesOut,
+    required this.rateIn,
+    required this.rateOut,
+    required this.duration,
+  });
+
+  ///Builds a sample from the map sent by the native side
+  factory VPNStats.fromMap(Map<dynamic, dynamic> map) {
+    return VPNStats(
+      bytesIn: (map["bytesIn"] as num?)?.toInt() ?? 0,
+      bytesOut: (map["bytesOut"] as num?)?.toInt() ?? 0,
+      rateIn: (map["rateIn"] as num?)?.toDouble() ?? 0,
+      rateOut: (map["rateOut"] as num?)?.toDouble() ?? 0,
+      duration: Duration(
+        milliseconds: (map["durationMs"] as num?)?.toInt() ?? 0,
+      ),
+    );
+  }
+}
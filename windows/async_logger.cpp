@@ -0,0 +1,363 @@
+#include "async_logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    std::atomic<uint32_t> g_next_thread_id{1};
+
+    uint32_t CurrentThreadId()
+    {
+      thread_local const uint32_t id = g_next_thread_id.fetch_add(1, std::memory_order_relaxed);
+      return id;
+    }
+
+    size_t RoundUpToPowerOfTwo(size_t value)
+    {
+      size_t result = 2;
+      while (result < value)
+      {
+        result <<= 1;
+      }
+      return result;
+    }
+
+    // Days since 1970-01-01 to a civil date (proleptic Gregorian)
+    void CivilFromDays(int64_t days, int *year, unsigned *month, unsigned *day)
+    {
+      days += 719468;
+      const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+      const unsigned doe = static_cast<unsigned>(days - era * 146097);
+      const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+      const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+      const unsigned mp = (5 * doy + 2) / 153;
+      *day = doy - (153 * mp + 2) / 5 + 1;
+      *month = mp < 10 ? mp + 3 : mp - 9;
+      *year = static_cast<int>(static_cast<int64_t>(yoe) + era * 400 + (*month <= 2 ? 1 : 0));
+    }
+
+    void AppendValue(std::string *out, const LogRecord &record, const LogRecord::Value &value)
+    {
+      char number[32];
+      switch (value.type)
+      {
+      case LogArg::Type::kInt:
+        std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(value.i));
+        out->append(number);
+        break;
+      case LogArg::Type::kUint:
+        std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value.u));
+        out->append(number);
+        break;
+      case LogArg::Type::kDouble:
+        std::snprintf(number, sizeof(number), "%g", value.d);
+        out->append(number);
+        break;
+      case LogArg::Type::kBool:
+        out->append(value.b ? "true" : "false");
+        break;
+      case LogArg::Type::kText:
+        out->append(record.text + value.offset, value.length);
+        if (value.clipped)
+        {
+          out->append("...");
+        }
+        break;
+      }
+    }
+
+  } // namespace
+
+  const char *LogLevelName(LogLevel level)
+  {
+    switch (level)
+    {
+    case LogLevel::kTrace:
+      return "TRACE";
+    case LogLevel::kDebug:
+      return "DEBUG";
+    case LogLevel::kInfo:
+      return "INFO";
+    case LogLevel::kWarning:
+      return "WARN";
+    case LogLevel::kError:
+      return "ERROR";
+    case LogLevel::kOff:
+      break;
+    }
+    return "OFF";
+  }
+
+  std::string FormatLogMessage(const LogRecord &record)
+  {
+    std::string message;
+    const char *format = record.format != nullptr ? record.format : "";
+    message.reserve(std::strlen(format) + record.text_bytes + 16);
+    size_t next_arg = 0;
+    for (const char *p = format; *p != '\0'; p++)
+    {
+      if (p[0] == '{' && p[1] == '}' && next_arg < record.arg_count)
+      {
+        AppendValue(&message, record, record.values[next_arg++]);
+        p++;
+        continue;
+      }
+      message.push_back(*p);
+    }
+    return message;
+  }
+
+  std::string FormatLogLine(const LogRecord &record)
+  {
+    const int64_t ms = ((record.unix_ms % 1000) + 1000) % 1000;
+    const int64_t seconds = (record.unix_ms - ms) / 1000;
+    const int64_t days = (seconds >= 0 ? seconds : seconds - 86399) / 86400;
+    const int64_t second_of_day = seconds - days * 86400;
+    int year;
+    unsigned month, day;
+    CivilFromDays(days, &year, &month, &day);
+
+    char prefix[64];
+    std::snprintf(prefix, sizeof(prefix), "%04d-%02u-%02u %02d:%02d:%02d.%03dZ %-5s [%u] ",
+                  year, month, day,
+                  static_cast<int>(second_of_day / 3600),
+                  static_cast<int>(second_of_day / 60 % 60),
+                  static_cast<int>(second_of_day % 60),
+                  static_cast<int>(ms), LogLevelName(record.level), record.thread_id);
+    return prefix + FormatLogMessage(record);
+  }
+
+  AsyncLogger::AsyncLogger(size_t capacity)
+      : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+        cells_(new Cell[mask_ + 1]),
+        enqueue_pos_(0),
+        dequeue_pos_(0),
+        written_pos_(0),
+        dropped_(0),
+        level_(kMinLogLevel),
+        reported_dropped_(0),
+        wake_requested_(false),
+        running_(false),
+        stopping_(false)
+  {
+    for (size_t i = 0; i <= mask_; i++)
+    {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  AsyncLogger::~AsyncLogger()
+  {
+    Stop();
+  }
+
+  AsyncLogger &AsyncLogger::Global()
+  {
+    // Never destroyed: threads may still log while the process exits
+    static AsyncLogger *logger = new AsyncLogger();
+    return *logger;
+  }
+
+  void AsyncLogger::Push(LogLevel level, const char *format, const LogArg *args, size_t arg_count)
+  {
+    // Bounded MPMC ring (Vyukov): a slot is free for position |pos| when
+    // its sequence equals |pos|, and holds a record once it is |pos| + 1
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;)
+    {
+      cell = &cells_[pos & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0)
+      {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if (diff < 0)
+      {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        Wake();
+        return;
+      }
+      else
+      {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    LogRecord &record = cell->record;
+    record.format = format;
+    record.level = level;
+    record.arg_count = static_cast<uint8_t>(arg_count);
+    record.thread_id = CurrentThreadId();
+    record.unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    size_t used = 0;
+    for (size_t i = 0; i < arg_count; i++)
+    {
+      LogRecord::Value &value = record.values[i];
+      value.type = args[i].type;
+      value.clipped = false;
+      value.offset = 0;
+      value.length = 0;
+      value.u = args[i].u;
+      if (args[i].type == LogArg::Type::kText)
+      {
+        const size_t length = std::min(args[i].text.size(), LogRecord::kTextBytes - used);
+        std::memcpy(record.text + used, args[i].text.data(), length);
+        value.offset = static_cast<uint16_t>(used);
+        value.length = static_cast<uint16_t>(length);
+        value.clipped = length < args[i].text.size();
+        used += length;
+      }
+    }
+    record.text_bytes = static_cast<uint16_t>(used);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    if (level >= LogLevel::kWarning ||
+        pos + 1 - dequeue_pos_.load(std::memory_order_relaxed) > (mask_ + 1) / 2)
+    {
+      Wake();
+    }
+  }
+
+  void AsyncLogger::Wake()
+  {
+    if (!wake_requested_.exchange(true, std::memory_order_acq_rel))
+    {
+      wake_cv_.notify_one();
+    }
+  }
+
+  void AsyncLogger::SetSinks(std::vector<Sink> sinks)
+  {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    sinks_ = std::move(sinks);
+  }
+
+  void AsyncLogger::Start()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_)
+    {
+      return;
+    }
+    running_ = true;
+    stopping_ = false;
+    thread_ = std::thread(&AsyncLogger::Run, this);
+  }
+
+  void AsyncLogger::Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!running_)
+      {
+        return;
+      }
+      stopping_ = true;
+    }
+    wake_cv_.notify_one();
+    thread_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+
+  void AsyncLogger::Flush()
+  {
+    const size_t target = enqueue_pos_.load(std::memory_order_acquire);
+    bool running;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running = running_ && !stopping_;
+    }
+    if (!running)
+    {
+      Drain();
+      return;
+    }
+    Wake();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (written_pos_.load(std::memory_order_acquire) < target && running_ && !stopping_)
+    {
+      drained_cv_.wait_for(lock, std::chrono::milliseconds(kPollMs));
+    }
+  }
+
+  void AsyncLogger::Run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_)
+    {
+      wake_cv_.wait_for(lock, std::chrono::milliseconds(kPollMs), [this]()
+                        { return stopping_ || wake_requested_.load(std::memory_order_acquire); });
+      wake_requested_.store(false, std::memory_order_release);
+      lock.unlock();
+      Drain();
+      lock.lock();
+      drained_cv_.notify_all();
+    }
+    lock.unlock();
+    Drain();
+    drained_cv_.notify_all();
+  }
+
+  size_t AsyncLogger::Drain()
+  {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    lines_.clear();
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Cell &cell = cells_[pos & mask_];
+      if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+      {
+        // Empty, or the next record is still being written
+        break;
+      }
+      lines_.emplace_back(cell.record.level, FormatLogLine(cell.record));
+      cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+      pos++;
+      dequeue_pos_.store(pos, std::memory_order_release);
+    }
+
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped_)
+    {
+      LogRecord record;
+      record.format = "{} log records dropped, ring full";
+      record.level = LogLevel::kWarning;
+      record.arg_count = 1;
+      record.thread_id = CurrentThreadId();
+      record.unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+      record.values[0].type = LogArg::Type::kUint;
+      record.values[0].u = dropped - reported_dropped_;
+      lines_.emplace_back(LogLevel::kWarning, FormatLogLine(record));
+      reported_dropped_ = dropped;
+    }
+
+    for (const auto &line : lines_)
+    {
+      for (const auto &sink : sinks_)
+      {
+        sink(line.first, line.second);
+      }
+    }
+    written_pos_.store(pos, std::memory_order_release);
+    return lines_.size();
+  }
+
+} // namespace openvpn_dart
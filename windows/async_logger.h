@@ -0,0 +1,294 @@
+#ifndef FLUTTER_PLUGIN_ASYNC_LOGGER_H_
+#define FLUTTER_PLUGIN_ASYNC_LOGGER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Calls below this level compile to nothing: 0 trace, 1 debug, 2 info,
+// 3 warning, 4 error.
+#ifndef OPENVPN_DART_MIN_LOG_LEVEL
+#ifdef NDEBUG
+#define OPENVPN_DART_MIN_LOG_LEVEL 2
+#else
+#define OPENVPN_DART_MIN_LOG_LEVEL 0
+#endif
+#endif
+
+namespace openvpn_dart
+{
+
+    enum class LogLevel : uint8_t
+    {
+        kTrace,
+        kDebug,
+        kInfo,
+        kWarning,
+        kError,
+        kOff
+    };
+
+    constexpr LogLevel kMinLogLevel = static_cast<LogLevel>(OPENVPN_DART_MIN_LOG_LEVEL);
+
+    const char *LogLevelName(LogLevel level);
+
+    // One argument of a log call. Numbers are kept by value; text refers to
+    // the caller's memory until the record copies it.
+    struct LogArg
+    {
+        enum class Type : uint8_t
+        {
+            kInt,
+            kUint,
+            kDouble,
+            kBool,
+            kText
+        };
+
+        Type type = Type::kInt;
+        union
+        {
+            int64_t i;
+            uint64_t u;
+            double d;
+            bool b;
+        };
+        std::string_view text;
+
+        LogArg() : i(0) {}
+    };
+
+    template <typename T>
+    LogArg MakeLogArg(const T &value)
+    {
+        LogArg arg;
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            arg.type = LogArg::Type::kBool;
+            arg.b = value;
+        }
+        else if constexpr (std::is_enum_v<T>)
+        {
+            arg.type = LogArg::Type::kInt;
+            arg.i = static_cast<int64_t>(value);
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            arg.type = LogArg::Type::kInt;
+            arg.i = value;
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            arg.type = LogArg::Type::kUint;
+            arg.u = value;
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            arg.type = LogArg::Type::kDouble;
+            arg.d = value;
+        }
+        else if constexpr (std::is_pointer_v<T>)
+        {
+            arg.type = LogArg::Type::kText;
+            arg.text = value != nullptr ? std::string_view(value) : std::string_view("(null)");
+        }
+        else
+        {
+            arg.type = LogArg::Type::kText;
+            arg.text = std::string_view(value);
+        }
+        return arg;
+    }
+
+    // A log call as captured on the calling thread: the format string by
+    // pointer (it must be a literal) and the arguments by value, text
+    // copied into |text|. Turned into a line only on the sink thread.
+    struct LogRecord
+    {
+        static constexpr size_t kMaxArgs = 6;
+        static constexpr size_t kTextBytes = 400;
+
+        struct Value
+        {
+            LogArg::Type type;
+            bool clipped; // Text cut short to fit
+            uint16_t offset;
+            uint16_t length;
+            union
+            {
+                int64_t i;
+                uint64_t u;
+                double d;
+                bool b;
+            };
+        };
+
+        const char *format = nullptr;
+        LogLevel level = LogLevel::kInfo;
+        uint8_t arg_count = 0;
+        uint16_t text_bytes = 0;
+        uint32_t thread_id = 0;
+        int64_t unix_ms = 0;
+        Value values[kMaxArgs];
+        char text[kTextBytes];
+    };
+
+    // |record|'s format with each "{}" replaced by the next argument.
+    std::string FormatLogMessage(const LogRecord &record);
+
+    // "2026-01-02 03:04:05.678Z INFO  [3] message"
+    std::string FormatLogLine(const LogRecord &record);
+
+    // Leveled logger that keeps formatting and I/O off the calling thread.
+    //
+    // Log() checks the runtime level, then claims a slot in a fixed ring
+    // with one CAS and fills it in place: no lock and no allocation. When
+    // the ring is full the record is dropped and counted rather than
+    // blocking. A background thread formats what has arrived and hands the
+    // lines to the sinks, polling a few times a second and woken early for
+    // warnings, errors or a ring filling up.
+    class AsyncLogger
+    {
+    public:
+        using Sink = std::function<void(LogLevel level, const std::string &line)>;
+
+        static constexpr int kPollMs = 50;
+
+        // |capacity| is rounded up to a power of two.
+        explicit AsyncLogger(size_t capacity = 1024);
+        ~AsyncLogger();
+
+        AsyncLogger(const AsyncLogger &) = delete;
+        AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+        // The logger behind LogTrace() .. LogError().
+        static AsyncLogger &Global();
+
+        void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+        LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+        bool ShouldLog(LogLevel level) const
+        {
+            return level != LogLevel::kOff && level >= level_.load(std::memory_order_relaxed);
+        }
+
+        template <typename... Args>
+        void Log(LogLevel level, const char *format, const Args &...args)
+        {
+            static_assert(sizeof...(Args) <= LogRecord::kMaxArgs, "Too many log arguments");
+            if (!ShouldLog(level))
+            {
+                return;
+            }
+            const LogArg captured[] = {MakeLogArg(args)..., LogArg()};
+            Push(level, format, captured, sizeof...(Args));
+        }
+
+        // Replaces the sinks; records not yet written go to the new ones.
+        void SetSinks(std::vector<Sink> sinks);
+
+        // Starts the sink thread. Records logged before are kept and
+        // written first.
+        void Start();
+        // Writes everything logged so far and stops the sink thread.
+        void Stop();
+        // Blocks until everything logged before the call is written.
+        void Flush();
+
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            LogRecord record;
+        };
+
+        void Push(LogLevel level, const char *format, const LogArg *args, size_t arg_count);
+        void Wake();
+        void Run();
+        // Consumer side; returns how many records were written
+        size_t Drain();
+
+        const size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+        std::atomic<size_t> enqueue_pos_;
+        std::atomic<size_t> dequeue_pos_;
+        // Records up to here have reached the sinks
+        std::atomic<size_t> written_pos_;
+        std::atomic<uint64_t> dropped_;
+        std::atomic<LogLevel> level_;
+
+        // Guards the consumer side: |sinks_|, |reported_dropped_| and
+        // advancing |dequeue_pos_| and |written_pos_|
+        std::mutex drain_mutex_;
+        std::vector<Sink> sinks_;
+        uint64_t reported_dropped_;
+        std::vector<std::pair<LogLevel, std::string>> lines_;
+
+        std::thread thread_;
+        std::mutex mutex_;
+        std::condition_variable wake_cv_;
+        std::condition_variable drained_cv_;
+        std::atomic<bool> wake_requested_;
+        bool running_;
+        bool stopping_;
+    };
+
+    template <typename... Args>
+    void LogTrace(const char *format, const Args &...args)
+    {
+        if constexpr (LogLevel::kTrace >= kMinLogLevel)
+        {
+            AsyncLogger::Global().Log(LogLevel::kTrace, format, args...);
+        }
+    }
+
+    template <typename... Args>
+    void LogDebug(const char *format, const Args &...args)
+    {
+        if constexpr (LogLevel::kDebug >= kMinLogLevel)
+        {
+            AsyncLogger::Global().Log(LogLevel::kDebug, format, args...);
+        }
+    }
+
+    template <typename... Args>
+    void LogInfo(const char *format, const Args &...args)
+    {
+        if constexpr (LogLevel::kInfo >= kMinLogLevel)
+        {
+            AsyncLogger::Global().Log(LogLevel::kInfo, format, args...);
+        }
+    }
+
+    template <typename... Args>
+    void LogWarning(const char *format, const Args &...args)
+    {
+        if constexpr (LogLevel::kWarning >= kMinLogLevel)
+        {
+            AsyncLogger::Global().Log(LogLevel::kWarning, format, args...);
+        }
+    }
+
+    template <typename... Args>
+    void LogError(const char *format, const Args &...args)
+    {
+        if constexpr (LogLevel::kError >= kMinLogLevel)
+        {
+            AsyncLogger::Global().Log(LogLevel::kError, format, args...);
+        }
+    }
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_ASYNC_LOGGER_H_
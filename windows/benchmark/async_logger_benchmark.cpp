@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "async_logger.h"
+
+namespace openvpn_dart
+{
+  namespace benchmarks
+  {
+
+    namespace
+    {
+
+      const std::string kPath = "C:\\Users\\user\\AppData\\Local\\openvpn_dart\\config\\openvpn.log";
+
+    } // namespace
+
+    // What a call site paid before the debugger call itself: building the
+    // message whether or not anyone reads it.
+    void BM_LogConcatenate(benchmark::State &state)
+    {
+      int64_t pid = 4242;
+      for (auto _ : state)
+      {
+        std::string message = "Started OpenVPN, PID " + std::to_string(pid) + ", log " + kPath;
+        benchmark::DoNotOptimize(message.data());
+      }
+    }
+    BENCHMARK(BM_LogConcatenate);
+
+    // A call below the runtime level: one relaxed load, no allocation.
+    void BM_LogDisabled(benchmark::State &state)
+    {
+      AsyncLogger logger;
+      logger.set_level(LogLevel::kWarning);
+      int64_t pid = 4242;
+      for (auto _ : state)
+      {
+        logger.Log(LogLevel::kDebug, "Started OpenVPN, PID {}, log {}", pid, kPath);
+      }
+    }
+    BENCHMARK(BM_LogDisabled);
+
+    // An enabled call: claim a slot and copy the arguments. The sink thread
+    // formats and writes behind it; records it cannot keep up with are
+    // dropped rather than slowing the caller.
+    void BM_LogEnabled(benchmark::State &state)
+    {
+      AsyncLogger logger(4096);
+      logger.set_level(LogLevel::kTrace);
+      logger.SetSinks({[](LogLevel, const std::string &line)
+                       { benchmark::DoNotOptimize(line.data()); }});
+      logger.Start();
+      int64_t pid = 4242;
+      for (auto _ : state)
+      {
+        logger.Log(LogLevel::kDebug, "Started OpenVPN, PID {}, log {}", pid, kPath);
+      }
+      logger.Stop();
+      state.counters["dropped"] = static_cast<double>(logger.dropped());
+    }
+    BENCHMARK(BM_LogEnabled);
+
+  } // namespace benchmarks
+} // namespace openvpn_dart
@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <thread>
+
+#include "event_reactor.h"
+
+namespace openvpn_dart
+{
+  namespace benchmarks
+  {
+
+    // Cross-thread wake-up latency for signals such as a stop request.
+    void BM_SignalToDispatch(benchmark::State &state)
+    {
+      EventReactor reactor;
+      bool fired = false;
+      const auto id = reactor.AddSignal([&fired]()
+                                        { fired = true; });
+      reactor.RunOnce(0);
+
+      for (auto _ : state)
+      {
+        fired = false;
+        const auto start = std::chrono::steady_clock::now();
+        std::thread signaller([&reactor, id]()
+                              { reactor.Signal(id); });
+        while (!fired)
+        {
+          reactor.RunOnce(1000);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        signaller.join();
+        state.SetIterationTime(std::chrono::duration<double>(elapsed).count());
+      }
+    }
+    BENCHMARK(BM_SignalToDispatch)->UseManualTime()->Unit(benchmark::kMicrosecond);
+
+  } // namespace benchmarks
+} // namespace openvpn_dart
@@ -0,0 +1,215 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_signatures.h"
+
+namespace openvpn_dart
+{
+  namespace benchmarks
+  {
+
+    namespace
+    {
+
+      // A verb-3 session: mostly routine lines, a few that carry meaning.
+      const char *const kSessionLines[] = {
+          "OpenVPN 2.6.8 [git:v2.6.8/3b0d9489cc423da3] Windows-MSVC [SSL (OpenSSL)] [LZO] [LZ4] [PKCS11] [AEAD] [DCO] built on Nov 17 2023",
+          "Windows version 10.0 (Windows 10 or greater), amd64 executable",
+          "library versions: OpenSSL 3.1.4 24 Oct 2023, LZO 2.10",
+          "DCO version: 1.0.0",
+          "MANAGEMENT: TCP Socket listening on [AF_INET]127.0.0.1:51234",
+          "TCP/UDP: Preserving recently used remote address: [AF_INET]203.0.113.7:1194",
+          "UDPv4 link local: (not bound)",
+          "UDPv4 link remote: [AF_INET]203.0.113.7:1194",
+          "MANAGEMENT: >STATE:1767261600,WAIT,,,,,,",
+          "MANAGEMENT: >STATE:1767261600,AUTH,,,,,,",
+          "TLS: Initial packet from [AF_INET]203.0.113.7:1194, sid=8e6f1c2a 4b5d7e9f",
+          "VERIFY OK: depth=1, CN=Example CA",
+          "VERIFY KU OK",
+          "Validating certificate extended key usage",
+          "++ Certificate has EKU (str) TLS Web Server Authentication, expects TLS Web Server Authentication",
+          "VERIFY EKU OK",
+          "VERIFY OK: depth=0, CN=server",
+          "Control Channel: TLSv1.3, cipher TLSv1.3 TLS_AES_256_GCM_SHA384, peer certificate: 2048 bit RSA, signature: RSA-SHA256",
+          "[server] Peer Connection Initiated with [AF_INET]203.0.113.7:1194",
+          "MANAGEMENT: >STATE:1767261601,GET_CONFIG,,,,,,",
+          "SENT CONTROL [server]: 'PUSH_REQUEST' (status=1)",
+          "PUSH: Received control message: 'PUSH_REPLY,redirect-gateway def1,dhcp-option DNS 10.8.0.1,route-gateway 10.8.0.1,topology subnet,ping 10,ping-restart 60,ifconfig 10.8.0.2 255.255.255.0,peer-id 0,cipher AES-256-GCM'",
+          "OPTIONS IMPORT: --ifconfig/up options modified",
+          "OPTIONS IMPORT: route options modified",
+          "OPTIONS IMPORT: --ip-win32 and/or --dhcp-option options modified",
+          "Data Channel: cipher 'AES-256-GCM', peer-id: 0",
+          "Timers: ping 10, ping-restart 60",
+          "Protocol options: explicit-exit-notify 1",
+          "interactive service msg_channel=0",
+          "open_tun",
+          "tap-windows6 device [OpenVPN TAP-Windows6] opened",
+          "Set TAP-Windows TUN subnet mode network/local/netmask = 10.8.0.0/10.8.0.2/255.255.255.0 [SUCCEEDED]",
+          "Notified TAP-Windows driver to set a DHCP IP/netmask of 10.8.0.2/255.255.255.0 on interface {5A1E2F3B-0C4D-4E5F-8A9B-0C1D2E3F4A5B} [DHCP-serv: 10.8.0.254, lease-time: 31536000]",
+          "Successful ARP Flush on interface [17] {5A1E2F3B-0C4D-4E5F-8A9B-0C1D2E3F4A5B}",
+          "IPv4 MTU set to 1500 on interface 17 using service",
+          "MANAGEMENT: >STATE:1767261602,ASSIGN_IP,,10.8.0.2,,,,",
+          "MANAGEMENT: >STATE:1767261602,ADD_ROUTES,,,,,,",
+          "C:\\WINDOWS\\system32\\route.exe ADD 203.0.113.7 MASK 255.255.255.255 192.168.1.1",
+          "Route addition via IPAPI succeeded [adaptive]",
+          "C:\\WINDOWS\\system32\\route.exe ADD 0.0.0.0 MASK 128.0.0.0 10.8.0.1",
+          "Route addition via IPAPI succeeded [adaptive]",
+          "Initialization Sequence Completed",
+          "MANAGEMENT: >STATE:1767261603,CONNECTED,SUCCESS,10.8.0.2,203.0.113.7,1194,,",
+          "MANAGEMENT: Client connected from [AF_INET]127.0.0.1:51234",
+          "MANAGEMENT: CMD 'bytecount 1'",
+          "TLS: soft reset sec=3600/3600 bytes=12345678/-1 pkts=45678/0",
+          "VERIFY OK: depth=0, CN=server",
+          "Control Channel: TLSv1.3, cipher TLSv1.3 TLS_AES_256_GCM_SHA384, peer certificate: 2048 bit RSA, signature: RSA-SHA256",
+          "[server] Inactivity timeout (--ping-restart), restarting",
+          "SIGUSR1[soft,ping-restart] received, process restarting",
+          "Restart pause, 5 second(s)",
+      };
+
+      // The status chain and error scrape as they were before the table.
+      int FindChain(std::string_view line)
+      {
+        int hits = 0;
+        if (line.find("Initialization Sequence Completed") != std::string_view::npos)
+        {
+          hits++;
+        }
+        else if (line.find("CONNECTED") != std::string_view::npos &&
+                 line.find("SUCCESS") != std::string_view::npos)
+        {
+          hits++;
+        }
+        else if (line.find("CONNECTION_TIMEOUT") != std::string_view::npos ||
+                 line.find("AUTH_FAILED") != std::string_view::npos)
+        {
+          hits++;
+        }
+        else if (line.find("TCP/UDP: Preserving recently used remote") != std::string_view::npos)
+        {
+          hits++;
+        }
+        if (line.find("AUTH_FAILED") != std::string_view::npos ||
+            line.find("ERROR") != std::string_view::npos ||
+            line.find("FATAL") != std::string_view::npos)
+        {
+          hits++;
+        }
+        return hits;
+      }
+
+      // Lines of $OPENVPN_DART_BENCH_LOG if set, else ~4 MB of kSessionLines.
+      const std::vector<std::string> &LogLines()
+      {
+        static const std::vector<std::string> lines = []()
+        {
+          std::vector<std::string> result;
+          if (const char *path = std::getenv("OPENVPN_DART_BENCH_LOG"))
+          {
+            std::ifstream in(path, std::ios::binary);
+            std::string line;
+            while (std::getline(in, line))
+            {
+              result.push_back(line);
+            }
+            if (!result.empty())
+            {
+              return result;
+            }
+          }
+          size_t bytes = 0;
+          for (int second = 0; bytes < 4 * 1024 * 1024; second++)
+          {
+            for (const char *text : kSessionLines)
+            {
+              std::ostringstream line;
+              line << "2026-01-01 10:" << (second / 60) % 60 << ":" << second % 60 << " " << text;
+              result.push_back(line.str());
+              bytes += result.back().size() + 1;
+            }
+          }
+          return result;
+        }();
+        return lines;
+      }
+
+      void SetLogCounters(benchmark::State &state)
+      {
+        int64_t bytes = 0;
+        for (const std::string &line : LogLines())
+        {
+          bytes += static_cast<int64_t>(line.size());
+        }
+        state.SetBytesProcessed(bytes * static_cast<int64_t>(state.iterations()));
+        state.SetItemsProcessed(static_cast<int64_t>(LogLines().size()) *
+                                static_cast<int64_t>(state.iterations()));
+      }
+
+    } // namespace
+
+    // The find() chains the plugin ran per line (9 signatures).
+    void BM_LogFindChain(benchmark::State &state)
+    {
+      const std::vector<std::string> &lines = LogLines();
+      for (auto _ : state)
+      {
+        int hits = 0;
+        for (const std::string &line : lines)
+        {
+          hits += FindChain(line);
+        }
+        benchmark::DoNotOptimize(hits);
+      }
+      SetLogCounters(state);
+    }
+    BENCHMARK(BM_LogFindChain)->Unit(benchmark::kMillisecond);
+
+    // One find() per entry of the full signature table.
+    void BM_LogFindEachSignature(benchmark::State &state)
+    {
+      const std::vector<std::string> &lines = LogLines();
+      for (auto _ : state)
+      {
+        LogEventMask all = 0;
+        for (const std::string &line : lines)
+        {
+          for (const LogSignature &signature : kLogSignatures)
+          {
+            if (std::string_view(line).find(signature.pattern) != std::string_view::npos)
+            {
+              all |= LogEventBit(signature.event);
+            }
+          }
+        }
+        benchmark::DoNotOptimize(all);
+      }
+      SetLogCounters(state);
+    }
+    BENCHMARK(BM_LogFindEachSignature)->Unit(benchmark::kMillisecond);
+
+    // The compiled matcher over the same table, one pass per line.
+    void BM_LogSignatureMatcher(benchmark::State &state)
+    {
+      const std::vector<std::string> &lines = LogLines();
+      const LogSignatureMatcher &matcher = LogSignatureMatcher::Default();
+      for (auto _ : state)
+      {
+        LogEventMask all = 0;
+        for (const std::string &line : lines)
+        {
+          all |= matcher.Match(line);
+        }
+        benchmark::DoNotOptimize(all);
+      }
+      SetLogCounters(state);
+    }
+    BENCHMARK(BM_LogSignatureMatcher)->Unit(benchmark::kMillisecond);
+
+  } // namespace benchmarks
+} // namespace openvpn_dart
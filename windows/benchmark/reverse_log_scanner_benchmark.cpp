@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "log_tail_reader.h"
+#include "reverse_log_scanner.h"
+
+namespace openvpn_dart
+{
+  namespace benchmarks
+  {
+
+    namespace
+    {
+
+      constexpr LogEventMask kSessionEndEvents = LogEventBit(LogEvent::kConnected) |
+                                                 LogEventBit(LogEvent::kExiting) |
+                                                 LogEventBit(LogEvent::kFatal);
+
+      // A log of |size| bytes of routine output with the decisive line a few
+      // hundred lines from the end. Kept between runs of the same size.
+      const std::string &LogOfSize(int64_t size)
+      {
+        static int64_t cached_size = -1;
+        static std::string path;
+        if (cached_size == size)
+        {
+          return path;
+        }
+        std::error_code ec;
+        if (!path.empty())
+        {
+          std::filesystem::remove(path, ec);
+        }
+        const auto stamp =
+            std::chrono::steady_clock::now().time_since_epoch().count();
+        path = (std::filesystem::temp_directory_path() /
+                ("openvpn_dart_bench_reverse_" + std::to_string(stamp) + ".log"))
+                   .string();
+
+        const std::string routine =
+            "2026-01-01 10:00:00 Data Channel: cipher 'AES-256-GCM', peer-id: 0\n";
+        std::string block;
+        while (block.size() < 1024 * 1024)
+        {
+          block += routine;
+        }
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        for (int64_t written = 0; written < size; written += static_cast<int64_t>(block.size()))
+        {
+          out.write(block.data(), static_cast<std::streamsize>(
+                                      std::min<int64_t>(size - written, static_cast<int64_t>(block.size()))));
+        }
+        out << "\n2026-01-01 10:00:01 Initialization Sequence Completed\n";
+        for (int i = 0; i < 300; i++)
+        {
+          out << routine;
+        }
+        cached_size = size;
+        return path;
+      }
+
+    } // namespace
+
+    // Reading the whole log forward and keeping the last decisive line.
+    void BM_LastStateForwardScan(benchmark::State &state)
+    {
+      const std::string &path = LogOfSize(state.range(0));
+      const LogSignatureMatcher &matcher = LogSignatureMatcher::Default();
+      for (auto _ : state)
+      {
+        LogTailReader reader(path);
+        LogEventMask last = 0;
+        reader.Poll([&](std::string_view line)
+                    {
+                      const LogEventMask events = matcher.Match(line) & kSessionEndEvents;
+                      if (events != 0)
+                      {
+                        last = events;
+                      } });
+        benchmark::DoNotOptimize(last);
+      }
+      state.SetBytesProcessed(state.range(0) * static_cast<int64_t>(state.iterations()));
+    }
+    BENCHMARK(BM_LastStateForwardScan)->RangeMultiplier(16)->Range(1 << 20, 1 << 30)->Unit(benchmark::kMillisecond);
+
+    // Reading backward from the end until the first decisive line.
+    void BM_LastStateReverseScan(benchmark::State &state)
+    {
+      const std::string &path = LogOfSize(state.range(0));
+      for (auto _ : state)
+      {
+        LastLogLine last;
+        benchmark::DoNotOptimize(FindLastLogLine(path, kSessionEndEvents, &last));
+      }
+    }
+    BENCHMARK(BM_LastStateReverseScan)->RangeMultiplier(16)->Range(1 << 20, 1 << 30)->Unit(benchmark::kMicrosecond);
+
+  } // namespace benchmarks
+} // namespace openvpn_dart
@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "route_aggregation.h"
+
+namespace openvpn_dart
+{
+  namespace benchmarks
+  {
+
+    namespace
+    {
+
+      // A split-tunnel profile with |count| IPv4 routes: runs of adjacent
+      // /24s, as country and provider lists are, plus scattered /32s, about
+      // one in ten of them inside a run. A tenth of the routes are IPv6.
+      std::string SplitTunnelProfile(int64_t count)
+      {
+        std::mt19937 random(42);
+        std::string profile = "client\ndev tun\nproto udp\nremote vpn.example.com 1194\n";
+        int64_t written = 0;
+        while (written < count)
+        {
+          const uint32_t base = random() & 0xFFFFFF00u;
+          const int run = 1 + static_cast<int>(random() % 16);
+          for (int i = 0; i < run && written < count; i++, written++)
+          {
+            const uint32_t network = base + (static_cast<uint32_t>(i) << 8);
+            profile += "route " + std::to_string(network >> 24) + "." + std::to_string((network >> 16) & 0xFF) +
+                       "." + std::to_string((network >> 8) & 0xFF) + ".0 255.255.255.0\n";
+          }
+          if (written < count && random() % 4 == 0)
+          {
+            const uint32_t host = random() % 10 == 0 ? base + (random() & 0xFF) : random();
+            profile += "route " + std::to_string(host >> 24) + "." + std::to_string((host >> 16) & 0xFF) + "." +
+                       std::to_string((host >> 8) & 0xFF) + "." + std::to_string(host & 0xFF) + "\n";
+            written++;
+          }
+          if (written < count && random() % 10 == 0)
+          {
+            char cidr[32];
+            std::snprintf(cidr, sizeof(cidr), "2001:db8:%x::/48", static_cast<unsigned>(random() & 0xFFFF));
+            profile += std::string("route-ipv6 ") + cidr + "\n";
+            written++;
+          }
+        }
+        return profile + "verb 3\n";
+      }
+
+    } // namespace
+
+    // Parse, aggregate and rewrite a whole profile, as done before launch.
+    void BM_AggregateRoutes(benchmark::State &state)
+    {
+      const std::string profile = SplitTunnelProfile(state.range(0));
+      RouteAggregationReport report;
+      for (auto _ : state)
+      {
+        std::string rewritten = AggregateRoutes(profile, &report);
+        benchmark::DoNotOptimize(rewritten);
+      }
+      state.SetItemsProcessed(state.range(0) * static_cast<int64_t>(state.iterations()));
+      state.SetBytesProcessed(static_cast<int64_t>(profile.size()) * static_cast<int64_t>(state.iterations()));
+      state.counters["before"] = static_cast<double>(report.ipv4_before + report.ipv6_before);
+      state.counters["after"] = static_cast<double>(report.ipv4_after + report.ipv6_after);
+    }
+    BENCHMARK(BM_AggregateRoutes)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+    // The trie alone on pre-parsed /24s.
+    void BM_RouteTrieAggregate(benchmark::State &state)
+    {
+      std::mt19937 random(7);
+      std::vector<RoutePrefix> prefixes(static_cast<size_t>(state.range(0)));
+      for (RoutePrefix &prefix : prefixes)
+      {
+        const uint32_t network = random() & 0xFFFFFF00u;
+        for (int i = 0; i < 4; i++)
+        {
+          prefix.address[i] = static_cast<uint8_t>(network >> (24 - 8 * i));
+        }
+        prefix.length = 24;
+      }
+      size_t after = 0;
+      for (auto _ : state)
+      {
+        RouteTrie trie(32);
+        for (const RoutePrefix &prefix : prefixes)
+        {
+          trie.Add(prefix, 0);
+        }
+        after = trie.Aggregate().size();
+        benchmark::DoNotOptimize(after);
+      }
+      state.SetItemsProcessed(state.range(0) * static_cast<int64_t>(state.iterations()));
+      state.counters["after"] = static_cast<double>(after);
+    }
+    BENCHMARK(BM_RouteTrieAggregate)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+  } // namespace benchmarks
+} // namespace openvpn_dart
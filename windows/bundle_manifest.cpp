@@ -0,0 +1,200 @@
+#include "bundle_manifest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    bool IsHexDigest(std::string_view text)
+    {
+      return text.size() == 64 &&
+             std::all_of(text.begin(), text.end(), [](char c)
+                         { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'); });
+    }
+
+    // Relative, without ".." components, so entries stay inside the bundle
+    bool IsSafeName(std::string_view name)
+    {
+      if (name.empty())
+      {
+        return false;
+      }
+      std::filesystem::path path{std::string(name)};
+      if (path.is_absolute() || path.has_root_name() || path.has_root_directory())
+      {
+        return false;
+      }
+      for (const auto &part : path)
+      {
+        if (part == "..")
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+  } // namespace
+
+  bool ParseBundleManifest(std::string_view text, std::vector<BundleEntry> *entries)
+  {
+    std::vector<BundleEntry> parsed;
+    while (!text.empty())
+    {
+      size_t newline = text.find('\n');
+      std::string_view line = text.substr(0, newline);
+      text = newline == std::string_view::npos ? std::string_view() : text.substr(newline + 1);
+      if (!line.empty() && line.back() == '\r')
+      {
+        line.remove_suffix(1);
+      }
+      if (line.empty() || line.front() == '#')
+      {
+        continue;
+      }
+
+      // The name is last so it may contain spaces
+      size_t first_space = line.find(' ');
+      size_t second_space = first_space == std::string_view::npos
+                                ? std::string_view::npos
+                                : line.find(' ', first_space + 1);
+      if (second_space == std::string_view::npos)
+      {
+        return false;
+      }
+
+      BundleEntry entry;
+      std::string_view digest = line.substr(0, first_space);
+      std::string_view size = line.substr(first_space + 1, second_space - first_space - 1);
+      std::string_view name = line.substr(second_space + 1);
+
+      auto size_result = std::from_chars(size.data(), size.data() + size.size(), entry.size);
+      if (!IsHexDigest(digest) || size_result.ec != std::errc() ||
+          size_result.ptr != size.data() + size.size() || !IsSafeName(name))
+      {
+        return false;
+      }
+      entry.sha256 = std::string(digest);
+      entry.name = std::string(name);
+      parsed.push_back(std::move(entry));
+    }
+
+    *entries = std::move(parsed);
+    return true;
+  }
+
+  std::vector<BundleEntry> PlanExtraction(const std::vector<BundleEntry> &manifest,
+                                          const std::string &dest_dir,
+                                          const FileHasher &hasher)
+  {
+    std::vector<BundleEntry> stale;
+    for (const BundleEntry &entry : manifest)
+    {
+      const std::string dest = (std::filesystem::path(dest_dir) / entry.name).string();
+      std::error_code ec;
+      const uint64_t size = std::filesystem::file_size(dest, ec);
+      std::string digest;
+      if (ec || size != entry.size || !hasher(dest, &digest) || digest != entry.sha256)
+      {
+        stale.push_back(entry);
+      }
+    }
+    return stale;
+  }
+
+  bool InstallFileAtomically(const std::string &source, const std::string &dest,
+                             uint64_t expected_size, std::string *error)
+  {
+    const std::filesystem::path dest_path(dest);
+    const std::filesystem::path temp_path = dest_path.string() + ".partial";
+    std::error_code ec;
+
+    std::filesystem::create_directories(dest_path.parent_path(), ec);
+    if (!std::filesystem::copy_file(source, temp_path,
+                                    std::filesystem::copy_options::overwrite_existing, ec))
+    {
+      *error = "copy " + source + ": " + ec.message();
+      std::filesystem::remove(temp_path, ec);
+      return false;
+    }
+
+    // A short copy must never replace a good file
+    const uint64_t copied = std::filesystem::file_size(temp_path, ec);
+    if (ec || copied != expected_size)
+    {
+      *error = "size mismatch for " + dest_path.string();
+      std::filesystem::remove(temp_path, ec);
+      return false;
+    }
+
+    std::filesystem::rename(temp_path, dest_path, ec);
+    if (ec)
+    {
+      *error = "rename " + dest_path.string() + ": " + ec.message();
+      std::filesystem::remove(temp_path, ec);
+      return false;
+    }
+    return true;
+  }
+
+  ExtractionResult ExtractBundle(const std::string &source_dir, const std::string &dest_dir,
+                                 const std::vector<BundleEntry> &manifest,
+                                 const FileHasher &hasher, size_t parallelism)
+  {
+    ExtractionResult result;
+    const std::vector<BundleEntry> stale = PlanExtraction(manifest, dest_dir, hasher);
+    result.up_to_date = manifest.size() - stale.size();
+    if (stale.empty())
+    {
+      return result;
+    }
+
+    std::atomic<size_t> next(0);
+    std::mutex result_mutex;
+    auto worker = [&]()
+    {
+      for (size_t i = next++; i < stale.size(); i = next++)
+      {
+        const BundleEntry &entry = stale[i];
+        std::string error;
+        const bool ok = InstallFileAtomically(
+            (std::filesystem::path(source_dir) / entry.name).string(),
+            (std::filesystem::path(dest_dir) / entry.name).string(), entry.size, &error);
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        if (ok)
+        {
+          result.copied++;
+        }
+        else
+        {
+          result.failed++;
+          result.errors.push_back(error);
+        }
+      }
+    };
+
+    const size_t threads = std::max<size_t>(1, std::min(parallelism, stale.size()));
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; i++)
+    {
+      pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : pool)
+    {
+      thread.join();
+    }
+    return result;
+  }
+
+} // namespace openvpn_dart
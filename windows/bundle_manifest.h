@@ -0,0 +1,60 @@
+#ifndef FLUTTER_PLUGIN_BUNDLE_MANIFEST_H_
+#define FLUTTER_PLUGIN_BUNDLE_MANIFEST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+    // Name of the manifest CMake writes next to the bundled files.
+    constexpr char kBundleManifestName[] = "openvpn_bundle.manifest";
+
+    // One bundled file as recorded at build time.
+    struct BundleEntry
+    {
+        std::string name; // Path relative to the bundle directory
+        uint64_t size = 0;
+        std::string sha256; // Lowercase hex
+    };
+
+    // Parses "<sha256> <size> <name>" lines. Blank lines and lines starting
+    // with '#' are skipped; malformed lines or names escaping the bundle
+    // directory fail the whole manifest.
+    bool ParseBundleManifest(std::string_view text, std::vector<BundleEntry> *entries);
+
+    // Computes the lowercase hex SHA-256 of a file.
+    using FileHasher = std::function<bool(const std::string &path, std::string *sha256)>;
+
+    // Entries whose copy under |dest_dir| is missing or differs. Sizes are
+    // compared first; a file is only hashed when its size already matches.
+    std::vector<BundleEntry> PlanExtraction(const std::vector<BundleEntry> &manifest,
+                                            const std::string &dest_dir,
+                                            const FileHasher &hasher);
+
+    // Copies |source| to a temporary file beside |dest| and renames it into
+    // place, so |dest| is either the old or the complete new file.
+    bool InstallFileAtomically(const std::string &source, const std::string &dest,
+                               uint64_t expected_size, std::string *error);
+
+    struct ExtractionResult
+    {
+        size_t up_to_date = 0;
+        size_t copied = 0;
+        size_t failed = 0;
+        std::vector<std::string> errors;
+    };
+
+    // Brings |dest_dir| in line with |manifest|, copying stale files from
+    // |source_dir| on up to |parallelism| threads.
+    ExtractionResult ExtractBundle(const std::string &source_dir, const std::string &dest_dir,
+                                   const std::vector<BundleEntry> &manifest,
+                                   const FileHasher &hasher, size_t parallelism);
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_BUNDLE_MANIFEST_H_
@@ -0,0 +1,307 @@
+#include "capability_cache.h"
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    std::string_view Trim(std::string_view text)
+    {
+      while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+      {
+        text.remove_prefix(1);
+      }
+      while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r'))
+      {
+        text.remove_suffix(1);
+      }
+      return text;
+    }
+
+    template <typename T>
+    bool ParseNumber(std::string_view text, T *value)
+    {
+      const char *end = text.data() + text.size();
+      auto result = std::from_chars(text.data(), end, *value);
+      return result.ec == std::errc() && result.ptr == end;
+    }
+
+    // The build line, e.g.
+    // "OpenVPN 2.6.9 [git:v2.6.9/6640a10bf6d84eee] Windows-MSVC [SSL (OpenSSL)] [LZO] [DCO] built on ..."
+    void ParseBuildLine(std::string_view line, OpenVPNCapabilities *capabilities)
+    {
+      line.remove_prefix(sizeof("OpenVPN ") - 1);
+      capabilities->version = std::string(line.substr(0, line.find(' ')));
+
+      size_t open = line.find('[');
+      while (open != std::string_view::npos)
+      {
+        size_t close = line.find(']', open);
+        if (close == std::string_view::npos)
+        {
+          break;
+        }
+        std::string_view feature = line.substr(open + 1, close - open - 1);
+        if (feature.substr(0, 4) != "git:")
+        {
+          capabilities->features.emplace_back(feature);
+          if (feature == "DCO")
+          {
+            capabilities->dco_compiled = true;
+          }
+        }
+        open = line.find('[', close);
+      }
+    }
+
+  } // namespace
+
+  bool OpenVPNCapabilities::SupportsDCO() const
+  {
+    // Compiled in is not enough: the version is "N/A" without the kernel driver
+    return dco_compiled && !dco_version.empty() &&
+           dco_version.find("N/A") == std::string::npos;
+  }
+
+  OpenVPNCapabilities ParseVersionOutput(std::string_view output)
+  {
+    OpenVPNCapabilities capabilities;
+    while (!output.empty())
+    {
+      size_t newline = output.find('\n');
+      std::string_view line = Trim(output.substr(0, newline));
+      output = newline == std::string_view::npos ? std::string_view() : output.substr(newline + 1);
+
+      if (!capabilities.probed && line.substr(0, 8) == "OpenVPN ")
+      {
+        ParseBuildLine(line, &capabilities);
+        capabilities.probed = !capabilities.version.empty();
+      }
+      else if (line.substr(0, 12) == "DCO version:")
+      {
+        capabilities.dco_version = std::string(Trim(line.substr(12)));
+      }
+    }
+    return capabilities;
+  }
+
+  bool ExecutableStamp::operator==(const ExecutableStamp &other) const
+  {
+    return path == other.path && size == other.size && mtime == other.mtime;
+  }
+
+  bool StampExecutable(const std::string &path, ExecutableStamp *stamp)
+  {
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+    {
+      return false;
+    }
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec)
+    {
+      return false;
+    }
+    stamp->path = path;
+    stamp->size = size;
+    stamp->mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return true;
+  }
+
+  std::string SerializeCapabilities(const ExecutableStamp &stamp,
+                                    const OpenVPNCapabilities &capabilities)
+  {
+    std::string features;
+    for (const std::string &feature : capabilities.features)
+    {
+      if (!features.empty())
+      {
+        features += ';';
+      }
+      features += feature;
+    }
+
+    std::ostringstream out;
+    out << "path=" << stamp.path << "\n"
+        << "size=" << stamp.size << "\n"
+        << "mtime=" << stamp.mtime << "\n"
+        << "version=" << capabilities.version << "\n"
+        << "features=" << features << "\n"
+        << "dco_compiled=" << (capabilities.dco_compiled ? 1 : 0) << "\n"
+        << "dco_version=" << capabilities.dco_version << "\n";
+    return out.str();
+  }
+
+  bool ParseCapabilities(std::string_view text, ExecutableStamp *stamp,
+                         OpenVPNCapabilities *capabilities)
+  {
+    ExecutableStamp parsed_stamp;
+    OpenVPNCapabilities parsed;
+    bool has_size = false;
+    bool has_mtime = false;
+
+    while (!text.empty())
+    {
+      size_t newline = text.find('\n');
+      std::string_view line = text.substr(0, newline);
+      text = newline == std::string_view::npos ? std::string_view() : text.substr(newline + 1);
+      if (!line.empty() && line.back() == '\r')
+      {
+        line.remove_suffix(1);
+      }
+
+      size_t equals = line.find('=');
+      if (equals == std::string_view::npos)
+      {
+        continue;
+      }
+      std::string_view key = line.substr(0, equals);
+      std::string_view value = line.substr(equals + 1);
+
+      if (key == "path")
+      {
+        parsed_stamp.path = std::string(value);
+      }
+      else if (key == "size")
+      {
+        has_size = ParseNumber(value, &parsed_stamp.size);
+      }
+      else if (key == "mtime")
+      {
+        has_mtime = ParseNumber(value, &parsed_stamp.mtime);
+      }
+      else if (key == "version")
+      {
+        parsed.version = std::string(value);
+      }
+      else if (key == "features")
+      {
+        while (!value.empty())
+        {
+          size_t separator = value.find(';');
+          parsed.features.emplace_back(value.substr(0, separator));
+          value = separator == std::string_view::npos ? std::string_view() : value.substr(separator + 1);
+        }
+      }
+      else if (key == "dco_compiled")
+      {
+        parsed.dco_compiled = value == "1";
+      }
+      else if (key == "dco_version")
+      {
+        parsed.dco_version = std::string(value);
+      }
+    }
+
+    if (parsed_stamp.path.empty() || !has_size || !has_mtime || parsed.version.empty())
+    {
+      return false;
+    }
+    parsed.probed = true;
+    *stamp = std::move(parsed_stamp);
+    *capabilities = std::move(parsed);
+    return true;
+  }
+
+  CapabilityCache::CapabilityCache(std::string executable_path, std::string cache_path,
+                                   Prober prober)
+      : executable_path_(std::move(executable_path)),
+        cache_path_(std::move(cache_path)),
+        prober_(std::move(prober)),
+        probing_(false),
+        valid_(false),
+        probe_count_(0)
+  {
+  }
+
+  CapabilityCache::~CapabilityCache()
+  {
+    if (probe_thread_.joinable())
+    {
+      probe_thread_.join();
+    }
+  }
+
+  void CapabilityCache::ProbeAsync()
+  {
+    if (probe_thread_.joinable())
+    {
+      probe_thread_.join();
+    }
+    probe_thread_ = std::thread([this]()
+                                { Get(); });
+  }
+
+  OpenVPNCapabilities CapabilityCache::Get()
+  {
+    ExecutableStamp current;
+    if (!StampExecutable(executable_path_, &current))
+    {
+      return OpenVPNCapabilities();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    probed_cv_.wait(lock, [this]()
+                    { return !probing_; });
+    if (valid_ && stamp_ == current)
+    {
+      return capabilities_;
+    }
+
+    // Probed by an earlier run against the same executable
+    if (!valid_)
+    {
+      std::ifstream in(cache_path_, std::ios::binary);
+      if (in)
+      {
+        std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        ExecutableStamp stored_stamp;
+        OpenVPNCapabilities stored;
+        if (ParseCapabilities(text, &stored_stamp, &stored) && stored_stamp == current)
+        {
+          stamp_ = stored_stamp;
+          capabilities_ = stored;
+          valid_ = true;
+          return capabilities_;
+        }
+      }
+    }
+
+    // Missing or stale: probe without holding the lock, other callers wait
+    // on |probed_cv_| instead of spawning their own process
+    probing_ = true;
+    lock.unlock();
+
+    OpenVPNCapabilities probed;
+    std::string output;
+    ++probe_count_;
+    if (prober_ && prober_(executable_path_, &output))
+    {
+      probed = ParseVersionOutput(output);
+    }
+
+    lock.lock();
+    probing_ = false;
+    if (probed.probed)
+    {
+      stamp_ = current;
+      capabilities_ = probed;
+      valid_ = true;
+
+      std::ofstream out(cache_path_, std::ios::binary | std::ios::trunc);
+      out << SerializeCapabilities(stamp_, capabilities_);
+    }
+    probed_cv_.notify_all();
+    return probed;
+  }
+
+} // namespace openvpn_dart
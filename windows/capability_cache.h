@@ -0,0 +1,96 @@
+#ifndef FLUTTER_PLUGIN_CAPABILITY_CACHE_H_
+#define FLUTTER_PLUGIN_CAPABILITY_CACHE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+    // What `openvpn --version` reports about a build.
+    struct OpenVPNCapabilities
+    {
+        bool probed = false;               // False when the output was unusable
+        std::string version;               // e.g. "2.6.9"
+        std::vector<std::string> features; // Bracketed build flags, e.g. "DCO"
+        bool dco_compiled = false;         // [DCO] among the build flags
+        std::string dco_version;           // "DCO version:" value, "N/A" if unavailable
+
+        bool SupportsDCO() const;
+    };
+
+    // Parses the output of `openvpn --version`.
+    OpenVPNCapabilities ParseVersionOutput(std::string_view output);
+
+    // Identity of the executable the capabilities were probed from. A changed
+    // size or modification time means the bundle was replaced.
+    struct ExecutableStamp
+    {
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+
+        bool operator==(const ExecutableStamp &other) const;
+        bool operator!=(const ExecutableStamp &other) const { return !(*this == other); }
+    };
+
+    // Stats |path|; returns false if it does not exist.
+    bool StampExecutable(const std::string &path, ExecutableStamp *stamp);
+
+    // Line-based key=value form stored next to the bundle.
+    std::string SerializeCapabilities(const ExecutableStamp &stamp,
+                                      const OpenVPNCapabilities &capabilities);
+    bool ParseCapabilities(std::string_view text, ExecutableStamp *stamp,
+                           OpenVPNCapabilities *capabilities);
+
+    // Probes an OpenVPN executable once and remembers the result in memory
+    // and in |cache_path|, keyed by the executable's ExecutableStamp.
+    //
+    // Get() is cheap after the first probe: it re-stats the executable and
+    // only runs the prober again when the stamp changed. ProbeAsync() warms
+    // the cache on a background thread; a Get() racing it waits for that
+    // probe instead of starting a second one.
+    class CapabilityCache
+    {
+    public:
+        // Runs `<executable> --version` and returns its output; false if the
+        // process could not be started.
+        using Prober = std::function<bool(const std::string &executable, std::string *output)>;
+
+        CapabilityCache(std::string executable_path, std::string cache_path, Prober prober);
+        ~CapabilityCache();
+
+        CapabilityCache(const CapabilityCache &) = delete;
+        CapabilityCache &operator=(const CapabilityCache &) = delete;
+
+        void ProbeAsync();
+        OpenVPNCapabilities Get();
+
+        // Number of times the prober ran.
+        int probe_count() const { return probe_count_; }
+
+    private:
+        std::string executable_path_;
+        std::string cache_path_;
+        Prober prober_;
+
+        std::mutex mutex_;
+        std::condition_variable probed_cv_;
+        bool probing_;
+        bool valid_;
+        ExecutableStamp stamp_;
+        OpenVPNCapabilities capabilities_;
+        std::atomic<int> probe_count_;
+        std::thread probe_thread_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_CAPABILITY_CACHE_H_
@@ -0,0 +1,256 @@
+#include "command_executor.h"
+
+#include <utility>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+  const char *CancelReasonName(CancelReason reason)
+  {
+    switch (reason)
+    {
+    case CancelReason::kNone:
+      return "none";
+    case CancelReason::kCancelled:
+      return "cancelled";
+    case CancelReason::kDeadlineExceeded:
+      return "deadline exceeded";
+    case CancelReason::kShutdown:
+      return "shut down";
+    }
+    return "unknown";
+  }
+
+  CommandContext::CommandContext(Clock::time_point deadline)
+      : deadline_(deadline),
+        reason_(CancelReason::kNone)
+  {
+  }
+
+  CancelReason CommandContext::reason() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (reason_ == CancelReason::kNone && Clock::now() >= deadline_)
+    {
+      return CancelReason::kDeadlineExceeded;
+    }
+    return reason_;
+  }
+
+  void CommandContext::ThrowIfCancelled() const
+  {
+    const CancelReason why = reason();
+    if (why != CancelReason::kNone)
+    {
+      throw CommandCancelled(why);
+    }
+  }
+
+  bool CommandContext::SleepFor(int ms) const
+  {
+    auto until = Clock::now() + std::chrono::milliseconds(ms > 0 ? ms : 0);
+    if (until > deadline_)
+    {
+      until = deadline_;
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait_until(lock, until, [this]()
+                     { return reason_ != CancelReason::kNone; });
+    }
+    return !cancelled();
+  }
+
+  int64_t CommandContext::remaining_ms() const
+  {
+    if (deadline_ == Clock::time_point::max())
+    {
+      return -1;
+    }
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline_ - Clock::now());
+    return left.count() > 0 ? left.count() : 0;
+  }
+
+  void CommandContext::Cancel(CancelReason reason)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (reason_ != CancelReason::kNone)
+      {
+        return;
+      }
+      reason_ = reason;
+    }
+    cv_.notify_all();
+  }
+
+  CommandExecutor::CommandExecutor()
+      : next_id_(1),
+        stopping_(false)
+  {
+    worker_ = std::thread(&CommandExecutor::Run, this);
+  }
+
+  CommandExecutor::~CommandExecutor()
+  {
+    Shutdown();
+  }
+
+  CommandExecutor::CommandId CommandExecutor::Submit(std::string name, int64_t timeout_ms, Work work,
+                                                     Dropped on_dropped)
+  {
+    auto deadline = CommandContext::Clock::time_point::max();
+    if (timeout_ms > 0)
+    {
+      deadline = CommandContext::Clock::now() + std::chrono::milliseconds(timeout_ms);
+    }
+
+    CommandId id;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!stopping_)
+      {
+        id = next_id_++;
+        queue_.push_back(Command{id, std::move(name), std::move(work), std::move(on_dropped),
+                                 std::make_shared<CommandContext>(deadline)});
+        cv_.notify_all();
+        return id;
+      }
+    }
+    if (on_dropped)
+    {
+      on_dropped(CancelReason::kShutdown);
+    }
+    return kInvalidCommand;
+  }
+
+  size_t CommandExecutor::Cancel(const std::string &name)
+  {
+    return CancelMatching(&name, CancelReason::kCancelled);
+  }
+
+  size_t CommandExecutor::CancelAll()
+  {
+    return CancelMatching(nullptr, CancelReason::kCancelled);
+  }
+
+  size_t CommandExecutor::CancelMatching(const std::string *name, CancelReason reason)
+  {
+    std::vector<Command> dropped;
+    size_t reached = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto it = queue_.begin(); it != queue_.end();)
+      {
+        if (name == nullptr || it->name == *name)
+        {
+          dropped.push_back(std::move(*it));
+          it = queue_.erase(it);
+        }
+        else
+        {
+          ++it;
+        }
+      }
+      if (current_ && (name == nullptr || current_name_ == *name))
+      {
+        current_->Cancel(reason);
+        reached++;
+      }
+      cv_.notify_all();
+    }
+
+    // Outside the lock: a callback may submit the next command
+    for (Command &command : dropped)
+    {
+      if (command.on_dropped)
+      {
+        command.on_dropped(reason);
+      }
+    }
+    return reached + dropped.size();
+  }
+
+  void CommandExecutor::WaitIdle()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]()
+             { return queue_.empty() && !current_; });
+  }
+
+  void CommandExecutor::Shutdown()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    CancelMatching(nullptr, CancelReason::kShutdown);
+    if (worker_.joinable() && worker_.get_id() != std::this_thread::get_id())
+    {
+      worker_.join();
+    }
+  }
+
+  size_t CommandExecutor::queued() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+  }
+
+  std::string CommandExecutor::running() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_ ? current_name_ : std::string();
+  }
+
+  void CommandExecutor::Run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      cv_.wait(lock, [this]()
+               { return stopping_ || !queue_.empty(); });
+      if (queue_.empty())
+      {
+        return;
+      }
+      Command command = std::move(queue_.front());
+      queue_.pop_front();
+
+      // Expired while waiting its turn
+      const CancelReason why = command.context->reason();
+      if (why != CancelReason::kNone)
+      {
+        lock.unlock();
+        if (command.on_dropped)
+        {
+          command.on_dropped(why);
+        }
+        lock.lock();
+        cv_.notify_all();
+        continue;
+      }
+
+      current_ = command.context;
+      current_name_ = command.name;
+      lock.unlock();
+
+      try
+      {
+        command.work(*command.context);
+      }
+      catch (...)
+      {
+        // Commands report their own failures; one that escapes must not
+        // take the worker down with it
+      }
+
+      lock.lock();
+      current_.reset();
+      current_name_.clear();
+      cv_.notify_all();
+    }
+  }
+
+} // namespace openvpn_dart
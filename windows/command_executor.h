@@ -0,0 +1,151 @@
+#ifndef FLUTTER_PLUGIN_COMMAND_EXECUTOR_H_
+#define FLUTTER_PLUGIN_COMMAND_EXECUTOR_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace openvpn_dart
+{
+
+    enum class CancelReason
+    {
+        kNone,
+        // Cancel() or CancelAll() reached the command
+        kCancelled,
+        // The command's deadline passed
+        kDeadlineExceeded,
+        // The executor shut down before the command finished
+        kShutdown,
+    };
+
+    const char *CancelReasonName(CancelReason reason);
+
+    // Thrown by CommandContext::ThrowIfCancelled() so a command can unwind
+    // from deep inside a blocking step.
+    class CommandCancelled : public std::runtime_error
+    {
+    public:
+        explicit CommandCancelled(CancelReason reason)
+            : std::runtime_error(CancelReasonName(reason)), reason_(reason) {}
+
+        CancelReason reason() const { return reason_; }
+
+    private:
+        CancelReason reason_;
+    };
+
+    // What a running command sees of its own cancellation. Blocking steps
+    // wait through SleepFor() or poll cancelled() in short slices, so a
+    // cancel or an expired deadline ends them within one slice.
+    class CommandContext
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit CommandContext(Clock::time_point deadline = Clock::time_point::max());
+
+        CommandContext(const CommandContext &) = delete;
+        CommandContext &operator=(const CommandContext &) = delete;
+
+        // kNone while the command may go on.
+        CancelReason reason() const;
+        bool cancelled() const { return reason() != CancelReason::kNone; }
+        void ThrowIfCancelled() const;
+
+        // Sleeps up to |ms|; returns false as soon as the command is
+        // cancelled or its deadline passes.
+        bool SleepFor(int ms) const;
+
+        // Milliseconds left before the deadline; -1 without one.
+        int64_t remaining_ms() const;
+
+        // Any thread; the first reason sticks.
+        void Cancel(CancelReason reason);
+
+    private:
+        const Clock::time_point deadline_;
+        mutable std::mutex mutex_;
+        mutable std::condition_variable cv_;
+        CancelReason reason_;
+    };
+
+    // Runs commands one at a time, in submission order, on a single worker
+    // thread, so the caller returns at once and operations on shared state
+    // never overlap.
+    //
+    // A command cancelled or timed out while still queued never runs; its
+    // |on_dropped| is called instead (on the cancelling thread, or on the
+    // worker for a deadline). A running command learns of it through its
+    // CommandContext. All methods may be called from any thread.
+    class CommandExecutor
+    {
+    public:
+        using CommandId = uint64_t;
+        using Work = std::function<void(CommandContext &context)>;
+        using Dropped = std::function<void(CancelReason reason)>;
+
+        static constexpr CommandId kInvalidCommand = 0;
+
+        CommandExecutor();
+        // Shutdown()
+        ~CommandExecutor();
+
+        CommandExecutor(const CommandExecutor &) = delete;
+        CommandExecutor &operator=(const CommandExecutor &) = delete;
+
+        // Queues |work| under |name|; |timeout_ms| <= 0 means no deadline.
+        // The deadline counts from submission, queueing included. After
+        // Shutdown() nothing is queued and |on_dropped| runs at once.
+        CommandId Submit(std::string name, int64_t timeout_ms, Work work,
+                         Dropped on_dropped = nullptr);
+
+        // Cancels every queued or running command named |name|; returns how
+        // many were reached.
+        size_t Cancel(const std::string &name);
+        size_t CancelAll();
+
+        // Blocks until the queue is empty and nothing runs.
+        void WaitIdle();
+
+        // Cancels everything, waits for the running command and stops the
+        // worker.
+        void Shutdown();
+
+        size_t queued() const;
+        // Name of the running command; empty when idle.
+        std::string running() const;
+
+    private:
+        struct Command
+        {
+            CommandId id;
+            std::string name;
+            Work work;
+            Dropped on_dropped;
+            std::shared_ptr<CommandContext> context;
+        };
+
+        void Run();
+        size_t CancelMatching(const std::string *name, CancelReason reason);
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<Command> queue_;
+        std::shared_ptr<CommandContext> current_;
+        std::string current_name_;
+        CommandId next_id_;
+        bool stopping_;
+        std::thread worker_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_COMMAND_EXECUTOR_H_
@@ -0,0 +1,159 @@
+#include "connect_timings.h"
+
+#include <algorithm>
+
+namespace openvpn_dart
+{
+
+  const char *ConnectMilestoneName(ConnectMilestone milestone)
+  {
+    switch (milestone)
+    {
+    case ConnectMilestone::kConfigWritten:
+      return "configWritten";
+    case ConnectMilestone::kProcessStarted:
+      return "processStarted";
+    case ConnectMilestone::kStandbyReleased:
+      return "standbyReleased";
+    case ConnectMilestone::kStartupChecked:
+      return "startupChecked";
+    case ConnectMilestone::kManagementAttached:
+      return "managementAttached";
+    case ConnectMilestone::kResolve:
+      return "resolve";
+    case ConnectMilestone::kTcpConnect:
+      return "tcpConnect";
+    case ConnectMilestone::kWait:
+      return "wait";
+    case ConnectMilestone::kAuth:
+      return "auth";
+    case ConnectMilestone::kGetConfig:
+      return "getConfig";
+    case ConnectMilestone::kAssignIp:
+      return "assignIp";
+    case ConnectMilestone::kAddRoutes:
+      return "addRoutes";
+    case ConnectMilestone::kConnected:
+      return "connected";
+    case ConnectMilestone::kCount:
+      break;
+    }
+    return "unknown";
+  }
+
+  ConnectMilestone MilestoneForState(ManagementState state)
+  {
+    switch (state)
+    {
+    case ManagementState::kResolve:
+      return ConnectMilestone::kResolve;
+    case ManagementState::kTcpConnect:
+      return ConnectMilestone::kTcpConnect;
+    case ManagementState::kWait:
+      return ConnectMilestone::kWait;
+    case ManagementState::kAuth:
+      return ConnectMilestone::kAuth;
+    case ManagementState::kGetConfig:
+      return ConnectMilestone::kGetConfig;
+    case ManagementState::kAssignIp:
+      return ConnectMilestone::kAssignIp;
+    case ManagementState::kAddRoutes:
+      return ConnectMilestone::kAddRoutes;
+    case ManagementState::kConnected:
+      return ConnectMilestone::kConnected;
+    default:
+      return ConnectMilestone::kCount;
+    }
+  }
+
+  const char *ConnectOutcomeName(ConnectOutcome outcome)
+  {
+    switch (outcome)
+    {
+    case ConnectOutcome::kPending:
+      return "pending";
+    case ConnectOutcome::kConnected:
+      return "connected";
+    case ConnectOutcome::kFailed:
+      return "failed";
+    case ConnectOutcome::kCancelled:
+      return "cancelled";
+    }
+    return "unknown";
+  }
+
+  ConnectTimingRecorder::ConnectTimingRecorder(size_t capacity)
+      : capacity_(std::max<size_t>(capacity, 1)),
+        start_ms_(0),
+        next_sequence_(1)
+  {
+  }
+
+  void ConnectTimingRecorder::Begin(int64_t now_ms, int64_t unix_ms, bool prewarmed)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!sessions_.empty() && sessions_.back().outcome == ConnectOutcome::kPending)
+    {
+      sessions_.back().outcome = ConnectOutcome::kCancelled;
+      sessions_.back().total_ms = now_ms - start_ms_;
+    }
+    if (sessions_.size() == capacity_)
+    {
+      sessions_.pop_front();
+    }
+
+    ConnectTimings timings;
+    timings.sequence = next_sequence_++;
+    timings.start_unix_ms = unix_ms;
+    timings.prewarmed = prewarmed;
+    sessions_.push_back(timings);
+    start_ms_ = now_ms;
+  }
+
+  void ConnectTimingRecorder::Mark(ConnectMilestone milestone, int64_t now_ms)
+  {
+    if (milestone == ConnectMilestone::kCount)
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sessions_.empty() || sessions_.back().outcome != ConnectOutcome::kPending)
+    {
+      return;
+    }
+    int64_t &at = sessions_.back().milestone_ms[static_cast<size_t>(milestone)];
+    if (at < 0)
+    {
+      at = std::max<int64_t>(now_ms - start_ms_, 0);
+    }
+  }
+
+  void ConnectTimingRecorder::Finish(ConnectOutcome outcome, int64_t now_ms)
+  {
+    if (outcome == ConnectOutcome::kConnected)
+    {
+      Mark(ConnectMilestone::kConnected, now_ms);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sessions_.empty() || sessions_.back().outcome != ConnectOutcome::kPending ||
+        outcome == ConnectOutcome::kPending)
+    {
+      return;
+    }
+    sessions_.back().outcome = outcome;
+    sessions_.back().total_ms = std::max<int64_t>(now_ms - start_ms_, 0);
+  }
+
+  bool ConnectTimingRecorder::pending() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !sessions_.empty() && sessions_.back().outcome == ConnectOutcome::kPending;
+  }
+
+  std::vector<ConnectTimings> ConnectTimingRecorder::Sessions() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<ConnectTimings>(sessions_.begin(), sessions_.end());
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,108 @@
+#ifndef FLUTTER_PLUGIN_CONNECT_TIMINGS_H_
+#define FLUTTER_PLUGIN_CONNECT_TIMINGS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "management_client.h"
+
+namespace openvpn_dart
+{
+
+    // Points a connect passes on its way up, in the order they normally
+    // happen. Differences between neighbours are the phases, e.g.
+    // kStartupChecked - kProcessStarted is the fixed start-up wait and
+    // kConnected - kAddRoutes is route installation.
+    enum class ConnectMilestone : uint8_t
+    {
+        kConfigWritten,      // Profile on disk
+        kProcessStarted,     // CreateProcess returned
+        kStandbyReleased,    // Prewarmed process told to go ("hold release")
+        kStartupChecked,     // Early-exit check passed
+        kManagementAttached, // Management client connected
+        // OpenVPN's own states, from the management interface
+        kResolve,
+        kTcpConnect,
+        kWait,      // Initial packet sent, waiting for the server
+        kAuth,      // TLS handshake
+        kGetConfig, // Pulling options from the server
+        kAssignIp,
+        kAddRoutes, // After --route-delay, routes going in
+        kConnected,
+        kCount
+    };
+
+    const char *ConnectMilestoneName(ConnectMilestone milestone);
+
+    // The milestone a management state marks; kCount for none.
+    ConnectMilestone MilestoneForState(ManagementState state);
+
+    enum class ConnectOutcome : uint8_t
+    {
+        kPending,
+        kConnected,
+        kFailed,    // OpenVPN exited or failed to start
+        kCancelled, // Disconnected, cancelled or superseded first
+    };
+
+    const char *ConnectOutcomeName(ConnectOutcome outcome);
+
+    struct ConnectTimings
+    {
+        // Connects recorded since the plugin started, from 1
+        uint64_t sequence = 0;
+        // Wall clock at the request, to line sessions up with other data
+        int64_t start_unix_ms = 0;
+        bool prewarmed = false;
+        ConnectOutcome outcome = ConnectOutcome::kPending;
+        // Request to outcome; -1 while pending
+        int64_t total_ms = -1;
+        // Since the request; -1 if not reached
+        std::array<int64_t, static_cast<size_t>(ConnectMilestone::kCount)> milestone_ms;
+
+        ConnectTimings() { milestone_ms.fill(-1); }
+
+        int64_t at(ConnectMilestone milestone) const
+        {
+            return milestone_ms[static_cast<size_t>(milestone)];
+        }
+    };
+
+    // Timings of the last |capacity| connects, each milestone stamped with
+    // monotonic time when first reached. Only the newest connect is open
+    // for marks; all methods may be called from any thread.
+    class ConnectTimingRecorder
+    {
+    public:
+        explicit ConnectTimingRecorder(size_t capacity = 32);
+
+        // Opens a new connect; one still pending ends as kCancelled.
+        void Begin(int64_t now_ms, int64_t unix_ms, bool prewarmed);
+
+        // Ignored without a pending connect or if already reached.
+        void Mark(ConnectMilestone milestone, int64_t now_ms);
+
+        // Closes the pending connect, if any. kConnected also marks the
+        // kConnected milestone.
+        void Finish(ConnectOutcome outcome, int64_t now_ms);
+
+        bool pending() const;
+
+        // Oldest first, the pending connect included.
+        std::vector<ConnectTimings> Sessions() const;
+
+    private:
+        const size_t capacity_;
+        mutable std::mutex mutex_;
+        std::deque<ConnectTimings> sessions_;
+        int64_t start_ms_;
+        uint64_t next_sequence_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_CONNECT_TIMINGS_H_
@@ -0,0 +1,36 @@
+#include "event_queue.h"
+
+namespace openvpn_dart
+{
+
+  EventRateWindow::EventRateWindow(int64_t window_ms)
+      : window_ms_(window_ms > 0 ? window_ms : 1),
+        start_ms_(-1),
+        events_(0),
+        batches_(0),
+        events_per_second_(0),
+        batches_per_second_(0)
+  {
+  }
+
+  void EventRateWindow::Record(int64_t now_ms, size_t events)
+  {
+    if (start_ms_ < 0)
+    {
+      start_ms_ = now_ms;
+    }
+    events_ += events;
+    batches_++;
+
+    const int64_t elapsed_ms = now_ms - start_ms_;
+    if (elapsed_ms >= window_ms_)
+    {
+      events_per_second_ = static_cast<double>(events_) * 1000.0 / static_cast<double>(elapsed_ms);
+      batches_per_second_ = static_cast<double>(batches_) * 1000.0 / static_cast<double>(elapsed_ms);
+      start_ms_ = now_ms;
+      events_ = 0;
+      batches_ = 0;
+    }
+  }
+
+} // namespace openvpn_dart
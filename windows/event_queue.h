@@ -0,0 +1,208 @@
+#ifndef FLUTTER_PLUGIN_EVENT_QUEUE_H_
+#define FLUTTER_PLUGIN_EVENT_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+    struct EventQueueMetrics
+    {
+        uint64_t published = 0; // Events pushed
+        uint64_t delivered = 0; // Events handed out in batches
+        uint64_t coalesced = 0; // Events superseded before delivery
+        uint64_t batches = 0;
+        size_t depth = 0;     // Events waiting now
+        size_t max_depth = 0; // Most events ever waiting at once
+        double events_per_second = 0;
+        double batches_per_second = 0;
+    };
+
+    // Delivery rates over windows of at least |window_ms|, updated by the
+    // consumer as it drains.
+    class EventRateWindow
+    {
+    public:
+        explicit EventRateWindow(int64_t window_ms = 1000);
+
+        void Record(int64_t now_ms, size_t events);
+
+        double events_per_second() const { return events_per_second_; }
+        double batches_per_second() const { return batches_per_second_; }
+
+    private:
+        const int64_t window_ms_;
+        int64_t start_ms_;
+        uint64_t events_;
+        uint64_t batches_;
+        double events_per_second_;
+        double batches_per_second_;
+    };
+
+    // Unbounded multi-producer, single-consumer event queue.
+    //
+    // Push() is lock-free (one atomic exchange) and may be called from any
+    // thread. Drain() belongs to one consumer at a time and hands out
+    // everything pushed so far as one batch. Events pushed with the same
+    // non-zero |coalesce_key| supersede each other within a batch, so a
+    // burst of samples reaches the consumer as the newest one.
+    //
+    // Push() reports when the consumer needs waking: exactly once between
+    // two drains, so a burst costs one wake-up however long it is.
+    template <typename T>
+    class EventQueue
+    {
+    public:
+        EventQueue()
+            : head_(new Node()),
+              tail_(head_),
+              depth_(0),
+              max_depth_(0),
+              published_(0),
+              drain_scheduled_(false),
+              delivered_(0),
+              coalesced_(0),
+              batches_(0)
+        {
+        }
+
+        ~EventQueue()
+        {
+            while (head_ != nullptr)
+            {
+                Node *next = head_->next.load(std::memory_order_relaxed);
+                delete head_;
+                head_ = next;
+            }
+        }
+
+        EventQueue(const EventQueue &) = delete;
+        EventQueue &operator=(const EventQueue &) = delete;
+
+        // Returns true if the caller should schedule a Drain().
+        bool Push(T value, uint32_t coalesce_key = 0)
+        {
+            Node *node = new Node();
+            node->value = std::move(value);
+            node->key = coalesce_key;
+
+            // Counted before the node is visible, so the consumer never
+            // takes away more than was added
+            published_.fetch_add(1, std::memory_order_relaxed);
+            const size_t depth = depth_.fetch_add(1, std::memory_order_relaxed) + 1;
+            size_t max_depth = max_depth_.load(std::memory_order_relaxed);
+            while (depth > max_depth &&
+                   !max_depth_.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed))
+            {
+            }
+
+            Node *prev = tail_.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+            return !drain_scheduled_.exchange(true, std::memory_order_acq_rel);
+        }
+
+        // Appends every event pushed so far to |batch|, coalesced; returns
+        // how many were appended. A Push() racing with the drain either
+        // lands in this batch or asks for another drain.
+        size_t Drain(int64_t now_ms, std::vector<T> *batch)
+        {
+            // Acquires every push that saw the drain already scheduled
+            drain_scheduled_.exchange(false, std::memory_order_acq_rel);
+
+            const size_t first = batch->size();
+            keyed_.clear();
+            size_t taken = 0;
+            Node *next;
+            while ((next = head_->next.load(std::memory_order_acquire)) != nullptr)
+            {
+                delete head_;
+                head_ = next;
+                taken++;
+                if (next->key != 0 && Supersede(next->key, std::move(next->value), batch))
+                {
+                    continue;
+                }
+                if (next->key != 0)
+                {
+                    keyed_.emplace_back(next->key, batch->size());
+                }
+                batch->push_back(std::move(next->value));
+            }
+            if (taken == 0)
+            {
+                return 0;
+            }
+
+            const size_t appended = batch->size() - first;
+            depth_.fetch_sub(taken, std::memory_order_relaxed);
+            delivered_ += appended;
+            coalesced_ += taken - appended;
+            batches_++;
+            rates_.Record(now_ms, appended);
+            return appended;
+        }
+
+        size_t depth() const { return depth_.load(std::memory_order_relaxed); }
+
+        // Consumer thread; depth and counts from producers are approximate.
+        EventQueueMetrics Metrics() const
+        {
+            EventQueueMetrics metrics;
+            metrics.published = published_.load(std::memory_order_relaxed);
+            metrics.delivered = delivered_;
+            metrics.coalesced = coalesced_;
+            metrics.batches = batches_;
+            metrics.depth = depth_.load(std::memory_order_relaxed);
+            metrics.max_depth = max_depth_.load(std::memory_order_relaxed);
+            metrics.events_per_second = rates_.events_per_second();
+            metrics.batches_per_second = rates_.batches_per_second();
+            return metrics;
+        }
+
+    private:
+        struct Node
+        {
+            std::atomic<Node *> next{nullptr};
+            T value{};
+            uint32_t key = 0;
+        };
+
+        // Replaces this batch's earlier event with |key|, if there is one
+        bool Supersede(uint32_t key, T &&value, std::vector<T> *batch)
+        {
+            for (const auto &entry : keyed_)
+            {
+                if (entry.first == key)
+                {
+                    (*batch)[entry.second] = std::move(value);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Consumer side: |head_| is the last node handed out (or the
+        // initial stub); its successors are the pending events
+        Node *head_;
+        std::atomic<Node *> tail_;
+
+        std::atomic<size_t> depth_;
+        std::atomic<size_t> max_depth_;
+        std::atomic<uint64_t> published_;
+        std::atomic<bool> drain_scheduled_;
+
+        // Consumer only
+        std::vector<std::pair<uint32_t, size_t>> keyed_;
+        uint64_t delivered_;
+        uint64_t coalesced_;
+        uint64_t batches_;
+        EventRateWindow rates_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_EVENT_QUEUE_H_
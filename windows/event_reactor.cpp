@@ -0,0 +1,461 @@
+#include "event_reactor.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+#else
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#endif
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+#ifndef _WIN32
+    constexpr uint64_t kWakeKey = ~0ull;
+
+    int OpenPidFd(int pid)
+    {
+#ifdef SYS_pidfd_open
+      return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+      errno = ENOSYS;
+      return -1;
+#endif
+    }
+#endif
+
+  } // namespace
+
+  EventReactor::EventReactor()
+      : ok_(false),
+        next_id_(0),
+        signal_pending_(false)
+  {
+#ifdef _WIN32
+    waiting_ = false;
+    wake_event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    ok_ = wake_event_ != nullptr;
+#else
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ >= 0 && wake_fd_ >= 0)
+    {
+      epoll_event ev = {};
+      ev.events = EPOLLIN;
+      ev.data.u64 = kWakeKey;
+      ok_ = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) == 0;
+    }
+#endif
+  }
+
+  EventReactor::~EventReactor()
+  {
+    for (auto &entry : sources_)
+    {
+      ReleaseSource(entry.second);
+    }
+    sources_.clear();
+#ifdef _WIN32
+    for (Source &source : retired_)
+    {
+      ReleaseSource(source);
+    }
+    if (wake_event_)
+    {
+      CloseHandle(wake_event_);
+    }
+#else
+    if (wake_fd_ >= 0)
+    {
+      close(wake_fd_);
+    }
+    if (epoll_fd_ >= 0)
+    {
+      close(epoll_fd_);
+    }
+#endif
+  }
+
+  EventReactor::SourceId EventReactor::AddSource(Source source)
+  {
+    SourceId id;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+#ifdef _WIN32
+      // The wake event takes one of the MAXIMUM_WAIT_OBJECTS slots
+      if (source.handle != nullptr)
+      {
+        const size_t waited = std::count_if(
+            sources_.begin(), sources_.end(),
+            [](const auto &entry)
+            { return entry.second.handle != nullptr; });
+        if (waited >= kMaxWaitSources)
+        {
+          ReleaseSource(source);
+          return kInvalidSource;
+        }
+      }
+#endif
+      id = next_id_++;
+#ifndef _WIN32
+      if (source.fd >= 0)
+      {
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = static_cast<uint64_t>(id);
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, source.fd, &ev) != 0)
+        {
+          ReleaseSource(source);
+          return kInvalidSource;
+        }
+      }
+#endif
+      sources_.emplace(id, std::move(source));
+    }
+    // Let a blocked RunOnce() pick up the new source.
+    Wake();
+    return id;
+  }
+
+  void EventReactor::ReleaseSource(Source &source)
+  {
+#ifdef _WIN32
+    if (source.owns_handle && source.handle)
+    {
+      if (source.type == SourceType::kSocket)
+      {
+        if (source.socket != INVALID_SOCKET)
+        {
+          WSAEventSelect(static_cast<SOCKET>(source.socket), nullptr, 0);
+        }
+        WSACloseEvent(source.handle);
+      }
+      else
+      {
+        CloseHandle(source.handle);
+      }
+    }
+    source.handle = nullptr;
+    source.owns_handle = false;
+#else
+    if (source.fd >= 0)
+    {
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, source.fd, nullptr);
+      if (source.type != SourceType::kSocket)
+      {
+        close(source.fd);
+      }
+      source.fd = -1;
+    }
+#endif
+  }
+
+  EventReactor::SourceId EventReactor::WatchProcess(ProcessRef process, Callback on_exit)
+  {
+    if (!ok_)
+    {
+      return kInvalidSource;
+    }
+
+    Source source;
+    source.type = SourceType::kProcess;
+    source.callback = std::move(on_exit);
+#ifdef _WIN32
+    // Wait on our own duplicate so the caller may close its handle at any time.
+    HANDLE duplicate = nullptr;
+    if (!DuplicateHandle(GetCurrentProcess(), static_cast<HANDLE>(process),
+                         GetCurrentProcess(), &duplicate, SYNCHRONIZE, FALSE, 0))
+    {
+      return kInvalidSource;
+    }
+    source.handle = duplicate;
+    source.owns_handle = true;
+#else
+    source.fd = OpenPidFd(process);
+    if (source.fd < 0)
+    {
+      return kInvalidSource;
+    }
+#endif
+    return AddSource(std::move(source));
+  }
+
+  EventReactor::SourceId EventReactor::WatchSocket(SocketRef socket, Callback on_readable)
+  {
+    if (!ok_)
+    {
+      return kInvalidSource;
+    }
+
+    Source source;
+    source.type = SourceType::kSocket;
+    source.callback = std::move(on_readable);
+#ifdef _WIN32
+    WSAEVENT event = WSACreateEvent();
+    if (event == WSA_INVALID_EVENT)
+    {
+      return kInvalidSource;
+    }
+    if (WSAEventSelect(static_cast<SOCKET>(socket), event, FD_READ | FD_CLOSE) != 0)
+    {
+      WSACloseEvent(event);
+      return kInvalidSource;
+    }
+    source.handle = event;
+    source.owns_handle = true;
+    source.socket = socket;
+#else
+    // Level-triggered: it fires again while unread data remains
+    source.fd = socket;
+#endif
+    return AddSource(std::move(source));
+  }
+
+  EventReactor::SourceId EventReactor::AddSignal(Callback on_signal)
+  {
+    if (!ok_)
+    {
+      return kInvalidSource;
+    }
+
+    Source source;
+    source.type = SourceType::kSignal;
+    source.callback = std::move(on_signal);
+    return AddSource(std::move(source));
+  }
+
+  void EventReactor::Signal(SourceId id)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = sources_.find(id);
+      if (it == sources_.end() || it->second.type != SourceType::kSignal)
+      {
+        return;
+      }
+      it->second.pending = true;
+      signal_pending_ = true;
+    }
+    Wake();
+  }
+
+  void EventReactor::Remove(SourceId id)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sources_.find(id);
+    if (it == sources_.end())
+    {
+      return;
+    }
+    Source source = std::move(it->second);
+    sources_.erase(it);
+#ifdef _WIN32
+    if (waiting_ && source.handle)
+    {
+      // The caller may close the socket once we return; only the event is
+      // still in use by the wait
+      if (source.type == SourceType::kSocket)
+      {
+        WSAEventSelect(static_cast<SOCKET>(source.socket), nullptr, 0);
+        source.socket = INVALID_SOCKET;
+      }
+      retired_.push_back(std::move(source));
+      Wake();
+      return;
+    }
+#endif
+    ReleaseSource(source);
+  }
+
+  void EventReactor::Wake()
+  {
+#ifdef _WIN32
+    if (wake_event_)
+    {
+      SetEvent(wake_event_);
+    }
+#else
+    if (wake_fd_ >= 0)
+    {
+      const uint64_t one = 1;
+      ssize_t written = write(wake_fd_, &one, sizeof(one));
+      (void)written;
+    }
+#endif
+  }
+
+  void EventReactor::Dispatch(const std::vector<SourceId> &ready)
+  {
+    std::vector<Callback> callbacks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (signal_pending_.exchange(false))
+      {
+        for (auto &entry : sources_)
+        {
+          if (entry.second.pending)
+          {
+            entry.second.pending = false;
+            callbacks.push_back(entry.second.callback);
+          }
+        }
+      }
+
+      for (SourceId id : ready)
+      {
+        auto it = sources_.find(id);
+        if (it == sources_.end())
+        {
+          continue;
+        }
+        callbacks.push_back(it->second.callback);
+        if (it->second.type == SourceType::kProcess)
+        {
+          // A finished process stays signaled forever; fire it only once.
+          Source source = std::move(it->second);
+          sources_.erase(it);
+          ReleaseSource(source);
+        }
+      }
+    }
+
+    for (const auto &callback : callbacks)
+    {
+      if (callback)
+      {
+        callback();
+      }
+    }
+  }
+
+#ifdef _WIN32
+
+  bool EventReactor::RunOnce(int timeout_ms)
+  {
+    if (!ok_)
+    {
+      return false;
+    }
+
+    std::vector<HANDLE> handles;
+    std::vector<SourceId> ids;
+    handles.push_back(wake_event_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      waiting_ = true;
+      for (const auto &entry : sources_)
+      {
+        if (entry.second.handle)
+        {
+          handles.push_back(entry.second.handle);
+          ids.push_back(entry.first);
+        }
+      }
+    }
+
+    const DWORD wait = WaitForMultipleObjects(
+        static_cast<DWORD>(handles.size()), handles.data(), FALSE,
+        timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms));
+
+    // WaitForMultipleObjects reports only the lowest signaled index; collect
+    // every other ready handle too so one busy source cannot starve the rest.
+    std::vector<SourceId> ready;
+    for (size_t i = 1; wait != WAIT_TIMEOUT && wait != WAIT_FAILED && i < handles.size(); ++i)
+    {
+      if (WaitForSingleObject(handles[i], 0) == WAIT_OBJECT_0)
+      {
+        ready.push_back(ids[i - 1]);
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // Done with the copied handles; close those removed during the wait
+      waiting_ = false;
+      for (Source &source : retired_)
+      {
+        ReleaseSource(source);
+      }
+      retired_.clear();
+      for (SourceId id : ready)
+      {
+        auto it = sources_.find(id);
+        if (it == sources_.end())
+        {
+          continue;
+        }
+        if (it->second.type == SourceType::kSocket)
+        {
+          // Resets the event; the next recv() re-arms FD_READ
+          WSANETWORKEVENTS events;
+          WSAEnumNetworkEvents(static_cast<SOCKET>(it->second.socket), it->second.handle, &events);
+        }
+      }
+    }
+
+    if (wait == WAIT_TIMEOUT || wait == WAIT_FAILED)
+    {
+      return false;
+    }
+
+    const bool had_signal = signal_pending_.load();
+    Dispatch(ready);
+    return !ready.empty() || had_signal;
+  }
+
+#else
+
+  bool EventReactor::RunOnce(int timeout_ms)
+  {
+    if (!ok_)
+    {
+      return false;
+    }
+
+    epoll_event events[16];
+    int count;
+    do
+    {
+      count = epoll_wait(epoll_fd_, events, 16, timeout_ms);
+    } while (count < 0 && errno == EINTR);
+
+    if (count <= 0)
+    {
+      return false;
+    }
+
+    std::vector<SourceId> ready;
+    for (int i = 0; i < count; ++i)
+    {
+      const uint64_t key = events[i].data.u64;
+      if (key == kWakeKey)
+      {
+        uint64_t value;
+        ssize_t drained = read(wake_fd_, &value, sizeof(value));
+        (void)drained;
+      }
+      else
+      {
+        ready.push_back(static_cast<SourceId>(key));
+      }
+    }
+
+    const bool had_signal = signal_pending_.load();
+    Dispatch(ready);
+    return !ready.empty() || had_signal;
+  }
+
+#endif
+
+} // namespace openvpn_dart
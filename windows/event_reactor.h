@@ -0,0 +1,128 @@
+#ifndef FLUTTER_PLUGIN_EVENT_REACTOR_H_
+#define FLUTTER_PLUGIN_EVENT_REACTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+    // Single-threaded event loop that sleeps until something happens.
+    //
+    // Sources are process exit, sockets with data to read, and signals
+    // raised from other threads. The thread calling
+    // RunOnce() blocks in the kernel
+    // (WaitForMultipleObjects on Windows, epoll on Linux) until a source
+    // fires, then invokes the matching callbacks on that same thread.
+    //
+    // Watch*/Add*/Remove/Signal/Wake may be called from any thread. A
+    // callback that is already running when its source is removed finishes.
+    class EventReactor
+    {
+    public:
+        using Callback = std::function<void()>;
+        using SourceId = int;
+
+#ifdef _WIN32
+        // A process HANDLE opened with SYNCHRONIZE access.
+        using ProcessRef = void *;
+        // A SOCKET.
+        using SocketRef = uintptr_t;
+#else
+        // A child process id; waited on through a pidfd.
+        using ProcessRef = int;
+        using SocketRef = int;
+#endif
+
+        static constexpr SourceId kInvalidSource = -1;
+
+        // On Windows one WaitForMultipleObjects covers every source, so at
+        // most this many process and socket sources can be registered
+        // at once; registering more returns kInvalidSource.
+        static constexpr size_t kMaxWaitSources = 63;
+
+        EventReactor();
+        ~EventReactor();
+
+        EventReactor(const EventReactor &) = delete;
+        EventReactor &operator=(const EventReactor &) = delete;
+
+        // False if the kernel objects backing the reactor could not be created.
+        bool ok() const { return ok_; }
+
+        // Fires once when |process| exits, then the source removes itself.
+        SourceId WatchProcess(ProcessRef process, Callback on_exit);
+
+        // Fires while |socket| has data to read or the peer has closed it;
+        // the callback does the reading. The caller keeps ownership of
+        // |socket|. On Windows this makes the socket non-blocking.
+        SourceId WatchSocket(SocketRef socket, Callback on_readable);
+
+        // A source fired explicitly through Signal() from any thread.
+        SourceId AddSignal(Callback on_signal);
+        void Signal(SourceId id);
+
+        void Remove(SourceId id);
+
+        // Interrupts a blocked RunOnce() without firing any callback, so the
+        // loop owner can re-check its own exit conditions.
+        void Wake();
+
+        // Waits up to |timeout_ms| (-1 waits forever) for at least one
+        // source, then dispatches everything that is ready. Returns false on
+        // timeout or wake-up with nothing dispatched.
+        bool RunOnce(int timeout_ms = -1);
+
+    private:
+        enum class SourceType
+        {
+            kProcess,
+            kSocket,
+            kSignal,
+        };
+
+        struct Source
+        {
+            SourceType type;
+            Callback callback;
+#ifdef _WIN32
+            void *handle = nullptr;
+            bool owns_handle = false;
+            SocketRef socket = 0;
+#else
+            int fd = -1;
+#endif
+            bool pending = false;
+        };
+
+        SourceId AddSource(Source source);
+        void ReleaseSource(Source &source);
+        void Dispatch(const std::vector<SourceId> &ready);
+
+        bool ok_;
+        std::mutex mutex_;
+        std::map<SourceId, Source> sources_;
+        SourceId next_id_;
+        std::atomic<bool> signal_pending_;
+
+#ifdef _WIN32
+        void *wake_event_;
+        // Set while RunOnce() uses a copy of the handles. Sources removed
+        // meanwhile wait in |retired_| until it is done with them, since a
+        // handle must not be closed during a wait on it.
+        bool waiting_;
+        std::vector<Source> retired_;
+#else
+        int epoll_fd_;
+        int wake_fd_;
+#endif
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_EVENT_REACTOR_H_
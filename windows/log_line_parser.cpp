@@ -0,0 +1,89 @@
+#include "log_line_parser.h"
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    constexpr LogEventMask kErrorEvents =
+        LogEventBit(LogEvent::kError) | LogEventBit(LogEvent::kAuthFailed) |
+        LogEventBit(LogEvent::kTlsError) | LogEventBit(LogEvent::kRouteFailed) |
+        LogEventBit(LogEvent::kConnectionTimeout);
+
+    bool IsDigit(char c)
+    {
+      return c >= '0' && c <= '9';
+    }
+
+    // True if |text| matches |shape|, where 'd' stands for any digit and
+    // '?' for any byte.
+    bool MatchesShape(std::string_view text, std::string_view shape)
+    {
+      if (text.size() < shape.size())
+      {
+        return false;
+      }
+      for (size_t i = 0; i < shape.size(); i++)
+      {
+        if (shape[i] == 'd' ? !IsDigit(text[i]) : shape[i] != '?' && shape[i] != text[i])
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    size_t TimestampLength(std::string_view line)
+    {
+      // OpenVPN 2.5+ and 2.4 respectively, each followed by a space
+      if (MatchesShape(line, "dddd-dd-dd dd:dd:dd "))
+      {
+        return 19;
+      }
+      if (MatchesShape(line, "??? ??? ?d dd:dd:dd dddd "))
+      {
+        return 24;
+      }
+      return 0;
+    }
+
+  } // namespace
+
+  LogRecord ParseLogRecord(std::string_view line)
+  {
+    LogRecord record;
+    const size_t timestamp_length = TimestampLength(line);
+    record.timestamp = line.substr(0, timestamp_length);
+    record.message = line.substr(timestamp_length == 0 ? 0 : timestamp_length + 1);
+
+    record.events = LogSignatureMatcher::Default().Match(record.message);
+    if (HasLogEvent(record.events, LogEvent::kFatal))
+    {
+      record.severity = LogSeverity::kFatal;
+    }
+    else if (record.events & kErrorEvents)
+    {
+      record.severity = LogSeverity::kError;
+    }
+    else if (HasLogEvent(record.events, LogEvent::kWarning))
+    {
+      record.severity = LogSeverity::kWarning;
+    }
+    return record;
+  }
+
+  void AppendSanitized(std::string_view text, std::string *out)
+  {
+    const size_t start = out->size();
+    out->append(text.data(), text.size());
+    for (size_t i = start; i < out->size(); i++)
+    {
+      if (static_cast<unsigned char>((*out)[i]) > 127)
+      {
+        (*out)[i] = '?';
+      }
+    }
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,136 @@
+#ifndef FLUTTER_PLUGIN_LOG_LINE_PARSER_H_
+#define FLUTTER_PLUGIN_LOG_LINE_PARSER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "log_signatures.h"
+
+namespace openvpn_dart
+{
+
+    // Splits a byte stream into lines (without "\n" or "\r\n") as views.
+    //
+    // Lines that lie entirely within one Feed() are handed out as views into
+    // the caller's data; only a line spanning two feeds is assembled in a
+    // single internal buffer, which keeps its capacity across lines. Once
+    // that buffer has grown to the longest split line, splitting allocates
+    // nothing. Views are valid only during the callback.
+    class LineSplitter
+    {
+    public:
+        // Lines longer than |max_line| bytes are delivered in pieces of
+        // |max_line|; 0 means no limit.
+        explicit LineSplitter(size_t max_line = 0) : max_line_(max_line) {}
+
+        template <typename OnLine>
+        void Feed(std::string_view data, OnLine &&on_line)
+        {
+            while (!data.empty())
+            {
+                const size_t newline = data.find('\n');
+                if (newline == std::string_view::npos)
+                {
+                    Hold(data, on_line);
+                    return;
+                }
+
+                std::string_view line = data.substr(0, newline);
+                data.remove_prefix(newline + 1);
+                if (!pending_.empty())
+                {
+                    pending_.append(line.data(), line.size());
+                    line = pending_;
+                }
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.remove_suffix(1);
+                }
+                while (max_line_ != 0 && line.size() > max_line_)
+                {
+                    on_line(line.substr(0, max_line_));
+                    line.remove_prefix(max_line_);
+                }
+                on_line(line);
+                pending_.clear();
+            }
+        }
+
+        // Delivers a trailing line that never got its newline.
+        template <typename OnLine>
+        void Finish(OnLine &&on_line)
+        {
+            if (!pending_.empty())
+            {
+                on_line(std::string_view(pending_));
+                pending_.clear();
+            }
+        }
+
+        // Forgets a partial line.
+        void Reset() { pending_.clear(); }
+
+        // Bytes of the partial line held back for the next Feed().
+        size_t pending_bytes() const { return pending_.size(); }
+
+    private:
+        template <typename OnLine>
+        void Hold(std::string_view data, OnLine &on_line)
+        {
+            if (max_line_ == 0)
+            {
+                pending_.append(data.data(), data.size());
+                return;
+            }
+            // Never hold more than one line's worth
+            while (!data.empty())
+            {
+                const size_t take = std::min(max_line_ - pending_.size(), data.size());
+                pending_.append(data.data(), take);
+                data.remove_prefix(take);
+                if (pending_.size() == max_line_)
+                {
+                    on_line(std::string_view(pending_));
+                    pending_.clear();
+                }
+            }
+        }
+
+        const size_t max_line_;
+        std::string pending_;
+    };
+
+    enum class LogSeverity : uint8_t
+    {
+        kInfo,
+        kWarning,
+        kError,
+        kFatal
+    };
+
+    // One line of OpenVPN output, as views into the line.
+    struct LogRecord
+    {
+        // "2026-01-01 10:00:00" (OpenVPN 2.5+) or "Thu Jan  1 10:00:00 2026"
+        // (older builds); empty if the line has no timestamp
+        std::string_view timestamp;
+        // The rest of the line after the timestamp
+        std::string_view message;
+        LogSeverity severity = LogSeverity::kInfo;
+        // Message class: every signature of kLogSignatures in the line
+        LogEventMask events = 0;
+    };
+
+    // Parses |line| without copying or allocating.
+    LogRecord ParseLogRecord(std::string_view line);
+
+    // Appends |text| to |out| with non-ASCII bytes replaced by '?', e.g. to
+    // quote a log line in an error message.
+    void AppendSanitized(std::string_view text, std::string *out);
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_LOG_LINE_PARSER_H_
@@ -0,0 +1,143 @@
+#include "log_signatures.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    uint16_t BytePair(const char *at)
+    {
+      return static_cast<uint16_t>(static_cast<unsigned char>(at[0]) << 8 |
+                                   static_cast<unsigned char>(at[1]));
+    }
+
+  } // namespace
+
+  const char *LogEventName(LogEvent event)
+  {
+    switch (event)
+    {
+    case LogEvent::kConnected:
+      return "connected";
+    case LogEvent::kReconnecting:
+      return "reconnecting";
+    case LogEvent::kAuthFailed:
+      return "authFailed";
+    case LogEvent::kConnectionTimeout:
+      return "connectionTimeout";
+    case LogEvent::kTlsError:
+      return "tlsError";
+    case LogEvent::kRouteFailed:
+      return "routeFailed";
+    case LogEvent::kDcoFallback:
+      return "dcoFallback";
+    case LogEvent::kError:
+      return "error";
+    case LogEvent::kFatal:
+      return "fatal";
+    case LogEvent::kWarning:
+      return "warning";
+    case LogEvent::kExiting:
+      return "exiting";
+    default:
+      return "unknown";
+    }
+  }
+
+  LogSignatureMatcher::LogSignatureMatcher(const LogSignature *signatures, size_t count)
+      : window_(UINT8_MAX)
+  {
+    static_assert(static_cast<size_t>(LogEvent::kCount) <= sizeof(LogEventMask) * 8,
+                  "LogEventMask too small");
+
+    for (size_t i = 0; i < count; i++)
+    {
+      const size_t length = signatures[i].pattern.size();
+      if (length == 1)
+      {
+        short_.push_back(signatures[i]);
+      }
+      else if (length > 1)
+      {
+        window_ = std::min(window_, length);
+      }
+    }
+
+    // Shift for a pair = distance from its last occurrence in any
+    // pattern's first |window_| bytes to the end of that prefix
+    shift_.assign(65536, static_cast<uint8_t>(window_ - 1));
+    for (size_t i = 0; i < count; i++)
+    {
+      const std::string_view pattern = signatures[i].pattern;
+      if (pattern.size() < 2)
+      {
+        continue;
+      }
+      for (size_t pos = 0; pos + 1 < window_; pos++)
+      {
+        uint8_t &shift = shift_[BytePair(pattern.data() + pos)];
+        shift = std::min(shift, static_cast<uint8_t>(window_ - 2 - pos));
+      }
+      candidates_.push_back({BytePair(pattern.data() + window_ - 2), pattern, signatures[i].event});
+    }
+    std::stable_sort(candidates_.begin(), candidates_.end(),
+                     [](const Candidate &a, const Candidate &b)
+                     { return a.pair < b.pair; });
+  }
+
+  const LogSignatureMatcher &LogSignatureMatcher::Default()
+  {
+    static const LogSignatureMatcher matcher(kLogSignatures, std::size(kLogSignatures));
+    return matcher;
+  }
+
+  LogEventMask LogSignatureMatcher::Match(std::string_view line) const
+  {
+    LogEventMask mask = 0;
+    for (const LogSignature &signature : short_)
+    {
+      if (line.find(signature.pattern) != std::string_view::npos)
+      {
+        mask |= LogEventBit(signature.event);
+      }
+    }
+    if (candidates_.empty())
+    {
+      return mask;
+    }
+
+    const uint8_t *shifts = shift_.data();
+    const char *data = line.data();
+    // |end| is one past the window ending at data[end - 1]
+    for (size_t end = window_; end <= line.size();)
+    {
+      const uint16_t pair = BytePair(data + end - 2);
+      const uint8_t shift = shifts[pair];
+      if (shift != 0)
+      {
+        end += shift;
+        continue;
+      }
+
+      const size_t start = end - window_;
+      auto it = std::lower_bound(candidates_.begin(), candidates_.end(), pair,
+                                 [](const Candidate &candidate, uint16_t value)
+                                 { return candidate.pair < value; });
+      for (; it != candidates_.end() && it->pair == pair; ++it)
+      {
+        if (line.size() - start >= it->pattern.size() &&
+            line.compare(start, it->pattern.size(), it->pattern) == 0)
+        {
+          mask |= LogEventBit(it->event);
+        }
+      }
+      end++;
+    }
+    return mask;
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,110 @@
+#ifndef FLUTTER_PLUGIN_LOG_SIGNATURES_H_
+#define FLUTTER_PLUGIN_LOG_SIGNATURES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+    // Typed meaning of an OpenVPN log line.
+    enum class LogEvent : uint8_t
+    {
+        kConnected,
+        kReconnecting,
+        kAuthFailed,
+        kConnectionTimeout,
+        kTlsError,
+        kRouteFailed,
+        kDcoFallback,
+        kError,
+        kFatal,
+        kWarning,
+        kExiting,
+        kCount
+    };
+
+    // Set of LogEvents, one bit per event.
+    using LogEventMask = uint32_t;
+
+    constexpr LogEventMask LogEventBit(LogEvent event)
+    {
+        return LogEventMask(1) << static_cast<unsigned>(event);
+    }
+
+    constexpr bool HasLogEvent(LogEventMask mask, LogEvent event)
+    {
+        return (mask & LogEventBit(event)) != 0;
+    }
+
+    // Name reported over the event channel, e.g. "tlsError".
+    const char *LogEventName(LogEvent event);
+
+    struct LogSignature
+    {
+        std::string_view pattern;
+        LogEvent event;
+    };
+
+    // Every substring the plugin looks for in OpenVPN's output (OpenVPN 2.5
+    // and 2.6 wording). Matching is case-sensitive.
+    inline constexpr LogSignature kLogSignatures[] = {
+        {"Initialization Sequence Completed", LogEvent::kConnected},
+        {"CONNECTED,SUCCESS", LogEvent::kConnected},
+        {"TCP/UDP: Preserving recently used remote", LogEvent::kReconnecting},
+        {"SIGUSR1[soft,", LogEvent::kReconnecting},
+        {"AUTH_FAILED", LogEvent::kAuthFailed},
+        {"CONNECTION_TIMEOUT", LogEvent::kConnectionTimeout},
+        {"TLS Error", LogEvent::kTlsError},
+        {"TLS handshake failed", LogEvent::kTlsError},
+        {"VERIFY ERROR", LogEvent::kTlsError},
+        {"route add command failed", LogEvent::kRouteFailed},
+        {"Route addition via IPAPI failed", LogEvent::kRouteFailed},
+        {"Route addition via service failed", LogEvent::kRouteFailed},
+        {"disabling data channel offload", LogEvent::kDcoFallback},
+        {"ERROR", LogEvent::kError},
+        {"FATAL", LogEvent::kFatal},
+        {"Exiting due to fatal error", LogEvent::kFatal},
+        {"WARNING", LogEvent::kWarning},
+        {"process exiting", LogEvent::kExiting},
+    };
+
+    // Single-pass multi-pattern matcher (Wu-Manber).
+    //
+    // The signatures are compiled into a shift table over byte pairs: for
+    // the two bytes ending the current window of |window_| bytes it gives
+    // how far the window can slide before any signature could end there.
+    // Most of OpenVPN's output shares few pairs with the signatures, so the
+    // scan skips several bytes per step, and only windows whose pair ends a
+    // signature prefix compare candidates in place. Cost is independent of
+    // the number of signatures.
+    class LogSignatureMatcher
+    {
+    public:
+        LogSignatureMatcher(const LogSignature *signatures, size_t count);
+
+        // The matcher for kLogSignatures, built on first use.
+        static const LogSignatureMatcher &Default();
+
+        // Events of every signature that occurs in |line|.
+        LogEventMask Match(std::string_view line) const;
+
+    private:
+        struct Candidate
+        {
+            uint16_t pair;
+            std::string_view pattern;
+            LogEvent event;
+        };
+
+        size_t window_;                     // Length of the shortest pattern
+        std::vector<uint8_t> shift_;        // By (first << 8 | second)
+        std::vector<Candidate> candidates_; // Sorted by pair
+        std::vector<LogSignature> short_;   // Single-byte patterns
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_LOG_SIGNATURES_H_
@@ -0,0 +1,57 @@
+#include "log_status_tracker.h"
+
+namespace openvpn_dart
+{
+
+  LogStatusTracker::LogStatusTracker()
+      : status_("connecting"),
+        connection_established_(false),
+        last_events_(0)
+  {
+  }
+
+  void LogStatusTracker::Reset()
+  {
+    status_ = "connecting";
+    connection_established_ = false;
+    last_events_ = 0;
+  }
+
+  bool LogStatusTracker::OnLine(std::string_view line)
+  {
+    last_events_ = LogSignatureMatcher::Default().Match(line);
+    if (last_events_ == 0)
+    {
+      return false;
+    }
+
+    const char *status = nullptr;
+    if (HasLogEvent(last_events_, LogEvent::kConnected))
+    {
+      status = "connected";
+      connection_established_ = true;
+    }
+    else if (HasLogEvent(last_events_, LogEvent::kConnectionTimeout) ||
+             HasLogEvent(last_events_, LogEvent::kAuthFailed))
+    {
+      status = "error";
+    }
+    else if (HasLogEvent(last_events_, LogEvent::kReconnecting))
+    {
+      // During initial connection, this is part of connecting process
+      // Only treat as reconnecting if we were already connected
+      if (connection_established_)
+      {
+        status = "connecting"; // Treat reconnect as connecting
+      }
+    }
+
+    if (status == nullptr || status_ == status)
+    {
+      return false;
+    }
+    status_ = status;
+    return true;
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,41 @@
+#ifndef FLUTTER_PLUGIN_LOG_STATUS_TRACKER_H_
+#define FLUTTER_PLUGIN_LOG_STATUS_TRACKER_H_
+
+#include <string>
+#include <string_view>
+
+#include "log_signatures.h"
+
+namespace openvpn_dart
+{
+
+    // Derives the plugin status from OpenVPN's log output, one line at a
+    // time. Used for the child's stdout and for log files alike, so both
+    // paths agree on what a line means.
+    class LogStatusTracker
+    {
+    public:
+        LogStatusTracker();
+
+        // Back to "connecting" with no connection seen, e.g. after the log
+        // was truncated or OpenVPN was restarted.
+        void Reset();
+
+        // Returns true if |line| changed status().
+        bool OnLine(std::string_view line);
+
+        const std::string &status() const { return status_; }
+        bool connection_established() const { return connection_established_; }
+
+        // Everything the last line passed to OnLine() matched.
+        LogEventMask last_events() const { return last_events_; }
+
+    private:
+        std::string status_;
+        bool connection_established_;
+        LogEventMask last_events_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_LOG_STATUS_TRACKER_H_
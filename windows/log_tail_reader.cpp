@@ -0,0 +1,119 @@
+#include "log_tail_reader.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace openvpn_dart
+{
+
+  LogTailReader::LogTailReader(std::string path)
+      : path_(std::move(path)),
+        offset_(0)
+  {
+  }
+
+  void LogTailReader::SetPath(const std::string &path)
+  {
+    path_ = path;
+    Reset();
+  }
+
+  void LogTailReader::Reset()
+  {
+    offset_ = 0;
+    splitter_.Reset();
+    fingerprint_.clear();
+  }
+
+  size_t LogTailReader::Poll(const LineCallback &on_line,
+                             const RestartCallback &on_restart)
+  {
+    if (path_.empty())
+    {
+      return 0;
+    }
+
+    std::ifstream file(path_, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+      return 0;
+    }
+
+    file.seekg(0, std::ios::end);
+    const std::streamoff end = file.tellg();
+    if (end < 0)
+    {
+      return 0;
+    }
+    const uint64_t size = static_cast<uint64_t>(end);
+
+    // A shorter file means it was truncated; different leading bytes mean
+    // it was replaced by a new file that has already grown past our offset.
+    bool restarted = size < offset_;
+    if (!restarted && !fingerprint_.empty())
+    {
+      std::string head(fingerprint_.size(), '\0');
+      file.seekg(0, std::ios::beg);
+      file.read(&head[0], static_cast<std::streamsize>(head.size()));
+      restarted = file.gcount() != static_cast<std::streamsize>(head.size()) ||
+                  head != fingerprint_;
+      file.clear();
+    }
+
+    if (restarted)
+    {
+      Reset();
+      if (on_restart)
+      {
+        on_restart();
+      }
+    }
+
+    if (size == offset_)
+    {
+      return 0;
+    }
+
+    if (buffer_.size() < kReadChunkSize)
+    {
+      buffer_.resize(kReadChunkSize);
+    }
+
+    file.seekg(static_cast<std::streamoff>(offset_), std::ios::beg);
+
+    size_t delivered = 0;
+    uint64_t remaining = size - offset_;
+    while (remaining > 0)
+    {
+      const size_t want = static_cast<size_t>(
+          std::min<uint64_t>(remaining, static_cast<uint64_t>(buffer_.size())));
+      file.read(buffer_.data(), static_cast<std::streamsize>(want));
+      const std::streamsize got_signed = file.gcount();
+      if (got_signed <= 0)
+      {
+        break;
+      }
+      const size_t got = static_cast<size_t>(got_signed);
+
+      if (offset_ < kFingerprintSize)
+      {
+        const size_t take = std::min(
+            got, kFingerprintSize - static_cast<size_t>(offset_));
+        fingerprint_.append(buffer_.data(), take);
+      }
+
+      offset_ += got;
+      remaining -= got;
+
+      splitter_.Feed(std::string_view(buffer_.data(), got),
+                     [&on_line, &delivered](std::string_view line)
+                     {
+                       on_line(line);
+                       ++delivered;
+                     });
+    }
+
+    return delivered;
+  }
+
+} // namespace openvpn_dart
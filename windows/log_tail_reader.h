@@ -0,0 +1,63 @@
+#ifndef FLUTTER_PLUGIN_LOG_TAIL_READER_H_
+#define FLUTTER_PLUGIN_LOG_TAIL_READER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_line_parser.h"
+
+namespace openvpn_dart
+{
+
+    // Incrementally follows a growing log file.
+    //
+    // Each Poll() reads only the bytes appended since the previous call and
+    // hands complete lines to the caller. A trailing partial line is carried
+    // over until its newline arrives. If the file shrinks (truncation) or its
+    // first bytes change (rotation / recreation), reading restarts from the
+    // beginning of the new file.
+    class LogTailReader
+    {
+    public:
+        using LineCallback = std::function<void(std::string_view line)>;
+        using RestartCallback = std::function<void()>;
+
+        explicit LogTailReader(std::string path = std::string());
+
+        // Points the reader at a different file and forgets all state.
+        void SetPath(const std::string &path);
+        const std::string &path() const { return path_; }
+
+        // Reads newly appended data. |on_line| receives every complete line
+        // (without the trailing "\n" or "\r\n"). |on_restart|, if set, is
+        // invoked before any line when the reader detected truncation or
+        // rotation and started over. Returns the number of lines delivered.
+        size_t Poll(const LineCallback &on_line,
+                    const RestartCallback &on_restart = nullptr);
+
+        // Forgets the offset and partial line; the next Poll() starts at 0.
+        void Reset();
+
+        // Byte offset of the next unread byte in the file.
+        uint64_t offset() const { return offset_; }
+
+        // Bytes of an incomplete trailing line held back from the last Poll().
+        size_t pending_bytes() const { return splitter_.pending_bytes(); }
+
+    private:
+        static constexpr size_t kFingerprintSize = 64;
+        static constexpr size_t kReadChunkSize = 64 * 1024;
+
+        std::string path_;
+        uint64_t offset_;
+        LineSplitter splitter_;
+        std::string fingerprint_;
+        std::vector<char> buffer_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_LOG_TAIL_READER_H_
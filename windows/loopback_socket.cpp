@@ -0,0 +1,237 @@
+#include "loopback_socket.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace openvpn_dart
+{
+  namespace loopback
+  {
+
+    namespace
+    {
+
+#ifdef _WIN32
+      // Winsock needs a process-wide WSAStartup before the first socket call.
+      bool EnsureWinsock()
+      {
+        static const bool started = []()
+        {
+          WSADATA data;
+          return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        return started;
+      }
+#endif
+
+      sockaddr_in LoopbackAddress(uint16_t port)
+      {
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return address;
+      }
+
+      SocketHandle NewStreamSocket()
+      {
+#ifdef _WIN32
+        if (!EnsureWinsock())
+        {
+          return kInvalidSocket;
+        }
+        const SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        return s == INVALID_SOCKET ? kInvalidSocket : static_cast<SocketHandle>(s);
+#else
+        const int s = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+        return s < 0 ? kInvalidSocket : s;
+#endif
+      }
+
+    } // namespace
+
+#ifdef _WIN32
+    const SocketHandle kInvalidSocket = static_cast<SocketHandle>(INVALID_SOCKET);
+#else
+    const SocketHandle kInvalidSocket = -1;
+#endif
+
+    SocketHandle Listen(uint16_t port, uint16_t *bound_port)
+    {
+      const SocketHandle s = NewStreamSocket();
+      if (s == kInvalidSocket)
+      {
+        return kInvalidSocket;
+      }
+
+      sockaddr_in address = LoopbackAddress(port);
+      if (bind(s, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+          listen(s, 4) != 0)
+      {
+        Close(s);
+        return kInvalidSocket;
+      }
+
+      if (bound_port)
+      {
+        socklen_t length = sizeof(address);
+        getsockname(s, reinterpret_cast<sockaddr *>(&address), &length);
+        *bound_port = ntohs(address.sin_port);
+      }
+      return s;
+    }
+
+    SocketHandle Accept(SocketHandle listener)
+    {
+#ifdef _WIN32
+      const SOCKET s = accept(static_cast<SOCKET>(listener), nullptr, nullptr);
+      return s == INVALID_SOCKET ? kInvalidSocket : static_cast<SocketHandle>(s);
+#else
+      const int s = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+      return s < 0 ? kInvalidSocket : s;
+#endif
+    }
+
+    SocketHandle Connect(uint16_t port, int timeout_ms)
+    {
+      const auto deadline =
+          std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+      const sockaddr_in address = LoopbackAddress(port);
+
+      while (true)
+      {
+        const SocketHandle s = NewStreamSocket();
+        if (s == kInvalidSocket)
+        {
+          return kInvalidSocket;
+        }
+#ifdef _WIN32
+        const int rc = connect(static_cast<SOCKET>(s),
+                               reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+#else
+        const int rc = connect(s, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+#endif
+        if (rc == 0)
+        {
+          // Management traffic is tiny request/response lines.
+          int no_delay = 1;
+          setsockopt(s, IPPROTO_TCP, TCP_NODELAY,
+                     reinterpret_cast<const char *>(&no_delay), sizeof(no_delay));
+          return s;
+        }
+        Close(s);
+
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+          return kInvalidSocket;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+    }
+
+    bool SendAll(SocketHandle socket, const std::string &data)
+    {
+      size_t sent = 0;
+      while (sent < data.size())
+      {
+#ifdef _WIN32
+        const int rc = send(static_cast<SOCKET>(socket), data.data() + sent,
+                            static_cast<int>(data.size() - sent), 0);
+        if (rc < 0 && WSAGetLastError() == WSAEWOULDBLOCK)
+        {
+          // Non-blocking while a reactor watches it; wait for buffer space
+          fd_set writable;
+          FD_ZERO(&writable);
+          FD_SET(static_cast<SOCKET>(socket), &writable);
+          timeval timeout = {1, 0};
+          if (select(0, nullptr, &writable, nullptr, &timeout) == 1)
+          {
+            continue;
+          }
+        }
+#else
+        const ssize_t rc = send(socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#endif
+        if (rc <= 0)
+        {
+          return false;
+        }
+        sent += static_cast<size_t>(rc);
+      }
+      return true;
+    }
+
+    long Receive(SocketHandle socket, char *buffer, size_t size)
+    {
+#ifdef _WIN32
+      return recv(static_cast<SOCKET>(socket), buffer, static_cast<int>(size), 0);
+#else
+      ssize_t rc;
+      do
+      {
+        rc = recv(socket, buffer, size, 0);
+      } while (rc < 0 && errno == EINTR);
+      return static_cast<long>(rc);
+#endif
+    }
+
+    bool WouldBlock()
+    {
+#ifdef _WIN32
+      return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
+
+    void Shutdown(SocketHandle socket)
+    {
+      if (socket == kInvalidSocket)
+      {
+        return;
+      }
+#ifdef _WIN32
+      shutdown(static_cast<SOCKET>(socket), SD_BOTH);
+#else
+      shutdown(socket, SHUT_RDWR);
+#endif
+    }
+
+    void Close(SocketHandle socket)
+    {
+      if (socket == kInvalidSocket)
+      {
+        return;
+      }
+#ifdef _WIN32
+      closesocket(static_cast<SOCKET>(socket));
+#else
+      close(socket);
+#endif
+    }
+
+    uint16_t PickFreePort()
+    {
+      uint16_t port = 0;
+      const SocketHandle s = Listen(0, &port);
+      Close(s);
+      return s == kInvalidSocket ? 0 : port;
+    }
+
+  } // namespace loopback
+} // namespace openvpn_dart
@@ -0,0 +1,57 @@
+#ifndef FLUTTER_PLUGIN_LOOPBACK_SOCKET_H_
+#define FLUTTER_PLUGIN_LOOPBACK_SOCKET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace openvpn_dart
+{
+
+    // Minimal blocking TCP helpers for 127.0.0.1, wrapping Winsock and BSD
+    // sockets behind one interface. Only used for OpenVPN's management port.
+    namespace loopback
+    {
+
+#ifdef _WIN32
+        using SocketHandle = uintptr_t; // SOCKET
+#else
+        using SocketHandle = int;
+#endif
+
+        extern const SocketHandle kInvalidSocket;
+
+        // Binds a listening socket on 127.0.0.1:|port| (0 picks a free port).
+        // The bound port is written to |bound_port| if non-null.
+        SocketHandle Listen(uint16_t port, uint16_t *bound_port);
+
+        SocketHandle Accept(SocketHandle listener);
+
+        // Connects to 127.0.0.1:|port|. While nothing listens yet the attempt
+        // is retried every 50ms until |timeout_ms| has elapsed.
+        SocketHandle Connect(uint16_t port, int timeout_ms);
+
+        // Writes all of |data|; false if the peer went away.
+        bool SendAll(SocketHandle socket, const std::string &data);
+
+        // Reads up to |size| bytes. Returns 0 on orderly close, <0 on error.
+        long Receive(SocketHandle socket, char *buffer, size_t size);
+
+        // True if the last failed Receive() on this thread only found no
+        // data waiting on a non-blocking socket.
+        bool WouldBlock();
+
+        // Unblocks any thread sitting in Receive()/Accept() on |socket|.
+        void Shutdown(SocketHandle socket);
+
+        void Close(SocketHandle socket);
+
+        // Asks the OS for a currently unused loopback port. Another process
+        // may grab it before it is used, so callers must tolerate failure.
+        uint16_t PickFreePort();
+
+    } // namespace loopback
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_LOOPBACK_SOCKET_H_
@@ -0,0 +1,609 @@
+#include "management_client.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    // Splits |text| on commas, keeping at most |max_fields| fields; the last
+    // field keeps any remaining commas (log messages contain them).
+    std::vector<std::string_view> SplitFields(std::string_view text, size_t max_fields)
+    {
+      std::vector<std::string_view> fields;
+      while (fields.size() + 1 < max_fields)
+      {
+        const size_t comma = text.find(',');
+        if (comma == std::string_view::npos)
+        {
+          break;
+        }
+        fields.push_back(text.substr(0, comma));
+        text.remove_prefix(comma + 1);
+      }
+      fields.push_back(text);
+      return fields;
+    }
+
+    bool ParseUnsigned(std::string_view text, uint64_t *out)
+    {
+      if (text.empty())
+      {
+        return false;
+      }
+      uint64_t value = 0;
+      for (char c : text)
+      {
+        if (c < '0' || c > '9')
+        {
+          return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+      }
+      *out = value;
+      return true;
+    }
+
+    bool StartsWith(std::string_view text, std::string_view prefix)
+    {
+      return text.substr(0, prefix.size()) == prefix;
+    }
+
+    std::string_view TrimLeadingSpace(std::string_view text)
+    {
+      while (!text.empty() && text.front() == ' ')
+      {
+        text.remove_prefix(1);
+      }
+      return text;
+    }
+
+  } // namespace
+
+  ManagementState ParseManagementState(std::string_view name)
+  {
+    static const std::pair<std::string_view, ManagementState> kStates[] = {
+        {"CONNECTING", ManagementState::kConnecting},
+        {"RESOLVE", ManagementState::kResolve},
+        {"TCP_CONNECT", ManagementState::kTcpConnect},
+        {"WAIT", ManagementState::kWait},
+        {"AUTH", ManagementState::kAuth},
+        {"AUTH_PENDING", ManagementState::kAuthPending},
+        {"GET_CONFIG", ManagementState::kGetConfig},
+        {"ASSIGN_IP", ManagementState::kAssignIp},
+        {"ADD_ROUTES", ManagementState::kAddRoutes},
+        {"CONNECTED", ManagementState::kConnected},
+        {"RECONNECTING", ManagementState::kReconnecting},
+        {"EXITING", ManagementState::kExiting},
+    };
+    for (const auto &entry : kStates)
+    {
+      if (entry.first == name)
+      {
+        return entry.second;
+      }
+    }
+    return ManagementState::kUnknown;
+  }
+
+  bool ParseStateLine(std::string_view payload, StateNotification *out)
+  {
+    // time,state,detail,local_ip,remote_ip[,remote_port,local_addr,local_port,local_ipv6]
+    const auto fields = SplitFields(payload, 9);
+    if (fields.size() < 2)
+    {
+      return false;
+    }
+    uint64_t timestamp = 0;
+    if (!ParseUnsigned(fields[0], &timestamp))
+    {
+      return false;
+    }
+
+    StateNotification state;
+    state.timestamp = static_cast<int64_t>(timestamp);
+    state.name = std::string(fields[1]);
+    state.state = ParseManagementState(fields[1]);
+    if (fields.size() > 2)
+    {
+      state.detail = std::string(fields[2]);
+    }
+    if (fields.size() > 3)
+    {
+      state.local_ip = std::string(fields[3]);
+    }
+    if (fields.size() > 4)
+    {
+      state.remote_ip = std::string(fields[4]);
+    }
+    *out = std::move(state);
+    return true;
+  }
+
+  bool ParseByteCountLine(std::string_view payload, ByteCountNotification *out)
+  {
+    const auto fields = SplitFields(payload, 3);
+    if (fields.size() != 2)
+    {
+      return false;
+    }
+    ByteCountNotification count;
+    if (!ParseUnsigned(fields[0], &count.bytes_in) ||
+        !ParseUnsigned(fields[1], &count.bytes_out))
+    {
+      return false;
+    }
+    *out = count;
+    return true;
+  }
+
+  bool ParseLogLine(std::string_view payload, LogNotification *out)
+  {
+    const auto fields = SplitFields(payload, 3);
+    if (fields.size() != 3)
+    {
+      return false;
+    }
+    uint64_t timestamp = 0;
+    if (!ParseUnsigned(fields[0], &timestamp))
+    {
+      return false;
+    }
+    LogNotification log;
+    log.timestamp = static_cast<int64_t>(timestamp);
+    log.flag = fields[1].empty() ? 'I' : fields[1].front();
+    log.message = std::string(fields[2]);
+    *out = std::move(log);
+    return true;
+  }
+
+  bool ParseRemoteLine(std::string_view payload, RemoteNotification *out)
+  {
+    const auto fields = SplitFields(payload, 3);
+    if (fields.size() != 3 || fields[0].empty())
+    {
+      return false;
+    }
+    RemoteNotification remote;
+    remote.host = std::string(fields[0]);
+    remote.port = std::string(fields[1]);
+    remote.proto = std::string(fields[2]);
+    *out = std::move(remote);
+    return true;
+  }
+
+  const char *StatusForState(const StateNotification &state)
+  {
+    switch (state.state)
+    {
+    case ManagementState::kUnknown:
+      return nullptr;
+    case ManagementState::kConnected:
+      return "connected";
+    case ManagementState::kReconnecting:
+      return state.detail == "auth-failure" ? "error" : "connecting";
+    case ManagementState::kExiting:
+      return state.detail == "auth-failure" ? "error" : "disconnecting";
+    default:
+      return "connecting";
+    }
+  }
+
+  ManagementClient::ManagementClient(Handlers handlers, std::string password)
+      : handlers_(std::move(handlers)),
+        password_(std::move(password)),
+        authenticating_(false),
+        password_sent_(false),
+        running_(false),
+        connected_(false),
+        socket_(loopback::kInvalidSocket),
+        reactor_(nullptr),
+        source_(EventReactor::kInvalidSource)
+  {
+  }
+
+  ManagementClient::~ManagementClient()
+  {
+    Stop();
+  }
+
+  bool ManagementClient::Start(uint16_t port, int connect_timeout_ms)
+  {
+    if (running_.exchange(true))
+    {
+      return false;
+    }
+    if (reader_.joinable())
+    {
+      reader_.join();
+    }
+    reactor_ = nullptr;
+    reader_ = std::thread(&ManagementClient::ReaderLoop, this, port, connect_timeout_ms);
+    return true;
+  }
+
+  bool ManagementClient::Start(EventReactor *reactor, uint16_t port, int connect_timeout_ms,
+                               std::function<bool()> keep_trying)
+  {
+    std::lock_guard<std::recursive_mutex> connect_lock(connect_mutex_);
+    if (running_.exchange(true))
+    {
+      return false;
+    }
+    if (reader_.joinable())
+    {
+      reader_.join();
+    }
+    reactor_ = reactor;
+    if (!Connect(port, connect_timeout_ms, keep_trying))
+    {
+      Disconnect();
+      return false;
+    }
+    if (connected_ && handlers_.on_connected)
+    {
+      handlers_.on_connected();
+    }
+
+    auto guard = std::make_shared<ReadGuard>();
+    std::lock_guard<std::recursive_mutex> read_lock(guard->mutex);
+    read_guard_ = guard;
+    if (running_)
+    {
+      source_ = reactor_->WatchSocket(socket_, [this, guard]
+                                      {
+        std::lock_guard<std::recursive_mutex> lock(guard->mutex);
+        if (guard->watching)
+        {
+          OnReadable();
+        } });
+    }
+    if (source_ == EventReactor::kInvalidSource)
+    {
+      Disconnect();
+      return false;
+    }
+    guard->watching = true;
+    return true;
+  }
+
+  void ManagementClient::Stop()
+  {
+    running_ = false;
+    {
+      std::lock_guard<std::mutex> lock(socket_mutex_);
+      loopback::Shutdown(socket_);
+    }
+    if (reader_.joinable() && reader_.get_id() != std::this_thread::get_id())
+    {
+      reader_.join();
+    }
+
+    // Reactor mode: wait out a connect or a running OnReadable(), then
+    // detach from the reactor ourselves since no reader will notice.
+    {
+      std::lock_guard<std::recursive_mutex> connect_lock(connect_mutex_);
+    }
+    if (read_guard_)
+    {
+      std::lock_guard<std::recursive_mutex> read_lock(read_guard_->mutex);
+      if (read_guard_->watching)
+      {
+        Unwatch();
+      }
+    }
+  }
+
+  bool ManagementClient::SendCommand(const std::string &command, ReplyCallback on_reply)
+  {
+    std::lock_guard<std::mutex> lock(socket_mutex_);
+    if (!connected_ || socket_ == loopback::kInvalidSocket)
+    {
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> pending_lock(pending_mutex_);
+      pending_.push_back(PendingCommand{std::move(on_reply), std::string(), false});
+    }
+    return loopback::SendAll(socket_, command + "\n");
+  }
+
+  bool ManagementClient::Connect(uint16_t port, int connect_timeout_ms,
+                                 const std::function<bool()> &keep_trying)
+  {
+    // Retry in short attempts so Stop() is honoured while OpenVPN starts up.
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(connect_timeout_ms);
+    loopback::SocketHandle socket = loopback::kInvalidSocket;
+    while (running_ && socket == loopback::kInvalidSocket &&
+           std::chrono::steady_clock::now() < deadline && (!keep_trying || keep_trying()))
+    {
+      socket = loopback::Connect(port, 0);
+      if (socket == loopback::kInvalidSocket)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(socket_mutex_);
+    if (!running_ && socket != loopback::kInvalidSocket)
+    {
+      loopback::Close(socket);
+      socket = loopback::kInvalidSocket;
+    }
+    socket_ = socket;
+    partial_.clear();
+    // With a password, commands wait until OpenVPN accepts it
+    authenticating_ = socket != loopback::kInvalidSocket && !password_.empty();
+    password_sent_ = false;
+    connected_ = socket != loopback::kInvalidSocket && !authenticating_;
+    return socket != loopback::kInvalidSocket;
+  }
+
+  void ManagementClient::ReaderLoop(uint16_t port, int connect_timeout_ms)
+  {
+    if (Connect(port, connect_timeout_ms, nullptr))
+    {
+      if (connected_ && handlers_.on_connected)
+      {
+        handlers_.on_connected();
+      }
+
+      char buffer[4096];
+      long received;
+      while (running_ && (received = loopback::Receive(socket_, buffer, sizeof(buffer))) > 0)
+      {
+        Consume(buffer, static_cast<size_t>(received));
+      }
+    }
+    Disconnect();
+  }
+
+  void ManagementClient::OnReadable()
+  {
+    // One read per wake-up keeps sessions on a shared reactor fair;
+    // anything left over fires the source again.
+    char buffer[4096];
+    const long received = loopback::Receive(socket_, buffer, sizeof(buffer));
+    if (received > 0)
+    {
+      Consume(buffer, static_cast<size_t>(received));
+      if (running_)
+      {
+        return;
+      }
+    }
+    else if (received < 0 && loopback::WouldBlock())
+    {
+      return;
+    }
+
+    // A handler may have stopped us already
+    if (read_guard_->watching)
+    {
+      Unwatch();
+    }
+  }
+
+  void ManagementClient::Unwatch()
+  {
+    read_guard_->watching = false;
+    reactor_->Remove(source_);
+    source_ = EventReactor::kInvalidSource;
+    Disconnect();
+  }
+
+  void ManagementClient::Consume(const char *data, size_t size)
+  {
+    std::string_view chunk(data, size);
+    size_t newline = chunk.find('\n');
+    while (running_ && newline != std::string_view::npos)
+    {
+      std::string_view line = chunk.substr(0, newline);
+      if (!partial_.empty())
+      {
+        partial_.append(line.data(), line.size());
+        line = partial_;
+      }
+      if (!line.empty() && line.back() == '\r')
+      {
+        line.remove_suffix(1);
+      }
+      ProcessLine(line);
+      partial_.clear();
+      chunk.remove_prefix(newline + 1);
+      newline = chunk.find('\n');
+    }
+    partial_.append(chunk.data(), chunk.size());
+
+    // The prompt comes without a newline
+    static constexpr std::string_view kPasswordPrompt = "ENTER PASSWORD:";
+    if (authenticating_ && !password_sent_ && partial_.size() >= kPasswordPrompt.size() &&
+        std::string_view(partial_).substr(partial_.size() - kPasswordPrompt.size()) == kPasswordPrompt)
+    {
+      partial_.clear();
+      password_sent_ = true;
+      std::lock_guard<std::mutex> lock(socket_mutex_);
+      loopback::SendAll(socket_, password_ + "\n");
+    }
+  }
+
+  void ManagementClient::Disconnect()
+  {
+    {
+      std::lock_guard<std::mutex> lock(socket_mutex_);
+      connected_ = false;
+      loopback::Close(socket_);
+      socket_ = loopback::kInvalidSocket;
+    }
+    FailPending();
+    running_ = false;
+
+    if (handlers_.on_disconnected)
+    {
+      handlers_.on_disconnected();
+    }
+  }
+
+  void ManagementClient::FailPending()
+  {
+    std::deque<PendingCommand> failed;
+    {
+      std::lock_guard<std::mutex> lock(pending_mutex_);
+      failed.swap(pending_);
+    }
+    for (auto &command : failed)
+    {
+      if (command.on_reply)
+      {
+        command.on_reply(false, "management connection closed");
+      }
+    }
+  }
+
+  void ManagementClient::ProcessLine(std::string_view line)
+  {
+    if (line.empty())
+    {
+      return;
+    }
+    if (authenticating_)
+    {
+      HandleAuthLine(line);
+      return;
+    }
+    if (line.front() == '>')
+    {
+      HandleNotification(line);
+      return;
+    }
+
+    PendingCommand completed;
+    bool success = true;
+    {
+      std::lock_guard<std::mutex> lock(pending_mutex_);
+      if (pending_.empty())
+      {
+        return; // Unsolicited output, e.g. a banner
+      }
+
+      PendingCommand &front = pending_.front();
+      const bool success_line = StartsWith(line, "SUCCESS:");
+      const bool error_line = StartsWith(line, "ERROR:");
+      if (!front.multiline && (success_line || error_line))
+      {
+        success = success_line;
+        front.body = std::string(TrimLeadingSpace(line.substr(success_line ? 8 : 6)));
+      }
+      else if (line == "END")
+      {
+        if (!front.body.empty() && front.body.back() == '\n')
+        {
+          front.body.pop_back();
+        }
+      }
+      else
+      {
+        front.multiline = true;
+        front.body.append(line.data(), line.size());
+        front.body.push_back('\n');
+        return;
+      }
+
+      completed = std::move(front);
+      pending_.pop_front();
+    }
+
+    if (completed.on_reply)
+    {
+      completed.on_reply(success, completed.body);
+    }
+  }
+
+  void ManagementClient::HandleAuthLine(std::string_view line)
+  {
+    if (!password_sent_)
+    {
+      return;
+    }
+    if (StartsWith(line, "SUCCESS:"))
+    {
+      authenticating_ = false;
+      connected_ = true;
+      if (handlers_.on_connected)
+      {
+        handlers_.on_connected();
+      }
+    }
+    else if (StartsWith(line, "ERROR:"))
+    {
+      // "ERROR: bad password"; the reader then disconnects
+      authenticating_ = false;
+      running_ = false;
+    }
+  }
+
+  void ManagementClient::HandleNotification(std::string_view line)
+  {
+    const size_t colon = line.find(':');
+    if (colon == std::string_view::npos)
+    {
+      return;
+    }
+    const std::string_view type = line.substr(1, colon - 1);
+    const std::string_view payload = line.substr(colon + 1);
+
+    if (type == "STATE")
+    {
+      StateNotification state;
+      if (handlers_.on_state && ParseStateLine(payload, &state))
+      {
+        handlers_.on_state(state);
+      }
+    }
+    else if (type == "BYTECOUNT")
+    {
+      ByteCountNotification count;
+      if (handlers_.on_bytecount && ParseByteCountLine(payload, &count))
+      {
+        handlers_.on_bytecount(count);
+      }
+    }
+    else if (type == "LOG")
+    {
+      LogNotification log;
+      if (handlers_.on_log && ParseLogLine(payload, &log))
+      {
+        handlers_.on_log(log);
+      }
+    }
+    else if (type == "HOLD")
+    {
+      if (handlers_.on_hold)
+      {
+        handlers_.on_hold(std::string(payload));
+      }
+    }
+    else if (type == "FATAL")
+    {
+      if (handlers_.on_fatal)
+      {
+        handlers_.on_fatal(std::string(payload));
+      }
+    }
+    else if (type == "REMOTE")
+    {
+      RemoteNotification remote;
+      if (handlers_.on_remote && ParseRemoteLine(payload, &remote))
+      {
+        handlers_.on_remote(remote);
+      }
+    }
+  }
+
+} // namespace openvpn_dart
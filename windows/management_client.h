@@ -0,0 +1,204 @@
+#ifndef FLUTTER_PLUGIN_MANAGEMENT_CLIENT_H_
+#define FLUTTER_PLUGIN_MANAGEMENT_CLIENT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "event_reactor.h"
+#include "loopback_socket.h"
+
+namespace openvpn_dart
+{
+
+    // States reported by OpenVPN's management interface (>STATE lines).
+    enum class ManagementState
+    {
+        kUnknown,
+        kConnecting,
+        kResolve,
+        kTcpConnect,
+        kWait,
+        kAuth,
+        kAuthPending,
+        kGetConfig,
+        kAssignIp,
+        kAddRoutes,
+        kConnected,
+        kReconnecting,
+        kExiting,
+    };
+
+    ManagementState ParseManagementState(std::string_view name);
+
+    struct StateNotification
+    {
+        int64_t timestamp = 0;
+        ManagementState state = ManagementState::kUnknown;
+        std::string name;      // Raw state name, e.g. "CONNECTED"
+        std::string detail;    // e.g. "SUCCESS", "auth-failure", "SIGTERM"
+        std::string local_ip;  // Tunnel address once assigned
+        std::string remote_ip; // Server address
+    };
+
+    struct ByteCountNotification
+    {
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+    };
+
+    struct LogNotification
+    {
+        int64_t timestamp = 0;
+        char flag = 'I'; // I(nfo), F(atal), N(on-fatal error), W(arning), D(ebug)
+        std::string message;
+    };
+
+    // Connection entry OpenVPN is about to use, under --management-query-remote.
+    // It waits for "remote ACCEPT", "remote SKIP" or "remote MOD host port".
+    struct RemoteNotification
+    {
+        std::string host;
+        std::string port;
+        std::string proto; // e.g. "udp", "tcp-client"
+    };
+
+    // Parsers for the payload after ">STATE:", ">BYTECOUNT:", ">LOG:" and
+    // ">REMOTE:". Also accept the same records as printed by the
+    // "state"/"log" commands.
+    bool ParseStateLine(std::string_view payload, StateNotification *out);
+    bool ParseByteCountLine(std::string_view payload, ByteCountNotification *out);
+    bool ParseLogLine(std::string_view payload, LogNotification *out);
+    bool ParseRemoteLine(std::string_view payload, RemoteNotification *out);
+
+    // Plugin status string ("connecting", "connected", "disconnecting",
+    // "error") for a management state, or nullptr if it implies no change.
+    const char *StatusForState(const StateNotification &state);
+
+    // Asynchronous client for OpenVPN's --management TCP interface.
+    //
+    // A reader thread connects (retrying while OpenVPN starts listening),
+    // splits the stream into lines, turns real-time notifications into typed
+    // callbacks and matches command replies to their requests in FIFO order.
+    // All callbacks run on the reader thread. Started on an EventReactor
+    // instead, the client has no thread of its own and its callbacks run on
+    // the reactor's thread.
+    class ManagementClient
+    {
+    public:
+        using ReplyCallback = std::function<void(bool success, const std::string &reply)>;
+
+        struct Handlers
+        {
+            std::function<void()> on_connected;
+            std::function<void(const StateNotification &)> on_state;
+            std::function<void(const ByteCountNotification &)> on_bytecount;
+            std::function<void(const LogNotification &)> on_log;
+            std::function<void(const std::string &message)> on_hold;
+            std::function<void(const std::string &message)> on_fatal;
+            std::function<void(const RemoteNotification &)> on_remote;
+            std::function<void()> on_disconnected;
+        };
+
+        // |password| answers OpenVPN's prompt when --management was given a
+        // password file; on_connected then waits until it is accepted, and
+        // a rejected password ends the connection.
+        explicit ManagementClient(Handlers handlers, std::string password = std::string());
+        ~ManagementClient();
+
+        ManagementClient(const ManagementClient &) = delete;
+        ManagementClient &operator=(const ManagementClient &) = delete;
+
+        // Starts the reader thread, which connects to 127.0.0.1:|port| within
+        // |connect_timeout_ms|. Returns false if already started.
+        bool Start(uint16_t port, int connect_timeout_ms);
+
+        // Connects on the calling thread, retrying the same way while
+        // |keep_trying| (if set) returns true, then reads on |reactor|'s
+        // thread. on_connected runs on the calling thread, or on the
+        // reactor's once a password is accepted. Returns false if already
+        // started or nothing accepted in time.
+        bool Start(EventReactor *reactor, uint16_t port, int connect_timeout_ms,
+                   std::function<bool()> keep_trying = nullptr);
+
+        // Disconnects and joins the reader thread, or waits out a callback
+        // running on the reactor. Pending replies fail.
+        void Stop();
+
+        bool connected() const { return connected_; }
+
+        // Queues |command|; |on_reply| receives the "SUCCESS:"/"ERROR:" text
+        // or the lines of a multi-line reply terminated by "END".
+        bool SendCommand(const std::string &command, ReplyCallback on_reply = nullptr);
+
+        // Feeds one line as if it arrived from the socket. Used by the reader
+        // thread and by tests.
+        void ProcessLine(std::string_view line);
+
+    private:
+        struct PendingCommand
+        {
+            ReplyCallback on_reply;
+            std::string body;
+            bool multiline = false;
+        };
+
+        // Sets |socket_| and |connected_|; false once Stop() is called,
+        // |keep_trying| fails or |connect_timeout_ms| has passed
+        bool Connect(uint16_t port, int connect_timeout_ms,
+                     const std::function<bool()> &keep_trying);
+        void ReaderLoop(uint16_t port, int connect_timeout_ms);
+        // Reactor mode, called with the read guard held
+        void OnReadable();
+        void Unwatch();
+        // Splits received bytes into lines for ProcessLine()
+        void Consume(const char *data, size_t size);
+        // Closes the socket, fails pending replies, reports the disconnect
+        void Disconnect();
+        void HandleNotification(std::string_view line);
+        // A line while the password is being checked
+        void HandleAuthLine(std::string_view line);
+        void FailPending();
+
+        Handlers handlers_;
+        const std::string password_;
+        // Set from connecting until OpenVPN accepts or rejects the password;
+        // only touched by whichever thread reads the socket
+        bool authenticating_;
+        bool password_sent_;
+        std::thread reader_;
+        std::atomic<bool> running_;
+        std::atomic<bool> connected_;
+        std::mutex socket_mutex_;
+        loopback::SocketHandle socket_;
+        std::mutex pending_mutex_;
+        std::deque<PendingCommand> pending_;
+        std::string partial_;
+
+        // Shared with the reactor callback, which may already be dispatched
+        // when Stop() removes the source; |watching| tells it the client is
+        // gone. The mutex is held around OnReadable(), and is recursive
+        // because handlers may call Stop().
+        struct ReadGuard
+        {
+            std::recursive_mutex mutex;
+            bool watching = false;
+        };
+
+        // Reactor mode. |connect_mutex_| is held while Start() connects so
+        // Stop() can wait for it.
+        EventReactor *reactor_;
+        EventReactor::SourceId source_;
+        std::shared_ptr<ReadGuard> read_guard_;
+        std::recursive_mutex connect_mutex_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_MANAGEMENT_CLIENT_H_
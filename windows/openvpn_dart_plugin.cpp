@@ -1,21 +1,391 @@
 #include "openvpn_dart_plugin.h"
+#include "async_logger.h"
+#include "bundle_manifest.h"
+#include "log_line_parser.h"
+#include "reverse_log_scanner.h"
+#include "shutdown_sequencer.h"
+#include "trace_recorder.h"
 
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
 #include <windows.h>
+#include <bcrypt.h>
 #include <shlobj.h>
-#include <tlhelp32.h>
 #include <memory>
 #include <sstream>
 #include <fstream>
 #include <filesystem>
 #include <regex>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
 
 namespace openvpn_dart
 {
 
+  namespace
+  {
+
+    // Bounds for StopVPN: clean exit after SIGTERM, then after TerminateProcess
+    constexpr int kGracefulStopTimeoutMs = 3000;
+    constexpr int kForcedStopTimeoutMs = 2000;
+
+    // A parked standby older than this is replaced rather than released, so
+    // a connect never runs on a profile read long before
+    constexpr int64_t kStandbyMaxAgeMs = 10 * 60 * 1000;
+
+    // Recent OpenVPN output kept in memory, and how long to wait for the
+    // rest of it once the process has exited
+    constexpr size_t kOutputRingLines = 512;
+    constexpr int kOutputDrainTimeoutMs = 1000;
+
+    // Connects whose phase timings getConnectTimings returns
+    constexpr size_t kConnectTimingSessions = 32;
+
+    // openvpn.log rotates at this size, keeping openvpn.log.1 .. .3
+    constexpr uint64_t kLogSegmentBytes = 8 * 1024 * 1024;
+    constexpr size_t kLogArchives = 3;
+
+    // Each named session's openvpn.log, kept smaller as there may be several
+    constexpr uint64_t kSessionLogSegmentBytes = 2 * 1024 * 1024;
+    constexpr size_t kSessionLogArchives = 2;
+
+    // The plugin's own diagnostics, plugin.log, kept smaller
+    constexpr uint64_t kPluginLogSegmentBytes = 2 * 1024 * 1024;
+    constexpr size_t kPluginLogArchives = 2;
+
+    // Lines that tell how a session ended: still connected (killed without
+    // a trace), a clean exit, or a fatal error
+    constexpr LogEventMask kSessionEndLogEvents =
+        LogEventBit(LogEvent::kConnected) | LogEventBit(LogEvent::kExiting) |
+        LogEventBit(LogEvent::kFatal);
+
+    // Events forwarded to Dart as {type: logEvent}; status changes already
+    // have the status stream
+    constexpr LogEventMask kReportedLogEvents =
+        LogEventBit(LogEvent::kAuthFailed) | LogEventBit(LogEvent::kConnectionTimeout) |
+        LogEventBit(LogEvent::kTlsError) | LogEventBit(LogEvent::kRouteFailed) |
+        LogEventBit(LogEvent::kDcoFallback);
+
+    // Method calls run on the command thread rather than the platform
+    // thread, because they start, stop or install something, or probe the
+    // system
+    constexpr const char *kLifecycleMethods[] = {
+        "ensureTapDriver", "initialize", "connect", "prewarm", "cancelPrewarm",
+        "disconnect", "removeTunnelConfiguration", "setupTunnel", "switchServer",
+        "checkTunnelConfiguration"};
+
+    // TAP installer run time limit, and how often the wait for it checks
+    // for cancellation
+    constexpr int kTapInstallTimeoutMs = 60000;
+    constexpr int kCancelPollMs = 100;
+
+    // Events for Dart are sent at most once per frame, as one list; stats
+    // samples queued in the same frame collapse to the newest. A named
+    // session's samples use kStatsEventKey + its key.
+    constexpr int64_t kEventFrameMs = 16;
+    constexpr uint32_t kStatsEventKey = 1;
+    constexpr UINT_PTR kEventTimerId = 0x4f56;
+
+    // OpenVPN's output when its management port was taken between
+    // PickFreePort() and its own bind, and how often a launch is retried
+    constexpr std::string_view kManagementBindFailed = "MANAGEMENT: Socket bind failed";
+    constexpr int kManagementBindAttempts = 3;
+
+    // How long a named session gets to bring up its management interface
+    constexpr int kSessionManagementTimeoutMs = 5000;
+
+    // How long the default tunnel's management client gets to attach. Under
+    // --management-query-remote OpenVPN waits for it before connecting.
+    constexpr int kManagementAttachTimeoutMs = 5000;
+
+    // switchServer: how long the new tunnel gets to connect, and how often
+    // its status is checked meanwhile. The new tunnel alternates between
+    // two internal sessions so it never shares files with the tunnel it
+    // replaces.
+    constexpr int64_t kSwitchConnectTimeoutMs = 60000;
+    constexpr int kSwitchPollMs = 50;
+    constexpr const char *kSwitchSessionIds[] = {".switch-a", ".switch-b"};
+
+    // Bundled files copied concurrently during extraction
+    constexpr size_t kExtractionThreads = 4;
+
+    // Archiver for rotated log segments: NTFS compression keeps them plain
+    // text for any reader. Volumes without compression keep them as is.
+    void CompressLogSegment(const std::string &path)
+    {
+      HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (file == INVALID_HANDLE_VALUE)
+      {
+        return;
+      }
+      USHORT format = COMPRESSION_FORMAT_DEFAULT;
+      DWORD returned = 0;
+      if (!DeviceIoControl(file, FSCTL_SET_COMPRESSION, &format, sizeof(format),
+                           nullptr, 0, &returned, nullptr))
+      {
+        LogWarning("Could not compress {}: {}", path, GetLastError());
+      }
+      CloseHandle(file);
+    }
+
+    // Unblocks a drain thread stuck in ReadFile on a pipe that OpenVPN's
+    // helpers (route.exe) still hold open
+    void CancelBlockedRead(std::thread::native_handle_type thread)
+    {
+      CancelSynchronousIo(thread);
+    }
+
+    // A fresh random password for OpenVPN's management interface, written
+    // to |path| for the third --management argument, so no other local
+    // process can connect to the port and drive the tunnel
+    std::string WriteManagementPassword(const std::string &path)
+    {
+      unsigned char random[16];
+      if (!BCRYPT_SUCCESS(BCryptGenRandom(nullptr, random, sizeof(random),
+                                          BCRYPT_USE_SYSTEM_PREFERRED_RNG)))
+      {
+        throw std::runtime_error("Failed to generate a management password");
+      }
+      static const char kHex[] = "0123456789abcdef";
+      std::string password;
+      for (unsigned char byte : random)
+      {
+        password.push_back(kHex[byte >> 4]);
+        password.push_back(kHex[byte & 0xf]);
+      }
+
+      std::ofstream file(path, std::ios::out | std::ios::trunc);
+      file << password << "\n";
+      if (!file)
+      {
+        throw std::runtime_error("Failed to write management password file: " + path);
+      }
+      return password;
+    }
+
+    // Completes a method call from any thread by handing the reply to the
+    // platform thread, where the engine expects it
+    class PlatformThreadResult : public flutter::MethodResult<flutter::EncodableValue>
+    {
+    public:
+      using Post = std::function<void(std::function<void()>)>;
+
+      PlatformThreadResult(std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+                           Post post)
+          : result_(std::move(result)), post_(std::move(post))
+      {
+      }
+
+    protected:
+      void SuccessInternal(const flutter::EncodableValue *result) override
+      {
+        auto value = result ? std::make_shared<flutter::EncodableValue>(*result) : nullptr;
+        post_([target = result_, value]()
+              { value ? target->Success(*value) : target->Success(); });
+      }
+
+      void ErrorInternal(const std::string &error_code, const std::string &error_message,
+                         const flutter::EncodableValue *error_details) override
+      {
+        auto details = error_details ? std::make_shared<flutter::EncodableValue>(*error_details) : nullptr;
+        post_([target = result_, error_code, error_message, details]()
+              { details ? target->Error(error_code, error_message, *details)
+                        : target->Error(error_code, error_message); });
+      }
+
+      void NotImplementedInternal() override
+      {
+        post_([target = result_]()
+              { target->NotImplemented(); });
+      }
+
+    private:
+      std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result_;
+      Post post_;
+    };
+
+    // Error code for a lifecycle call that did not run to completion
+    const char *CancelErrorCode(CancelReason reason)
+    {
+      switch (reason)
+      {
+      case CancelReason::kDeadlineExceeded:
+        return "DEADLINE_EXCEEDED";
+      case CancelReason::kShutdown:
+        return "SHUTTING_DOWN";
+      default:
+        return "CANCELLED";
+      }
+    }
+
+    // The "sessionId" argument of a method call, empty for the default
+    // tunnel. False if it is there but not a string.
+    bool SessionIdArgument(const flutter::EncodableValue *arguments, std::string *id)
+    {
+      id->clear();
+      const auto *map = arguments ? std::get_if<flutter::EncodableMap>(arguments) : nullptr;
+      if (map == nullptr)
+      {
+        return true;
+      }
+      auto id_it = map->find(flutter::EncodableValue("sessionId"));
+      if (id_it == map->end() || id_it->second.IsNull())
+      {
+        return true;
+      }
+      const auto *value = std::get_if<std::string>(&id_it->second);
+      if (value == nullptr)
+      {
+        return false;
+      }
+      *id = *value == "default" ? std::string() : *value;
+      return true;
+    }
+
+    // Monotonic milliseconds for durations and rates
+    int64_t SteadyNowMs()
+    {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+    }
+
+    // Wall-clock milliseconds, for times that must survive a plugin restart
+    int64_t UnixNowMs()
+    {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    }
+
+    // FILETIME ticks at which |process| started; 0 if unavailable
+    uint64_t ProcessCreationTime(HANDLE process)
+    {
+      FILETIME creation, exit, kernel, user;
+      if (!GetProcessTimes(process, &creation, &exit, &kernel, &user))
+      {
+        return 0;
+      }
+      return (static_cast<uint64_t>(creation.dwHighDateTime) << 32) | creation.dwLowDateTime;
+    }
+
+    // Lowercase hex SHA-256 of a file, as written to the bundle manifest
+    bool Sha256File(const std::string &path, std::string *sha256)
+    {
+      std::ifstream file(path, std::ios::binary);
+      if (!file)
+      {
+        return false;
+      }
+
+      BCRYPT_ALG_HANDLE algorithm = nullptr;
+      BCRYPT_HASH_HANDLE hash = nullptr;
+      if (!BCRYPT_SUCCESS(BCryptOpenAlgorithmProvider(&algorithm, BCRYPT_SHA256_ALGORITHM, nullptr, 0)))
+      {
+        return false;
+      }
+      bool ok = BCRYPT_SUCCESS(BCryptCreateHash(algorithm, &hash, nullptr, 0, nullptr, 0, 0));
+
+      char buffer[64 * 1024];
+      while (ok && file)
+      {
+        file.read(buffer, sizeof(buffer));
+        if (file.gcount() > 0)
+        {
+          ok = BCRYPT_SUCCESS(BCryptHashData(hash, reinterpret_cast<PUCHAR>(buffer),
+                                             static_cast<ULONG>(file.gcount()), 0));
+        }
+      }
+
+      UCHAR digest[32];
+      ok = ok && file.eof() && BCRYPT_SUCCESS(BCryptFinishHash(hash, digest, sizeof(digest), 0));
+      if (hash != nullptr)
+      {
+        BCryptDestroyHash(hash);
+      }
+      BCryptCloseAlgorithmProvider(algorithm, 0);
+      if (!ok)
+      {
+        return false;
+      }
+
+      static const char kHex[] = "0123456789abcdef";
+      sha256->clear();
+      for (UCHAR byte : digest)
+      {
+        sha256->push_back(kHex[byte >> 4]);
+        sha256->push_back(kHex[byte & 0x0f]);
+      }
+      return true;
+    }
+
+    // Runs `openvpn --version` and collects its output for the capability cache
+    bool RunVersionProbe(const std::string &executable, std::string *output)
+    {
+      TraceSpan span("probe", "openvpn --version");
+      std::string test_cmd = "\"" + executable + "\" --version";
+
+      SECURITY_ATTRIBUTES sa = {sizeof(sa), nullptr, TRUE};
+      HANDLE read_pipe, write_pipe;
+
+      if (!CreatePipe(&read_pipe, &write_pipe, &sa, 0))
+      {
+        return false;
+      }
+
+      STARTUPINFOA si = {0};
+      si.cb = sizeof(si);
+      si.dwFlags = STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
+      si.hStdOutput = write_pipe;
+      si.hStdError = write_pipe;
+      si.wShowWindow = SW_HIDE;
+
+      PROCESS_INFORMATION pi = {0};
+
+      BOOL success = CreateProcessA(
+          nullptr,
+          const_cast<char *>(test_cmd.c_str()),
+          nullptr,
+          nullptr,
+          TRUE,
+          CREATE_NO_WINDOW,
+          nullptr,
+          nullptr,
+          &si,
+          &pi);
+
+      CloseHandle(write_pipe);
+
+      if (!success)
+      {
+        CloseHandle(read_pipe);
+        return false;
+      }
+
+      // Read output
+      char buffer[4096];
+      DWORD bytes_read;
+
+      while (ReadFile(read_pipe, buffer, sizeof(buffer) - 1, &bytes_read, nullptr) && bytes_read > 0)
+      {
+        buffer[bytes_read] = '\0';
+        *output += buffer;
+      }
+
+      WaitForSingleObject(pi.hProcess, 5000);
+      CloseHandle(read_pipe);
+      CloseHandle(pi.hProcess);
+      CloseHandle(pi.hThread);
+      return true;
+    }
+
+  } // namespace
+
   // Static method registration
   void OpenVpnDartPlugin::RegisterWithRegistrar(
       flutter::PluginRegistrarWindows *registrar)
@@ -60,62 +430,196 @@ namespace openvpn_dart
 
   OpenVpnDartPlugin::OpenVpnDartPlugin(flutter::PluginRegistrarWindows *registrar)
       : registrar_(registrar),
+        listening_(false),
+        event_window_(nullptr),
+        drain_message_(0),
+        window_proc_id_(-1),
+        last_flush_ms_(0),
+        wake_failed_(false),
         process_handle_(nullptr),
         pipe_read_(nullptr),
         pipe_write_(nullptr),
         is_connected_(false),
         is_monitoring_(false),
-        current_status_("disconnected")
+        teardown_running_(false),
+        current_status_("disconnected"),
+        management_port_(0),
+        management_active_(false),
+        stats_interval_seconds_(1),
+        standby_pipe_read_(nullptr),
+        standby_pipe_write_(nullptr),
+        standby_port_(0),
+        standby_spawned_ms_(0),
+        standby_held_(false),
+        shutting_down_(false),
+        handover_(false),
+        switch_count_(0),
+        remote_override_applied_(false),
+        native_routes_requested_(false),
+        native_routes_active_(false),
+        native_routes_installed_(false),
+        native_routes_failed_(false),
+        native_push_more_(false),
+        route_programmer_(&route_backend_),
+        journal_active_(false),
+        output_drain_(kOutputRingLines),
+        log_to_file_(true),
+        connect_timings_(kConnectTimingSessions)
   {
     ZeroMemory(&process_info_, sizeof(process_info_));
+    ZeroMemory(&standby_info_, sizeof(standby_info_));
+
+    const int64_t constructed_ms = SteadyNowMs();
+    TraceRecorder::Global().SetThreadName("platform");
 
     // Get the bundled OpenVPN path
     bundled_path_ = GetPluginDataPath();
     openvpn_executable_path_ = bundled_path_ + "\\openvpn.exe";
+    log_file_path_ = bundled_path_ + "\\config\\openvpn.log";
+    journal_path_ = bundled_path_ + "\\session.journal";
+    sessions_.set_root_directory(bundled_path_ + "\\sessions");
+    output_log_ = std::make_unique<RotatingLog>(log_file_path_, kLogSegmentBytes, kLogArchives,
+                                                CompressLogSegment);
+
+    // Log calls only queue records; the logger's thread formats them into
+    // plugin.log and, while a debugger is attached, the debugger output
+    plugin_log_ = std::make_shared<RotatingLog>(bundled_path_ + "\\plugin.log", kPluginLogSegmentBytes,
+                                                kPluginLogArchives, CompressLogSegment);
+    plugin_log_->Open();
+    AsyncLogger::Global().SetSinks(
+        {[log = plugin_log_](LogLevel, const std::string &line)
+         { log->Write(line); },
+         [](LogLevel, const std::string &line)
+         {
+           if (IsDebuggerPresent())
+           {
+             OutputDebugStringA((line + "\n").c_str());
+           }
+         }});
+    AsyncLogger::Global().Start();
+
+    // Events are queued from any thread and sent from the platform thread,
+    // woken through a message to the top-level window
+    if (registrar_ != nullptr && registrar_->GetView() != nullptr)
+    {
+      event_window_ = GetAncestor(registrar_->GetView()->GetNativeWindow(), GA_ROOT);
+      drain_message_ = RegisterWindowMessageA("OpenVpnDartDrainEvents");
+      window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+          [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam)
+          { return HandleWindowMessage(hwnd, message, wparam, lparam); });
+    }
+
+    capability_cache_ = std::make_unique<CapabilityCache>(
+        openvpn_executable_path_, bundled_path_ + "\\capabilities.txt", RunVersionProbe);
+
+    // Bundle extraction and attach detection run off the registration path;
+    // HandleMethodCall waits for |ready_| before touching their results
+    ready_ = ready_promise_.get_future().share();
+    init_thread_ = std::thread(&OpenVpnDartPlugin::InitializeInBackground, this, constructed_ms);
+  }
 
-    // Extract bundled OpenVPN on first run or if files are missing
-    std::string tap_installer = bundled_path_ + "\\tap-windows-installer.exe";
-    if (!std::filesystem::exists(openvpn_executable_path_) ||
-        !std::filesystem::exists(tap_installer))
+  void OpenVpnDartPlugin::InitializeInBackground(int64_t constructed_ms)
+  {
+    TraceRecorder::Global().SetThreadName("init");
+    TraceSpan span("init", "InitializeInBackground");
+    const int64_t started_ms = SteadyNowMs();
+    int64_t extract_ms = 0;
+    int64_t attach_ms = 0;
+
+    try
     {
+      // Brings the extracted bundle up to date; a no-op apart from hashing
+      // when nothing changed
       ExtractBundledOpenVPN();
+      extract_ms = SteadyNowMs() - started_ms;
+
+      // Probe openvpn.exe once in the background; a re-extracted bundle changes
+      // the executable's size or mtime and is probed again on next use
+      capability_cache_->ProbeAsync();
+
+      // Check for existing OpenVPN connection
+      const int64_t attach_started_ms = SteadyNowMs();
+      CheckExistingConnection();
+      attach_ms = SteadyNowMs() - attach_started_ms;
+    }
+    catch (const std::exception &e)
+    {
+      LogError("Error during background initialization: {}", e.what());
     }
 
-    // Check for existing OpenVPN connection
-    CheckExistingConnection();
+    const int64_t ready_ms = SteadyNowMs() - constructed_ms;
+    LogInfo("Plugin ready after {}ms (wait {}ms, extract {}ms, attach {}ms)",
+            ready_ms, started_ms - constructed_ms, extract_ms, attach_ms);
+
+    {
+      std::lock_guard<std::mutex> lock(event_sink_mutex_);
+      ready_event_ = flutter::EncodableMap{
+          {flutter::EncodableValue("type"), flutter::EncodableValue("ready")},
+          {flutter::EncodableValue("readyMs"), flutter::EncodableValue(ready_ms)},
+          {flutter::EncodableValue("extractMs"), flutter::EncodableValue(extract_ms)},
+          {flutter::EncodableValue("attachMs"), flutter::EncodableValue(attach_ms)},
+          {flutter::EncodableValue("attached"), flutter::EncodableValue(is_connected_.load())},
+      };
+      if (!last_session_end_.empty())
+      {
+        ready_event_[flutter::EncodableValue("lastSessionEnd")] = flutter::EncodableValue(last_session_end_);
+      }
+    }
+    PublishEvent(ready_event_);
+    ready_promise_.set_value();
   }
 
   OpenVpnDartPlugin::~OpenVpnDartPlugin()
   {
     try
     {
-      OutputDebugStringA("OpenVpnDartPlugin destructor called");
+      LogDebug("OpenVpnDartPlugin destructor called");
+
+      // Cancel pending lifecycle calls and let the running one unwind
+      // before the state it works on goes away
+      commands_.Shutdown();
+
+      // Background init may still be attaching to a running process
+      if (init_thread_.joinable())
+      {
+        init_thread_.join();
+      }
 
       // Signal threads to stop
+      shutting_down_ = true;
       is_monitoring_ = false;
       is_connected_ = false;
+      reactor_.Wake();
 
       // Stop VPN safely
       try
       {
-        StopVPN();
+        StopVPN(true);
       }
       catch (const std::exception &e)
       {
-        OutputDebugStringA(("Error in StopVPN during cleanup: " + std::string(e.what())).c_str());
+        LogWarning("Error in StopVPN during cleanup: {}", e.what());
+      }
+      RecycleStandby();
+
+      // Named sessions, then the thread that watched them
+      for (const auto &session : sessions_.List())
+      {
+        StopSession(session);
+      }
+      session_reactor_.Wake();
+      if (session_reactor_thread_.joinable())
+      {
+        session_reactor_thread_.join();
       }
 
       // Wait for threads with timeout
       if (monitor_thread_.joinable())
       {
-        OutputDebugStringA("Waiting for monitor thread...");
+        LogDebug("Waiting for monitor thread...");
         monitor_thread_.join();
       }
-      if (log_thread_.joinable())
-      {
-        OutputDebugStringA("Waiting for log thread...");
-        log_thread_.join();
-      }
+      StopOutputCapture();
 
       // Clean up pipes
       if (pipe_read_)
@@ -129,13 +633,24 @@ namespace openvpn_dart
         pipe_write_ = nullptr;
       }
 
-      OutputDebugStringA("OpenVpnDartPlugin cleanup completed");
+      if (window_proc_id_ != -1)
+      {
+        KillTimer(event_window_, kEventTimerId);
+        registrar_->UnregisterTopLevelWindowProcDelegate(window_proc_id_);
+      }
+
+      LogInfo("OpenVpnDartPlugin cleanup completed");
     }
     catch (...)
     {
-      OutputDebugStringA("Critical error in OpenVpnDartPlugin destructor - suppressing exception");
+      LogError("Critical error in OpenVpnDartPlugin destructor - suppressing exception");
       // Never throw from destructor
     }
+
+    // Write out what is queued; later records wait for the next plugin
+    AsyncLogger::Global().Stop();
+    AsyncLogger::Global().SetSinks({});
+    plugin_log_->Close();
   }
 
   std::string OpenVpnDartPlugin::GetPluginDataPath()
@@ -199,23 +714,24 @@ namespace openvpn_dart
 
   bool OpenVpnDartPlugin::ExtractBundledOpenVPN()
   {
+    TraceSpan span("extract", "ExtractBundledOpenVPN");
     try
     {
       std::string source = GetBundledOpenVPNPath();
       std::string dest = bundled_path_;
 
-      OutputDebugStringA(("Extracting from: " + source).c_str());
-      OutputDebugStringA(("Extracting to: " + dest).c_str());
+      LogDebug("Extracting from: {}", source);
+      LogDebug("Extracting to: {}", dest);
 
       if (source.empty() || dest.empty())
       {
-        OutputDebugStringA("Invalid source or destination path");
+        LogWarning("Invalid source or destination path");
         return false;
       }
 
       if (!std::filesystem::exists(source))
       {
-        OutputDebugStringA(("Source bundle not found: " + source).c_str());
+        LogWarning("Source bundle not found: {}", source);
         return false;
       }
 
@@ -226,48 +742,63 @@ namespace openvpn_dart
       }
       catch (const std::filesystem::filesystem_error &e)
       {
-        OutputDebugStringA(("Failed to create destination directory: " + std::string(e.what())).c_str());
+        LogWarning("Failed to create destination directory: {}", e.what());
         return false;
       }
 
-      // Copy all files from bundle to destination
-      int file_count = 0;
-      int error_count = 0;
+      // The build records each bundled file's size and SHA-256; only files
+      // missing or different at the destination are copied
+      std::vector<BundleEntry> manifest;
+      std::filesystem::path manifest_path = std::filesystem::path(source) / kBundleManifestName;
+      std::ifstream manifest_file(manifest_path, std::ios::binary);
+      if (manifest_file)
+      {
+        std::string text((std::istreambuf_iterator<char>(manifest_file)), std::istreambuf_iterator<char>());
+        if (!ParseBundleManifest(text, &manifest))
+        {
+          LogWarning("Ignoring malformed bundle manifest: {}", manifest_path.string());
+          manifest.clear();
+        }
+      }
 
-      for (const auto &entry : std::filesystem::recursive_directory_iterator(source))
+      if (manifest.empty())
       {
-        try
+        // No usable manifest: describe the source directory as it is now
+        LogInfo("Bundle manifest not found, hashing source files");
+        for (const auto &entry : std::filesystem::recursive_directory_iterator(source))
         {
-          if (entry.is_regular_file())
+          if (!entry.is_regular_file())
           {
-            std::filesystem::path relative = std::filesystem::relative(entry.path(), source);
-            std::filesystem::path dest_file = std::filesystem::path(dest) / relative;
-
-            std::filesystem::create_directories(dest_file.parent_path());
-            std::filesystem::copy_file(entry.path(), dest_file,
-                                       std::filesystem::copy_options::overwrite_existing);
-            file_count++;
-            OutputDebugStringA(("Copied: " + dest_file.string()).c_str());
+            continue;
+          }
+          BundleEntry file;
+          file.name = std::filesystem::relative(entry.path(), source).string();
+          file.size = entry.file_size();
+          if (file.name != kBundleManifestName && Sha256File(entry.path().string(), &file.sha256))
+          {
+            manifest.push_back(std::move(file));
           }
         }
-        catch (const std::filesystem::filesystem_error &e)
-        {
-          error_count++;
-          OutputDebugStringA(("Failed to copy file: " + std::string(e.what())).c_str());
-        }
       }
 
-      OutputDebugStringA(("Extracted " + std::to_string(file_count) + " files with " + std::to_string(error_count) + " errors").c_str());
-      return file_count > 0 && error_count == 0;
+      ExtractionResult extraction = ExtractBundle(source, dest, manifest, Sha256File, kExtractionThreads);
+      for (const std::string &error : extraction.errors)
+      {
+        LogWarning("Failed to copy file: {}", error);
+      }
+
+      LogInfo("Extracted {} files ({} up to date) with {} errors",
+              extraction.copied, extraction.up_to_date, extraction.failed);
+      return !manifest.empty() && extraction.failed == 0;
     }
     catch (const std::exception &e)
     {
-      OutputDebugStringA(("Exception in ExtractBundledOpenVPN: " + std::string(e.what())).c_str());
+      LogError("Exception in ExtractBundledOpenVPN: {}", e.what());
       return false;
     }
     catch (...)
     {
-      OutputDebugStringA("Unknown exception in ExtractBundledOpenVPN");
+      LogError("Unknown exception in ExtractBundledOpenVPN");
       return false;
     }
   }
@@ -278,11 +809,12 @@ namespace openvpn_dart
     if (IsWindows11OrGreater() && SupportsDCO())
     {
       // DCO is built into Windows kernel, no separate driver needed
-      OutputDebugStringA("Using DCO driver (built-in for Windows 11)");
+      LogInfo("Using DCO driver (built-in for Windows 11)");
       return true;
     }
 
     // Check if TAP adapter exists in network adapters
+    TraceSpan span("registry", "TAP adapter scan");
     HKEY hKey;
     if (RegOpenKeyExA(HKEY_LOCAL_MACHINE,
                       "SYSTEM\\CurrentControlSet\\Control\\Class\\{4D36E972-E325-11CE-BFC1-08002BE10318}",
@@ -323,19 +855,20 @@ namespace openvpn_dart
     return false;
   }
 
-  bool OpenVpnDartPlugin::InstallTAPDriver()
+  bool OpenVpnDartPlugin::InstallTAPDriver(const CommandContext &context)
   {
+    TraceSpan span("process", "InstallTAPDriver");
     // Run the TAP driver installer
     // Note: App already runs with admin privileges (requireAdministrator manifest)
     std::string installer_path = bundled_path_ + "\\tap-windows-installer.exe";
 
     if (!std::filesystem::exists(installer_path))
     {
-      OutputDebugStringA(("TAP installer not found at: " + installer_path).c_str());
+      LogWarning("TAP installer not found at: {}", installer_path);
       return false;
     }
 
-    OutputDebugStringA("Attempting to install TAP-Windows driver...");
+    LogInfo("Attempting to install TAP-Windows driver...");
 
     // Use CreateProcess since we already have admin rights
     std::string command_line = "\"" + installer_path + "\" /S"; // Silent install
@@ -360,19 +893,30 @@ namespace openvpn_dart
             &pi))
     {
       DWORD error = GetLastError();
-      OutputDebugStringA(("Failed to launch TAP installer. Error: " + std::to_string(error)).c_str());
+      LogError("Failed to launch TAP installer. Error: {}", error);
       return false;
     }
 
-    OutputDebugStringA("Waiting for TAP driver installation to complete...");
-    DWORD waitResult = WaitForSingleObject(pi.hProcess, 60000); // 60 second timeout
+    LogDebug("Waiting for TAP driver installation to complete...");
+    DWORD waitResult = WAIT_TIMEOUT;
+    for (int waited_ms = 0; waited_ms < kTapInstallTimeoutMs && !context.cancelled();
+         waited_ms += kCancelPollMs)
+    {
+      waitResult = WaitForSingleObject(pi.hProcess, kCancelPollMs);
+      if (waitResult != WAIT_TIMEOUT)
+      {
+        break;
+      }
+    }
 
     if (waitResult == WAIT_TIMEOUT)
     {
-      OutputDebugStringA("TAP driver installation timed out");
+      LogWarning(context.cancelled() ? "TAP driver installation cancelled"
+                                     : "TAP driver installation timed out");
       TerminateProcess(pi.hProcess, 1);
       CloseHandle(pi.hProcess);
       CloseHandle(pi.hThread);
+      context.ThrowIfCancelled();
       return false;
     }
 
@@ -384,27 +928,27 @@ namespace openvpn_dart
 
     if (exitCode != 0)
     {
-      OutputDebugStringA(("TAP installer exited with code: " + std::to_string(exitCode)).c_str());
+      LogInfo("TAP installer exited with code: {}", exitCode);
       if (exitCode == 1)
       {
-        OutputDebugStringA("Installation failed - may be blocked by Windows 11 security (Memory Integrity)");
+        LogWarning("Installation failed - may be blocked by Windows 11 security (Memory Integrity)");
       }
       return false;
     }
 
-    OutputDebugStringA("TAP driver installation completed successfully");
+    LogInfo("TAP driver installation completed successfully");
 
     // Give Windows a moment to register the driver
-    Sleep(2000);
+    context.SleepFor(2000);
 
     bool installed = IsTAPDriverInstalled();
     if (installed)
     {
-      OutputDebugStringA("TAP driver verified: Successfully installed and detected");
+      LogInfo("TAP driver verified: Successfully installed and detected");
     }
     else
     {
-      OutputDebugStringA("TAP driver installation completed but driver not detected in registry");
+      LogWarning("TAP driver installation completed but driver not detected in registry");
     }
 
     return installed;
@@ -427,7 +971,7 @@ namespace openvpn_dart
                          osInfo.dwMajorVersion > 10;
           if (isWin11)
           {
-            OutputDebugStringA(("Detected Windows 11 or greater (Build: " + std::to_string(osInfo.dwBuildNumber) + ")").c_str());
+            LogInfo("Detected Windows 11 or greater (Build: {})", osInfo.dwBuildNumber);
           }
           return isWin11;
         }
@@ -438,107 +982,57 @@ namespace openvpn_dart
 
   bool OpenVpnDartPlugin::SupportsDCO()
   {
+    TraceSpan span("probe", "SupportsDCO");
     // Check if openvpn.exe has DCO (Data Channel Offload) available
-    // DCO is built into OpenVPN 2.6+ but may not be enabled
-    // Use --version to check build flags and DCO version status
-    std::string test_cmd = "\"" + openvpn_executable_path_ + "\" --version";
-
-    SECURITY_ATTRIBUTES sa = {sizeof(sa), nullptr, TRUE};
-    HANDLE read_pipe, write_pipe;
-
-    if (!CreatePipe(&read_pipe, &write_pipe, &sa, 0))
+    // DCO is built into OpenVPN 2.6+ but may not be enabled. The --version
+    // probe runs once per bundle; later calls are answered from the cache
+    OpenVPNCapabilities caps = capability_cache_->Get();
+    if (caps.SupportsDCO())
     {
-      return false;
+      return true;
     }
-
-    STARTUPINFOA si = {0};
-    si.cb = sizeof(si);
-    si.dwFlags = STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
-    si.hStdOutput = write_pipe;
-    si.hStdError = write_pipe;
-    si.wShowWindow = SW_HIDE;
-
-    PROCESS_INFORMATION pi = {0};
-
-    BOOL success = CreateProcessA(
-        nullptr,
-        const_cast<char *>(test_cmd.c_str()),
-        nullptr,
-        nullptr,
-        TRUE,
-        CREATE_NO_WINDOW,
-        nullptr,
-        nullptr,
-        &si,
-        &pi);
-
-    CloseHandle(write_pipe);
-
-    if (!success)
+    if (caps.dco_compiled)
     {
-      CloseHandle(read_pipe);
-      return false;
+      LogInfo("DCO compiled but not available (DCO version: {}). TAP driver will be used.", caps.dco_version);
     }
-
-    // Read output
-    char buffer[4096];
-    DWORD bytes_read;
-    std::string output;
-
-    while (ReadFile(read_pipe, buffer, sizeof(buffer) - 1, &bytes_read, nullptr) && bytes_read > 0)
+    else
     {
-      buffer[bytes_read] = '\0';
-      output += buffer;
+      LogInfo("DCO not compiled into this OpenVPN build");
     }
+    return false;
+  }
 
-    WaitForSingleObject(pi.hProcess, 5000);
-    CloseHandle(read_pipe);
-    CloseHandle(pi.hProcess);
-    CloseHandle(pi.hThread);
-
-    // Check if DCO is compiled in (look for [DCO] in build line)
-    bool dcoCompiled = output.find("[DCO]") != std::string::npos;
+  std::string OpenVpnDartPlugin::WindowsDriverOption()
+  {
+    // Driver selection based on OS and DCO availability
+    // Windows 11 has security features that can block TAP-Windows6
+    // DCO (ovpn-dco) is kernel-integrated and compatible with Windows 11 security
+    bool isWin11 = IsWindows11OrGreater();
+    bool dcoSupported = SupportsDCO();
 
-    // Check DCO version line - if it's not "N/A", DCO is actually available
-    bool dcoAvailable = false;
-    size_t dcoPos = output.find("DCO version:");
-    if (dcoPos != std::string::npos)
+    if (isWin11 && dcoSupported)
     {
-      std::string dcoLine = output.substr(dcoPos, 100);
-      size_t endPos = dcoLine.find('\n');
-      if (endPos != std::string::npos)
-      {
-        dcoLine = dcoLine.substr(0, endPos);
-      }
-      // DCO is available if version is NOT "N/A"
-      dcoAvailable = (dcoLine.find("N/A") == std::string::npos);
-
-      if (dcoCompiled && dcoAvailable)
-      {
-        OutputDebugStringA(("DCO is compiled and available: " + dcoLine).c_str());
-        return true;
-      }
-      else if (dcoCompiled && !dcoAvailable)
-      {
-        OutputDebugStringA(("DCO compiled but not available (" + dcoLine + "). TAP driver will be used.").c_str());
-      }
+      LogInfo("Windows 11 with DCO: Using ovpn-dco driver");
+      return " --windows-driver ovpn-dco";
     }
-
-    if (!dcoCompiled)
+    if (isWin11 && !dcoSupported)
     {
-      OutputDebugStringA("DCO not compiled into this OpenVPN build");
+      // Windows 11 without DCO - this may fail due to security features
+      LogWarning("Windows 11 without DCO support. TAP driver may be blocked by security features (HVCI/Memory Integrity).");
+      LogWarning("Consider: 1) Upgrading to OpenVPN 2.6.9+ with DCO, or 2) Disabling Memory Integrity in Windows Security");
+      return " --windows-driver tap-windows6";
     }
-
-    return false;
+    LogInfo("Windows 10: Using TAP-Windows6 driver");
+    return " --windows-driver tap-windows6";
   }
 
-  void OpenVpnDartPlugin::EnsureTAPDriver()
+  void OpenVpnDartPlugin::EnsureTAPDriver(const CommandContext &context)
   {
-    OutputDebugStringA("=== Checking TAP Driver ===");
+    LogDebug("=== Checking TAP Driver ===");
 
     if (IsTAPDriverInstalled())
     {
-      OutputDebugStringA("TAP driver is already installed");
+      LogDebug("TAP driver is already installed");
       return;
     }
 
@@ -547,7 +1041,7 @@ namespace openvpn_dart
     // Extract bundled files if TAP installer is missing
     if (!std::filesystem::exists(installer_path))
     {
-      OutputDebugStringA("TAP installer not found, extracting from bundle...");
+      LogInfo("TAP installer not found, extracting from bundle...");
       if (!ExtractBundledOpenVPN())
       {
         throw std::runtime_error("Failed to extract TAP installer from bundle");
@@ -560,9 +1054,9 @@ namespace openvpn_dart
       }
     }
 
-    OutputDebugStringA("TAP driver not found. Starting installation...");
+    LogInfo("TAP driver not found. Starting installation...");
 
-    if (!InstallTAPDriver())
+    if (!InstallTAPDriver(context))
     {
       std::string error_msg = "Failed to install TAP driver.";
 
@@ -589,7 +1083,7 @@ namespace openvpn_dart
       throw std::runtime_error("TAP driver installation completed but driver not detected. Please restart your computer and try again.");
     }
 
-    OutputDebugStringA("TAP driver installed successfully");
+    LogInfo("TAP driver installed successfully");
   }
 
   std::string OpenVpnDartPlugin::CheckSecurityFeatures()
@@ -630,6 +1124,7 @@ namespace openvpn_dart
 
   std::string OpenVpnDartPlugin::GetTAPAdapterName()
   {
+    TraceSpan span("registry", "TAP connection name scan");
     // Get the name of the TAP adapter
     HKEY hKey;
     std::string adapter_name = "TAP-Windows Adapter V9";
@@ -677,48 +1172,309 @@ namespace openvpn_dart
   {
 
     const std::string &method = method_call.method_name();
+    const char *trace_name = TraceRecorder::Global().Intern(method);
+    TraceSpan span("method", trace_name);
+    // Delivers anything whose wake-up message could not be posted
+    if (wake_failed_)
+    {
+      DrainOnPlatformThread();
+    }
 
-    if (method == "ensureTapDriver")
+    if (method == "cancel")
     {
-      try
-      {
-        EnsureTAPDriver();
-        result->Success(flutter::EncodableValue(true));
-      }
-      catch (const std::exception &e)
+      // Cancels the named lifecycle call, or all of them, queued or running
+      std::string target;
+      if (const auto *arguments = std::get_if<flutter::EncodableMap>(method_call.arguments()))
       {
-        result->Error("TAP_DRIVER_ERROR", e.what());
+        auto method_it = arguments->find(flutter::EncodableValue("method"));
+        if (method_it != arguments->end())
+        {
+          if (const auto *name = std::get_if<std::string>(&method_it->second))
+          {
+            target = *name;
+          }
+        }
       }
+      const size_t cancelled = target.empty() ? commands_.CancelAll() : commands_.Cancel(target);
+      result->Success(flutter::EncodableValue(static_cast<int32_t>(cancelled)));
+      return;
     }
-    else if (method == "initialize")
+    if (method == "getRecentLogs")
     {
-      OutputDebugStringA("=== OpenVPN Initialization Starting ===");
-
-      // Log Windows version
-      if (IsWindows11OrGreater())
+      // Served from the in-memory ring; never touches openvpn.log
+      int32_t count = 100;
+      if (const auto *arguments = std::get_if<flutter::EncodableMap>(method_call.arguments()))
       {
-        OutputDebugStringA("Detected: Windows 11 or greater");
-        std::string secWarnings = CheckSecurityFeatures();
-        if (!secWarnings.empty())
+        auto count_it = arguments->find(flutter::EncodableValue("count"));
+        if (count_it != arguments->end())
         {
-          OutputDebugStringA(("Security warnings: " + secWarnings).c_str());
+          if (const auto *value = std::get_if<int32_t>(&count_it->second))
+          {
+            count = std::max(0, *value);
+          }
         }
       }
-      else
-      {
-        OutputDebugStringA("Detected: Windows 10 or earlier");
-      }
-
-      // Log DCO support
-      if (std::filesystem::exists(openvpn_executable_path_))
+      flutter::EncodableList lines;
+      output_drain_.VisitRecentLines(static_cast<size_t>(count), [&lines](std::string_view line)
+                                     { lines.push_back(flutter::EncodableValue(std::string(line))); });
+      result->Success(flutter::EncodableValue(std::move(lines)));
+      return;
+    }
+    if (method == "getEventMetrics")
+    {
+      const EventQueueMetrics metrics = events_.Metrics();
+      result->Success(flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("published"), flutter::EncodableValue(static_cast<int64_t>(metrics.published))},
+          {flutter::EncodableValue("delivered"), flutter::EncodableValue(static_cast<int64_t>(metrics.delivered))},
+          {flutter::EncodableValue("coalesced"), flutter::EncodableValue(static_cast<int64_t>(metrics.coalesced))},
+          {flutter::EncodableValue("batches"), flutter::EncodableValue(static_cast<int64_t>(metrics.batches))},
+          {flutter::EncodableValue("queueDepth"), flutter::EncodableValue(static_cast<int64_t>(metrics.depth))},
+          {flutter::EncodableValue("maxQueueDepth"), flutter::EncodableValue(static_cast<int64_t>(metrics.max_depth))},
+          {flutter::EncodableValue("eventsPerSecond"), flutter::EncodableValue(metrics.events_per_second)},
+          {flutter::EncodableValue("batchesPerSecond"), flutter::EncodableValue(metrics.batches_per_second)},
+      }));
+      return;
+    }
+    if (method == "getConnectTimings")
+    {
+      // Oldest first; milestones are milliseconds after the connect request
+      flutter::EncodableList sessions;
+      for (const ConnectTimings &timings : connect_timings_.Sessions())
       {
-        if (SupportsDCO())
+        flutter::EncodableMap milestones;
+        for (size_t i = 0; i < static_cast<size_t>(ConnectMilestone::kCount); i++)
         {
-          OutputDebugStringA("DCO (Data Channel Offload) is available");
+          if (timings.milestone_ms[i] >= 0)
+          {
+            milestones[flutter::EncodableValue(ConnectMilestoneName(static_cast<ConnectMilestone>(i)))] =
+                flutter::EncodableValue(timings.milestone_ms[i]);
+          }
         }
-        else
+        sessions.push_back(flutter::EncodableValue(flutter::EncodableMap{
+            {flutter::EncodableValue("sequence"), flutter::EncodableValue(static_cast<int64_t>(timings.sequence))},
+            {flutter::EncodableValue("startUnixMs"), flutter::EncodableValue(timings.start_unix_ms)},
+            {flutter::EncodableValue("prewarmed"), flutter::EncodableValue(timings.prewarmed)},
+            {flutter::EncodableValue("outcome"), flutter::EncodableValue(ConnectOutcomeName(timings.outcome))},
+            {flutter::EncodableValue("totalMs"), flutter::EncodableValue(timings.total_ms)},
+            {flutter::EncodableValue("milestones"), flutter::EncodableValue(std::move(milestones))},
+        }));
+      }
+      result->Success(flutter::EncodableValue(std::move(sessions)));
+      return;
+    }
+    if (method == "getTrace")
+    {
+      // Chrome trace-event JSON of the spans still buffered
+      bool clear = false;
+      if (const auto *arguments = std::get_if<flutter::EncodableMap>(method_call.arguments()))
+      {
+        auto clear_it = arguments->find(flutter::EncodableValue("clear"));
+        if (clear_it != arguments->end())
         {
-          OutputDebugStringA("DCO not available, will use TAP driver");
+          if (const auto *value = std::get_if<bool>(&clear_it->second))
+          {
+            clear = *value;
+          }
+        }
+      }
+      std::string trace = TraceRecorder::Global().ExportChromeTrace();
+      if (clear)
+      {
+        TraceRecorder::Global().Clear();
+      }
+      result->Success(flutter::EncodableValue(std::move(trace)));
+      return;
+    }
+    if (method == "setTracing")
+    {
+      const auto *enabled = std::get_if<bool>(method_call.arguments());
+      if (enabled == nullptr)
+      {
+        result->Error("INVALID_ARGUMENT", "Expected a bool");
+        return;
+      }
+      TraceRecorder::Global().set_enabled(*enabled);
+      result->Success();
+      return;
+    }
+    if (method == "getSessions")
+    {
+      // Named sessions by ID; the default tunnel is not among them
+      const int64_t now = SteadyNowMs();
+      flutter::EncodableList sessions;
+      for (const auto &session : sessions_.List())
+      {
+        if (!IsValidSessionId(session->id()))
+        {
+          continue; // The plugin's own, e.g. a switchServer in progress
+        }
+        const TrafficSnapshot traffic = session->Traffic(now);
+        sessions.push_back(flutter::EncodableValue(flutter::EncodableMap{
+            {flutter::EncodableValue("sessionId"), flutter::EncodableValue(session->id())},
+            {flutter::EncodableValue("status"), flutter::EncodableValue(session->status())},
+            {flutter::EncodableValue("pid"), flutter::EncodableValue(static_cast<int64_t>(session->pid()))},
+            {flutter::EncodableValue("bytesIn"), flutter::EncodableValue(static_cast<int64_t>(traffic.bytes_in))},
+            {flutter::EncodableValue("bytesOut"), flutter::EncodableValue(static_cast<int64_t>(traffic.bytes_out))},
+            {flutter::EncodableValue("durationMs"), flutter::EncodableValue(traffic.duration_ms)},
+        }));
+      }
+      result->Success(flutter::EncodableValue(std::move(sessions)));
+      return;
+    }
+    if (method == "request_permission")
+    {
+      result->Success(flutter::EncodableValue(true));
+      return;
+    }
+    if (method == "status")
+    {
+      // Answered in place from the last known status, without waiting for
+      // background init; a session it reattaches is reported through the
+      // status stream
+      std::string session_id;
+      if (SessionIdArgument(method_call.arguments(), &session_id) && !session_id.empty())
+      {
+        // A session that has ended is gone, so it reads as disconnected
+        auto session = sessions_.Find(session_id);
+        result->Success(flutter::EncodableValue(session ? session->status() : std::string("disconnected")));
+      }
+      else
+      {
+        result->Success(flutter::EncodableValue(GetCurrentStatus()));
+      }
+      return;
+    }
+    if (std::find(std::begin(kLifecycleMethods), std::end(kLifecycleMethods), method) ==
+        std::end(kLifecycleMethods))
+    {
+      result->NotImplemented();
+      return;
+    }
+
+    // The rest start, stop, install or probe something: they run in order on
+    // the command thread and complete |result| from there. Calls for a named
+    // session go by "<method>:<sessionId>", so they cancel only each other.
+    std::string session_id;
+    if (!SessionIdArgument(method_call.arguments(), &session_id))
+    {
+      result->Error("INVALID_ARGUMENT", "sessionId must be a string");
+      return;
+    }
+    std::string command_name = method;
+    if (!session_id.empty() && (method == "connect" || method == "disconnect"))
+    {
+      command_name += ":" + session_id;
+      if (method == "disconnect")
+      {
+        commands_.Cancel("connect:" + session_id);
+      }
+    }
+    else if (method == "disconnect" || method == "removeTunnelConfiguration")
+    {
+      // A disconnect supersedes a connect still starting or queued
+      commands_.Cancel("connect");
+      commands_.Cancel("prewarm");
+      commands_.Cancel("switchServer");
+    }
+
+    int64_t timeout_ms = 0;
+    if (const auto *arguments = std::get_if<flutter::EncodableMap>(method_call.arguments()))
+    {
+      auto timeout_it = arguments->find(flutter::EncodableValue("timeoutMs"));
+      if (timeout_it != arguments->end())
+      {
+        if (const auto *value = std::get_if<int32_t>(&timeout_it->second))
+        {
+          timeout_ms = *value;
+        }
+      }
+    }
+
+    // Replies from the command thread are delivered on the platform thread
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+        std::make_shared<PlatformThreadResult>(std::move(result), [this](std::function<void()> task)
+                                               { RunOnPlatformThread(std::move(task)); });
+    auto arguments = std::make_shared<flutter::EncodableValue>(
+        method_call.arguments() ? *method_call.arguments() : flutter::EncodableValue());
+    commands_.Submit(
+        command_name, timeout_ms,
+        [this, method, arguments, shared_result, trace_name](CommandContext &context)
+        {
+          TraceRecorder::Global().SetThreadName("command");
+          // Calls made during cold start queue up behind background init
+          ready_.wait();
+          const CancelReason reason = context.reason();
+          if (reason != CancelReason::kNone)
+          {
+            shared_result->Error(CancelErrorCode(reason), CancelReasonName(reason));
+            return;
+          }
+          TraceSpan span("command", trace_name);
+          RunLifecycleCall(method, *arguments, *shared_result, context);
+        },
+        [shared_result](CancelReason reason)
+        { shared_result->Error(CancelErrorCode(reason), CancelReasonName(reason)); });
+  }
+
+  void OpenVpnDartPlugin::RunLifecycleCall(const std::string &method,
+                                           const flutter::EncodableValue &call_arguments,
+                                           flutter::MethodResult<flutter::EncodableValue> &result,
+                                           const CommandContext &context)
+  {
+    if (method == "ensureTapDriver")
+    {
+      try
+      {
+        EnsureTAPDriver(context);
+        result.Success(flutter::EncodableValue(true));
+      }
+      catch (const CommandCancelled &e)
+      {
+        result.Error(CancelErrorCode(e.reason()), e.what());
+      }
+      catch (const std::exception &e)
+      {
+        result.Error("TAP_DRIVER_ERROR", e.what());
+      }
+    }
+    else if (method == "checkTunnelConfiguration")
+    {
+      // A registry scan, and possibly an "openvpn --version" probe for DCO
+      bool configured = std::filesystem::exists(openvpn_executable_path_) &&
+                        IsTAPDriverInstalled();
+      result.Success(flutter::EncodableValue(configured));
+    }
+    else if (method == "initialize")
+    {
+      LogDebug("=== OpenVPN Initialization Starting ===");
+
+      // Log Windows version
+      if (IsWindows11OrGreater())
+      {
+        LogInfo("Detected: Windows 11 or greater");
+        std::string secWarnings = CheckSecurityFeatures();
+        if (!secWarnings.empty())
+        {
+          LogWarning("Security warnings: {}", secWarnings);
+        }
+      }
+      else
+      {
+        LogInfo("Detected: Windows 10 or earlier");
+      }
+
+      // Log OpenVPN build and DCO support
+      if (std::filesystem::exists(openvpn_executable_path_))
+      {
+        OpenVPNCapabilities caps = capability_cache_->Get();
+        LogInfo("OpenVPN version: {}", caps.probed ? caps.version : std::string("unknown"));
+        if (SupportsDCO())
+        {
+          LogInfo("DCO (Data Channel Offload) is available");
+        }
+        else
+        {
+          LogInfo("DCO not available, will use TAP driver");
         }
       }
 
@@ -746,8 +1502,8 @@ namespace openvpn_dart
           user_message += "2. Install TAP-Windows manually from: https://openvpn.net/community-downloads/";
         }
 
-        OutputDebugStringA(("Initialization warning: " + user_message).c_str());
-        result->Error("TAP_DRIVER_REQUIRED", user_message);
+        LogWarning("Initialization warning: {}", user_message);
+        result.Error("TAP_DRIVER_REQUIRED", user_message);
         return;
       }
 
@@ -756,46 +1512,110 @@ namespace openvpn_dart
       {
         if (!ExtractBundledOpenVPN())
         {
-          result->Error("OPENVPN_NOT_FOUND",
-                        "Failed to extract bundled OpenVPN from: " + GetBundledOpenVPNPath());
+          result.Error("OPENVPN_NOT_FOUND",
+                       "Failed to extract bundled OpenVPN from: " + GetBundledOpenVPNPath());
           return;
         }
       }
 
-      result->Success(flutter::EncodableValue(true));
+      result.Success(flutter::EncodableValue(true));
     }
     else if (method == "connect")
     {
-      const auto *arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+      const auto *arguments = std::get_if<flutter::EncodableMap>(&call_arguments);
       if (!arguments)
       {
-        result->Error("INVALID_ARGUMENT", "Arguments must be a map");
+        result.Error("INVALID_ARGUMENT", "Arguments must be a map");
         return;
       }
 
       auto config_it = arguments->find(flutter::EncodableValue("config"));
       if (config_it == arguments->end())
       {
-        result->Error("INVALID_ARGUMENT", "Missing 'config' parameter");
+        result.Error("INVALID_ARGUMENT", "Missing 'config' parameter");
         return;
       }
 
+      std::string session_id;
+      SessionIdArgument(&call_arguments, &session_id);
+
       try
       {
         const std::string config = std::get<std::string>(config_it->second);
-        OutputDebugStringA(("Config length: " + std::to_string(config.length())).c_str());
+        LogDebug("Config length: {}", config.length());
+
+        if (!session_id.empty())
+        {
+          int stats_interval = 1;
+          auto interval_it = arguments->find(flutter::EncodableValue("statsInterval"));
+          if (interval_it != arguments->end())
+          {
+            if (const auto *seconds = std::get_if<int32_t>(&interval_it->second))
+            {
+              stats_interval = std::max(0, *seconds);
+            }
+          }
+          try
+          {
+            StartSession(session_id, config, stats_interval, context);
+          }
+          catch (const std::invalid_argument &e)
+          {
+            // Bad ID, ID in use or too many sessions
+            result.Error("INVALID_ARGUMENT", e.what());
+            return;
+          }
+          result.Success(flutter::EncodableValue(true));
+          return;
+        }
+
+        // Seconds between traffic samples on the event channel; 0 disables them
+        auto interval_it = arguments->find(flutter::EncodableValue("statsInterval"));
+        if (interval_it != arguments->end())
+        {
+          if (const auto *seconds = std::get_if<int32_t>(&interval_it->second))
+          {
+            stats_interval_seconds_ = std::max(0, *seconds);
+          }
+        }
+
+        // Copy OpenVPN's output to openvpn.log; status never depends on it
+        auto log_it = arguments->find(flutter::EncodableValue("logToFile"));
+        if (log_it != arguments->end())
+        {
+          if (const auto *enabled = std::get_if<bool>(&log_it->second))
+          {
+            log_to_file_ = *enabled;
+          }
+        }
+
+        // Install the tunnel's routes from the plugin rather than route.exe
+        bool native_routes = false;
+        auto routes_it = arguments->find(flutter::EncodableValue("nativeRoutes"));
+        if (routes_it != arguments->end())
+        {
+          if (const auto *enabled = std::get_if<bool>(&routes_it->second))
+          {
+            native_routes = *enabled;
+          }
+        }
+        native_routes_requested_ = native_routes;
 
-        StartVPN(config);
-        result->Success(flutter::EncodableValue(true));
+        StartVPN(config, context);
+        result.Success(flutter::EncodableValue(true));
       }
       catch (const std::bad_variant_access &)
       {
-        result->Error("INVALID_ARGUMENT", "Config parameter must be a string");
+        result.Error("INVALID_ARGUMENT", "Config parameter must be a string");
+      }
+      catch (const CommandCancelled &e)
+      {
+        result.Error(CancelErrorCode(e.reason()), e.what());
       }
       catch (const std::exception &e)
       {
         std::string error_msg = e.what();
-        OutputDebugStringA(("StartVPN exception: " + error_msg).c_str());
+        LogError("StartVPN exception: {}", error_msg);
 
         // Try to extract just the exit code if it's there
         std::string simple_msg = "OpenVPN failed to start";
@@ -809,45 +1629,128 @@ namespace openvpn_dart
           }
         }
 
-        result->Error("CONNECTION_FAILED", simple_msg);
+        result.Error("CONNECTION_FAILED", simple_msg);
       }
       catch (...)
       {
-        result->Error("CONNECTION_FAILED", "Unknown error starting VPN");
+        result.Error("CONNECTION_FAILED", "Unknown error starting VPN");
       }
     }
-    else if (method == "disconnect")
+    else if (method == "prewarm")
     {
+      const auto *arguments = std::get_if<flutter::EncodableMap>(&call_arguments);
+      const flutter::EncodableValue *config_value = nullptr;
+      if (arguments)
+      {
+        auto config_it = arguments->find(flutter::EncodableValue("config"));
+        if (config_it != arguments->end())
+        {
+          config_value = &config_it->second;
+        }
+      }
+      const auto *config = config_value ? std::get_if<std::string>(config_value) : nullptr;
+      if (!config)
+      {
+        result.Error("INVALID_ARGUMENT", "Missing 'config' parameter");
+        return;
+      }
+
       try
       {
-        StopVPN();
-        result->Success(flutter::EncodableValue(true));
+        Prewarm(*config);
+        result.Success(flutter::EncodableValue(true));
       }
       catch (const std::exception &e)
       {
-        result->Error("DISCONNECTION_FAILED", e.what());
+        result.Error("PREWARM_FAILED", e.what());
       }
     }
-    else if (method == "status")
+    else if (method == "switchServer")
     {
-      std::string status = GetCurrentStatus();
-      result->Success(flutter::EncodableValue(status));
+      const auto *arguments = std::get_if<flutter::EncodableMap>(&call_arguments);
+      const std::string *config = nullptr;
+      if (arguments)
+      {
+        auto config_it = arguments->find(flutter::EncodableValue("config"));
+        if (config_it != arguments->end())
+        {
+          config = std::get_if<std::string>(&config_it->second);
+        }
+        auto interval_it = arguments->find(flutter::EncodableValue("statsInterval"));
+        if (interval_it != arguments->end())
+        {
+          if (const auto *seconds = std::get_if<int32_t>(&interval_it->second))
+          {
+            stats_interval_seconds_ = std::max(0, *seconds);
+          }
+        }
+      }
+      if (!config)
+      {
+        result.Error("INVALID_ARGUMENT", "Missing 'config' parameter");
+        return;
+      }
+
+      try
+      {
+        const SwitchReport report = SwitchServer(*config, context);
+        const flutter::EncodableMap event{
+            {flutter::EncodableValue("type"), flutter::EncodableValue("serverSwitch")},
+            {flutter::EncodableValue("makeBeforeBreak"), flutter::EncodableValue(report.make_before_break)},
+            {flutter::EncodableValue("inPlace"), flutter::EncodableValue(report.in_place)},
+            {flutter::EncodableValue("connectMs"), flutter::EncodableValue(report.connect_ms)},
+            {flutter::EncodableValue("overlapMs"), flutter::EncodableValue(report.overlap_ms)},
+            {flutter::EncodableValue("gapMs"), flutter::EncodableValue(report.gap_ms)},
+            {flutter::EncodableValue("teardownMs"), flutter::EncodableValue(report.teardown_ms)},
+        };
+        PublishEvent(event);
+        result.Success(flutter::EncodableValue(event));
+      }
+      catch (const CommandCancelled &e)
+      {
+        result.Error(CancelErrorCode(e.reason()), e.what());
+      }
+      catch (const std::invalid_argument &e)
+      {
+        result.Error("INVALID_ARGUMENT", e.what());
+      }
+      catch (const std::exception &e)
+      {
+        LogError("switchServer failed: {}", e.what());
+        result.Error("SWITCH_FAILED", e.what());
+      }
     }
-    else if (method == "request_permission")
+    else if (method == "cancelPrewarm")
     {
-      result->Success(flutter::EncodableValue(true));
+      CancelPrewarm();
+      result.Success(flutter::EncodableValue(true));
     }
-    else if (method == "checkTunnelConfiguration")
+    else if (method == "disconnect")
     {
-      // On Windows, check if OpenVPN executable and TAP driver are available
-      bool configured = std::filesystem::exists(openvpn_executable_path_) &&
-                        IsTAPDriverInstalled();
-      result->Success(flutter::EncodableValue(configured));
+      std::string session_id;
+      SessionIdArgument(&call_arguments, &session_id);
+      if (!session_id.empty())
+      {
+        // Stopping a session that is not running is not an error
+        StopSession(session_id);
+        result.Success(flutter::EncodableValue(true));
+        return;
+      }
+
+      try
+      {
+        StopVPN();
+        result.Success(flutter::EncodableValue(true));
+      }
+      catch (const std::exception &e)
+      {
+        result.Error("DISCONNECTION_FAILED", e.what());
+      }
     }
     else if (method == "removeTunnelConfiguration")
     {
       StopVPN();
-      result->Success(flutter::EncodableValue(true));
+      result.Success(flutter::EncodableValue(true));
     }
     else if (method == "setupTunnel")
     {
@@ -859,22 +1762,33 @@ namespace openvpn_dart
         setup_success = ExtractBundledOpenVPN();
       }
 
-      if (setup_success && !IsTAPDriverInstalled())
+      try
+      {
+        if (setup_success && !IsTAPDriverInstalled())
+        {
+          setup_success = InstallTAPDriver(context);
+        }
+      }
+      catch (const CommandCancelled &e)
       {
-        setup_success = InstallTAPDriver();
+        result.Error(CancelErrorCode(e.reason()), e.what());
+        return;
       }
 
-      result->Success(flutter::EncodableValue(setup_success));
+      result.Success(flutter::EncodableValue(setup_success));
     }
     else
     {
-      result->NotImplemented();
+      result.NotImplemented();
     }
   }
 
-  void OpenVpnDartPlugin::StartVPN(const std::string &config)
+  void OpenVpnDartPlugin::StartVPN(const std::string &config, const CommandContext &context)
   {
-    OutputDebugStringA(("StartVPN called with config length: " + std::to_string(config.length())).c_str());
+    TraceSpan span("connect", "StartVPN");
+    LogDebug("StartVPN called with config length: {}", config.length());
+    const int64_t connect_requested_ms = SteadyNowMs();
+    const int64_t connect_requested_unix_ms = UnixNowMs();
 
     // Validate input
     if (config.empty())
@@ -893,82 +1807,296 @@ namespace openvpn_dart
       throw std::runtime_error("OpenVPN executable not found at: " + openvpn_executable_path_);
     }
 
+    context.ThrowIfCancelled();
+
+    // Let an in-flight disconnect finish before its handles are reused
+    if (teardown_thread_.joinable())
+    {
+      teardown_thread_.join();
+    }
+
     // Ensure previous connection is fully stopped
     if (is_connected_ || is_monitoring_)
     {
-      OutputDebugStringA("Stopping previous VPN connection before starting new one");
+      LogInfo("Stopping previous VPN connection before starting new one");
 
       try
       {
         is_monitoring_ = false;
         is_connected_ = false;
+        reactor_.Wake();
 
         // Wait for monitoring thread to exit
         if (monitor_thread_.joinable())
         {
-          OutputDebugStringA("Waiting for monitor thread to join...");
+          LogDebug("Waiting for monitor thread to join...");
           monitor_thread_.join();
-          OutputDebugStringA("Monitor thread joined");
+          LogDebug("Monitor thread joined");
         }
 
         // Now call StopVPN to clean up process
-        StopVPN();
+        StopVPN(true);
       }
       catch (const std::exception &e)
       {
-        OutputDebugStringA(("Error stopping previous connection: " + std::string(e.what())).c_str());
+        LogWarning("Error stopping previous connection: {}", e.what());
         // Continue anyway - try to start new connection
       }
     }
 
-    // Create directories with error handling
-    std::filesystem::path temp_dir = std::filesystem::path(bundled_path_) / "config";
+    context.ThrowIfCancelled();
 
-    try
+    // A new process starts on its profile's own remotes
+    ClearRemoteOverride();
+    running_config_.clear();
     {
-      std::filesystem::create_directories(temp_dir);
+      // A cold start decides again in LaunchOpenVPN; a standby routes itself
+      std::lock_guard<std::mutex> lock(native_routes_mutex_);
+      native_routes_active_ = false;
     }
-    catch (const std::filesystem::filesystem_error &e)
+
+    // Hand the connect to a warm standby parked for this profile, or start cold
+    const bool prewarmed = AdoptStandby(ConfigFingerprint(config));
+    connect_timings_.Begin(connect_requested_ms, connect_requested_unix_ms, prewarmed);
+    // PickFreePort() only reserves the management port until OpenVPN binds
+    // it; a cold start that lost it to another process is launched again.
+    // So is one whose management client never attached, without the remote
+    // query it would wait on forever.
+    bool query_remote = true;
+    auto release_process = [this]()
     {
-      throw std::runtime_error("Failed to create config directory: " + std::string(e.what()));
-    }
+      is_connected_ = false;
+      CloseHandle(process_info_.hProcess);
+      CloseHandle(process_info_.hThread);
+      // A later teardown must not close them again
+      process_info_ = {};
+      CloseHandle(pipe_read_);
+      if (pipe_write_ != nullptr)
+      {
+        CloseHandle(pipe_write_);
+      }
+      pipe_read_ = nullptr;
+      pipe_write_ = nullptr;
+      process_handle_ = nullptr;
+    };
+    for (int attempt = 1;; attempt++)
+    {
+      const int64_t launched_ms = SteadyNowMs();
+      if (!prewarmed)
+      {
+        LaunchOpenVPN(config, false, query_remote, &process_info_, &pipe_read_, &pipe_write_,
+                      &management_port_, &management_password_);
+      }
 
-    config_file_path_ = (temp_dir / "client.ovpn").string();
-    log_file_path_ = (temp_dir / "openvpn.log").string();
+      process_handle_ = process_info_.hProcess;
+      is_connected_ = true;
+      StartOutputCapture();
 
-    // Write config to file with error handling
-    try
-    {
-      std::ofstream config_file(config_file_path_, std::ios::out | std::ios::trunc);
-      if (!config_file.is_open())
       {
-        throw std::runtime_error("Failed to open config file for writing: " + config_file_path_);
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        traffic_stats_.Start(SteadyNowMs());
       }
+      connect_timer_.Start(connect_requested_ms, prewarmed);
 
-      config_file << config;
-      if (!config_file)
+      // An adopted standby was checked to be alive and parked. A cold start
+      // attaches the management client before the early-exit check so the
+      // first states are not missed while we sleep.
+      if (!prewarmed)
       {
-        throw std::runtime_error("Failed to write config data to file");
+        StartManagementClient();
       }
 
-      config_file.close();
-      OutputDebugStringA(("Config file written successfully: " + config_file_path_).c_str());
+      // Check if process is still running and look for early errors
+      DWORD exit_code;
+      if (!prewarmed && !context.SleepFor(500)) // Give it a moment to start and write logs
+      {
+        // Cancelled or out of time while starting; take the half-started
+        // process down before reporting why
+        LogInfo("StartVPN cancelled while starting");
+        connect_timings_.Finish(ConnectOutcome::kCancelled, SteadyNowMs());
+        StopVPN(true);
+        context.ThrowIfCancelled();
+      }
+
+      bool process_exited = false;
+      if (!prewarmed && GetExitCodeProcess(process_handle_, &exit_code) && exit_code != STILL_ACTIVE)
+      {
+        process_exited = true;
+        std::string exit_msg = "OpenVPN process exited with code " + std::to_string(exit_code);
+        LogWarning("{}", exit_msg);
+
+        // The child is gone, so its output ends shortly; take the error from
+        // the captured lines instead of the log file
+        output_drain_.WaitFor(kOutputDrainTimeoutMs);
+        std::string error_detail;
+        bool port_taken = false;
+        output_drain_.VisitRecentLines(
+            kOutputRingLines,
+            [&error_detail, &port_taken](std::string_view line)
+            {
+              port_taken = port_taken || line.find(kManagementBindFailed) != std::string_view::npos;
+              if (ParseLogRecord(line).severity >= LogSeverity::kError)
+              {
+                error_detail.clear();
+                AppendSanitized(line, &error_detail);
+              }
+            });
+        if (!error_detail.empty())
+        {
+          exit_msg += ": " + error_detail;
+        }
+
+        LogError("Full error: {}", exit_msg);
+
+        // Process already exited - this is an error
+        StopManagementClient();
+        StopOutputCapture();
+        release_process();
+        if (port_taken && attempt < kManagementBindAttempts)
+        {
+          LogWarning("Management port {} was taken before OpenVPN bound it; retrying", management_port_);
+          continue;
+        }
+        connect_timings_.Finish(ConnectOutcome::kFailed, SteadyNowMs());
+        PublishStatus("disconnected"); // Undo any "connecting" the client reported
+        throw std::runtime_error(exit_msg);
+      }
+
+      const std::shared_ptr<ManagementClient> management = Management();
+      if (!prewarmed && query_remote && management)
+      {
+        while (!management->connected() && SteadyNowMs() - launched_ms < kManagementAttachTimeoutMs)
+        {
+          if (!context.SleepFor(kCancelPollMs))
+          {
+            LogInfo("StartVPN cancelled while starting");
+            connect_timings_.Finish(ConnectOutcome::kCancelled, SteadyNowMs());
+            StopVPN(true);
+            context.ThrowIfCancelled();
+          }
+        }
+        if (!management->connected())
+        {
+          // Still before its first remote, so nothing to unwind
+          LogWarning("Management interface did not attach; restarting OpenVPN without the remote query");
+          StopManagementClient();
+          TerminateProcess(process_info_.hProcess, 1);
+          WaitForSingleObject(process_info_.hProcess, kForcedStopTimeoutMs);
+          StopOutputCapture();
+          release_process();
+          query_remote = false;
+          continue;
+        }
+      }
+      break;
     }
-    catch (const std::exception &e)
+
+    if (!prewarmed)
     {
-      throw std::runtime_error("Error writing config file: " + std::string(e.what()));
+      connect_timings_.Mark(ConnectMilestone::kStartupChecked, SteadyNowMs());
     }
 
-    // Clean up any existing pipes
-    if (pipe_read_ != nullptr && pipe_read_ != INVALID_HANDLE_VALUE)
+    // Lets a later plugin instance take over this process without the log
+    BeginJournal(ConfigFingerprint(config));
+    if (query_remote)
     {
-      CloseHandle(pipe_read_);
-      pipe_read_ = nullptr;
+      running_config_ = config;
     }
-    if (pipe_write_ != nullptr && pipe_write_ != INVALID_HANDLE_VALUE)
+
+    // Update status and send to Flutter immediately
     {
-      CloseHandle(pipe_write_);
-      pipe_write_ = nullptr;
+      std::lock_guard<std::mutex> lock(status_mutex_);
+      current_status_ = "connecting";
+    }
+
+    // Send initial connecting status to Flutter
+    QueueEvent(flutter::EncodableValue("connecting"));
+
+    // Start monitoring thread
+    StartMonitor();
+
+    if (prewarmed)
+    {
+      // The adopted client now drives plugin state; releasing the hold lets
+      // OpenVPN go straight to the network
+      *standby_active_ = true;
+      const std::shared_ptr<ManagementClient> management = Management();
+      AttachManagement(*management);
+      management->SendCommand("hold release");
+      connect_timings_.Mark(ConnectMilestone::kStandbyReleased, SteadyNowMs());
+    }
+  }
+
+  void OpenVpnDartPlugin::LaunchOpenVPN(const std::string &config, bool hold, bool query_remote,
+                                        PROCESS_INFORMATION *info, HANDLE *pipe_read,
+                                        HANDLE *pipe_write, uint16_t *management_port,
+                                        std::string *management_password)
+  {
+    TraceSpan span("process", hold ? "LaunchOpenVPN (standby)" : "LaunchOpenVPN");
+    // Create directories with error handling
+    std::filesystem::path temp_dir = std::filesystem::path(bundled_path_) / "config";
+
+    try
+    {
+      std::filesystem::create_directories(temp_dir);
+    }
+    catch (const std::filesystem::filesystem_error &e)
+    {
+      throw std::runtime_error("Failed to create config directory: " + std::string(e.what()));
+    }
+
+    config_file_path_ = (temp_dir / "client.ovpn").string();
+    log_file_path_ = (temp_dir / "openvpn.log").string();
+
+    // Real-time state over the management interface; the log remains the
+    // fallback if the port cannot be reserved or the client never attaches
+    // (StartVPN then relaunches without |query_remote|)
+    *management_port = loopback::PickFreePort();
+
+    // Write config to file with error handling
+    try
+    {
+      std::ofstream config_file(config_file_path_, std::ios::out | std::ios::trunc);
+      if (!config_file.is_open())
+      {
+        throw std::runtime_error("Failed to open config file for writing: " + config_file_path_);
+      }
+
+      std::string profile = AggregateProfileRoutes(config, "");
+      if (!hold)
+      {
+        // Only a process StartVPN waits on the management client for; one
+        // that may run without it keeps OpenVPN's own routing
+        profile = TakeNativeRoutes(profile, *management_port != 0 && query_remote);
+      }
+      config_file << profile;
+      if (!config_file)
+      {
+        throw std::runtime_error("Failed to write config data to file");
+      }
+
+      config_file.close();
+      LogDebug("Config file written successfully: {}", config_file_path_);
+      if (!hold)
+      {
+        connect_timings_.Mark(ConnectMilestone::kConfigWritten, SteadyNowMs());
+      }
+    }
+    catch (const std::exception &e)
+    {
+      throw std::runtime_error("Error writing config file: " + std::string(e.what()));
+    }
+
+    // Clean up any existing pipes
+    if (*pipe_read != nullptr && *pipe_read != INVALID_HANDLE_VALUE)
+    {
+      CloseHandle(*pipe_read);
+      *pipe_read = nullptr;
+    }
+    if (*pipe_write != nullptr && *pipe_write != INVALID_HANDLE_VALUE)
+    {
+      CloseHandle(*pipe_write);
+      *pipe_write = nullptr;
     }
 
     // Create pipe for reading OpenVPN output
@@ -977,68 +2105,73 @@ namespace openvpn_dart
     sa.bInheritHandle = TRUE;
     sa.lpSecurityDescriptor = nullptr;
 
-    if (!CreatePipe(&pipe_read_, &pipe_write_, &sa, 0))
+    if (!CreatePipe(pipe_read, pipe_write, &sa, 0))
     {
       DWORD error = GetLastError();
       throw std::runtime_error("Failed to create pipe. Error: " + std::to_string(error));
     }
 
-    if (!SetHandleInformation(pipe_read_, HANDLE_FLAG_INHERIT, 0))
+    if (!SetHandleInformation(*pipe_read, HANDLE_FLAG_INHERIT, 0))
     {
       DWORD error = GetLastError();
-      CloseHandle(pipe_read_);
-      CloseHandle(pipe_write_);
-      pipe_read_ = nullptr;
-      pipe_write_ = nullptr;
+      CloseHandle(*pipe_read);
+      CloseHandle(*pipe_write);
+      *pipe_read = nullptr;
+      *pipe_write = nullptr;
       throw std::runtime_error("Failed to set pipe handle information. Error: " + std::to_string(error));
     }
 
     // Prepare command line with detailed logging
     std::string command_line = "\"" + openvpn_executable_path_ + "\"";
     command_line += " --config \"" + config_file_path_ + "\"";
-    command_line += " --log \"" + log_file_path_ + "\"";
-    command_line += " --verb 3";
-    command_line += " --route-method exe"; // Use external routing method for Windows
-    command_line += " --route-delay 2";    // Give Windows time to set up routes
-
-    // Driver selection based on OS and DCO availability
-    // Windows 11 has security features that can block TAP-Windows6
-    // DCO (ovpn-dco) is kernel-integrated and compatible with Windows 11 security
-    bool isWin11 = IsWindows11OrGreater();
-    bool dcoSupported = SupportsDCO();
+    command_line += " --verb 3"; // Output goes to stdout, drained by StartOutputCapture
 
-    if (isWin11 && dcoSupported)
-    {
-      command_line += " --windows-driver ovpn-dco";
-      OutputDebugStringA("Windows 11 with DCO: Using ovpn-dco driver");
-    }
-    else if (isWin11 && !dcoSupported)
+    management_password->clear();
+    if (*management_port != 0)
     {
-      // Windows 11 without DCO - this may fail due to security features
-      command_line += " --windows-driver tap-windows6";
-      OutputDebugStringA("WARNING: Windows 11 without DCO support. TAP driver may be blocked by security features (HVCI/Memory Integrity).");
-      OutputDebugStringA("Consider: 1) Upgrading to OpenVPN 2.6.9+ with DCO, or 2) Disabling Memory Integrity in Windows Security");
+      // A parked standby and the default tunnel may run side by side
+      const std::string password_path =
+          (temp_dir / (hold ? "standby-management.pw" : "management.pw")).string();
+      *management_password = WriteManagementPassword(password_path);
+      command_line += " --management 127.0.0.1 " + std::to_string(*management_port) +
+                      " \"" + password_path + "\"";
+      // Lets switchServer point a running process at another server, but
+      // holds OpenVPN at each remote until the client answers
+      if (query_remote)
+      {
+        command_line += " --management-query-remote";
+      }
+      if (hold)
+      {
+        // Stop after startup (config parsed, crypto libraries loaded) until
+        // the management client sends "hold release"
+        command_line += " --management-hold";
+      }
     }
-    else
+    else if (hold)
     {
-      command_line += " --windows-driver tap-windows6";
-      OutputDebugStringA("Windows 10: Using TAP-Windows6 driver");
+      throw std::runtime_error("No free management port for a held OpenVPN process");
     }
+    command_line += " --route-method exe"; // Use external routing method for Windows
+    command_line += " --route-delay 2";    // Give Windows time to set up routes
+
+    command_line += WindowsDriverOption();
 
-    OutputDebugStringA(("Starting OpenVPN with command: " + command_line).c_str());
-    OutputDebugStringA(("Log file path: " + log_file_path_).c_str());
+    LogDebug("Starting OpenVPN with command: {}", command_line);
+    LogDebug("Log file path: {}", log_file_path_);
 
     // Setup process creation
     STARTUPINFOA si = {0};
     si.cb = sizeof(si);
     si.dwFlags = STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
-    si.hStdOutput = pipe_write_;
-    si.hStdError = pipe_write_;
+    si.hStdOutput = *pipe_write;
+    si.hStdError = *pipe_write;
     si.wShowWindow = SW_HIDE;
 
-    ZeroMemory(&process_info_, sizeof(process_info_));
+    ZeroMemory(info, sizeof(*info));
 
     // Create the OpenVPN process
+    TraceSpan spawn_span("process", "CreateProcess");
     BOOL success = CreateProcessA(
         nullptr,
         const_cast<char *>(command_line.c_str()),
@@ -1049,7 +2182,7 @@ namespace openvpn_dart
         nullptr,
         nullptr,
         &si,
-        &process_info_);
+        info);
 
     if (!success)
     {
@@ -1086,151 +2219,1534 @@ namespace openvpn_dart
         break;
       }
 
-      OutputDebugStringA(error_msg.c_str());
-      CloseHandle(pipe_read_);
-      CloseHandle(pipe_write_);
-      pipe_read_ = nullptr;
-      pipe_write_ = nullptr;
-      throw std::runtime_error(error_msg);
+      LogError("{}", error_msg);
+      CloseHandle(*pipe_read);
+      CloseHandle(*pipe_write);
+      *pipe_read = nullptr;
+      *pipe_write = nullptr;
+      throw std::runtime_error(error_msg);
+    }
+
+    // Only the child holds the write end now, so its exit ends the drain
+    CloseHandle(*pipe_write);
+    *pipe_write = nullptr;
+    if (!hold)
+    {
+      connect_timings_.Mark(ConnectMilestone::kProcessStarted, SteadyNowMs());
+    }
+
+    LogInfo(hold ? "OpenVPN process created in management hold"
+                 : "OpenVPN process created successfully");
+  }
+
+  void OpenVpnDartPlugin::Prewarm(const std::string &config)
+  {
+    if (config.empty())
+    {
+      throw std::invalid_argument("OpenVPN configuration cannot be empty");
+    }
+    if (config.length() > 1024 * 1024) // 1MB limit
+    {
+      throw std::invalid_argument("OpenVPN configuration too large (> 1MB)");
+    }
+
+    // Standby state is only touched on this thread and the teardown thread
+    if (teardown_thread_.joinable())
+    {
+      teardown_thread_.join();
+    }
+
+    standby_config_ = config;
+    if (is_connected_)
+    {
+      // The standby shares the config and log files with the live tunnel;
+      // the teardown parks a new one once this connection is gone
+      LogInfo("Warm standby deferred until disconnect");
+      return;
+    }
+    SpawnStandby();
+  }
+
+  void OpenVpnDartPlugin::CancelPrewarm()
+  {
+    if (teardown_thread_.joinable())
+    {
+      teardown_thread_.join();
+    }
+    standby_config_.clear();
+    RecycleStandby();
+  }
+
+  void OpenVpnDartPlugin::SpawnStandby()
+  {
+    RecycleStandby();
+    if (standby_config_.empty() || shutting_down_)
+    {
+      return;
+    }
+
+    LaunchOpenVPN(standby_config_, true, true, &standby_info_, &standby_pipe_read_,
+                  &standby_pipe_write_, &standby_port_, &standby_password_);
+    standby_spawned_ms_ = SteadyNowMs();
+    standby_active_ = std::make_shared<std::atomic<bool>>(false);
+    standby_management_ = CreateManagementClient(standby_active_, &standby_held_, standby_password_);
+    standby_management_->Start(standby_port_, kManagementAttachTimeoutMs);
+    LogInfo("Warm standby parked, PID {}", standby_info_.dwProcessId);
+  }
+
+  bool OpenVpnDartPlugin::AdoptStandby(uint64_t fingerprint)
+  {
+    StandbyState standby;
+    standby.present = standby_info_.hProcess != nullptr;
+    if (standby.present)
+    {
+      standby.alive = WaitForSingleObject(standby_info_.hProcess, 0) == WAIT_TIMEOUT;
+      standby.held = standby_held_ && standby_management_ && standby_management_->connected();
+      standby.fingerprint = ConfigFingerprint(standby_config_);
+      standby.spawned_ms = standby_spawned_ms_;
+    }
+
+    const StandbyVerdict verdict =
+        EvaluateStandby(standby, fingerprint, SteadyNowMs(), kStandbyMaxAgeMs);
+    if (verdict == StandbyVerdict::kNone)
+    {
+      return false;
+    }
+    LogInfo("Warm standby verdict: {}", StandbyVerdictName(verdict));
+    if (verdict != StandbyVerdict::kAdopt)
+    {
+      RecycleStandby();
+      return false;
+    }
+
+    // Move the parked process into the active slots; StartVPN releases it
+    StopManagementClient();
+    if (pipe_read_ != nullptr && pipe_read_ != INVALID_HANDLE_VALUE)
+    {
+      CloseHandle(pipe_read_);
+    }
+    if (pipe_write_ != nullptr && pipe_write_ != INVALID_HANDLE_VALUE)
+    {
+      CloseHandle(pipe_write_);
+    }
+    process_info_ = standby_info_;
+    pipe_read_ = standby_pipe_read_;
+    pipe_write_ = standby_pipe_write_;
+    management_port_ = standby_port_;
+    management_password_ = std::move(standby_password_);
+    {
+      std::lock_guard<std::mutex> lock(management_mutex_);
+      management_ = std::move(standby_management_);
+    }
+
+    ZeroMemory(&standby_info_, sizeof(standby_info_));
+    standby_pipe_read_ = nullptr;
+    standby_pipe_write_ = nullptr;
+    standby_port_ = 0;
+    standby_password_.clear();
+    standby_held_ = false;
+    return true;
+  }
+
+  void OpenVpnDartPlugin::RecycleStandby()
+  {
+    if (standby_management_)
+    {
+      standby_management_->Stop();
+      standby_management_.reset();
+    }
+    if (standby_info_.hProcess != nullptr)
+    {
+      // Parked before touching the network, so there is nothing to unwind;
+      // wait so the config and log files are free for the next process
+      TerminateProcess(standby_info_.hProcess, 0);
+      WaitForSingleObject(standby_info_.hProcess, kForcedStopTimeoutMs);
+      CloseHandle(standby_info_.hProcess);
+      if (standby_info_.hThread != nullptr)
+      {
+        CloseHandle(standby_info_.hThread);
+      }
+      ZeroMemory(&standby_info_, sizeof(standby_info_));
+    }
+    if (standby_pipe_read_ != nullptr)
+    {
+      CloseHandle(standby_pipe_read_);
+      standby_pipe_read_ = nullptr;
+    }
+    if (standby_pipe_write_ != nullptr)
+    {
+      CloseHandle(standby_pipe_write_);
+      standby_pipe_write_ = nullptr;
+    }
+    standby_port_ = 0;
+    standby_password_.clear();
+    standby_held_ = false;
+  }
+
+  std::unique_ptr<ManagementClient> OpenVpnDartPlugin::CreateManagementClient(
+      std::shared_ptr<std::atomic<bool>> active, std::atomic<bool> *held,
+      const std::string &password)
+  {
+    // Handlers reach their own client through |self|; the object stays put
+    // while its reader thread runs, whichever member ends up owning it
+    auto self = std::make_shared<ManagementClient *>(nullptr);
+
+    ManagementClient::Handlers handlers;
+    handlers.on_connected = [this, self, active]()
+    {
+      LogInfo("Management interface attached");
+      if (*active)
+      {
+        AttachManagement(**self);
+      }
+    };
+    handlers.on_state = [this, active](const StateNotification &state)
+    {
+      if (*active)
+      {
+        OnManagementState(state);
+      }
+    };
+    handlers.on_bytecount = [this, active](const ByteCountNotification &count)
+    {
+      if (*active)
+      {
+        OnByteCount(count);
+      }
+    };
+    handlers.on_log = [this, active](const LogNotification &log)
+    {
+      LogDebug("OpenVPN: {}", log.message);
+      if (*active)
+      {
+        OnNativeRoutesLog(log.message);
+      }
+    };
+    handlers.on_hold = [self, active, held](const std::string &message)
+    {
+      LogInfo("Management hold: {}", message);
+      if (*active)
+      {
+        (*self)->SendCommand("hold release");
+      }
+      else if (held)
+      {
+        *held = true; // Parked; the adopting connect releases it
+      }
+    };
+    handlers.on_remote = [this, self](const RemoteNotification &remote)
+    {
+      // Answered even while inactive: OpenVPN waits for the reply
+      OnRemoteQuery(**self, remote);
+    };
+    handlers.on_fatal = [](const std::string &message)
+    {
+      LogError("OpenVPN fatal: {}", message);
+    };
+    handlers.on_disconnected = [this, active]()
+    {
+      // Status detection falls back to the log
+      if (*active)
+      {
+        management_active_ = false;
+      }
+    };
+
+    auto client = std::make_unique<ManagementClient>(std::move(handlers), password);
+    *self = client.get();
+    return client;
+  }
+
+  void OpenVpnDartPlugin::AttachManagement(ManagementClient &client)
+  {
+    TraceSpan span("management", "AttachManagement");
+    management_active_ = true;
+    connect_timings_.Mark(ConnectMilestone::kManagementAttached, SteadyNowMs());
+    client.SendCommand("state on");
+    client.SendCommand("log on");
+    // Lines logged before we attached, such as the PUSH_REPLY native routes
+    // are read from. "log on all" would answer twice to one command.
+    client.SendCommand(
+        "log all",
+        [this](bool success, const std::string &reply)
+        {
+          LogNotification log;
+          for (size_t pos = 0; success && pos < reply.size();)
+          {
+            size_t end = reply.find('\n', pos);
+            end = end == std::string::npos ? reply.size() : end;
+            if (ParseLogLine(std::string_view(reply).substr(pos, end - pos), &log))
+            {
+              OnNativeRoutesLog(log.message);
+            }
+            pos = end + 1;
+          }
+        });
+    UpdateByteCountSubscription(listening_);
+    // Catch up on the state reached before real-time notifications were on
+    client.SendCommand(
+        "state",
+        [this](bool success, const std::string &reply)
+        {
+          StateNotification state;
+          if (success && ParseStateLine(reply, &state))
+          {
+            OnManagementState(state);
+          }
+        });
+  }
+
+  void OpenVpnDartPlugin::StartManagementClient()
+  {
+    StopManagementClient();
+    if (management_port_ == 0)
+    {
+      return;
+    }
+
+    std::shared_ptr<ManagementClient> management =
+        CreateManagementClient(std::make_shared<std::atomic<bool>>(true), nullptr, management_password_);
+    {
+      std::lock_guard<std::mutex> lock(management_mutex_);
+      management_ = management;
+    }
+    management->Start(management_port_, kManagementAttachTimeoutMs);
+  }
+
+  void OpenVpnDartPlugin::StopManagementClient()
+  {
+    std::shared_ptr<ManagementClient> management;
+    {
+      std::lock_guard<std::mutex> lock(management_mutex_);
+      management.swap(management_);
+    }
+    // Outside the lock: the reader's callbacks take it, and Stop() waits
+    // for them. Senders holding a snapshot find the client stopped.
+    if (management)
+    {
+      management->Stop();
+    }
+    management_active_ = false;
+  }
+
+  std::shared_ptr<ManagementClient> OpenVpnDartPlugin::Management()
+  {
+    std::lock_guard<std::mutex> lock(management_mutex_);
+    return management_;
+  }
+
+  bool OpenVpnDartPlugin::SendManagementCommand(const std::string &command)
+  {
+    const std::shared_ptr<ManagementClient> management = Management();
+    return management && management_active_ && management->SendCommand(command);
+  }
+
+  void OpenVpnDartPlugin::OnManagementState(const StateNotification &state)
+  {
+    LogDebug("Management state: {} {}", state.name, state.detail);
+    // "connected" waits for the routes the pull-filter kept from OpenVPN
+    bool routes_ready = true;
+    if (state.state == ManagementState::kConnected)
+    {
+      routes_ready = InstallNativeRoutes(state.local_ip);
+    }
+    else if (state.state == ManagementState::kReconnecting)
+    {
+      // The next connection brings its own push
+      RemoveNativeRoutes();
+    }
+
+    const char *status = routes_ready ? StatusForState(state) : "error";
+    if (status)
+    {
+      PublishStatus(status);
+    }
+    if (!routes_ready)
+    {
+      // Without its routes the tunnel's traffic would leave through the
+      // physical interface; take it down instead
+      LogError("Stopping OpenVPN: the tunnel has no routes");
+      SendManagementCommand("signal SIGTERM");
+    }
+
+    const int64_t now = SteadyNowMs();
+    if (state.state == ManagementState::kConnected)
+    {
+      connect_timings_.Finish(routes_ready ? ConnectOutcome::kConnected : ConnectOutcome::kFailed, now);
+    }
+    else
+    {
+      connect_timings_.Mark(MilestoneForState(state.state), now);
+    }
+
+    if (connect_timer_.OnState(state.state, now))
+    {
+      LogInfo("Connected in {}ms, first packet after {}ms ({})",
+              connect_timer_.connected_ms(), connect_timer_.first_packet_ms(),
+              connect_timer_.prewarmed() ? "prewarmed" : "cold start");
+      PublishEvent(flutter::EncodableMap{
+          {flutter::EncodableValue("type"), flutter::EncodableValue("connectTiming")},
+          {flutter::EncodableValue("prewarmed"), flutter::EncodableValue(connect_timer_.prewarmed())},
+          {flutter::EncodableValue("firstPacketMs"), flutter::EncodableValue(connect_timer_.first_packet_ms())},
+          {flutter::EncodableValue("connectedMs"), flutter::EncodableValue(connect_timer_.connected_ms())},
+      });
+    }
+  }
+
+  SwitchReport OpenVpnDartPlugin::SwitchServer(const std::string &config, const CommandContext &context)
+  {
+    TraceSpan span("connect", "SwitchServer");
+    const int64_t requested_ms = SteadyNowMs();
+
+    // Let an in-flight disconnect finish before deciding what is up
+    if (teardown_thread_.joinable())
+    {
+      teardown_thread_.join();
+    }
+
+    const bool make_before_break = is_connected_ && GetCurrentStatus() == "connected";
+
+    // Same profile apart from the server: reconnect the running process
+    ProfileRemote target;
+    if (make_before_break &&
+        CompareProfiles(running_config_, config, &target) == ProfileChange::kRemoteOnly)
+    {
+      SwitchTimeline timeline(requested_ms, false);
+      if (SwitchInPlace(config, target, &timeline, context))
+      {
+        SwitchReport report = timeline.Report();
+        report.in_place = true;
+        LogInfo("switchServer: reconnected in place after {}ms, gap {}ms",
+                report.connect_ms, report.gap_ms);
+        return report;
+      }
+      LogInfo("switchServer: management not attached, switching make-before-break");
+    }
+
+    SwitchTimeline timeline(requested_ms, make_before_break);
+
+    if (!make_before_break)
+    {
+      // Nothing working to keep: tear down whatever is there and connect,
+      // as connect would, but timed like a switch
+      LogInfo("switchServer: no connected tunnel, switching break-before-make");
+      if (is_connected_ || is_monitoring_)
+      {
+        timeline.TeardownStarted(SteadyNowMs());
+        StopVPN(true);
+        timeline.TeardownFinished(SteadyNowMs());
+      }
+      else
+      {
+        timeline.OldDown(requested_ms);
+      }
+      StartVPN(config, context);
+      while (!timeline.new_connected() && is_connected_ &&
+             SteadyNowMs() - requested_ms < kSwitchConnectTimeoutMs)
+      {
+        if (GetCurrentStatus() == "connected")
+        {
+          timeline.NewConnected(SteadyNowMs());
+        }
+        else if (!context.SleepFor(kSwitchPollMs))
+        {
+          context.ThrowIfCancelled();
+        }
+      }
+      return timeline.Report();
+    }
+
+    // Make: bring the new tunnel up next to the old one, on its own adapter
+    const std::string id = kSwitchSessionIds[switch_count_++ % 2];
+    std::shared_ptr<TunnelSession> next =
+        StartSession(id, config, stats_interval_seconds_, context, true);
+    LogInfo("switchServer: new tunnel starting as PID {}", next->pid());
+    while (next->status() != "connected")
+    {
+      uint32_t exit_code = 0;
+      if (next->exit_code(&exit_code))
+      {
+        throw std::runtime_error("New tunnel exited with code " + std::to_string(exit_code) +
+                                 " before connecting; still on the old server");
+      }
+      if (SteadyNowMs() - requested_ms >= kSwitchConnectTimeoutMs)
+      {
+        StopSession(next);
+        throw std::runtime_error("New tunnel did not connect in time; still on the old server");
+      }
+      if (GetCurrentStatus() != "connected")
+      {
+        timeline.OldDown(SteadyNowMs());
+      }
+      if (!context.SleepFor(kSwitchPollMs))
+      {
+        StopSession(next);
+        context.ThrowIfCancelled();
+      }
+    }
+    timeline.NewConnected(SteadyNowMs());
+
+    // Break: the old tunnel's teardown removes its routes, leaving the new
+    // tunnel's. The default status stays up throughout.
+    handover_ = true;
+    timeline.TeardownStarted(SteadyNowMs());
+    StopVPN(true);
+    timeline.TeardownFinished(SteadyNowMs());
+    handover_ = false;
+
+    if (!PromoteSession(next, config))
+    {
+      PublishStatus("disconnected");
+      throw std::runtime_error("New tunnel exited during the switch");
+    }
+
+    const SwitchReport report = timeline.Report();
+    LogInfo("switchServer: connected after {}ms, gap {}ms, overlap {}ms, teardown {}ms",
+            report.connect_ms, report.gap_ms, report.overlap_ms, report.teardown_ms);
+    return report;
+  }
+
+  bool OpenVpnDartPlugin::SwitchInPlace(const std::string &config, const ProfileRemote &target,
+                                        SwitchTimeline *timeline, const CommandContext &context)
+  {
+    TraceSpan span("connect", "SwitchInPlace");
+    {
+      std::lock_guard<std::mutex> lock(remote_mutex_);
+      remote_override_ = target;
+      remote_override_applied_ = false;
+    }
+    // SIGUSR1 reconnects without re-reading the profile; the next remote
+    // query gets the override
+    if (!SendManagementCommand("signal SIGUSR1"))
+    {
+      ClearRemoteOverride();
+      return false;
+    }
+    const int64_t signalled_ms = SteadyNowMs();
+    timeline->OldDown(signalled_ms);
+    LogInfo("switchServer: reconnecting in place to {}:{} ({})", target.host, target.port, target.proto);
+
+    while (true)
+    {
+      bool applied;
+      {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        applied = remote_override_applied_;
+      }
+      if (applied && GetCurrentStatus() == "connected")
+      {
+        break;
+      }
+      if (!is_connected_)
+      {
+        throw std::runtime_error("Tunnel exited during the switch");
+      }
+      if (SteadyNowMs() - signalled_ms >= kSwitchConnectTimeoutMs || !context.SleepFor(kSwitchPollMs))
+      {
+        // Back to the profile's own remotes rather than retrying the new one
+        ClearRemoteOverride();
+        SendManagementCommand("signal SIGUSR1");
+        context.ThrowIfCancelled();
+        throw std::runtime_error("Tunnel did not reconnect to the new server in time; returning to the old one");
+      }
+    }
+    timeline->NewConnected(SteadyNowMs());
+
+    running_config_ = config;
+    {
+      std::lock_guard<std::mutex> lock(journal_mutex_);
+      if (journal_active_)
+      {
+        journal_.config_hash = ConfigFingerprint(config);
+        WriteSessionJournal(journal_path_, journal_);
+      }
+    }
+    return true;
+  }
+
+  void OpenVpnDartPlugin::OnRemoteQuery(ManagementClient &client, const RemoteNotification &remote)
+  {
+    std::string reply;
+    {
+      std::lock_guard<std::mutex> lock(remote_mutex_);
+      reply = RemoteQueryReply(remote.proto, remote_override_ ? &*remote_override_ : nullptr);
+      if (remote_override_ && ProtoFamily(remote.proto) == ProtoFamily(remote_override_->proto))
+      {
+        remote_override_applied_ = true;
+      }
+    }
+    LogDebug("Remote {}:{} ({}): {}", remote.host, remote.port, remote.proto, reply);
+    client.SendCommand(reply);
+  }
+
+  void OpenVpnDartPlugin::ClearRemoteOverride()
+  {
+    std::lock_guard<std::mutex> lock(remote_mutex_);
+    remote_override_.reset();
+    remote_override_applied_ = false;
+  }
+
+  bool OpenVpnDartPlugin::PromoteSession(const std::shared_ptr<TunnelSession> &session,
+                                         const std::string &config)
+  {
+    session_reactor_.Remove(session->exit_source());
+    EventReactor::ProcessRef process;
+    std::unique_ptr<ManagementClient> management;
+    if (!session->Detach(&process, &management))
+    {
+      return false;
+    }
+    sessions_.Remove(session);
+    // The management interface takes one client; the default one follows
+    if (management)
+    {
+      management->Stop();
+    }
+
+    // From here on it is the default tunnel, as if attached after a restart:
+    // state over the management interface, output still drained into the
+    // session's log until the tunnel is torn down
+    promoted_session_ = session;
+    process_handle_ = process;
+    ZeroMemory(&process_info_, sizeof(process_info_));
+    process_info_.hProcess = process;
+    process_info_.dwProcessId = session->pid();
+    management_port_ = session->management_port();
+    management_password_ = session->management_password();
+    is_connected_ = true;
+    {
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      traffic_stats_.Start(SteadyNowMs());
+    }
+
+    BeginJournal(ConfigFingerprint(config));
+    UpdateJournal(GetCurrentStatus());
+    ClearRemoteOverride();
+    running_config_ = config;
+    {
+      // Sessions keep their routes in the profile
+      std::lock_guard<std::mutex> lock(native_routes_mutex_);
+      native_routes_active_ = false;
+    }
+
+    StartMonitor();
+    StartManagementClient();
+    return true;
+  }
+
+  void OpenVpnDartPlugin::UpdateByteCountSubscription(bool listening)
+  {
+    // OpenVPN only pushes counters while someone is there to see them
+    const int interval = listening ? stats_interval_seconds_.load() : 0;
+    SendManagementCommand("bytecount " + std::to_string(interval));
+    for (const auto &session : sessions_.List())
+    {
+      session->SendCommand("bytecount " + std::to_string(listening ? session->stats_interval() : 0));
+    }
+  }
+
+  void OpenVpnDartPlugin::OnByteCount(const ByteCountNotification &count)
+  {
+    TrafficSnapshot snapshot;
+    {
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      const int64_t now = SteadyNowMs();
+      traffic_stats_.AddSample(now, count.bytes_in, count.bytes_out);
+      snapshot = traffic_stats_.Snapshot(now);
+    }
+
+    PublishEvent(flutter::EncodableMap{
+        {flutter::EncodableValue("type"), flutter::EncodableValue("stats")},
+        {flutter::EncodableValue("bytesIn"), flutter::EncodableValue(static_cast<int64_t>(snapshot.bytes_in))},
+        {flutter::EncodableValue("bytesOut"), flutter::EncodableValue(static_cast<int64_t>(snapshot.bytes_out))},
+        {flutter::EncodableValue("rateIn"), flutter::EncodableValue(snapshot.rate_in)},
+        {flutter::EncodableValue("rateOut"), flutter::EncodableValue(snapshot.rate_out)},
+        {flutter::EncodableValue("durationMs"), flutter::EncodableValue(snapshot.duration_ms)},
+    }, kStatsEventKey);
+  }
+
+  std::shared_ptr<TunnelSession> OpenVpnDartPlugin::StartSession(
+      const std::string &id, const std::string &config, int stats_interval,
+      const CommandContext &context, bool internal, int attempt)
+  {
+    TraceSpan span("connect", "StartSession");
+    if (config.empty())
+    {
+      throw std::invalid_argument("OpenVPN configuration cannot be empty");
+    }
+    if (config.length() > 1024 * 1024) // 1MB limit
+    {
+      throw std::invalid_argument("OpenVPN configuration too large (> 1MB)");
+    }
+    if (!std::filesystem::exists(openvpn_executable_path_))
+    {
+      throw std::runtime_error("OpenVPN executable not found at: " + openvpn_executable_path_);
+    }
+    context.ThrowIfCancelled();
+
+    TunnelSessionManager::CreateResult created;
+    std::shared_ptr<TunnelSession> session = sessions_.Create(id, &created, internal);
+    if (!session)
+    {
+      throw std::invalid_argument(CreateResultMessage(created));
+    }
+    session->set_stats_interval(stats_interval);
+
+    PROCESS_INFORMATION info;
+    ZeroMemory(&info, sizeof(info));
+    uint16_t port = 0;
+    std::string password;
+    HANDLE output_read = nullptr;
+    HANDLE output_write = nullptr;
+    try
+    {
+      std::filesystem::create_directories(session->directory());
+      std::ofstream config_file(session->config_path(), std::ios::out | std::ios::trunc);
+      config_file << AggregateProfileRoutes(config, id);
+      if (!config_file)
+      {
+        throw std::runtime_error("Failed to write config file: " + session->config_path());
+      }
+      config_file.close();
+
+      // Output goes to the session's rotating log; state comes only from
+      // the management interface
+      SECURITY_ATTRIBUTES sa = {sizeof(sa), nullptr, TRUE};
+      if (!CreatePipe(&output_read, &output_write, &sa, 0) ||
+          !SetHandleInformation(output_read, HANDLE_FLAG_INHERIT, 0))
+      {
+        DWORD error = GetLastError();
+        throw std::runtime_error("Failed to create output pipe for session " + id +
+                                 ". Error: " + std::to_string(error));
+      }
+
+      port = loopback::PickFreePort();
+      if (port == 0)
+      {
+        throw std::runtime_error("No free management port for session " + id);
+      }
+      const std::string password_path =
+          (std::filesystem::path(session->directory()) / "management.pw").string();
+      password = WriteManagementPassword(password_path);
+      std::string command_line = "\"" + openvpn_executable_path_ + "\"";
+      command_line += " --config \"" + session->config_path() + "\"";
+      command_line += " --verb 3";
+      command_line += " --management 127.0.0.1 " + std::to_string(port) + " \"" +
+                      password_path + "\"";
+      command_line += " --management-query-remote"; // Kept if promoted by switchServer
+      command_line += " --route-method exe";
+      command_line += " --route-delay 2";
+      command_line += WindowsDriverOption();
+      LogDebug("Starting OpenVPN for session {} with command: {}", id, command_line);
+
+      STARTUPINFOA si = {0};
+      si.cb = sizeof(si);
+      si.dwFlags = STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
+      si.hStdOutput = output_write;
+      si.hStdError = output_write;
+      si.wShowWindow = SW_HIDE;
+
+      TraceSpan spawn_span("process", "CreateProcess");
+      if (!CreateProcessA(nullptr, const_cast<char *>(command_line.c_str()), nullptr, nullptr,
+                          TRUE, CREATE_NO_WINDOW, nullptr, nullptr, &si, &info))
+      {
+        DWORD error = GetLastError();
+        throw std::runtime_error("Failed to start OpenVPN for session " + id +
+                                 ". Error code: " + std::to_string(error));
+      }
+      CloseHandle(info.hThread);
+      CloseHandle(output_write);
+    }
+    catch (...)
+    {
+      if (output_read != nullptr)
+      {
+        CloseHandle(output_read);
+      }
+      if (output_write != nullptr)
+      {
+        CloseHandle(output_write);
+      }
+      sessions_.Remove(session);
+      throw;
+    }
+    LogInfo("OpenVPN process created for session {} (pid {})", id, info.dwProcessId);
+
+    // The drain thread owns the read end and closes it when it finishes
+    std::shared_ptr<void> pipe(output_read, CloseHandle);
+    session->StartOutput(
+        [pipe](char *buffer, size_t size) -> int64_t
+        {
+          DWORD bytes_read = 0;
+          if (!ReadFile(pipe.get(), buffer, static_cast<DWORD>(size), &bytes_read, nullptr))
+          {
+            return -1; // ERROR_BROKEN_PIPE once OpenVPN has exited
+          }
+          return bytes_read;
+        },
+        std::make_unique<RotatingLog>(session->log_path(), kSessionLogSegmentBytes,
+                                      kSessionLogArchives, CompressLogSegment));
+
+    std::unique_ptr<ManagementClient> management = CreateSessionManagementClient(session, password);
+    ManagementClient *client = management.get();
+    session->StartTraffic(SteadyNowMs());
+    session->Attach(info.hProcess, info.dwProcessId, port, password, std::move(management));
+    PublishSessionStatus(*session, "connecting");
+    // Attached before its exit is watched, so nothing stops the client
+    // under us; a process that exits early ends the connect attempts
+    HANDLE process = info.hProcess;
+    if (!client->Start(&session_reactor_, port, kSessionManagementTimeoutMs,
+                       [process]()
+                       { return WaitForSingleObject(process, 0) == WAIT_TIMEOUT; }) &&
+        WaitForSingleObject(process, 0) == WAIT_TIMEOUT)
+    {
+      // Without it the session reports nothing, and OpenVPN waits forever
+      // on its first remote query. An early exit is reported below.
+      LogWarning("Management interface of session {} did not attach", id);
+      StopSession(session);
+      throw std::runtime_error("Management interface of session " + id + " did not attach");
+    }
+
+    // One thread waits on every session's process and management socket
+    if (!session_reactor_thread_.joinable())
+    {
+      session_reactor_thread_ = std::thread(
+          [this]()
+          {
+            TraceRecorder::Global().SetThreadName("sessions");
+            while (!shutting_down_)
+            {
+              session_reactor_.RunOnce();
+            }
+          });
+    }
+    std::weak_ptr<TunnelSession> weak_session = session;
+    const EventReactor::SourceId exit_source = session_reactor_.WatchProcess(
+        info.hProcess,
+        [this, weak_session]()
+        {
+          if (auto exited = weak_session.lock())
+          {
+            OnSessionExit(exited);
+          }
+        });
+    if (exit_source == EventReactor::kInvalidSource)
+    {
+      LogWarning("Could not watch the OpenVPN process of session {}", id);
+    }
+    session->set_exit_source(exit_source);
+
+    // Look for an early exit, as StartVPN does
+    if (!context.SleepFor(500))
+    {
+      LogInfo("Session {} cancelled while starting", id);
+      StopSession(session);
+      context.ThrowIfCancelled();
+    }
+    uint32_t exit_code = 0;
+    if (session->exit_code(&exit_code))
+    {
+      // Its output is complete once the exit code is set
+      const std::vector<std::string> output = session->RecentOutput(kOutputRingLines);
+      const bool port_taken = std::any_of(output.begin(), output.end(), [](const std::string &line)
+                                          { return line.find(kManagementBindFailed) != std::string::npos; });
+      if (port_taken && attempt < kManagementBindAttempts)
+      {
+        LogWarning("Management port {} of session {} was taken before OpenVPN bound it; retrying",
+                   port, id);
+        sessions_.Remove(session); // May still be in OnSessionExit
+        return StartSession(id, config, stats_interval, context, internal, attempt + 1);
+      }
+      throw std::runtime_error("OpenVPN process exited with code " + std::to_string(exit_code) +
+                               " (see " + session->log_path() + ")");
+    }
+    return session;
+  }
+
+  bool OpenVpnDartPlugin::StopSession(const std::string &id)
+  {
+    std::shared_ptr<TunnelSession> session = sessions_.Find(id);
+    if (!session)
+    {
+      return false;
+    }
+    StopSession(session);
+    return true;
+  }
+
+  void OpenVpnDartPlugin::StopSession(const std::shared_ptr<TunnelSession> &session)
+  {
+    TraceSpan span("process", "StopSession");
+    EventReactor::ProcessRef process;
+    std::unique_ptr<ManagementClient> management;
+    if (!session->Detach(&process, &management))
+    {
+      return; // Its exit was handled already
+    }
+    session_reactor_.Remove(session->exit_source());
+    PublishSessionStatus(*session, "disconnecting");
+
+    ShutdownSteps steps;
+    steps.request_graceful = [&management]()
+    {
+      return management && management->connected() &&
+             management->SendCommand("signal SIGTERM");
+    };
+    steps.wait_for_exit = [process](int timeout_ms)
+    {
+      return WaitForSingleObject(process, static_cast<DWORD>(timeout_ms)) != WAIT_TIMEOUT;
+    };
+    steps.force_kill = [process, &session]()
+    {
+      LogInfo("Terminating OpenVPN process of session {}...", session->id());
+      if (!TerminateProcess(process, 0))
+      {
+        DWORD error = GetLastError();
+        LogWarning("TerminateProcess failed with error: {}", error);
+      }
+    };
+    steps.cleanup = [process, &management, &session]()
+    {
+      if (management)
+      {
+        management->Stop();
+      }
+      session->StopOutput(kOutputDrainTimeoutMs, CancelBlockedRead);
+      DWORD exit_code;
+      if (GetExitCodeProcess(process, &exit_code) && exit_code != STILL_ACTIVE)
+      {
+        session->set_exit_code(exit_code);
+      }
+      CloseHandle(process);
+    };
+
+    ShutdownSequencer sequencer(kGracefulStopTimeoutMs, kForcedStopTimeoutMs);
+    const ShutdownReport report = sequencer.Run(steps);
+    sessions_.Remove(session);
+    LogInfo("Session {} stopped in {}ms ({})", session->id(), report.total_ms,
+            report.graceful ? "graceful" : report.killed ? "killed" : "not running");
+
+    PublishSessionStatus(*session, "disconnected");
+    PublishEvent(flutter::EncodableMap{
+        {flutter::EncodableValue("type"), flutter::EncodableValue("teardown")},
+        {flutter::EncodableValue("sessionId"), flutter::EncodableValue(session->id())},
+        {flutter::EncodableValue("durationMs"), flutter::EncodableValue(report.total_ms)},
+        {flutter::EncodableValue("graceful"), flutter::EncodableValue(report.graceful)},
+        {flutter::EncodableValue("killed"), flutter::EncodableValue(report.killed)},
+    });
+  }
+
+  void OpenVpnDartPlugin::OnSessionExit(const std::shared_ptr<TunnelSession> &session)
+  {
+    EventReactor::ProcessRef process;
+    std::unique_ptr<ManagementClient> management;
+    if (!session->Detach(&process, &management))
+    {
+      return; // StopSession is taking it down
+    }
+
+    // No further state notifications once we report "disconnected"
+    if (management)
+    {
+      management->Stop();
+    }
+    session->StopOutput(kOutputDrainTimeoutMs, CancelBlockedRead);
+    DWORD exit_code = 0;
+    if (GetExitCodeProcess(process, &exit_code))
+    {
+      session->set_exit_code(exit_code);
+    }
+    CloseHandle(process);
+    sessions_.Remove(session);
+
+    LogInfo("OpenVPN process of session {} exited with code {}", session->id(), exit_code);
+    PublishSessionStatus(*session, "disconnected");
+  }
+
+  std::unique_ptr<ManagementClient> OpenVpnDartPlugin::CreateSessionManagementClient(
+      std::weak_ptr<TunnelSession> weak_session, const std::string &password)
+  {
+    auto self = std::make_shared<ManagementClient *>(nullptr);
+
+    ManagementClient::Handlers handlers;
+    handlers.on_connected = [this, self, weak_session]()
+    {
+      auto session = weak_session.lock();
+      if (!session)
+      {
+        return;
+      }
+      LogInfo("Management interface attached for session {}", session->id());
+      ManagementClient &client = **self;
+      client.SendCommand("state on");
+      client.SendCommand("bytecount " + std::to_string(listening_ ? session->stats_interval() : 0));
+      client.SendCommand(
+          "state",
+          [this, weak_session](bool success, const std::string &reply)
+          {
+            auto session = weak_session.lock();
+            StateNotification state;
+            if (session && success && ParseStateLine(reply, &state))
+            {
+              if (const char *status = StatusForState(state))
+              {
+                PublishSessionStatus(*session, status);
+              }
+            }
+          });
+    };
+    handlers.on_state = [this, weak_session](const StateNotification &state)
+    {
+      auto session = weak_session.lock();
+      if (!session)
+      {
+        return;
+      }
+      LogDebug("Session {} state: {} {}", session->id(), state.name, state.detail);
+      if (const char *status = StatusForState(state))
+      {
+        PublishSessionStatus(*session, status);
+      }
+    };
+    handlers.on_bytecount = [this, weak_session](const ByteCountNotification &count)
+    {
+      if (auto session = weak_session.lock())
+      {
+        PublishSessionStats(*session, session->AddTraffic(SteadyNowMs(), count.bytes_in, count.bytes_out));
+      }
+    };
+    handlers.on_hold = [self](const std::string &message)
+    {
+      LogInfo("Management hold: {}", message);
+      (*self)->SendCommand("hold release");
+    };
+    handlers.on_remote = [self](const RemoteNotification &)
+    {
+      (*self)->SendCommand(RemoteQueryReply("", nullptr));
+    };
+    handlers.on_fatal = [weak_session](const std::string &message)
+    {
+      auto session = weak_session.lock();
+      LogError("OpenVPN fatal in session {}: {}", session ? session->id() : std::string(), message);
+    };
+
+    auto client = std::make_unique<ManagementClient>(std::move(handlers), password);
+    *self = client.get();
+    return client;
+  }
+
+  std::string OpenVpnDartPlugin::AggregateProfileRoutes(const std::string &config,
+                                                        const std::string &session_id)
+  {
+    TraceSpan span("connect", "AggregateProfileRoutes");
+    RouteAggregationReport report;
+    std::string profile = AggregateRoutes(config, &report);
+    if (report.ipv4_before + report.ipv6_before == 0)
+    {
+      return profile;
+    }
+    LogInfo("Routes: IPv4 {} -> {}, IPv6 {} -> {}", report.ipv4_before, report.ipv4_after,
+            report.ipv6_before, report.ipv6_after);
+    flutter::EncodableMap event{
+        {flutter::EncodableValue("type"), flutter::EncodableValue("routeAggregation")},
+        {flutter::EncodableValue("ipv4Before"), flutter::EncodableValue(static_cast<int64_t>(report.ipv4_before))},
+        {flutter::EncodableValue("ipv4After"), flutter::EncodableValue(static_cast<int64_t>(report.ipv4_after))},
+        {flutter::EncodableValue("ipv6Before"), flutter::EncodableValue(static_cast<int64_t>(report.ipv6_before))},
+        {flutter::EncodableValue("ipv6After"), flutter::EncodableValue(static_cast<int64_t>(report.ipv6_after))},
+    };
+    if (!session_id.empty())
+    {
+      event[flutter::EncodableValue("sessionId")] = flutter::EncodableValue(session_id);
+    }
+    PublishEvent(event);
+    return profile;
+  }
+
+  std::string OpenVpnDartPlugin::TakeNativeRoutes(const std::string &config, bool managed)
+  {
+    std::lock_guard<std::mutex> lock(native_routes_mutex_);
+    native_routes_active_ = false;
+    native_routes_installed_ = false;
+    native_routes_failed_ = false;
+    native_profile_routes_ = RouteOptions();
+    native_pushed_routes_ = RouteOptions();
+    native_push_more_ = false;
+    native_net_gateway_ = NetGateway();
+    if (!native_routes_requested_)
+    {
+      return config;
+    }
+    if (!managed)
+    {
+      LogWarning("Native routes off, OpenVPN installs them: no management interface");
+      return config;
+    }
+
+    std::string profile;
+    std::string reason;
+    if (!TakeProfileRoutes(config, &profile, &native_profile_routes_, &reason))
+    {
+      LogWarning("Native routes off, OpenVPN installs them: {}", reason);
+      return config;
+    }
+    native_routes_active_ = true;
+    LogInfo("Native routes on: {} IPv4 and {} IPv6 from the profile",
+            native_profile_routes_.routes.size(), native_profile_routes_.ipv6_routes.size());
+    return profile;
+  }
+
+  void OpenVpnDartPlugin::OnNativeRoutesLog(const std::string &message)
+  {
+    // The push, and the ROUTE_GATEWAY lines that resolve its net_gateway
+    if (message.find("PUSH_REPLY,") == std::string::npos &&
+        message.find("_GATEWAY ") == std::string::npos)
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(native_routes_mutex_);
+    if (!native_routes_active_ || ParseNetGateway(message, &native_net_gateway_))
+    {
+      return;
+    }
+    // A reply that does not continue a split one replaces the last push
+    RouteOptions reply = native_push_more_ ? native_pushed_routes_ : RouteOptions();
+    bool more = false;
+    if (ParsePushReply(message, &reply, &more))
+    {
+      native_pushed_routes_ = std::move(reply);
+      native_push_more_ = more;
+    }
+  }
+
+  bool OpenVpnDartPlugin::InstallNativeRoutes(const std::string &local_ip)
+  {
+    RouteOptions profile_routes;
+    RouteOptions pushed_routes;
+    NetGateway net_gateway;
+    {
+      std::lock_guard<std::mutex> lock(native_routes_mutex_);
+      // A repeated CONNECTED (the catch-up "state") finds them in place
+      if (!native_routes_active_ || native_routes_installed_ || native_routes_failed_)
+      {
+        return !native_routes_failed_;
+      }
+      profile_routes = native_profile_routes_;
+      pushed_routes = native_pushed_routes_;
+      net_gateway = native_net_gateway_;
+    }
+
+    TraceSpan span("connect", "InstallNativeRoutes");
+    const int64_t started_ms = SteadyNowMs();
+    IpAddress address;
+    const uint32_t interface_index =
+        ParseIpAddress(local_ip, &address) ? route_backend_.InterfaceIndexForAddress(address) : 0;
+    std::vector<std::string> skipped;
+    std::string error;
+    bool installed = false;
+    if (interface_index == 0)
+    {
+      error = "No interface has the tunnel address '" + local_ip + "'";
+    }
+    else
+    {
+      installed = route_programmer_.Install(
+          ResolveRoutes(profile_routes, pushed_routes, net_gateway, interface_index, &skipped), &error);
+    }
+    {
+      std::lock_guard<std::mutex> lock(native_routes_mutex_);
+      native_routes_installed_ = installed;
+      native_routes_failed_ = !installed;
+    }
+    const int64_t elapsed_ms = SteadyNowMs() - started_ms;
+
+    flutter::EncodableList skipped_list;
+    for (const std::string &route : skipped)
+    {
+      LogWarning("Route not installed: {}", route);
+      skipped_list.push_back(flutter::EncodableValue(route));
+    }
+    if (installed)
+    {
+      LogInfo("Installed {} routes on interface {} in {}ms", route_programmer_.installed(),
+              interface_index, elapsed_ms);
+    }
+    else
+    {
+      LogError("Native routes failed, none left installed: {}", error);
+    }
+
+    flutter::EncodableMap event{
+        {flutter::EncodableValue("type"), flutter::EncodableValue("nativeRoutes")},
+        {flutter::EncodableValue("installed"), flutter::EncodableValue(static_cast<int64_t>(route_programmer_.installed()))},
+        {flutter::EncodableValue("skipped"), flutter::EncodableValue(skipped_list)},
+        {flutter::EncodableValue("elapsedMs"), flutter::EncodableValue(elapsed_ms)},
+    };
+    if (!installed)
+    {
+      event[flutter::EncodableValue("error")] = flutter::EncodableValue(error);
+    }
+    PublishEvent(event);
+    return installed;
+  }
+
+  void OpenVpnDartPlugin::RemoveNativeRoutes()
+  {
+    {
+      std::lock_guard<std::mutex> lock(native_routes_mutex_);
+      native_routes_installed_ = false;
+    }
+    const size_t count = route_programmer_.installed();
+    if (count == 0)
+    {
+      return;
+    }
+    std::string error;
+    if (route_programmer_.RemoveAll(&error))
+    {
+      LogInfo("Removed {} native routes", count);
+    }
+    else
+    {
+      LogWarning("Removing native routes: {}", error);
+    }
+  }
+
+  void OpenVpnDartPlugin::PublishSessionStatus(TunnelSession &session, const std::string &status)
+  {
+    if (!session.SetStatus(status))
+    {
+      return;
+    }
+    LogDebug("Session {} status changed to: {}", session.id(), status);
+    PublishEvent(flutter::EncodableMap{
+        {flutter::EncodableValue("type"), flutter::EncodableValue("sessionStatus")},
+        {flutter::EncodableValue("sessionId"), flutter::EncodableValue(session.id())},
+        {flutter::EncodableValue("status"), flutter::EncodableValue(status)},
+    });
+  }
+
+  void OpenVpnDartPlugin::PublishSessionStats(const TunnelSession &session,
+                                              const TrafficSnapshot &snapshot)
+  {
+    PublishEvent(flutter::EncodableMap{
+        {flutter::EncodableValue("type"), flutter::EncodableValue("stats")},
+        {flutter::EncodableValue("sessionId"), flutter::EncodableValue(session.id())},
+        {flutter::EncodableValue("bytesIn"), flutter::EncodableValue(static_cast<int64_t>(snapshot.bytes_in))},
+        {flutter::EncodableValue("bytesOut"), flutter::EncodableValue(static_cast<int64_t>(snapshot.bytes_out))},
+        {flutter::EncodableValue("rateIn"), flutter::EncodableValue(snapshot.rate_in)},
+        {flutter::EncodableValue("rateOut"), flutter::EncodableValue(snapshot.rate_out)},
+        {flutter::EncodableValue("durationMs"), flutter::EncodableValue(snapshot.duration_ms)},
+    }, kStatsEventKey + session.key());
+  }
+
+  void OpenVpnDartPlugin::PublishEvent(const flutter::EncodableMap &event, uint32_t coalesce_key)
+  {
+    QueueEvent(flutter::EncodableValue(event), coalesce_key);
+  }
+
+  void OpenVpnDartPlugin::QueueEvent(flutter::EncodableValue event, uint32_t coalesce_key)
+  {
+    // Events are only worth queueing for an attached listener
+    if (!listening_)
+    {
+      return;
+    }
+    // Otherwise a drain is already on its way, unless its wake-up was lost
+    if (events_.Push(std::move(event), coalesce_key) || wake_failed_)
+    {
+      WakePlatformThread();
+    }
+  }
+
+  void OpenVpnDartPlugin::RunOnPlatformThread(std::function<void()> task)
+  {
+    if (platform_tasks_.Push(std::move(task)) || wake_failed_)
+    {
+      WakePlatformThread();
+    }
+  }
+
+  void OpenVpnDartPlugin::WakePlatformThread()
+  {
+    // Never drained here: the sink and method results belong to the
+    // platform thread. A lost wake-up is retried by the next producer, and
+    // the next method call drains whatever is waiting.
+    if (event_window_ == nullptr || !PostMessage(event_window_, drain_message_, 0, 0))
+    {
+      wake_failed_ = true;
+    }
+  }
+
+  void OpenVpnDartPlugin::DrainOnPlatformThread()
+  {
+    wake_failed_ = false;
+    RunPlatformTasks();
+    FlushEvents();
+  }
+
+  void OpenVpnDartPlugin::RunPlatformTasks()
+  {
+    std::vector<std::function<void()>> tasks;
+    {
+      std::lock_guard<std::mutex> lock(platform_tasks_mutex_);
+      platform_tasks_.Drain(SteadyNowMs(), &tasks);
+    }
+    for (auto &task : tasks)
+    {
+      task();
     }
+  }
 
-    OutputDebugStringA("OpenVPN process created successfully");
-    process_handle_ = process_info_.hProcess;
-    is_connected_ = true;
+  std::optional<LRESULT> OpenVpnDartPlugin::HandleWindowMessage(HWND hwnd, UINT message,
+                                                                WPARAM wparam, LPARAM lparam)
+  {
+    if (message == drain_message_ && drain_message_ != 0)
+    {
+      wake_failed_ = false;
+      RunPlatformTasks();
 
-    // Check if process is still running and look for early errors
-    DWORD exit_code;
-    Sleep(500); // Give it a moment to start and write logs
+      // Bursts arriving faster than frames wait for the next one
+      const int64_t since_flush_ms = SteadyNowMs() - last_flush_ms_;
+      if (since_flush_ms < kEventFrameMs &&
+          SetTimer(event_window_, kEventTimerId, static_cast<UINT>(kEventFrameMs - since_flush_ms), nullptr))
+      {
+        return 0;
+      }
+      FlushEvents();
+      return 0;
+    }
+    if (message == WM_TIMER && wparam == kEventTimerId)
+    {
+      KillTimer(event_window_, kEventTimerId);
+      FlushEvents();
+      return 0;
+    }
+    return std::nullopt;
+  }
 
-    bool process_exited = false;
-    if (GetExitCodeProcess(process_handle_, &exit_code) && exit_code != STILL_ACTIVE)
+  void OpenVpnDartPlugin::FlushEvents()
+  {
+    TraceSpan span("events", "FlushEvents");
+    // Only ever called on the platform thread, the queue's one consumer
+    const int64_t now = SteadyNowMs();
+    flutter::EncodableList batch;
+    if (events_.Drain(now, &batch) == 0)
     {
-      process_exited = true;
-      std::string exit_msg = "OpenVPN process exited with code " + std::to_string(exit_code);
-      OutputDebugStringA(exit_msg.c_str());
+      return;
+    }
+    last_flush_ms_ = now;
+    if (event_sink_)
+    {
+      event_sink_->Success(flutter::EncodableValue(std::move(batch)));
+    }
+  }
 
-      // Try to read error from log file
-      if (std::filesystem::exists(log_file_path_))
+  void OpenVpnDartPlugin::PublishStatus(const std::string &status)
+  {
+    {
+      std::lock_guard<std::mutex> lock(status_mutex_);
+      if (current_status_ == status)
       {
-        std::ifstream log_file(log_file_path_);
-        std::string line, error_detail;
-        while (std::getline(log_file, line))
-        {
-          if (line.find("AUTH_FAILED") != std::string::npos ||
-              line.find("ERROR") != std::string::npos ||
-              line.find("FATAL") != std::string::npos)
-          {
-            error_detail = line;
-          }
-        }
-        log_file.close();
+        return;
+      }
+      current_status_ = status;
+    }
+    LogDebug("Status changed to: {}", status);
+    UpdateJournal(status);
+    QueueEvent(flutter::EncodableValue(status));
+  }
 
-        if (!error_detail.empty())
+  void OpenVpnDartPlugin::StartOutputCapture()
+  {
+    StopOutputCapture();
+    output_status_.Reset();
+    if (log_to_file_)
+    {
+      output_log_->Open();
+    }
+
+    HANDLE pipe = pipe_read_;
+    output_drain_.Start(
+        [pipe](char *buffer, size_t size) -> int64_t
         {
-          // Sanitize the error message
-          for (char &c : error_detail)
+          DWORD bytes_read = 0;
+          if (!ReadFile(pipe, buffer, static_cast<DWORD>(size), &bytes_read, nullptr))
           {
-            if (static_cast<unsigned char>(c) > 127)
-            {
-              c = '?';
-            }
+            return -1; // ERROR_BROKEN_PIPE once OpenVPN has exited
           }
-          exit_msg += ": " + error_detail;
-        }
-      }
+          return bytes_read;
+        },
+        [this](std::string_view line)
+        {
+          OnOutputLine(line);
+        });
+  }
 
-      OutputDebugStringA(("Full error: " + exit_msg).c_str());
+  void OpenVpnDartPlugin::StopOutputCapture()
+  {
+    // Helpers spawned by OpenVPN (route.exe) may still hold the pipe open;
+    // don't let them stall the teardown
+    if (!output_drain_.WaitFor(kOutputDrainTimeoutMs))
+    {
+      CancelSynchronousIo(output_drain_.native_handle());
+    }
+    output_drain_.Join();
+    output_log_->Close();
 
-      // Process already exited - this is an error
-      is_connected_ = false;
-      CloseHandle(process_info_.hProcess);
-      CloseHandle(process_info_.hThread);
-      CloseHandle(pipe_read_);
-      CloseHandle(pipe_write_);
-      pipe_read_ = nullptr;
-      pipe_write_ = nullptr;
-      process_handle_ = nullptr;
-      throw std::runtime_error(exit_msg);
+    if (promoted_session_)
+    {
+      promoted_session_->StopOutput(kOutputDrainTimeoutMs, CancelBlockedRead);
+      promoted_session_.reset();
     }
+  }
 
-    // Update status and send to Flutter immediately
+  void OpenVpnDartPlugin::OnOutputLine(std::string_view line)
+  {
+    // Runs on the drain thread, the only writer of the log and the tracker
+    if (output_log_->is_open())
     {
-      std::lock_guard<std::mutex> lock(status_mutex_);
-      current_status_ = "connecting";
+      output_log_->Write(line);
     }
 
-    // Send initial connecting status to Flutter
+    if (output_status_.OnLine(line))
     {
-      std::lock_guard<std::mutex> lock(event_sink_mutex_);
-      if (event_sink_)
+      LogDebug("Status from OpenVPN output: {}", output_status_.status());
+      // Once the management interface is attached it reports state directly
+      if (!management_active_)
       {
-        OutputDebugStringA("Sending 'connecting' status to Flutter");
-        event_sink_->Success(flutter::EncodableValue("connecting"));
+        PublishStatus(output_status_.status());
       }
-      else
+    }
+
+    // Without the management interface the log is all there is to time
+    if (!management_active_ && HasLogEvent(output_status_.last_events(), LogEvent::kConnected))
+    {
+      connect_timings_.Finish(ConnectOutcome::kConnected, SteadyNowMs());
+    }
+
+    const LogEventMask reported = output_status_.last_events() & kReportedLogEvents;
+    for (size_t i = 0; reported != 0 && i < static_cast<size_t>(LogEvent::kCount); i++)
+    {
+      const LogEvent event = static_cast<LogEvent>(i);
+      if (HasLogEvent(reported, event))
       {
-        OutputDebugStringA("Warning: event_sink is null, cannot send connecting status");
+        PublishEvent(flutter::EncodableMap{
+            {flutter::EncodableValue("type"), flutter::EncodableValue("logEvent")},
+            {flutter::EncodableValue("event"), flutter::EncodableValue(LogEventName(event))},
+            {flutter::EncodableValue("line"), flutter::EncodableValue(std::string(line))},
+        });
       }
     }
+  }
 
-    // Start monitoring thread
-    if (!is_monitoring_)
+  void OpenVpnDartPlugin::BeginJournal(uint64_t config_hash)
+  {
+    std::lock_guard<std::mutex> lock(journal_mutex_);
+    journal_ = SessionRecord();
+    journal_.pid = process_info_.dwProcessId;
+    journal_.creation_time = ProcessCreationTime(process_handle_);
+    journal_.config_hash = config_hash;
+    journal_.management_port = management_port_;
+    journal_.management_password = management_password_;
+    journal_.started_unix_ms = UnixNowMs();
+    journal_.status = "connecting";
+    journal_active_ = WriteSessionJournal(journal_path_, journal_);
+    if (!journal_active_)
+    {
+      LogWarning("Failed to write session journal: {}", journal_path_);
+    }
+  }
+
+  void OpenVpnDartPlugin::UpdateJournal(const std::string &status)
+  {
+    std::lock_guard<std::mutex> lock(journal_mutex_);
+    if (!journal_active_ || journal_.status == status)
+    {
+      return;
+    }
+    if (status == "disconnected")
     {
-      is_monitoring_ = true;
-      monitor_thread_ = std::thread(&OpenVpnDartPlugin::MonitorVPNStatus, this);
+      ClearSessionJournal(journal_path_);
+      journal_active_ = false;
+      return;
     }
+    journal_.status = status;
+    WriteSessionJournal(journal_path_, journal_);
   }
 
-  void OpenVpnDartPlugin::StopVPN()
+  void OpenVpnDartPlugin::StopVPN(bool wait)
   {
-    OutputDebugStringA("StopVPN called");
+    LogDebug("StopVPN called");
 
-    try
+    if (teardown_thread_.joinable())
     {
-      // Send disconnecting status
+      if (teardown_running_ && !wait)
       {
-        std::lock_guard<std::mutex> lock(status_mutex_);
-        current_status_ = "disconnecting";
+        // The teardown in flight reports completion itself
+        LogDebug("Teardown already in progress");
+        return;
       }
+      teardown_thread_.join();
+    }
 
-      {
-        std::lock_guard<std::mutex> lock(event_sink_mutex_);
-        if (event_sink_)
-        {
-          try
-          {
-            OutputDebugStringA("Sending 'disconnecting' status to Flutter");
-            event_sink_->Success(flutter::EncodableValue("disconnecting"));
-          }
-          catch (const std::exception &e)
-          {
-            OutputDebugStringA(("Failed to send disconnecting status: " + std::string(e.what())).c_str());
-          }
-        }
-      }
+    if (!handover_)
+    {
+      PublishStatus("disconnecting");
+    }
+
+    // The platform thread only kicks off the teardown; waiting for OpenVPN to
+    // exit and joining threads happens on the teardown thread
+    teardown_running_ = true;
+    // Blocking stops come from StartVPN and the destructor, neither of which
+    // wants a fresh standby parked behind it
+    teardown_thread_ = std::thread(&OpenVpnDartPlugin::TeardownVPN, this, !wait);
+    if (wait)
+    {
+      teardown_thread_.join();
+    }
+  }
 
-      // Give the disconnecting status time to be processed
-      Sleep(100);
+  void OpenVpnDartPlugin::TeardownVPN(bool rearm_standby)
+  {
+    TraceRecorder::Global().SetThreadName("teardown");
+    TraceSpan span("process", "TeardownVPN");
+    // A connect still coming up ends here
+    connect_timings_.Finish(ConnectOutcome::kCancelled, SteadyNowMs());
 
-      // Terminate the process gracefully
-      if (process_handle_ != nullptr)
+    try
+    {
+      // Stop the monitor first so it never waits on handles closed below
+      is_monitoring_ = false;
+      reactor_.Wake();
+      if (monitor_thread_.joinable())
       {
-        OutputDebugStringA("Terminating OpenVPN process...");
+        LogDebug("Waiting for monitor thread to finish...");
+        monitor_thread_.join();
+        LogDebug("Monitor thread finished");
+      }
 
-        // Try graceful shutdown
+      ShutdownSteps steps;
+      steps.request_graceful = [this]()
+      {
+        // On SIGTERM OpenVPN removes its routes and DNS settings before exiting
+        return SendManagementCommand("signal SIGTERM");
+      };
+      steps.wait_for_exit = [this](int timeout_ms)
+      {
+        return process_handle_ == nullptr ||
+               WaitForSingleObject(process_handle_, static_cast<DWORD>(timeout_ms)) != WAIT_TIMEOUT;
+      };
+      steps.force_kill = [this]()
+      {
+        LogInfo("Terminating OpenVPN process...");
         if (!TerminateProcess(process_handle_, 0))
         {
           DWORD error = GetLastError();
-          OutputDebugStringA(("TerminateProcess failed with error: " + std::to_string(error)).c_str());
-        }
-
-        // Wait for process to exit with timeout
-        DWORD wait_result = WaitForSingleObject(process_handle_, 5000);
-        if (wait_result == WAIT_TIMEOUT)
-        {
-          OutputDebugStringA("Process did not exit within timeout, forcing termination");
+          LogWarning("TerminateProcess failed with error: {}", error);
         }
-
+      };
+      steps.cleanup = [this]()
+      {
         // Clean up handles safely
         if (process_info_.hProcess != nullptr && process_info_.hProcess != INVALID_HANDLE_VALUE)
         {
@@ -1240,218 +3756,167 @@ namespace openvpn_dart
         {
           CloseHandle(process_info_.hThread);
         }
-
         process_handle_ = nullptr;
         ZeroMemory(&process_info_, sizeof(process_info_));
-        OutputDebugStringA("Process terminated");
-      }
 
-      // Close pipes safely
-      if (pipe_write_ != nullptr && pipe_write_ != INVALID_HANDLE_VALUE)
-      {
-        CloseHandle(pipe_write_);
-        pipe_write_ = nullptr;
-      }
-      if (pipe_read_ != nullptr && pipe_read_ != INVALID_HANDLE_VALUE)
-      {
-        CloseHandle(pipe_read_);
-        pipe_read_ = nullptr;
-      }
+        ReleaseTunnel();
 
-      // Set flags to false to stop monitoring thread
-      is_connected_ = false;
-      is_monitoring_ = false;
+        // Close pipes safely
+        if (pipe_write_ != nullptr && pipe_write_ != INVALID_HANDLE_VALUE)
+        {
+          CloseHandle(pipe_write_);
+          pipe_write_ = nullptr;
+        }
+        if (pipe_read_ != nullptr && pipe_read_ != INVALID_HANDLE_VALUE)
+        {
+          CloseHandle(pipe_read_);
+          pipe_read_ = nullptr;
+        }
 
-      // Wait for threads to finish
-      if (monitor_thread_.joinable())
-      {
-        OutputDebugStringA("Waiting for monitor thread to finish...");
-        monitor_thread_.join();
-        OutputDebugStringA("Monitor thread finished");
-      }
-      if (log_thread_.joinable())
-      {
-        OutputDebugStringA("Waiting for log thread to finish...");
-        log_thread_.join();
-        OutputDebugStringA("Log thread finished");
-      }
+        is_connected_ = false;
+      };
 
-      // Update status to disconnected
+      ShutdownSequencer sequencer(kGracefulStopTimeoutMs, kForcedStopTimeoutMs);
+      const ShutdownReport report = sequencer.Run(steps);
+      LogInfo("Teardown finished in {}ms ({})", report.total_ms,
+              report.graceful ? "graceful" : report.killed ? "killed" : "not running");
+
+      if (!handover_)
       {
-        std::lock_guard<std::mutex> lock(status_mutex_);
-        current_status_ = "disconnected";
+        PublishStatus("disconnected");
       }
+      PublishEvent(flutter::EncodableMap{
+          {flutter::EncodableValue("type"), flutter::EncodableValue("teardown")},
+          {flutter::EncodableValue("durationMs"), flutter::EncodableValue(report.total_ms)},
+          {flutter::EncodableValue("graceful"), flutter::EncodableValue(report.graceful)},
+          {flutter::EncodableValue("killed"), flutter::EncodableValue(report.killed)},
+      });
+
+      LogInfo("StopVPN completed successfully");
 
-      // Send disconnected status
+      // Park the next connect's process now that the files are free again
+      if (rearm_standby && !standby_config_.empty() && standby_info_.hProcess == nullptr)
       {
-        std::lock_guard<std::mutex> lock(event_sink_mutex_);
-        if (event_sink_)
-        {
-          try
-          {
-            OutputDebugStringA("Sending 'disconnected' status to Flutter");
-            event_sink_->Success(flutter::EncodableValue("disconnected"));
-          }
-          catch (const std::exception &e)
-          {
-            OutputDebugStringA(("Failed to send disconnected status: " + std::string(e.what())).c_str());
-          }
-        }
+        SpawnStandby();
       }
-
-      OutputDebugStringA("StopVPN completed successfully");
     }
     catch (const std::exception &e)
     {
-      OutputDebugStringA(("Exception in StopVPN: " + std::string(e.what())).c_str());
+      LogError("Exception in StopVPN: {}", e.what());
       // Ensure flags are reset even on error
       is_connected_ = false;
       is_monitoring_ = false;
     }
     catch (...)
     {
-      OutputDebugStringA("Unknown exception in StopVPN");
+      LogError("Unknown exception in StopVPN");
       is_connected_ = false;
       is_monitoring_ = false;
     }
+
+    teardown_running_ = false;
   }
 
-  void OpenVpnDartPlugin::MonitorVPNStatus()
+  void OpenVpnDartPlugin::ReleaseTunnel()
   {
-    OutputDebugStringA("MonitorVPNStatus thread started");
+    // No further state notifications once we report "disconnected"
+    StopManagementClient();
+    StopOutputCapture();
+    RemoveNativeRoutes();
+  }
 
-    try
+  void OpenVpnDartPlugin::StartMonitor()
+  {
+    if (is_monitoring_)
+    {
+      return;
+    }
+    // A monitor that saw OpenVPN exit has already ended on its own
+    if (monitor_thread_.joinable())
     {
-      std::string last_status = "";
-      bool connection_established = false;
+      monitor_thread_.join();
+    }
+    is_monitoring_ = true;
+    monitor_thread_ = std::thread(&OpenVpnDartPlugin::MonitorVPNStatus, this);
+  }
+
+  void OpenVpnDartPlugin::MonitorVPNStatus()
+  {
+    TraceRecorder::Global().SetThreadName("monitor");
+    LogDebug("MonitorVPNStatus thread started");
+
+    // Sleep until OpenVPN exits or StopVPN wakes the reactor; status lines
+    // arrive through the output drain, not through this loop
+    bool process_exited = false;
+    const EventReactor::SourceId process_source =
+        process_handle_ != nullptr
+            ? reactor_.WatchProcess(process_handle_, [&process_exited]()
+                                    { process_exited = true; })
+            : EventReactor::kInvalidSource;
 
-      // Give the "connecting" status time to be sent and processed
-      Sleep(100);
+    // With the exit watched nothing needs a timer; fall back to the old 1s
+    // poll if the watch could not be registered
+    int wait_ms = -1;
+    if (process_source == EventReactor::kInvalidSource)
+    {
+      wait_ms = process_handle_ != nullptr ? 1000 : 5000;
+    }
 
+    try
+    {
       while (is_monitoring_ && is_connected_)
       {
+        TraceSpan iteration_span("monitor", "iteration");
         // Check if we should stop monitoring
         if (!is_monitoring_ || !is_connected_)
         {
-          OutputDebugStringA("Monitoring flags set to false, exiting thread");
+          LogDebug("Monitoring flags set to false, exiting thread");
           break;
         }
 
         // Check if process is still running
-        if (process_handle_ != nullptr)
+        if (process_handle_ != nullptr &&
+            (process_exited || process_source == EventReactor::kInvalidSource))
         {
           DWORD exit_code;
           if (GetExitCodeProcess(process_handle_, &exit_code))
           {
             if (exit_code != STILL_ACTIVE)
             {
-              OutputDebugStringA(("Process exited with code " + std::to_string(exit_code)).c_str());
-              // Process terminated unexpectedly
+              LogInfo("Process exited with code {}", exit_code);
+              connect_timings_.Finish(ConnectOutcome::kFailed, SteadyNowMs());
+              // Process terminated unexpectedly; its routes would otherwise
+              // stay installed until the next connect or stop
+              ReleaseTunnel();
+              CloseHandle(process_info_.hProcess);
+              if (process_info_.hThread != nullptr)
+              {
+                CloseHandle(process_info_.hThread);
+              }
+              process_info_ = {};
+              process_handle_ = nullptr;
               is_connected_ = false;
+              is_monitoring_ = false;
               {
                 std::lock_guard<std::mutex> lock(status_mutex_);
                 current_status_ = "disconnected";
               }
-
-              {
-                std::lock_guard<std::mutex> sink_lock(event_sink_mutex_);
-                if (event_sink_)
-                {
-                  event_sink_->Success(flutter::EncodableValue("disconnected"));
-                }
-              }
+              UpdateJournal("disconnected");
+              QueueEvent(flutter::EncodableValue("disconnected"));
               break;
             }
           }
         }
 
-        // Read log file to detect connection status
-        if (std::filesystem::exists(log_file_path_))
-        {
-          try
-          {
-            std::ifstream log_file(log_file_path_);
-            if (!log_file.is_open())
-            {
-              OutputDebugStringA("Failed to open log file");
-            }
-            else
-            {
-              std::string line;
-              std::string new_status = "connecting"; // Default to connecting if no specific state found
-
-              while (std::getline(log_file, line))
-              {
-                // Look for connection indicators
-                if (line.find("Initialization Sequence Completed") != std::string::npos)
-                {
-                  new_status = "connected";
-                  connection_established = true;
-                  OutputDebugStringA("VPN connection established!");
-                }
-                else if (line.find("CONNECTED") != std::string::npos &&
-                         line.find("SUCCESS") != std::string::npos)
-                {
-                  new_status = "connected";
-                  connection_established = true;
-                }
-                else if (line.find("CONNECTION_TIMEOUT") != std::string::npos ||
-                         line.find("AUTH_FAILED") != std::string::npos)
-                {
-                  new_status = "error";
-                  OutputDebugStringA("VPN connection error detected");
-                }
-                else if (line.find("TCP/UDP: Preserving recently used remote") != std::string::npos)
-                {
-                  // During initial connection, this is part of connecting process
-                  // Only treat as reconnecting if we were already connected
-                  if (connection_established)
-                  {
-                    new_status = "connecting"; // Treat reconnect as connecting
-                    OutputDebugStringA("VPN reconnecting");
-                  }
-                }
-              }
-              log_file.close();
-
-              if (new_status != last_status)
-              {
-                last_status = new_status;
-                OutputDebugStringA(("Status changed to: " + new_status).c_str());
-
-                {
-                  std::lock_guard<std::mutex> lock(status_mutex_);
-                  current_status_ = new_status;
-                }
-
-                {
-                  std::lock_guard<std::mutex> sink_lock(event_sink_mutex_);
-                  if (event_sink_)
-                  {
-                    event_sink_->Success(flutter::EncodableValue(new_status));
-                  }
-                  else
-                  {
-                    OutputDebugStringA("event_sink is null, cannot send status update");
-                  }
-                }
-              }
-            }
-          }
-          catch (const std::exception &e)
-          {
-            OutputDebugStringA(("Error reading log file: " + std::string(e.what())).c_str());
-          }
-        }
-
-        Sleep(1000); // Check every second
+        TraceSpan wait_span("monitor", "wait");
+        reactor_.RunOnce(wait_ms);
       }
 
-      OutputDebugStringA("MonitorVPNStatus thread exiting normally");
+      LogDebug("MonitorVPNStatus thread exiting normally");
     }
     catch (const std::exception &e)
     {
-      OutputDebugStringA(("Exception in MonitorVPNStatus: " + std::string(e.what())).c_str());
+      LogError("Exception in MonitorVPNStatus: {}", e.what());
 
       // Update status to error on exception
       try
@@ -1465,11 +3930,7 @@ namespace openvpn_dart
 
       try
       {
-        std::lock_guard<std::mutex> sink_lock(event_sink_mutex_);
-        if (event_sink_)
-        {
-          event_sink_->Success(flutter::EncodableValue("disconnected"));
-        }
+        QueueEvent(flutter::EncodableValue("disconnected"));
       }
       catch (...)
       {
@@ -1480,12 +3941,15 @@ namespace openvpn_dart
     }
     catch (...)
     {
-      OutputDebugStringA("Unknown exception in MonitorVPNStatus thread");
+      LogError("Unknown exception in MonitorVPNStatus thread");
       is_monitoring_ = false;
       is_connected_ = false;
     }
 
-    OutputDebugStringA("MonitorVPNStatus thread terminated");
+    // The callbacks reference this frame; unregister before returning
+    reactor_.Remove(process_source);
+
+    LogDebug("MonitorVPNStatus thread terminated");
   }
 
   std::string OpenVpnDartPlugin::GetCurrentStatus()
@@ -1501,112 +3965,85 @@ namespace openvpn_dart
 
   void OpenVpnDartPlugin::CheckExistingConnection()
   {
-    OutputDebugStringA("Checking for existing OpenVPN connection...");
+    TraceSpan span("init", "CheckExistingConnection");
+    LogDebug("Checking for existing OpenVPN connection...");
 
-    // Set up log file path
-    log_file_path_ = bundled_path_ + "\\config\\openvpn.log";
+    // StartVPN journals the process it launched; no journal means no session
+    SessionRecord record;
+    if (!ReadSessionJournal(journal_path_, &record))
+    {
+      LogInfo("No existing OpenVPN connection found");
+      return;
+    }
 
-    // Check if log file exists and has recent "Initialization Sequence Completed" message
-    if (std::filesystem::exists(log_file_path_))
+    // PID plus creation time, so a reused PID is never mistaken for ours
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE | PROCESS_TERMINATE,
+                                 FALSE, record.pid);
+    if (process == nullptr ||
+        WaitForSingleObject(process, 0) != WAIT_TIMEOUT ||
+        ProcessCreationTime(process) != record.creation_time)
     {
-      try
+      if (process != nullptr)
       {
-        std::ifstream log_file(log_file_path_);
-        if (log_file.is_open())
-        {
-          std::string line;
-          bool found_connected = false;
-          bool found_exit = false;
-
-          while (std::getline(log_file, line))
-          {
-            if (line.find("Initialization Sequence Completed") != std::string::npos)
-            {
-              found_connected = true;
-            }
-            else if (line.find("process exiting") != std::string::npos ||
-                     line.find("SIGTERM") != std::string::npos)
-            {
-              found_exit = true;
-            }
-          }
-          log_file.close();
+        CloseHandle(process);
+      }
+      LogInfo("Journaled OpenVPN process {} is gone", record.pid);
+      ClearSessionJournal(journal_path_);
 
-          // If we found connection but no exit, check if process is still running
-          if (found_connected && !found_exit)
+      // How the session ended, from the newest decisive line of its log
+      // The segment may have rotated just before the end
+      LastLogLine last;
+      if (FindLastLogLine(log_file_path_, kSessionEndLogEvents, &last) ||
+          FindLastLogLine(RotatingLog::ArchivePath(log_file_path_, 1), kSessionEndLogEvents, &last))
+      {
+        for (size_t i = 0; i < static_cast<size_t>(LogEvent::kCount); i++)
+        {
+          if (HasLogEvent(last.events, static_cast<LogEvent>(i)))
           {
-            // Try to find the OpenVPN process by name
-            HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-            if (snapshot != INVALID_HANDLE_VALUE)
-            {
-              PROCESSENTRY32 pe32;
-              pe32.dwSize = sizeof(PROCESSENTRY32);
-
-              if (Process32First(snapshot, &pe32))
-              {
-                do
-                {
-                  // Convert wide string to narrow string
-                  char processName[MAX_PATH];
-                  WideCharToMultiByte(CP_ACP, 0, pe32.szExeFile, -1, processName, MAX_PATH, NULL, NULL);
-
-                  if (strcmp(processName, "openvpn.exe") == 0)
-                  {
-                    // Found OpenVPN process - check if it's ours by command line
-                    HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | SYNCHRONIZE | PROCESS_TERMINATE, FALSE, pe32.th32ProcessID);
-                    if (hProcess != nullptr)
-                    {
-                      OutputDebugStringA(("Found existing OpenVPN process with PID " + std::to_string(pe32.th32ProcessID)).c_str());
-
-                      // Set up our state to monitor this process
-                      process_handle_ = hProcess;
-                      ZeroMemory(&process_info_, sizeof(process_info_));
-                      process_info_.hProcess = hProcess;
-                      process_info_.hThread = nullptr; // We don't have the thread handle for existing process
-                      process_info_.dwProcessId = pe32.th32ProcessID;
-                      is_connected_ = true;
-
-                      {
-                        std::lock_guard<std::mutex> lock(status_mutex_);
-                        current_status_ = "connected";
-                      }
-
-                      // Start monitoring thread
-                      if (!is_monitoring_)
-                      {
-                        is_monitoring_ = true;
-                        monitor_thread_ = std::thread(&OpenVpnDartPlugin::MonitorVPNStatus, this);
-                      }
-
-                      OutputDebugStringA("Attached to existing OpenVPN connection");
-                      break;
-                    }
-                  }
-                } while (Process32Next(snapshot, &pe32));
-              }
-              CloseHandle(snapshot);
-            }
+            last_session_end_ = LogEventName(static_cast<LogEvent>(i));
+            break;
           }
         }
+        LogInfo("Previous session ended after: {}", last.line);
       }
-      catch (const std::exception &e)
-      {
-        OutputDebugStringA(("Error checking existing connection: " + std::string(e.what())).c_str());
-      }
-      catch (...)
-      {
-        OutputDebugStringA("Unknown error checking existing connection");
-      }
+      return;
     }
 
-    if (!is_connected_)
+    LogInfo("Found existing OpenVPN process with PID {}", record.pid);
+
+    // Set up our state to monitor this process
+    process_handle_ = process;
+    ZeroMemory(&process_info_, sizeof(process_info_));
+    process_info_.hProcess = process;
+    process_info_.hThread = nullptr; // We don't have the thread handle for existing process
+    process_info_.dwProcessId = record.pid;
+    management_port_ = record.management_port;
+    management_password_ = record.management_password;
+    is_connected_ = true;
+
     {
-      OutputDebugStringA("No existing OpenVPN connection found");
+      std::lock_guard<std::mutex> lock(journal_mutex_);
+      journal_ = record;
+      journal_active_ = true;
     }
-    else
+
+    // Session duration continues from the original start
     {
-      OutputDebugStringA("Successfully attached to existing connection");
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      const int64_t elapsed_ms = std::max<int64_t>(0, UnixNowMs() - record.started_unix_ms);
+      traffic_stats_.Start(SteadyNowMs() - elapsed_ms);
     }
+
+    // A listener may already be attached while init runs
+    PublishStatus(record.status.empty() ? "connected" : record.status);
+
+    // Start monitoring thread
+    StartMonitor();
+
+    // Live state and counters resume over the management interface
+    StartManagementClient();
+
+    LogInfo("Successfully attached to existing connection");
   }
 
   std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>>
@@ -1614,25 +4051,40 @@ namespace openvpn_dart
       const flutter::EncodableValue *arguments,
       std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> &&events)
   {
-    std::lock_guard<std::mutex> lock(event_sink_mutex_);
-    event_sink_ = std::move(events);
+    flutter::EncodableMap ready_event;
+    {
+      std::lock_guard<std::mutex> lock(event_sink_mutex_);
+      event_sink_ = std::move(events);
+      ready_event = ready_event_;
+    }
+    listening_ = true;
 
-    // Always send current status when stream listener attaches
-    if (event_sink_)
+    // Always send current status when stream listener attaches. It goes
+    // through the queue so it never overtakes an update queued before it.
+    std::string status = GetCurrentStatus();
+    LogDebug("Sending initial status on stream listen: {}", status);
+    QueueEvent(flutter::EncodableValue(status));
+
+    // A listener attached after background init still learns it is done
+    if (!ready_event.empty())
     {
-      std::string status = GetCurrentStatus();
-      OutputDebugStringA(("Sending initial status on stream listen: " + status).c_str());
-      event_sink_->Success(flutter::EncodableValue(status));
+      PublishEvent(ready_event);
     }
 
+    UpdateByteCountSubscription(true);
     return nullptr;
   }
 
   std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>>
   OpenVpnDartPlugin::OnCancelInternal(const flutter::EncodableValue *arguments)
   {
-    std::lock_guard<std::mutex> lock(event_sink_mutex_);
-    event_sink_.reset();
+    listening_ = false;
+    {
+      std::lock_guard<std::mutex> lock(event_sink_mutex_);
+      event_sink_.reset();
+    }
+
+    UpdateByteCountSubscription(false);
     return nullptr;
   }
 
@@ -6,12 +6,36 @@
 #include <flutter/event_channel.h>
 #include <flutter/event_stream_handler_functions.h>
 
+#include <functional>
+#include <future>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <atomic>
 #include <mutex>
 
+#include "capability_cache.h"
+#include "command_executor.h"
+#include "connect_timings.h"
+#include "event_queue.h"
+#include "event_reactor.h"
+#include "log_status_tracker.h"
+#include "management_client.h"
+#include "pipe_drain.h"
+#include "profile_diff.h"
+#include "route_aggregation.h"
+#include "route_options.h"
+#include "route_programmer.h"
+#include "rotating_log.h"
+#include "server_switch.h"
+#include "session_journal.h"
+#include "system_route_backend.h"
+#include "traffic_stats.h"
+#include "tunnel_sessions.h"
+#include "warm_standby.h"
+
 namespace openvpn_dart
 {
 
@@ -34,23 +58,160 @@ namespace openvpn_dart
             std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
     private:
+        // Lifecycle method calls, run on |commands_|; |context| carries
+        // cancellation and the caller's deadline
+        void RunLifecycleCall(const std::string &method,
+                              const flutter::EncodableValue &call_arguments,
+                              flutter::MethodResult<flutter::EncodableValue> &result,
+                              const CommandContext &context);
+
+        // Bundle extraction and attach detection, run once on |init_thread_|
+        void InitializeInBackground(int64_t constructed_ms);
+
         // OpenVPN process management
-        void StartVPN(const std::string &config);
-        void StopVPN();
+        // Throws CommandCancelled if |context| ends before OpenVPN is up.
+        void StartVPN(const std::string &config, const CommandContext &context);
+        // Starts an asynchronous teardown; |wait| blocks until it finishes.
+        void StopVPN(bool wait = false);
+        void TeardownVPN(bool rearm_standby);
+        // Starts MonitorVPNStatus() unless it is running
+        void StartMonitor();
         void MonitorVPNStatus();
+        // Stops the management client and output capture and removes native
+        // routes; shared by teardown and an unexpected exit of OpenVPN
+        void ReleaseTunnel();
         std::string GetCurrentStatus();
         bool IsVPNRunning();
         void CheckExistingConnection();
+        void PublishStatus(const std::string &status);
+        // Events with the same non-zero |coalesce_key| sent within one
+        // frame reach Dart as the newest one.
+        void PublishEvent(const flutter::EncodableMap &event, uint32_t coalesce_key = 0);
+
+        // Delivery to Dart: events are queued from any thread and sent in
+        // batches from the platform thread, woken through |drain_message_|
+        // on the top-level window
+        void QueueEvent(flutter::EncodableValue event, uint32_t coalesce_key = 0);
+        void FlushEvents();
+        void RunOnPlatformThread(std::function<void()> task);
+        void RunPlatformTasks();
+        void WakePlatformThread();
+        void DrainOnPlatformThread();
+        std::optional<LRESULT> HandleWindowMessage(HWND hwnd, UINT message,
+                                                   WPARAM wparam, LPARAM lparam);
+
+        // Session journal for reattaching after a plugin restart
+        void BeginJournal(uint64_t config_hash);
+        void UpdateJournal(const std::string &status);
+
+        // Drains OpenVPN's stdout/stderr pipe and derives status from it
+        // until the management interface takes over
+        void StartOutputCapture();
+        void StopOutputCapture();
+        void OnOutputLine(std::string_view line);
+
+        // Writes the profile and spawns OpenVPN; |hold| parks it in
+        // --management-hold until released over the management interface,
+        // which is guarded by a fresh |management_password|. |query_remote|
+        // lets switchServer answer OpenVPN's remote queries.
+        void LaunchOpenVPN(const std::string &config, bool hold, bool query_remote,
+                           PROCESS_INFORMATION *info, HANDLE *pipe_read,
+                           HANDLE *pipe_write, uint16_t *management_port,
+                           std::string *management_password);
+
+        // Warm standby process for near-instant connects
+        void Prewarm(const std::string &config);
+        void CancelPrewarm();
+        void SpawnStandby();
+        bool AdoptStandby(uint64_t fingerprint);
+        void RecycleStandby();
+
+        // OpenVPN management interface. |active| gates whether the client's
+        // notifications drive plugin state; a standby client stays inactive
+        // until its process is adopted.
+        std::unique_ptr<ManagementClient> CreateManagementClient(
+            std::shared_ptr<std::atomic<bool>> active, std::atomic<bool> *held,
+            const std::string &password);
+        void AttachManagement(ManagementClient &client);
+        void StartManagementClient();
+        void StopManagementClient();
+        // The default tunnel's client, kept alive for the caller even if
+        // StopManagementClient() runs meanwhile; null if there is none
+        std::shared_ptr<ManagementClient> Management();
+        // Sends |command| once the management interface is attached
+        bool SendManagementCommand(const std::string &command);
+        void OnManagementState(const StateNotification &state);
+
+        // Named tunnels running next to the default one, each with its own
+        // OpenVPN process, directory and management client. Their exits and
+        // management sockets are all watched on |session_reactor_|.
+        // Throws CommandCancelled if |context| ends before OpenVPN is up.
+        // |internal| sessions are the plugin's own, hidden from getSessions.
+        // |attempt| counts launches that lost their management port.
+        std::shared_ptr<TunnelSession> StartSession(const std::string &id, const std::string &config,
+                                                    int stats_interval, const CommandContext &context,
+                                                    bool internal = false, int attempt = 1);
+        // False if no session |id| is running.
+        bool StopSession(const std::string &id);
+        void StopSession(const std::shared_ptr<TunnelSession> &session);
+        void OnSessionExit(const std::shared_ptr<TunnelSession> &session);
+        std::unique_ptr<ManagementClient> CreateSessionManagementClient(
+            std::weak_ptr<TunnelSession> session, const std::string &password);
+        // Publishes {type: sessionStatus} if |status| is new for |session|
+        void PublishSessionStatus(TunnelSession &session, const std::string &status);
+        void PublishSessionStats(const TunnelSession &session, const TrafficSnapshot &snapshot);
+
+        // |config| with its routes merged to the fewest equivalent ones, so
+        // OpenVPN runs route.exe fewer times. Publishes the before and after
+        // counts as {type: routeAggregation} when there are routes.
+        std::string AggregateProfileRoutes(const std::string &config, const std::string &session_id);
+
+        // Routes of the default tunnel installed by the plugin, in batches,
+        // instead of one route.exe run each. |config| with the routes taken
+        // out, or unchanged when connect did not ask for nativeRoutes, the
+        // profile handles routes itself, or the process runs without a
+        // |managed| connection (whose log and states drive the install).
+        std::string TakeNativeRoutes(const std::string &config, bool managed);
+        // Collects the routes of a PUSH_REPLY quoted in OpenVPN's log, and
+        // the gateway net_gateway stands for
+        void OnNativeRoutesLog(const std::string &message);
+        // Installs the collected routes once the tunnel at |local_ip| is up
+        // and publishes {type: nativeRoutes}. False if native routes are on
+        // but not in place, which leaves the tunnel without its routes.
+        bool InstallNativeRoutes(const std::string &local_ip);
+        void RemoveNativeRoutes();
+
+        // Replaces the default tunnel with one for |config|. While the
+        // default tunnel is connected the new one comes up first, as an
+        // internal session, and is promoted once the old one is torn down.
+        // A profile differing only in its remotes is switched in place.
+        SwitchReport SwitchServer(const std::string &config, const CommandContext &context);
+        // Points the running process at |target| through its remote queries
+        // and restarts it with SIGUSR1; false if management is not attached.
+        bool SwitchInPlace(const std::string &config, const ProfileRemote &target,
+                           SwitchTimeline *timeline, const CommandContext &context);
+        // Answers the default tunnel's ">REMOTE:" queries
+        void OnRemoteQuery(ManagementClient &client, const RemoteNotification &remote);
+        void ClearRemoteOverride();
+        // Moves |session|'s process into the default tunnel's slots; false
+        // if it exited first.
+        bool PromoteSession(const std::shared_ptr<TunnelSession> &session, const std::string &config);
+
+        // Traffic statistics streamed over the event channel
+        void UpdateByteCountSubscription(bool listening);
+        void OnByteCount(const ByteCountNotification &count);
 
         // TAP driver management
         bool IsTAPDriverInstalled();
-        bool InstallTAPDriver();
-        void EnsureTAPDriver();
+        bool InstallTAPDriver(const CommandContext &context);
+        void EnsureTAPDriver(const CommandContext &context);
         std::string GetTAPAdapterName();
 
         // Windows version and driver detection
         bool IsWindows11OrGreater();
         bool SupportsDCO();
+        // " --windows-driver ..." for this machine
+        std::string WindowsDriverOption();
         std::string CheckSecurityFeatures();
 
         // Bundled OpenVPN setup
@@ -70,9 +231,20 @@ namespace openvpn_dart
         // Plugin registrar
         flutter::PluginRegistrarWindows *registrar_;
 
-        // Event sink for status updates
+        // Event sink for status updates. The sink and draining |events_|
+        // belong to the platform thread.
         std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> event_sink_;
         std::mutex event_sink_mutex_;
+        std::atomic<bool> listening_;
+        EventQueue<flutter::EncodableValue> events_;
+        EventQueue<std::function<void()>> platform_tasks_;
+        std::mutex platform_tasks_mutex_;
+        HWND event_window_;
+        UINT drain_message_;
+        int window_proc_id_;
+        int64_t last_flush_ms_;
+        // Set when no drain message could be posted; the items stay queued
+        std::atomic<bool> wake_failed_;
 
         // OpenVPN process handle
         PROCESS_INFORMATION process_info_;
@@ -82,10 +254,117 @@ namespace openvpn_dart
         std::atomic<bool> is_connected_;
         std::atomic<bool> is_monitoring_;
         std::thread monitor_thread_;
-        std::thread log_thread_;
+        std::thread teardown_thread_;
+        std::atomic<bool> teardown_running_;
+        EventReactor reactor_;
         std::string current_status_;
         std::mutex status_mutex_;
 
+        // Management interface client, attached after OpenVPN starts. The
+        // pointer is guarded by |management_mutex_|; use Management().
+        std::mutex management_mutex_;
+        std::shared_ptr<ManagementClient> management_;
+        uint16_t management_port_;
+        std::string management_password_;
+        std::atomic<bool> management_active_;
+
+        // Byte counters from the management interface
+        TrafficStats traffic_stats_;
+        std::mutex stats_mutex_;
+        std::atomic<int> stats_interval_seconds_;
+
+        // Warm standby: OpenVPN parked in --management-hold for the staged
+        // profile, handed over by the next connect for the same profile
+        std::string standby_config_;
+        PROCESS_INFORMATION standby_info_;
+        HANDLE standby_pipe_read_;
+        HANDLE standby_pipe_write_;
+        uint16_t standby_port_;
+        std::string standby_password_;
+        int64_t standby_spawned_ms_;
+        std::unique_ptr<ManagementClient> standby_management_;
+        std::shared_ptr<std::atomic<bool>> standby_active_;
+        std::atomic<bool> standby_held_;
+        std::atomic<bool> shutting_down_;
+        ConnectTimer connect_timer_;
+
+        // Additional tunnels keyed by session ID, and the thread that waits
+        // on all of their processes and management sockets, started with the
+        // first of them
+        TunnelSessionManager sessions_;
+        EventReactor session_reactor_;
+        std::thread session_reactor_thread_;
+        // A session promoted to the default tunnel by switchServer; its
+        // output keeps draining into its own log until StopOutputCapture()
+        std::shared_ptr<TunnelSession> promoted_session_;
+        // Set while switchServer tears down the tunnel it replaces, so the
+        // default status stays up across the handover
+        std::atomic<bool> handover_;
+        uint64_t switch_count_;
+        // Profile the default tunnel was started with. Empty for a process
+        // reattached from the journal or started without the remote query,
+        // which may not query its remotes.
+        std::string running_config_;
+        // Server an in-place switch points the default tunnel at. Kept for
+        // the process's later reconnects; |remote_override_applied_| is set
+        // once OpenVPN has been told.
+        std::mutex remote_mutex_;
+        std::optional<ProfileRemote> remote_override_;
+        bool remote_override_applied_;
+
+        // Routes for the default tunnel, see TakeNativeRoutes. The options
+        // are guarded by |native_routes_mutex_|; the programmer has its own.
+        std::atomic<bool> native_routes_requested_;
+        std::mutex native_routes_mutex_;
+        bool native_routes_active_;
+        // Set once this connection's routes are in; the programmer may also
+        // hold routes an earlier removal failed to take out
+        bool native_routes_installed_;
+        // Set when installing failed; this process is on its way out
+        bool native_routes_failed_;
+        RouteOptions native_profile_routes_;
+        RouteOptions native_pushed_routes_;
+        bool native_push_more_;
+        NetGateway native_net_gateway_;
+        SystemRouteBackend route_backend_;
+        RouteProgrammer route_programmer_;
+
+        // Journal of the running session, rewritten on status changes
+        std::string journal_path_;
+        SessionRecord journal_;
+        bool journal_active_;
+        std::mutex journal_mutex_;
+
+        // OpenVPN output, read from |pipe_read_|. The drain's ring serves
+        // getRecentLogs; |output_log_| is an optional, size-bounded copy on
+        // disk written only by the drain thread.
+        PipeDrain output_drain_;
+        LogStatusTracker output_status_;
+        std::unique_ptr<RotatingLog> output_log_;
+        bool log_to_file_;
+
+        // The plugin's own log, written by the global AsyncLogger's thread
+        std::shared_ptr<RotatingLog> plugin_log_;
+
+        // Per-phase timings of recent connects
+        ConnectTimingRecorder connect_timings_;
+
+        // Background initialization; |ready_event_| (guarded by
+        // |event_sink_mutex_|) is replayed to listeners that attach late
+        std::thread init_thread_;
+        std::promise<void> ready_promise_;
+        std::shared_future<void> ready_;
+        flutter::EncodableMap ready_event_;
+        // Set when a journaled session died while the plugin was away
+        std::string last_session_end_;
+
+        // Serializes connect, disconnect, driver setup and the like off the
+        // platform thread
+        CommandExecutor commands_;
+
+        // Cached `openvpn --version` results for the bundled executable
+        std::unique_ptr<CapabilityCache> capability_cache_;
+
         // Paths
         std::string config_file_path_;
         std::string openvpn_executable_path_;
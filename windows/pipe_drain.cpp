@@ -0,0 +1,156 @@
+#include "pipe_drain.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "log_line_parser.h"
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    constexpr size_t kReadChunkSize = 16 * 1024;
+
+  } // namespace
+
+  LineRing::LineRing(size_t capacity)
+      : lines_(std::max<size_t>(capacity, 1)),
+        head_(0),
+        count_(0)
+  {
+  }
+
+  void LineRing::Push(std::string_view line)
+  {
+    lines_[head_].assign(line.data(), line.size());
+    head_ = (head_ + 1) % lines_.size();
+    count_ = std::min(count_ + 1, lines_.size());
+  }
+
+  std::vector<std::string> LineRing::Recent(size_t count) const
+  {
+    std::vector<std::string> recent;
+    recent.reserve(std::min(count, count_));
+    VisitRecent(count, [&recent](std::string_view line)
+                { recent.emplace_back(line); });
+    return recent;
+  }
+
+  void LineRing::VisitRecent(size_t count, const std::function<void(std::string_view)> &visit) const
+  {
+    count = std::min(count, count_);
+    for (size_t age = count; age > 0; age--)
+    {
+      visit(lines_[(head_ + lines_.size() - age) % lines_.size()]);
+    }
+  }
+
+  PipeDrain::PipeDrain(size_t ring_capacity, size_t max_line)
+      : max_line_(std::max<size_t>(max_line, 1)),
+        finished_(true),
+        ring_(ring_capacity),
+        lines_read_(0),
+        bytes_read_(0)
+  {
+  }
+
+  PipeDrain::~PipeDrain()
+  {
+    Join();
+  }
+
+  void PipeDrain::Start(ReadFn read, LineCallback on_line)
+  {
+    Join();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished_ = false;
+    }
+    thread_ = std::thread(&PipeDrain::Run, this, std::move(read), std::move(on_line));
+  }
+
+  bool PipeDrain::WaitFor(int timeout_ms)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return finished_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                 [this]()
+                                 { return finished_; });
+  }
+
+  void PipeDrain::Join()
+  {
+    if (thread_.joinable())
+    {
+      thread_.join();
+    }
+  }
+
+  std::vector<std::string> PipeDrain::RecentLines(size_t count) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ring_.Recent(count);
+  }
+
+  void PipeDrain::VisitRecentLines(size_t count, const LineCallback &visit) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ring_.VisitRecent(count, visit);
+  }
+
+  uint64_t PipeDrain::lines_read() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lines_read_;
+  }
+
+  uint64_t PipeDrain::bytes_read() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_read_;
+  }
+
+  void PipeDrain::Run(ReadFn read, LineCallback on_line)
+  {
+    std::vector<char> buffer(kReadChunkSize);
+    LineSplitter splitter(max_line_);
+    const auto deliver = [this, &on_line](std::string_view line)
+    {
+      Deliver(line, on_line);
+    };
+
+    while (true)
+    {
+      const int64_t n = read(buffer.data(), buffer.size());
+      if (n <= 0)
+      {
+        break;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bytes_read_ += static_cast<uint64_t>(n);
+      }
+      splitter.Feed(std::string_view(buffer.data(), static_cast<size_t>(n)), deliver);
+    }
+    splitter.Finish(deliver);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished_ = true;
+    finished_cv_.notify_all();
+  }
+
+  void PipeDrain::Deliver(std::string_view line, const LineCallback &on_line)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ring_.Push(line);
+      lines_read_++;
+    }
+    if (on_line)
+    {
+      on_line(line);
+    }
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,92 @@
+#ifndef FLUTTER_PLUGIN_PIPE_DRAIN_H_
+#define FLUTTER_PLUGIN_PIPE_DRAIN_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+    // Fixed number of recent lines. Slots are reused, so once warm the ring
+    // only allocates when a line outgrows the string it replaces.
+    class LineRing
+    {
+    public:
+        explicit LineRing(size_t capacity);
+
+        void Push(std::string_view line);
+
+        // Up to |count| newest lines, oldest first.
+        std::vector<std::string> Recent(size_t count) const;
+        void VisitRecent(size_t count, const std::function<void(std::string_view)> &visit) const;
+
+        size_t size() const { return count_; }
+        size_t capacity() const { return lines_.size(); }
+
+    private:
+        std::vector<std::string> lines_;
+        size_t head_;
+        size_t count_;
+    };
+
+    // Reads a child's stdout/stderr pipe on its own thread until end of
+    // stream, so the child never blocks on a full pipe buffer.
+    //
+    // Output is split into lines (without "\n" or "\r\n"); a line longer than
+    // |max_line| is delivered in pieces. Every line goes to the callback and
+    // into a LineRing of the newest |ring_capacity| lines.
+    class PipeDrain
+    {
+    public:
+        // Fills |buffer| and returns the byte count; 0 at end of stream and
+        // negative on error, both of which end the drain.
+        using ReadFn = std::function<int64_t(char *buffer, size_t size)>;
+        using LineCallback = std::function<void(std::string_view line)>;
+
+        explicit PipeDrain(size_t ring_capacity = 256, size_t max_line = 4096);
+        ~PipeDrain();
+
+        PipeDrain(const PipeDrain &) = delete;
+        PipeDrain &operator=(const PipeDrain &) = delete;
+
+        void Start(ReadFn read, LineCallback on_line);
+
+        // Waits up to |timeout_ms| for end of stream; true once finished.
+        bool WaitFor(int timeout_ms);
+        void Join();
+
+        // The reader thread, e.g. to cancel a blocked read before Join().
+        std::thread::native_handle_type native_handle() { return thread_.native_handle(); }
+
+        std::vector<std::string> RecentLines(size_t count) const;
+        // Like RecentLines() without copying; |visit| runs under the drain's
+        // lock, so it must not call back into the drain.
+        void VisitRecentLines(size_t count, const LineCallback &visit) const;
+        uint64_t lines_read() const;
+        uint64_t bytes_read() const;
+
+    private:
+        void Run(ReadFn read, LineCallback on_line);
+        void Deliver(std::string_view line, const LineCallback &on_line);
+
+        const size_t max_line_;
+        std::thread thread_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable finished_cv_;
+        bool finished_;
+        LineRing ring_;
+        uint64_t lines_read_;
+        uint64_t bytes_read_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_PIPE_DRAIN_H_
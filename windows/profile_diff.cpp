@@ -0,0 +1,223 @@
+#include "profile_diff.h"
+
+#include <utility>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    constexpr const char *kDefaultPort = "1194";
+    constexpr const char *kDefaultProto = "udp";
+
+    bool IsSpace(char c)
+    {
+      return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    std::vector<std::string> Tokens(std::string_view line)
+    {
+      std::vector<std::string> tokens;
+      size_t i = 0;
+      while (i < line.size())
+      {
+        while (i < line.size() && IsSpace(line[i]))
+        {
+          i++;
+        }
+        const size_t start = i;
+        while (i < line.size() && !IsSpace(line[i]))
+        {
+          i++;
+        }
+        if (i > start)
+        {
+          tokens.emplace_back(line.substr(start, i - start));
+        }
+      }
+      return tokens;
+    }
+
+    // A profile reduced to its directives, one token list per line
+    struct ParsedProfile
+    {
+      // Everything that is not remote/port/rport/proto, in order
+      std::vector<std::vector<std::string>> other;
+      std::vector<std::vector<std::string>> remote_lines;
+      std::string port = kDefaultPort;
+      std::string proto = kDefaultProto;
+      bool has_connection_blocks = false;
+    };
+
+    ParsedProfile Parse(std::string_view profile)
+    {
+      ParsedProfile parsed;
+      std::string rport;
+      // Inline blocks like <ca> hold data, not directives
+      std::string inline_block;
+      size_t pos = 0;
+      while (pos <= profile.size())
+      {
+        size_t end = profile.find('\n', pos);
+        if (end == std::string_view::npos)
+        {
+          end = profile.size();
+        }
+        std::vector<std::string> tokens = Tokens(profile.substr(pos, end - pos));
+        pos = end + 1;
+
+        if (tokens.empty())
+        {
+          continue;
+        }
+        const std::string &first = tokens[0];
+        if (!inline_block.empty())
+        {
+          if (first == "</" + inline_block + ">")
+          {
+            inline_block.clear();
+          }
+          parsed.other.push_back(std::move(tokens));
+          continue;
+        }
+        if (first[0] == '#' || first[0] == ';')
+        {
+          continue;
+        }
+        if (first.size() > 2 && first.front() == '<' && first.back() == '>' && first[1] != '/')
+        {
+          inline_block = first.substr(1, first.size() - 2);
+          if (inline_block == "connection")
+          {
+            parsed.has_connection_blocks = true;
+          }
+          parsed.other.push_back(std::move(tokens));
+          continue;
+        }
+
+        if (first == "remote")
+        {
+          parsed.remote_lines.push_back(std::move(tokens));
+        }
+        else if (first == "port" && tokens.size() > 1)
+        {
+          parsed.port = tokens[1];
+        }
+        else if (first == "rport" && tokens.size() > 1)
+        {
+          rport = tokens[1];
+        }
+        else if (first == "proto" && tokens.size() > 1)
+        {
+          parsed.proto = tokens[1];
+        }
+        else
+        {
+          parsed.other.push_back(std::move(tokens));
+        }
+      }
+      if (!rport.empty())
+      {
+        parsed.port = rport;
+      }
+      return parsed;
+    }
+
+    std::vector<ProfileRemote> Remotes(const ParsedProfile &parsed)
+    {
+      std::vector<ProfileRemote> remotes;
+      for (const auto &tokens : parsed.remote_lines)
+      {
+        if (tokens.size() < 2)
+        {
+          continue;
+        }
+        ProfileRemote remote;
+        remote.host = tokens[1];
+        remote.port = tokens.size() > 2 ? tokens[2] : parsed.port;
+        remote.proto = tokens.size() > 3 ? tokens[3] : parsed.proto;
+        remotes.push_back(std::move(remote));
+      }
+      return remotes;
+    }
+
+    bool SameRemote(const ProfileRemote &a, const ProfileRemote &b)
+    {
+      return a.host == b.host && a.port == b.port && ProtoFamily(a.proto) == ProtoFamily(b.proto);
+    }
+
+  } // namespace
+
+  std::vector<ProfileRemote> ParseRemotes(std::string_view profile)
+  {
+    return Remotes(Parse(profile));
+  }
+
+  std::string ProtoFamily(std::string_view proto)
+  {
+    const std::string_view suffix = "-client";
+    if (proto.size() > suffix.size() && proto.substr(proto.size() - suffix.size()) == suffix)
+    {
+      proto.remove_suffix(suffix.size());
+    }
+    if (!proto.empty() && (proto.back() == '4' || proto.back() == '6'))
+    {
+      proto.remove_suffix(1);
+    }
+    return std::string(proto);
+  }
+
+  ProfileChange CompareProfiles(std::string_view running, std::string_view updated,
+                                ProfileRemote *target)
+  {
+    const ParsedProfile old_profile = Parse(running);
+    const ParsedProfile new_profile = Parse(updated);
+    if (old_profile.other != new_profile.other)
+    {
+      return ProfileChange::kOther;
+    }
+
+    const std::vector<ProfileRemote> old_remotes = Remotes(old_profile);
+    const std::vector<ProfileRemote> new_remotes = Remotes(new_profile);
+    bool same = old_remotes.size() == new_remotes.size();
+    for (size_t i = 0; same && i < old_remotes.size(); i++)
+    {
+      same = SameRemote(old_remotes[i], new_remotes[i]);
+    }
+    if (same)
+    {
+      return ProfileChange::kSame;
+    }
+
+    // <connection> blocks carry per-entry options MOD cannot reach
+    if (new_remotes.empty() || old_profile.has_connection_blocks)
+    {
+      return ProfileChange::kOther;
+    }
+    const std::string family = ProtoFamily(new_remotes[0].proto);
+    for (const auto &remote : old_remotes)
+    {
+      if (ProtoFamily(remote.proto) == family)
+      {
+        *target = new_remotes[0];
+        return ProfileChange::kRemoteOnly;
+      }
+    }
+    return ProfileChange::kOther;
+  }
+
+  std::string RemoteQueryReply(std::string_view proto, const ProfileRemote *target)
+  {
+    if (!target)
+    {
+      return "remote ACCEPT";
+    }
+    if (ProtoFamily(proto) != ProtoFamily(target->proto))
+    {
+      return "remote SKIP";
+    }
+    return "remote MOD " + target->host + " " + target->port;
+  }
+
+} // namespace openvpn_dart
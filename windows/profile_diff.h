@@ -0,0 +1,51 @@
+#ifndef FLUTTER_PLUGIN_PROFILE_DIFF_H_
+#define FLUTTER_PLUGIN_PROFILE_DIFF_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+    // One "remote" entry of a client profile, with the profile's "port",
+    // "rport" and "proto" defaults filled in.
+    struct ProfileRemote
+    {
+        std::string host;
+        std::string port;
+        std::string proto;
+    };
+
+    // Remotes in profile order. Entries inside <connection> blocks are not
+    // included.
+    std::vector<ProfileRemote> ParseRemotes(std::string_view profile);
+
+    // "udp", "udp4", "udp6" -> "udp"; "tcp-client", "tcp6-client" -> "tcp".
+    // "remote MOD" can change the host and port of an entry but not its
+    // protocol, so entries are matched by family.
+    std::string ProtoFamily(std::string_view proto);
+
+    enum class ProfileChange
+    {
+        kSame,
+        // Only remote/port/rport/proto lines differ, and the running process
+        // has an entry it can be pointed at the new server with
+        kRemoteOnly,
+        kOther,
+    };
+
+    // Compares two profiles ignoring comments, blank lines and whitespace.
+    // On kRemoteOnly, |target| is the updated profile's first remote.
+    ProfileChange CompareProfiles(std::string_view running, std::string_view updated,
+                                  ProfileRemote *target);
+
+    // Answer to a --management-query-remote ">REMOTE:" query for an entry
+    // using |proto|: "remote ACCEPT" with no |target|, otherwise
+    // "remote MOD host port" for entries of the target's family and
+    // "remote SKIP" for the rest.
+    std::string RemoteQueryReply(std::string_view proto, const ProfileRemote *target);
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_PROFILE_DIFF_H_
@@ -0,0 +1,265 @@
+#include "reverse_log_scanner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    // Read-only view of a whole file.
+    class MappedFile
+    {
+    public:
+      MappedFile() = default;
+      MappedFile(const MappedFile &) = delete;
+      MappedFile &operator=(const MappedFile &) = delete;
+
+      ~MappedFile()
+      {
+#ifdef _WIN32
+        if (data_ != nullptr)
+        {
+          UnmapViewOfFile(data_);
+        }
+        if (mapping_ != nullptr)
+        {
+          CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE)
+        {
+          CloseHandle(file_);
+        }
+#else
+        if (data_ != nullptr)
+        {
+          munmap(const_cast<char *>(data_), static_cast<size_t>(size_));
+        }
+        if (fd_ >= 0)
+        {
+          close(fd_);
+        }
+#endif
+      }
+
+      // Maps |path| if it holds at least |min_size| bytes.
+      bool Open(const std::string &path, uint64_t min_size)
+      {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size;
+        if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size) ||
+            static_cast<uint64_t>(size.QuadPart) < min_size || size.QuadPart == 0)
+        {
+          return false;
+        }
+        size_ = static_cast<uint64_t>(size.QuadPart);
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_ == nullptr)
+        {
+          return false;
+        }
+        data_ = static_cast<const char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        return data_ != nullptr;
+#else
+        fd_ = open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd_ < 0 || fstat(fd_, &st) != 0 ||
+            static_cast<uint64_t>(st.st_size) < min_size || st.st_size == 0)
+        {
+          return false;
+        }
+        size_ = static_cast<uint64_t>(st.st_size);
+        void *data = mmap(nullptr, static_cast<size_t>(size_), PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (data == MAP_FAILED)
+        {
+          return false;
+        }
+        data_ = static_cast<const char *>(data);
+        return true;
+#endif
+      }
+
+      std::string_view view() const
+      {
+        return std::string_view(data_, static_cast<size_t>(size_));
+      }
+
+    private:
+#ifdef _WIN32
+      HANDLE file_ = INVALID_HANDLE_VALUE;
+      HANDLE mapping_ = nullptr;
+#else
+      int fd_ = -1;
+#endif
+      const char *data_ = nullptr;
+      uint64_t size_ = 0;
+    };
+
+    std::string_view TrimLineEnding(std::string_view line)
+    {
+      if (!line.empty() && line.back() == '\r')
+      {
+        line.remove_suffix(1);
+      }
+      return line;
+    }
+
+    // Splits lines out of the back of |block|, the bytes just before
+    // |*carry|. The block's first, possibly partial line is left prepended
+    // to |*carry| for the block before it. Returns false once |visit| stops.
+    bool VisitBlockBackward(std::string_view block, std::string *carry, bool *at_end,
+                            const ReverseLineScanner::Visitor &visit)
+    {
+      while (true)
+      {
+        const size_t newline = block.rfind('\n');
+        if (newline == std::string_view::npos)
+        {
+          carry->insert(0, block.data(), block.size());
+          return true;
+        }
+
+        std::string_view line = block.substr(newline + 1);
+        if (!carry->empty())
+        {
+          carry->insert(0, line.data(), line.size());
+          line = *carry;
+        }
+        line = TrimLineEnding(line);
+        // A final newline does not start another line
+        const bool skip = *at_end && line.empty();
+        *at_end = false;
+        if (!skip && !visit(line))
+        {
+          return false;
+        }
+        carry->clear();
+        block = block.substr(0, newline);
+      }
+    }
+
+  } // namespace
+
+  ReverseLineScanner::ReverseLineScanner(size_t block_size, uint64_t map_threshold)
+      : block_size_(std::max<size_t>(block_size, 1)),
+        map_threshold_(map_threshold),
+        bytes_examined_(0),
+        mapped_(false)
+  {
+  }
+
+  bool ReverseLineScanner::Scan(const std::string &path, const Visitor &visit)
+  {
+    bytes_examined_ = 0;
+    mapped_ = false;
+    if (ScanMapped(path, visit))
+    {
+      return true;
+    }
+    return ScanBlocks(path, visit);
+  }
+
+  bool ReverseLineScanner::ScanMapped(const std::string &path, const Visitor &visit)
+  {
+    MappedFile file;
+    if (!file.Open(path, map_threshold_))
+    {
+      return false;
+    }
+    mapped_ = true;
+
+    const std::string_view data = file.view();
+    std::string carry;
+    bool at_end = true;
+    // Track how far back the visitor got through the lines it was shown
+    uint64_t line_start = data.size();
+    const Visitor counting = [&](std::string_view line)
+    {
+      line_start = static_cast<uint64_t>(line.data() - data.data());
+      return visit(line);
+    };
+    if (VisitBlockBackward(data, &carry, &at_end, counting) && !carry.empty())
+    {
+      line_start = 0;
+      visit(TrimLineEnding(carry));
+    }
+    bytes_examined_ = data.size() - std::min<uint64_t>(line_start, data.size());
+    return true;
+  }
+
+  bool ReverseLineScanner::ScanBlocks(const std::string &path, const Visitor &visit)
+  {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+      return false;
+    }
+    file.seekg(0, std::ios::end);
+    const std::streamoff end = file.tellg();
+    if (end <= 0)
+    {
+      return end == 0;
+    }
+
+    std::vector<char> buffer(block_size_);
+    std::string carry;
+    bool at_end = true;
+    uint64_t position = static_cast<uint64_t>(end);
+    while (position > 0)
+    {
+      const size_t want = static_cast<size_t>(std::min<uint64_t>(position, block_size_));
+      position -= want;
+      file.seekg(static_cast<std::streamoff>(position), std::ios::beg);
+      file.read(buffer.data(), static_cast<std::streamsize>(want));
+      if (file.gcount() != static_cast<std::streamsize>(want))
+      {
+        break;
+      }
+      bytes_examined_ += want;
+      if (!VisitBlockBackward(std::string_view(buffer.data(), want), &carry, &at_end, visit))
+      {
+        return true;
+      }
+    }
+    if (!carry.empty())
+    {
+      visit(TrimLineEnding(carry));
+    }
+    return true;
+  }
+
+  bool FindLastLogLine(const std::string &path, LogEventMask events, LastLogLine *found)
+  {
+    const LogSignatureMatcher &matcher = LogSignatureMatcher::Default();
+    bool matched = false;
+    ReverseLineScanner scanner;
+    scanner.Scan(path, [&](std::string_view line)
+                 {
+                   const LogEventMask line_events = matcher.Match(line) & events;
+                   if (line_events == 0)
+                   {
+                     return true;
+                   }
+                   found->line.assign(line.data(), line.size());
+                   found->events = line_events;
+                   matched = true;
+                   return false; });
+    return matched;
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,62 @@
+#ifndef FLUTTER_PLUGIN_REVERSE_LOG_SCANNER_H_
+#define FLUTTER_PLUGIN_REVERSE_LOG_SCANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "log_signatures.h"
+
+namespace openvpn_dart
+{
+
+    // Reads a file's lines from the last to the first, stopping as soon as
+    // the visitor has seen enough, so finding the newest line of interest
+    // costs the same however much older output precedes it.
+    //
+    // Files of at least |map_threshold| bytes are memory-mapped and scanned
+    // in place; smaller ones, or files that cannot be mapped, are read in
+    // blocks of |block_size| from the end.
+    class ReverseLineScanner
+    {
+    public:
+        // Receives lines without "\n" or "\r\n"; returns false to stop.
+        using Visitor = std::function<bool(std::string_view line)>;
+
+        explicit ReverseLineScanner(size_t block_size = 64 * 1024,
+                                    uint64_t map_threshold = 4 * 1024 * 1024);
+
+        // Returns false if |path| could not be opened.
+        bool Scan(const std::string &path, const Visitor &visit);
+
+        // Bytes from the end of the file the last Scan() had to look at.
+        uint64_t bytes_examined() const { return bytes_examined_; }
+        // Whether the last Scan() used a mapping.
+        bool mapped() const { return mapped_; }
+
+    private:
+        bool ScanMapped(const std::string &path, const Visitor &visit);
+        bool ScanBlocks(const std::string &path, const Visitor &visit);
+
+        const size_t block_size_;
+        const uint64_t map_threshold_;
+        uint64_t bytes_examined_;
+        bool mapped_;
+    };
+
+    struct LastLogLine
+    {
+        std::string line;
+        // Events of |line|, within the requested set
+        LogEventMask events = 0;
+    };
+
+    // The newest line of |path| carrying any of |events|. Returns false if
+    // there is none or the file cannot be read.
+    bool FindLastLogLine(const std::string &path, LogEventMask events, LastLogLine *found);
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_REVERSE_LOG_SCANNER_H_
@@ -0,0 +1,156 @@
+#include "rotating_log.h"
+
+#include <filesystem>
+#include <system_error>
+
+namespace openvpn_dart
+{
+
+  RotatingLog::RotatingLog(std::string path, uint64_t max_segment_bytes, size_t max_archives,
+                           Archiver archiver)
+      : path_(std::move(path)),
+        max_segment_bytes_(max_segment_bytes),
+        max_archives_(max_archives),
+        archiver_(std::move(archiver)),
+        segment_bytes_(0),
+        rotations_(0),
+        archiver_busy_(false),
+        stopping_(false)
+  {
+    if (archiver_)
+    {
+      archiver_thread_ = std::thread(&RotatingLog::RunArchiver, this);
+    }
+  }
+
+  RotatingLog::~RotatingLog()
+  {
+    Close();
+    if (archiver_thread_.joinable())
+    {
+      {
+        std::lock_guard<std::mutex> lock(archiver_mutex_);
+        stopping_ = true;
+      }
+      archiver_cv_.notify_all();
+      archiver_thread_.join();
+    }
+  }
+
+  std::string RotatingLog::ArchivePath(const std::string &path, size_t index)
+  {
+    return path + "." + std::to_string(index);
+  }
+
+  bool RotatingLog::Open()
+  {
+    Close();
+    std::error_code ec;
+    if (std::filesystem::file_size(path_, ec) > 0 && !ec)
+    {
+      Rotate();
+    }
+    out_.open(path_, std::ios::out | std::ios::trunc | std::ios::binary);
+    segment_bytes_ = 0;
+    return out_.is_open();
+  }
+
+  void RotatingLog::Close()
+  {
+    if (out_.is_open())
+    {
+      out_.close();
+    }
+  }
+
+  void RotatingLog::Write(std::string_view line)
+  {
+    if (!out_.is_open())
+    {
+      return;
+    }
+    if (segment_bytes_ > 0 && segment_bytes_ + line.size() + 1 > max_segment_bytes_)
+    {
+      out_.close();
+      Rotate();
+      out_.open(path_, std::ios::out | std::ios::trunc | std::ios::binary);
+      segment_bytes_ = 0;
+    }
+    out_.write(line.data(), static_cast<std::streamsize>(line.size()));
+    out_.put('\n');
+    out_.flush();
+    segment_bytes_ += line.size() + 1;
+  }
+
+  void RotatingLog::Rotate()
+  {
+    std::error_code ec;
+    if (max_archives_ == 0)
+    {
+      std::filesystem::remove(path_, ec);
+      return;
+    }
+
+    std::filesystem::remove(ArchivePath(path_, max_archives_), ec);
+    for (size_t index = max_archives_ - 1; index >= 1; index--)
+    {
+      const std::string from = ArchivePath(path_, index);
+      if (std::filesystem::exists(from, ec))
+      {
+        std::filesystem::rename(from, ArchivePath(path_, index + 1), ec);
+      }
+    }
+    std::filesystem::rename(path_, ArchivePath(path_, 1), ec);
+    if (ec)
+    {
+      // Keep the budget even if the segment could not be archived
+      std::filesystem::remove(path_, ec);
+      return;
+    }
+    rotations_++;
+
+    if (archiver_)
+    {
+      {
+        std::lock_guard<std::mutex> lock(archiver_mutex_);
+        archive_queue_.push_back(ArchivePath(path_, 1));
+      }
+      archiver_cv_.notify_all();
+    }
+  }
+
+  void RotatingLog::WaitForArchiver()
+  {
+    std::unique_lock<std::mutex> lock(archiver_mutex_);
+    archiver_cv_.wait(lock, [this]()
+                      { return archive_queue_.empty() && !archiver_busy_; });
+  }
+
+  void RotatingLog::RunArchiver()
+  {
+    std::unique_lock<std::mutex> lock(archiver_mutex_);
+    while (true)
+    {
+      archiver_cv_.wait(lock, [this]()
+                        { return stopping_ || !archive_queue_.empty(); });
+      if (archive_queue_.empty())
+      {
+        return;
+      }
+      const std::string segment = std::move(archive_queue_.front());
+      archive_queue_.pop_front();
+      archiver_busy_ = true;
+      lock.unlock();
+
+      // Quick rotations may have shifted the segment to a higher index by
+      // now; the archiver then processes the newer segment under this name,
+      // which is queued anyway
+      archiver_(segment);
+
+      lock.lock();
+      archiver_busy_ = false;
+      archiver_cv_.notify_all();
+    }
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,80 @@
+#ifndef FLUTTER_PLUGIN_ROTATING_LOG_H_
+#define FLUTTER_PLUGIN_ROTATING_LOG_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace openvpn_dart
+{
+
+    // A line log on disk that never outgrows a fixed budget.
+    //
+    // Lines go to |path| until it reaches |max_segment_bytes|; the segment is
+    // then archived as "<path>.1", older archives shift to ".2" and so on,
+    // and anything beyond |max_archives| is deleted. Each freshly archived
+    // segment is handed to |archiver| (e.g. to compress it) on a background
+    // thread so writing never waits for it.
+    //
+    // Write() is meant for a single writer thread.
+    class RotatingLog
+    {
+    public:
+        using Archiver = std::function<void(const std::string &segment_path)>;
+
+        RotatingLog(std::string path, uint64_t max_segment_bytes, size_t max_archives,
+                    Archiver archiver = nullptr);
+        ~RotatingLog();
+
+        RotatingLog(const RotatingLog &) = delete;
+        RotatingLog &operator=(const RotatingLog &) = delete;
+
+        // Starts a fresh segment; a non-empty one left from before is
+        // archived first, so the previous session stays readable.
+        bool Open();
+        void Close();
+        bool is_open() const { return out_.is_open(); }
+
+        // Appends |line| and a newline, flushed so readers of the file see
+        // it at once.
+        void Write(std::string_view line);
+
+        // Blocks until the archiver has processed every rotated segment.
+        void WaitForArchiver();
+
+        static std::string ArchivePath(const std::string &path, size_t index);
+        const std::string &path() const { return path_; }
+        uint64_t segment_bytes() const { return segment_bytes_; }
+        uint64_t rotations() const { return rotations_; }
+
+    private:
+        void Rotate();
+        void RunArchiver();
+
+        const std::string path_;
+        const uint64_t max_segment_bytes_;
+        const size_t max_archives_;
+        const Archiver archiver_;
+
+        std::ofstream out_;
+        uint64_t segment_bytes_;
+        uint64_t rotations_;
+
+        std::thread archiver_thread_;
+        std::mutex archiver_mutex_;
+        std::condition_variable archiver_cv_;
+        std::deque<std::string> archive_queue_;
+        bool archiver_busy_;
+        bool stopping_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_ROTATING_LOG_H_
@@ -0,0 +1,548 @@
+#include "route_aggregation.h"
+
+#include <cstdio>
+#include <map>
+#include <utility>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    bool IsSpace(char c)
+    {
+      return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    std::vector<std::string_view> Tokens(std::string_view line)
+    {
+      std::vector<std::string_view> tokens;
+      size_t i = 0;
+      while (i < line.size())
+      {
+        while (i < line.size() && IsSpace(line[i]))
+        {
+          i++;
+        }
+        const size_t start = i;
+        while (i < line.size() && !IsSpace(line[i]))
+        {
+          i++;
+        }
+        if (i > start)
+        {
+          tokens.push_back(line.substr(start, i - start));
+        }
+      }
+      return tokens;
+    }
+
+    bool ParseDecimal(std::string_view text, unsigned max, unsigned *out)
+    {
+      if (text.empty() || text.size() > 3)
+      {
+        return false;
+      }
+      unsigned value = 0;
+      for (char c : text)
+      {
+        if (c < '0' || c > '9')
+        {
+          return false;
+        }
+        value = value * 10 + static_cast<unsigned>(c - '0');
+      }
+      if (value > max)
+      {
+        return false;
+      }
+      *out = value;
+      return true;
+    }
+
+    bool ParseIpv4Address(std::string_view text, uint32_t *out)
+    {
+      uint32_t address = 0;
+      for (int i = 0; i < 4; i++)
+      {
+        const size_t dot = text.find('.');
+        if ((i < 3) == (dot == std::string_view::npos))
+        {
+          return false;
+        }
+        unsigned octet = 0;
+        if (!ParseDecimal(text.substr(0, dot), 255, &octet))
+        {
+          return false;
+        }
+        address = (address << 8) | octet;
+        text = i < 3 ? text.substr(dot + 1) : std::string_view();
+      }
+      *out = address;
+      return true;
+    }
+
+    int HexDigit(char c)
+    {
+      if (c >= '0' && c <= '9')
+      {
+        return c - '0';
+      }
+      if (c >= 'a' && c <= 'f')
+      {
+        return c - 'a' + 10;
+      }
+      if (c >= 'A' && c <= 'F')
+      {
+        return c - 'A' + 10;
+      }
+      return -1;
+    }
+
+    // Colon-separated groups; empty text is no groups
+    bool ParseIpv6Groups(std::string_view text, std::vector<uint16_t> *groups)
+    {
+      if (text.empty())
+      {
+        return true;
+      }
+      while (true)
+      {
+        const size_t colon = text.find(':');
+        const std::string_view group = text.substr(0, colon);
+        if (group.empty() || group.size() > 4)
+        {
+          return false;
+        }
+        unsigned value = 0;
+        for (char c : group)
+        {
+          const int digit = HexDigit(c);
+          if (digit < 0)
+          {
+            return false;
+          }
+          value = (value << 4) | static_cast<unsigned>(digit);
+        }
+        groups->push_back(static_cast<uint16_t>(value));
+        if (colon == std::string_view::npos)
+        {
+          return true;
+        }
+        text = text.substr(colon + 1);
+      }
+    }
+
+    bool HostBitsClear(const RoutePrefix &prefix, int address_bits)
+    {
+      for (int bit = prefix.length; bit < address_bits; bit++)
+      {
+        if (prefix.address[bit / 8] & (0x80 >> (bit % 8)))
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Route lines of one family and the set they reduce to
+    struct RouteFamily
+    {
+      explicit RouteFamily(int address_bits) : trie(address_bits) {}
+
+      RouteTrie trie;
+      std::map<std::string, uint32_t> label_ids;
+      std::vector<std::string> labels;
+      std::vector<size_t> lines;
+
+      uint32_t Label(const std::vector<std::string_view> &tokens, size_t first)
+      {
+        std::string label;
+        for (size_t i = first; i < tokens.size(); i++)
+        {
+          if (!label.empty())
+          {
+            label += ' ';
+          }
+          label += tokens[i];
+        }
+        auto it = label_ids.find(label);
+        if (it != label_ids.end())
+        {
+          return it->second;
+        }
+        const uint32_t id = static_cast<uint32_t>(labels.size());
+        label_ids.emplace(label, id);
+        labels.push_back(std::move(label));
+        return id;
+      }
+    };
+
+  } // namespace
+
+  bool ParseIpv4Route(std::string_view network, std::string_view netmask, RoutePrefix *out)
+  {
+    uint32_t address = 0;
+    uint32_t mask = 0xFFFFFFFFu;
+    if (!ParseIpv4Address(network, &address) || (!netmask.empty() && !ParseIpv4Address(netmask, &mask)))
+    {
+      return false;
+    }
+    // Contiguous: the inverted mask plus one is a power of two (or zero)
+    const uint32_t host = ~mask;
+    if ((host & (host + 1)) != 0 || (address & host) != 0)
+    {
+      return false;
+    }
+    RoutePrefix prefix;
+    for (int i = 0; i < 4; i++)
+    {
+      prefix.address[i] = static_cast<uint8_t>(address >> (24 - 8 * i));
+    }
+    prefix.length = 0;
+    for (uint32_t m = mask; m != 0; m <<= 1)
+    {
+      prefix.length++;
+    }
+    *out = prefix;
+    return true;
+  }
+
+  bool ParseIpv6Route(std::string_view cidr, RoutePrefix *out)
+  {
+    RoutePrefix prefix;
+    prefix.length = 128;
+    const size_t slash = cidr.find('/');
+    if (slash != std::string_view::npos)
+    {
+      unsigned length = 0;
+      if (!ParseDecimal(cidr.substr(slash + 1), 128, &length))
+      {
+        return false;
+      }
+      prefix.length = static_cast<int>(length);
+      cidr = cidr.substr(0, slash);
+    }
+
+    std::vector<uint16_t> head;
+    std::vector<uint16_t> tail;
+    const size_t gap = cidr.find("::");
+    if (gap == std::string_view::npos)
+    {
+      if (!ParseIpv6Groups(cidr, &head) || head.size() != 8)
+      {
+        return false;
+      }
+    }
+    else if (cidr.find("::", gap + 1) != std::string_view::npos ||
+             !ParseIpv6Groups(cidr.substr(0, gap), &head) ||
+             !ParseIpv6Groups(cidr.substr(gap + 2), &tail) || head.size() + tail.size() > 7)
+    {
+      return false;
+    }
+
+    std::array<uint16_t, 8> groups{};
+    for (size_t i = 0; i < head.size(); i++)
+    {
+      groups[i] = head[i];
+    }
+    for (size_t i = 0; i < tail.size(); i++)
+    {
+      groups[8 - tail.size() + i] = tail[i];
+    }
+    for (int i = 0; i < 8; i++)
+    {
+      prefix.address[2 * i] = static_cast<uint8_t>(groups[i] >> 8);
+      prefix.address[2 * i + 1] = static_cast<uint8_t>(groups[i]);
+    }
+    if (!HostBitsClear(prefix, 128))
+    {
+      return false;
+    }
+    *out = prefix;
+    return true;
+  }
+
+  std::string FormatIpv4Address(const RoutePrefix &prefix)
+  {
+    char text[16];
+    std::snprintf(text, sizeof(text), "%u.%u.%u.%u", prefix.address[0], prefix.address[1],
+                  prefix.address[2], prefix.address[3]);
+    return text;
+  }
+
+  std::string FormatIpv4Netmask(int length)
+  {
+    RoutePrefix mask;
+    for (int bit = 0; bit < length; bit++)
+    {
+      mask.address[bit / 8] |= static_cast<uint8_t>(0x80 >> (bit % 8));
+    }
+    return FormatIpv4Address(mask);
+  }
+
+  std::string FormatIpv6Route(const RoutePrefix &prefix)
+  {
+    uint16_t groups[8];
+    for (int i = 0; i < 8; i++)
+    {
+      groups[i] = static_cast<uint16_t>((prefix.address[2 * i] << 8) | prefix.address[2 * i + 1]);
+    }
+    // The first longest run of two or more zero groups becomes "::"
+    int run_start = -1;
+    int run_length = 1;
+    for (int i = 0; i < 8;)
+    {
+      int j = i;
+      while (j < 8 && groups[j] == 0)
+      {
+        j++;
+      }
+      if (j - i > run_length)
+      {
+        run_start = i;
+        run_length = j - i;
+      }
+      i = j == i ? i + 1 : j;
+    }
+
+    std::string text;
+    char group[8];
+    for (int i = 0; i < 8; i++)
+    {
+      if (i == run_start)
+      {
+        text += "::";
+        i += run_length - 1;
+        continue;
+      }
+      if (!text.empty() && text.back() != ':')
+      {
+        text += ':';
+      }
+      std::snprintf(group, sizeof(group), "%x", groups[i]);
+      text += group;
+    }
+    return text + "/" + std::to_string(prefix.length);
+  }
+
+  RouteTrie::RouteTrie(int address_bits)
+      : address_bits_(address_bits),
+        nodes_(1),
+        added_(0),
+        conflicting_(false)
+  {
+  }
+
+  void RouteTrie::Add(const RoutePrefix &prefix, uint32_t label)
+  {
+    int32_t node = 0;
+    for (int bit = 0; bit < prefix.length && bit < address_bits_; bit++)
+    {
+      const int side = (prefix.address[bit / 8] >> (7 - bit % 8)) & 1;
+      if (nodes_[node].child[side] < 0)
+      {
+        nodes_[node].child[side] = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+      }
+      node = nodes_[node].child[side];
+    }
+    if (nodes_[node].label != kNoLabel && nodes_[node].label != label)
+    {
+      conflicting_ = true;
+    }
+    nodes_[node].label = label;
+    added_++;
+  }
+
+  std::vector<LabeledRoute> RouteTrie::Aggregate()
+  {
+    Merge(0);
+    DropCovered(0, kNoLabel);
+    std::vector<LabeledRoute> routes;
+    RoutePrefix prefix;
+    Collect(0, &prefix, &routes);
+    return routes;
+  }
+
+  void RouteTrie::Merge(int32_t node)
+  {
+    const int32_t left = nodes_[node].child[0];
+    const int32_t right = nodes_[node].child[1];
+    if (left >= 0)
+    {
+      Merge(left);
+    }
+    if (right >= 0)
+    {
+      Merge(right);
+    }
+    // Both halves go the same way, so the whole prefix does; a route of
+    // this node's own is shadowed by them. Halves of everything (0/1 and
+    // 128/1) stay apart: they exist to outrank the default route.
+    if (node != 0 && left >= 0 && right >= 0 && nodes_[left].label != kNoLabel &&
+        nodes_[left].label == nodes_[right].label)
+    {
+      nodes_[node].label = nodes_[left].label;
+      nodes_[left].label = kNoLabel;
+      nodes_[right].label = kNoLabel;
+    }
+  }
+
+  void RouteTrie::DropCovered(int32_t node, uint32_t inherited)
+  {
+    Node &current = nodes_[node];
+    if (current.label == inherited)
+    {
+      current.label = kNoLabel;
+    }
+    const uint32_t effective = current.label != kNoLabel ? current.label : inherited;
+    for (int32_t child : current.child)
+    {
+      if (child >= 0)
+      {
+        DropCovered(child, effective);
+      }
+    }
+  }
+
+  void RouteTrie::Collect(int32_t node, RoutePrefix *prefix, std::vector<LabeledRoute> *out) const
+  {
+    if (nodes_[node].label != kNoLabel)
+    {
+      out->push_back(LabeledRoute{*prefix, nodes_[node].label});
+    }
+    const int depth = prefix->length;
+    for (int side = 0; side < 2; side++)
+    {
+      const int32_t child = nodes_[node].child[side];
+      if (child < 0)
+      {
+        continue;
+      }
+      const uint8_t bit = static_cast<uint8_t>(0x80 >> (depth % 8));
+      if (side)
+      {
+        prefix->address[depth / 8] |= bit;
+      }
+      prefix->length = depth + 1;
+      Collect(child, prefix, out);
+      prefix->address[depth / 8] &= static_cast<uint8_t>(~bit);
+      prefix->length = depth;
+    }
+  }
+
+  std::string AggregateRoutes(std::string_view profile, RouteAggregationReport *report)
+  {
+    // Lines with their terminators, so untouched ones are copied exactly
+    std::vector<std::string_view> lines;
+    for (size_t pos = 0; pos < profile.size();)
+    {
+      size_t end = profile.find('\n', pos);
+      end = end == std::string_view::npos ? profile.size() : end + 1;
+      lines.push_back(profile.substr(pos, end - pos));
+      pos = end;
+    }
+    const char *newline = profile.find("\r\n") != std::string_view::npos ? "\r\n" : "\n";
+
+    RouteFamily ipv4(32);
+    RouteFamily ipv6(128);
+    bool in_inline_block = false;
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+      const std::vector<std::string_view> tokens = Tokens(lines[i].substr(0, lines[i].find('\n')));
+      if (tokens.empty())
+      {
+        continue;
+      }
+      const std::string_view first = tokens[0];
+      if (in_inline_block)
+      {
+        in_inline_block = first.substr(0, 2) != "</";
+        continue;
+      }
+      if (first.size() > 2 && first.front() == '<' && first.back() == '>')
+      {
+        in_inline_block = true;
+        continue;
+      }
+
+      RoutePrefix prefix;
+      if (first == "route" && tokens.size() >= 2 &&
+          ParseIpv4Route(tokens[1], tokens.size() > 2 ? tokens[2] : std::string_view(), &prefix))
+      {
+        ipv4.trie.Add(prefix, ipv4.Label(tokens, 3));
+        ipv4.lines.push_back(i);
+      }
+      else if (first == "route-ipv6" && tokens.size() >= 2 && ParseIpv6Route(tokens[1], &prefix))
+      {
+        ipv6.trie.Add(prefix, ipv6.Label(tokens, 2));
+        ipv6.lines.push_back(i);
+      }
+    }
+
+    // Replacement text for each family, written at its first route line
+    std::map<size_t, std::string> replacements;
+    std::vector<bool> dropped(lines.size(), false);
+    auto reduce = [&](RouteFamily &family, bool is_ipv4, size_t *before, size_t *after)
+    {
+      *before = family.lines.size();
+      *after = family.lines.size();
+      if (family.lines.empty() || family.trie.conflicting())
+      {
+        return;
+      }
+      const std::vector<LabeledRoute> routes = family.trie.Aggregate();
+      if (routes.size() >= family.lines.size())
+      {
+        return;
+      }
+      *after = routes.size();
+      std::string text;
+      for (const LabeledRoute &route : routes)
+      {
+        if (is_ipv4)
+        {
+          text += "route " + FormatIpv4Address(route.prefix) + " " + FormatIpv4Netmask(route.prefix.length);
+        }
+        else
+        {
+          text += "route-ipv6 " + FormatIpv6Route(route.prefix);
+        }
+        const std::string &label = family.labels[route.label];
+        if (!label.empty())
+        {
+          text += " " + label;
+        }
+        text += newline;
+      }
+      for (size_t line : family.lines)
+      {
+        dropped[line] = true;
+      }
+      replacements[family.lines.front()] = std::move(text);
+    };
+    RouteAggregationReport counts;
+    reduce(ipv4, true, &counts.ipv4_before, &counts.ipv4_after);
+    reduce(ipv6, false, &counts.ipv6_before, &counts.ipv6_after);
+    *report = counts;
+
+    std::string result;
+    result.reserve(profile.size());
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+      auto replacement = replacements.find(i);
+      if (replacement != replacements.end())
+      {
+        result += replacement->second;
+      }
+      else if (!dropped[i])
+      {
+        result += lines[i];
+      }
+    }
+    return result;
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,92 @@
+#ifndef FLUTTER_PLUGIN_ROUTE_AGGREGATION_H_
+#define FLUTTER_PLUGIN_ROUTE_AGGREGATION_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+    // One CIDR block; IPv4 uses the first 4 bytes of |address|.
+    struct RoutePrefix
+    {
+        std::array<uint8_t, 16> address{};
+        int length = 0;
+    };
+
+    // Numeric forms only; hostnames and keywords such as "vpn_gateway" fail.
+    // Non-contiguous masks and host bits outside the prefix also fail.
+    bool ParseIpv4Route(std::string_view network, std::string_view netmask, RoutePrefix *out);
+    bool ParseIpv6Route(std::string_view cidr, RoutePrefix *out);
+    std::string FormatIpv4Address(const RoutePrefix &prefix);
+    std::string FormatIpv4Netmask(int length);
+    // RFC 5952 form with "/length"
+    std::string FormatIpv6Route(const RoutePrefix &prefix);
+
+    struct LabeledRoute
+    {
+        RoutePrefix prefix;
+        uint32_t label = 0;
+    };
+
+    // Minimal route set with the same longest-prefix-match result as the
+    // routes added. Each route carries a label (its gateway and metric);
+    // routes only merge with routes of the same label.
+    //
+    // Two sibling prefixes with one label become their parent, except into
+    // a /0, and a route whose nearest covering route has its label is
+    // dropped. Adding the same prefix with two labels marks the set
+    // conflicting.
+    class RouteTrie
+    {
+    public:
+        explicit RouteTrie(int address_bits);
+
+        void Add(const RoutePrefix &prefix, uint32_t label);
+        bool conflicting() const { return conflicting_; }
+        size_t added() const { return added_; }
+
+        // Merges in place; the remaining routes in address order
+        std::vector<LabeledRoute> Aggregate();
+
+    private:
+        static constexpr uint32_t kNoLabel = UINT32_MAX;
+
+        struct Node
+        {
+            int32_t child[2] = {-1, -1};
+            uint32_t label = kNoLabel;
+        };
+
+        void Merge(int32_t node);
+        void DropCovered(int32_t node, uint32_t inherited);
+        void Collect(int32_t node, RoutePrefix *prefix, std::vector<LabeledRoute> *out) const;
+
+        const int address_bits_;
+        std::vector<Node> nodes_;
+        size_t added_;
+        bool conflicting_;
+    };
+
+    struct RouteAggregationReport
+    {
+        size_t ipv4_before = 0;
+        size_t ipv4_after = 0;
+        size_t ipv6_before = 0;
+        size_t ipv6_after = 0;
+    };
+
+    // Rewrites the numeric route/route-ipv6 lines of |profile| as the
+    // minimal equivalent set, written where the first of them was. Other
+    // lines, including routes to hostnames or gateway keywords as the
+    // network, are kept as they are. A family with conflicting routes is
+    // left untouched.
+    std::string AggregateRoutes(std::string_view profile, RouteAggregationReport *report);
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_ROUTE_AGGREGATION_H_
@@ -0,0 +1,382 @@
+#include "route_options.h"
+
+#include <utility>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    constexpr std::string_view kPushReply = "PUSH_REPLY,";
+    constexpr std::string_view kRouteGateway = "ROUTE_GATEWAY ";
+    constexpr std::string_view kRoute6Gateway = "ROUTE6_GATEWAY ";
+
+    bool IsSpace(char c)
+    {
+      return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    std::vector<std::string> Tokens(std::string_view line)
+    {
+      std::vector<std::string> tokens;
+      size_t i = 0;
+      while (i < line.size())
+      {
+        while (i < line.size() && IsSpace(line[i]))
+        {
+          i++;
+        }
+        const size_t start = i;
+        while (i < line.size() && !IsSpace(line[i]))
+        {
+          i++;
+        }
+        if (i > start)
+        {
+          tokens.emplace_back(line.substr(start, i - start));
+        }
+      }
+      return tokens;
+    }
+
+    bool IsNumber(const std::string &text)
+    {
+      if (text.empty() || text.size() > 9)
+      {
+        return false;
+      }
+      for (char c : text)
+      {
+        if (c < '0' || c > '9')
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // A gateway argument that means "the VPN's gateway"
+    bool IsVpnGateway(const std::string &gateway)
+    {
+      return gateway.empty() || gateway == "vpn_gateway" || gateway == "default";
+    }
+
+    // Records one option; true if it is a routing option
+    bool AddOption(const std::vector<std::string> &tokens, RouteOptions *options)
+    {
+      if (tokens.empty())
+      {
+        return false;
+      }
+      const std::string &name = tokens[0];
+      const std::vector<std::string> args(tokens.begin() + 1, tokens.end());
+      if (name == "route" && !args.empty())
+      {
+        options->routes.push_back(args);
+      }
+      else if (name == "route-ipv6" && !args.empty())
+      {
+        options->ipv6_routes.push_back(args);
+      }
+      else if (name == "route-gateway" && !args.empty())
+      {
+        options->route_gateway = args[0];
+      }
+      else if (name == "route-metric" && !args.empty())
+      {
+        options->route_metric = args[0];
+      }
+      else if (name == "topology" && !args.empty())
+      {
+        options->topology = args[0];
+      }
+      else if (name == "ifconfig" && args.size() > 1)
+      {
+        options->ifconfig_remote = args[1];
+      }
+      else if (name == "ifconfig-ipv6" && args.size() > 1)
+      {
+        options->ifconfig_ipv6_remote = args[1];
+      }
+      else
+      {
+        return false;
+      }
+      return true;
+    }
+
+    // Whether ResolveRoutes can install this "route"/"route-ipv6" itself
+    bool Installable(const std::vector<std::string> &args, bool ipv6)
+    {
+      RoutePrefix prefix;
+      IpAddress address;
+      const size_t gateway_at = ipv6 ? 1 : 2;
+      if (ipv6 ? !ParseIpv6Route(args[0], &prefix)
+               : !ParseIpv4Route(args[0], args.size() > 1 ? args[1] : std::string(), &prefix))
+      {
+        return false;
+      }
+      if (args.size() > gateway_at && !IsVpnGateway(args[gateway_at]) &&
+          (!ParseIpAddress(args[gateway_at], &address) || address.ipv6 != ipv6))
+      {
+        return false;
+      }
+      return args.size() <= gateway_at + 1 || args[gateway_at + 1] == "default" ||
+             IsNumber(args[gateway_at + 1]);
+    }
+
+    // Whether the pull-filter written by TakeProfileRoutes keeps this
+    // pushed route from OpenVPN: IPv6 routes, and IPv4 routes to addresses
+    bool FilteredFromPush(const std::vector<std::string> &args, bool ipv6)
+    {
+      return ipv6 || (args[0][0] >= '0' && args[0][0] <= '9');
+    }
+
+    // First set of |pushed| and |profile|
+    const std::string &Either(const std::string &pushed, const std::string &profile)
+    {
+      return pushed.empty() ? profile : pushed;
+    }
+
+  } // namespace
+
+  bool ParseNetGateway(std::string_view line, NetGateway *gateway)
+  {
+    bool ipv6 = false;
+    size_t start = line.find(kRouteGateway);
+    if (start == std::string_view::npos)
+    {
+      ipv6 = true;
+      start = line.find(kRoute6Gateway);
+      if (start == std::string_view::npos)
+      {
+        return false;
+      }
+    }
+    const std::vector<std::string> tokens =
+        Tokens(line.substr(start + (ipv6 ? kRoute6Gateway.size() : kRouteGateway.size())));
+    if (tokens.empty())
+    {
+      return false;
+    }
+
+    // "192.168.1.1/255.255.255.0" or "fe80::1/64"; ON_LINK has no address
+    IpAddress address;
+    std::optional<IpAddress> &target = ipv6 ? gateway->ipv6 : gateway->ipv4;
+    if (ParseIpAddress(tokens[0].substr(0, tokens[0].find('/')), &address) && address.ipv6 == ipv6)
+    {
+      target = address;
+    }
+    else
+    {
+      target.reset();
+    }
+    uint32_t &interface_index = ipv6 ? gateway->ipv6_interface : gateway->ipv4_interface;
+    interface_index = 0;
+    for (const std::string &token : tokens)
+    {
+      if (token.compare(0, 2, "I=") == 0 && IsNumber(token.substr(2)))
+      {
+        interface_index = static_cast<uint32_t>(std::stoul(token.substr(2)));
+      }
+    }
+    return true;
+  }
+
+  bool ParsePushReply(std::string_view message, RouteOptions *options, bool *more)
+  {
+    const size_t start = message.find(kPushReply);
+    if (start == std::string_view::npos)
+    {
+      return false;
+    }
+    message = message.substr(start + kPushReply.size());
+    // The log quotes the message
+    if (!message.empty() && message.back() == '\'')
+    {
+      message.remove_suffix(1);
+    }
+
+    *more = false;
+    while (!message.empty())
+    {
+      const size_t comma = message.find(',');
+      const std::vector<std::string> tokens = Tokens(message.substr(0, comma));
+      if (tokens.size() == 2 && tokens[0] == "push-continuation")
+      {
+        *more = tokens[1] == "2";
+      }
+      AddOption(tokens, options);
+      message = comma == std::string_view::npos ? std::string_view() : message.substr(comma + 1);
+    }
+    return true;
+  }
+
+  bool TakeProfileRoutes(std::string_view profile, std::string *rewritten, RouteOptions *options,
+                         std::string *reason)
+  {
+    std::string result;
+    result.reserve(profile.size() + 64);
+    bool in_inline_block = false;
+    for (size_t pos = 0; pos < profile.size();)
+    {
+      size_t end = profile.find('\n', pos);
+      end = end == std::string_view::npos ? profile.size() : end + 1;
+      const std::string_view line = profile.substr(pos, end - pos);
+      pos = end;
+
+      const std::vector<std::string> tokens = Tokens(line.substr(0, line.find('\n')));
+      if (tokens.empty() || tokens[0][0] == '#' || tokens[0][0] == ';')
+      {
+        result += line;
+        continue;
+      }
+      const std::string &name = tokens[0];
+      if (in_inline_block)
+      {
+        in_inline_block = name.compare(0, 2, "</") != 0;
+        result += line;
+        continue;
+      }
+      if (name.size() > 2 && name.front() == '<' && name.back() == '>')
+      {
+        in_inline_block = true;
+        result += line;
+        continue;
+      }
+
+      if (name == "route-nopull" || name == "route-noexec" || name == "pull-filter")
+      {
+        *reason = "the profile uses " + name;
+        return false;
+      }
+      if (name == "route" || name == "route-ipv6")
+      {
+        // Routes we cannot install stay with OpenVPN
+        if (tokens.size() > 1 &&
+            Installable(std::vector<std::string>(tokens.begin() + 1, tokens.end()), name == "route-ipv6"))
+        {
+          AddOption(tokens, options);
+        }
+        else
+        {
+          result += line;
+        }
+        continue;
+      }
+      AddOption(tokens, options);
+      result += line;
+    }
+
+    if (!result.empty() && result.back() != '\n')
+    {
+      result += '\n';
+    }
+    // Pushed routes arrive through the PUSH_REPLY log line instead. The
+    // filter matches prefixes, so routes to hostnames are let through.
+    for (char digit = '0'; digit <= '9'; digit++)
+    {
+      result += "pull-filter ignore \"route ";
+      result += digit;
+      result += "\"\n";
+    }
+    result += "pull-filter ignore \"route-ipv6 \"\n";
+    *rewritten = std::move(result);
+    return true;
+  }
+
+  std::vector<NativeRoute> ResolveRoutes(const RouteOptions &profile, const RouteOptions &pushed,
+                                         const NetGateway &net_gateway, uint32_t tunnel_interface,
+                                         std::vector<std::string> *skipped)
+  {
+    // The VPN's gateway: route-gateway, else the far end of a net30 or p2p
+    // ifconfig. Without either, routes go on-link through the tunnel.
+    std::optional<IpAddress> vpn_gateway;
+    IpAddress address;
+    if (ParseIpAddress(Either(pushed.route_gateway, profile.route_gateway), &address))
+    {
+      vpn_gateway = address;
+    }
+    else if (Either(pushed.topology, profile.topology) != "subnet" &&
+             ParseIpAddress(Either(pushed.ifconfig_remote, profile.ifconfig_remote), &address))
+    {
+      vpn_gateway = address;
+    }
+    std::optional<IpAddress> vpn_gateway6;
+    if (ParseIpAddress(Either(pushed.ifconfig_ipv6_remote, profile.ifconfig_ipv6_remote), &address) &&
+        address.ipv6)
+    {
+      vpn_gateway6 = address;
+    }
+    const std::string &metric_text = Either(pushed.route_metric, profile.route_metric);
+    const uint32_t default_metric = IsNumber(metric_text) ? static_cast<uint32_t>(std::stoul(metric_text)) : 0;
+
+    std::vector<NativeRoute> routes;
+    auto add = [&](std::vector<std::string> args, bool ipv6)
+    {
+      const size_t gateway_at = ipv6 ? 1 : 2;
+      const std::optional<IpAddress> &net = ipv6 ? net_gateway.ipv6 : net_gateway.ipv4;
+      const bool via_net_gateway = args.size() > gateway_at && args[gateway_at] == "net_gateway";
+      if (via_net_gateway && net)
+      {
+        args[gateway_at] = FormatIpAddress(*net);
+      }
+      if (!Installable(args, ipv6))
+      {
+        std::string text = ipv6 ? "route-ipv6" : "route";
+        for (const std::string &arg : args)
+        {
+          text += " " + arg;
+        }
+        skipped->push_back(std::move(text));
+        return;
+      }
+      NativeRoute route;
+      route.ipv6 = ipv6;
+      if (ipv6)
+      {
+        ParseIpv6Route(args[0], &route.destination);
+      }
+      else
+      {
+        ParseIpv4Route(args[0], args.size() > 1 ? args[1] : std::string(), &route.destination);
+      }
+      const std::string gateway = args.size() > gateway_at ? args[gateway_at] : std::string();
+      if (IsVpnGateway(gateway))
+      {
+        route.gateway = ipv6 ? vpn_gateway6 : vpn_gateway;
+        route.interface_index = tunnel_interface;
+      }
+      else
+      {
+        ParseIpAddress(gateway, &address);
+        route.gateway = address;
+        if (via_net_gateway)
+        {
+          route.interface_index = ipv6 ? net_gateway.ipv6_interface : net_gateway.ipv4_interface;
+        }
+      }
+      const std::string metric = args.size() > gateway_at + 1 ? args[gateway_at + 1] : std::string();
+      route.metric = IsNumber(metric) ? static_cast<uint32_t>(std::stoul(metric)) : default_metric;
+      routes.push_back(std::move(route));
+    };
+
+    for (const RouteOptions *options : {&profile, &pushed})
+    {
+      for (const auto &args : options->routes)
+      {
+        if (options == &profile || FilteredFromPush(args, false))
+        {
+          add(args, false);
+        }
+      }
+      for (const auto &args : options->ipv6_routes)
+      {
+        add(args, true);
+      }
+    }
+    return routes;
+  }
+
+} // namespace openvpn_dart
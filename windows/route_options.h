@@ -0,0 +1,69 @@
+#ifndef FLUTTER_PLUGIN_ROUTE_OPTIONS_H_
+#define FLUTTER_PLUGIN_ROUTE_OPTIONS_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "route_programmer.h"
+
+namespace openvpn_dart
+{
+
+    // The routing options of a profile or of a server push, as written
+    struct RouteOptions
+    {
+        // Arguments of each "route" and "route-ipv6"
+        std::vector<std::vector<std::string>> routes;
+        std::vector<std::vector<std::string>> ipv6_routes;
+        std::string route_gateway;
+        std::string route_metric;
+        std::string topology;
+        // Remote end of "ifconfig" (net30/p2p) and "ifconfig-ipv6"
+        std::string ifconfig_remote;
+        std::string ifconfig_ipv6_remote;
+    };
+
+    // What net_gateway stands for, as OpenVPN logs it before connecting
+    // ("ROUTE_GATEWAY 192.168.1.1/255.255.255.0 I=12 HWADDR=...")
+    struct NetGateway
+    {
+        std::optional<IpAddress> ipv4;
+        // Logged on Windows only; 0 otherwise
+        uint32_t ipv4_interface = 0;
+        std::optional<IpAddress> ipv6;
+        uint32_t ipv6_interface = 0;
+    };
+
+    // Records a ROUTE_GATEWAY or ROUTE6_GATEWAY log line. False for others.
+    bool ParseNetGateway(std::string_view line, NetGateway *gateway);
+
+    // Adds the options of a PUSH_REPLY, given the message or the log line
+    // quoting it. False if there is none. |more| is set when the server
+    // sends the rest in another reply (push-continuation 2).
+    bool ParsePushReply(std::string_view message, RouteOptions *options, bool *more);
+
+    // Prepares |profile| for routes installed by the plugin: takes the
+    // routes it can install out into |options|, collects the options that
+    // resolve them, and filters the server's pushed routes to addresses out
+    // of OpenVPN's hands. Pushed routes to hostnames stay with OpenVPN.
+    // False, with the reason, for profiles that already filter or skip
+    // routes themselves.
+    bool TakeProfileRoutes(std::string_view profile, std::string *rewritten, RouteOptions *options,
+                           std::string *reason);
+
+    // Routes of |profile| and |pushed| as installed on a tunnel reached
+    // through |tunnel_interface|. Routes through the VPN gateway go on the
+    // tunnel interface, routes through net_gateway via |net_gateway|.
+    // Pushed routes the profile's pull-filter let through are OpenVPN's and
+    // left out. Other routes that cannot be installed (hostnames, remote_host,
+    // an unknown net_gateway) are left out and described in |skipped|.
+    std::vector<NativeRoute> ResolveRoutes(const RouteOptions &profile, const RouteOptions &pushed,
+                                           const NetGateway &net_gateway, uint32_t tunnel_interface,
+                                           std::vector<std::string> *skipped);
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_ROUTE_OPTIONS_H_
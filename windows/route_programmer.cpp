@@ -0,0 +1,210 @@
+#include "route_programmer.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    // Every field, for spotting repeats
+    std::string RouteKey(const NativeRoute &route)
+    {
+      std::string key(reinterpret_cast<const char *>(route.destination.address.data()),
+                      route.destination.address.size());
+      key += static_cast<char>(route.destination.length);
+      key += route.ipv6 ? '6' : '4';
+      key += route.gateway ? 'g' : 'n';
+      if (route.gateway)
+      {
+        key.append(reinterpret_cast<const char *>(route.gateway->bytes.data()), route.gateway->bytes.size());
+      }
+      key += '|' + std::to_string(route.interface_index) + '|' + std::to_string(route.metric);
+      return key;
+    }
+
+    // Removes |routes| in batches, newest first. The routes of batches that
+    // failed, which may still be in the table, are added to |left| in their
+    // original order.
+    bool DeleteInBatches(RouteBackend *backend, std::vector<NativeRoute> routes, size_t batch_size,
+                         std::vector<NativeRoute> *left, std::string *error)
+    {
+      std::reverse(routes.begin(), routes.end());
+      std::vector<NativeRoute> failed;
+      for (size_t start = 0; start < routes.size(); start += batch_size)
+      {
+        const size_t end = std::min(routes.size(), start + batch_size);
+        const std::vector<NativeRoute> batch(routes.begin() + start, routes.begin() + end);
+        std::string batch_error;
+        if (!backend->DeleteRoutes(batch, &batch_error))
+        {
+          if (failed.empty())
+          {
+            *error = batch_error.empty() ? "Failed to remove a route" : batch_error;
+          }
+          failed.insert(failed.end(), batch.begin(), batch.end());
+        }
+      }
+      left->insert(left->end(), failed.rbegin(), failed.rend());
+      return failed.empty();
+    }
+
+  } // namespace
+
+  bool ParseIpAddress(std::string_view text, IpAddress *out)
+  {
+    RoutePrefix prefix;
+    IpAddress address;
+    if (ParseIpv4Route(text, "", &prefix))
+    {
+      address.ipv6 = false;
+    }
+    else if (text.find('/') == std::string_view::npos && ParseIpv6Route(text, &prefix))
+    {
+      address.ipv6 = true;
+    }
+    else
+    {
+      return false;
+    }
+    address.bytes = prefix.address;
+    *out = address;
+    return true;
+  }
+
+  std::string FormatIpAddress(const IpAddress &address)
+  {
+    RoutePrefix prefix;
+    prefix.address = address.bytes;
+    if (!address.ipv6)
+    {
+      return FormatIpv4Address(prefix);
+    }
+    prefix.length = 128;
+    std::string text = FormatIpv6Route(prefix);
+    return text.substr(0, text.rfind('/'));
+  }
+
+  bool NativeRoute::operator==(const NativeRoute &other) const
+  {
+    return ipv6 == other.ipv6 && destination.address == other.destination.address &&
+           destination.length == other.destination.length && gateway == other.gateway &&
+           interface_index == other.interface_index && metric == other.metric;
+  }
+
+  std::string DescribeRoute(const NativeRoute &route)
+  {
+    std::string text;
+    if (route.ipv6)
+    {
+      text = FormatIpv6Route(route.destination);
+    }
+    else
+    {
+      text = FormatIpv4Address(route.destination) + "/" + std::to_string(route.destination.length);
+    }
+    if (route.gateway)
+    {
+      text += " via " + FormatIpAddress(*route.gateway);
+    }
+    if (route.interface_index != 0)
+    {
+      text += " if " + std::to_string(route.interface_index);
+    }
+    if (route.metric != 0)
+    {
+      text += " metric " + std::to_string(route.metric);
+    }
+    return text;
+  }
+
+  RouteProgrammer::RouteProgrammer(RouteBackend *backend, size_t batch_size)
+      : backend_(backend),
+        batch_size_(std::max<size_t>(1, batch_size))
+  {
+  }
+
+  bool RouteProgrammer::Install(const std::vector<NativeRoute> &routes, std::string *error)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Profile and pushed routes can repeat each other, and a second add of
+    // the same route would fail
+    std::unordered_set<std::string> seen;
+    for (const NativeRoute &route : installed_)
+    {
+      seen.insert(RouteKey(route));
+    }
+    std::vector<NativeRoute> pending;
+    pending.reserve(routes.size());
+    for (const NativeRoute &route : routes)
+    {
+      if (seen.insert(RouteKey(route)).second)
+      {
+        pending.push_back(route);
+      }
+    }
+
+    std::vector<NativeRoute> added;
+    std::vector<RouteResult> results;
+    for (size_t start = 0; start < pending.size(); start += batch_size_)
+    {
+      const size_t end = std::min(pending.size(), start + batch_size_);
+      const std::vector<NativeRoute> batch(pending.begin() + start, pending.begin() + end);
+      results.assign(batch.size(), RouteResult::kFailed);
+      std::string batch_error;
+      backend_->AddRoutes(batch, &results, &batch_error);
+
+      bool failed = false;
+      for (size_t i = 0; i < batch.size(); i++)
+      {
+        if (results[i] == RouteResult::kAdded)
+        {
+          added.push_back(batch[i]);
+        }
+        else if (results[i] == RouteResult::kUnknown)
+        {
+          // Taken out with the rest; deleting a route that is not there
+          // is no error
+          added.push_back(batch[i]);
+          failed = true;
+        }
+        else if (results[i] == RouteResult::kFailed)
+        {
+          failed = true;
+        }
+      }
+      if (failed)
+      {
+        *error = batch_error.empty() ? "Failed to add a route" : batch_error;
+        // What the rollback could not take out is left for RemoveAll()
+        std::string rollback_error;
+        if (!DeleteInBatches(backend_, std::move(added), batch_size_, &installed_, &rollback_error))
+        {
+          *error += "; rollback failed: " + rollback_error;
+        }
+        return false;
+      }
+    }
+    installed_.insert(installed_.end(), added.begin(), added.end());
+    return true;
+  }
+
+  bool RouteProgrammer::RemoveAll(std::string *error)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<NativeRoute> routes;
+    routes.swap(installed_);
+    return DeleteInBatches(backend_, std::move(routes), batch_size_, &installed_, error);
+  }
+
+  size_t RouteProgrammer::installed() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return installed_.size();
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,106 @@
+#ifndef FLUTTER_PLUGIN_ROUTE_PROGRAMMER_H_
+#define FLUTTER_PLUGIN_ROUTE_PROGRAMMER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "route_aggregation.h"
+
+namespace openvpn_dart
+{
+
+    struct IpAddress
+    {
+        bool ipv6 = false;
+        // IPv4 uses the first 4 bytes
+        std::array<uint8_t, 16> bytes{};
+
+        bool operator==(const IpAddress &other) const
+        {
+            return ipv6 == other.ipv6 && bytes == other.bytes;
+        }
+    };
+
+    bool ParseIpAddress(std::string_view text, IpAddress *out);
+    std::string FormatIpAddress(const IpAddress &address);
+
+    // A route as handed to the system
+    struct NativeRoute
+    {
+        bool ipv6 = false;
+        RoutePrefix destination;
+        // None: on-link through |interface_index|
+        std::optional<IpAddress> gateway;
+        // 0: the interface |gateway| is reached through
+        uint32_t interface_index = 0;
+        // 0: the system's default
+        uint32_t metric = 0;
+
+        bool operator==(const NativeRoute &other) const;
+    };
+
+    // "10.0.0.0/8 via 10.8.0.1 metric 5", for logs
+    std::string DescribeRoute(const NativeRoute &route);
+
+    enum class RouteResult
+    {
+        kAdded,
+        // Already in the table; not ours to remove
+        kExisted,
+        kFailed,
+        // No answer came; the route may or may not be in the table
+        kUnknown,
+    };
+
+    // Programs the system routing table. Implementations may be called from
+    // any thread, one call at a time.
+    class RouteBackend
+    {
+    public:
+        virtual ~RouteBackend() = default;
+
+        // Adds |routes| as one batch, filling |results| one per route.
+        // |error| gets the reason for the first failure.
+        virtual void AddRoutes(const std::vector<NativeRoute> &routes,
+                               std::vector<RouteResult> *results, std::string *error) = 0;
+        // Routes already gone are not an error. False if any removal failed.
+        virtual bool DeleteRoutes(const std::vector<NativeRoute> &routes, std::string *error) = 0;
+        // 0 if no interface has |address|
+        virtual uint32_t InterfaceIndexForAddress(const IpAddress &address) = 0;
+    };
+
+    // Installs route sets through a backend in batches, all or nothing, and
+    // remembers what it added so it can take exactly that out again.
+    // Thread-safe.
+    class RouteProgrammer
+    {
+    public:
+        static constexpr size_t kDefaultBatchSize = 256;
+
+        explicit RouteProgrammer(RouteBackend *backend, size_t batch_size = kDefaultBatchSize);
+
+        // Adds |routes|, skipping repeats. If any route fails, the routes
+        // added by this call are removed again and false is returned; any
+        // the rollback could not remove stay recorded.
+        bool Install(const std::vector<NativeRoute> &routes, std::string *error);
+        // Removes every route Install() added. Routes whose removal failed
+        // stay recorded, so a later call tries them again.
+        bool RemoveAll(std::string *error);
+        size_t installed() const;
+
+    private:
+        RouteBackend *const backend_;
+        const size_t batch_size_;
+        mutable std::mutex mutex_;
+        std::vector<NativeRoute> installed_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_ROUTE_PROGRAMMER_H_
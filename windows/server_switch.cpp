@@ -0,0 +1,77 @@
+#include "server_switch.h"
+
+#include <algorithm>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    void MarkOnce(int64_t *point, int64_t now_ms)
+    {
+      if (*point < 0)
+      {
+        *point = now_ms;
+      }
+    }
+
+  } // namespace
+
+  SwitchTimeline::SwitchTimeline(int64_t requested_ms, bool make_before_break)
+      : requested_ms_(requested_ms),
+        make_before_break_(make_before_break),
+        old_down_ms_(-1),
+        new_connected_ms_(-1),
+        teardown_started_ms_(-1),
+        teardown_finished_ms_(-1)
+  {
+  }
+
+  void SwitchTimeline::OldDown(int64_t now_ms)
+  {
+    MarkOnce(&old_down_ms_, now_ms);
+  }
+
+  void SwitchTimeline::NewConnected(int64_t now_ms)
+  {
+    MarkOnce(&new_connected_ms_, now_ms);
+  }
+
+  void SwitchTimeline::TeardownStarted(int64_t now_ms)
+  {
+    MarkOnce(&teardown_started_ms_, now_ms);
+    OldDown(now_ms);
+  }
+
+  void SwitchTimeline::TeardownFinished(int64_t now_ms)
+  {
+    MarkOnce(&teardown_finished_ms_, now_ms);
+  }
+
+  SwitchReport SwitchTimeline::Report() const
+  {
+    SwitchReport report;
+    report.make_before_break = make_before_break_;
+    if (new_connected_ms_ >= 0)
+    {
+      report.connect_ms = new_connected_ms_ - requested_ms_;
+    }
+    if (teardown_started_ms_ >= 0 && teardown_finished_ms_ >= 0)
+    {
+      report.teardown_ms = teardown_finished_ms_ - teardown_started_ms_;
+    }
+    if (old_down_ms_ >= 0 && new_connected_ms_ >= 0)
+    {
+      report.overlap_ms = std::max<int64_t>(0, old_down_ms_ - new_connected_ms_);
+      report.gap_ms = std::max<int64_t>(0, new_connected_ms_ - old_down_ms_);
+    }
+    else if (old_down_ms_ >= 0)
+    {
+      // Never connected: report the outage so far as -1 rather than guess
+      report.gap_ms = -1;
+    }
+    return report;
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,59 @@
+#ifndef FLUTTER_PLUGIN_SERVER_SWITCH_H_
+#define FLUTTER_PLUGIN_SERVER_SWITCH_H_
+
+#include <cstdint>
+
+namespace openvpn_dart
+{
+
+    struct SwitchReport
+    {
+        // The new tunnel came up before the old one went down
+        bool make_before_break = false;
+        // The running process was pointed at the new server and reconnected;
+        // nothing was torn down
+        bool in_place = false;
+        // Request to the new tunnel reporting connected
+        int64_t connect_ms = -1;
+        // Both tunnels connected at once
+        int64_t overlap_ms = 0;
+        // Neither tunnel connected: the outage the switch caused
+        int64_t gap_ms = 0;
+        // Old tunnel teardown, signal to exit
+        int64_t teardown_ms = -1;
+    };
+
+    // Times one server switch from the points it passes. Times are
+    // monotonic milliseconds; the first report of each point counts.
+    //
+    // The gap runs from the old tunnel going down to the new one
+    // connecting, so it is zero when the new tunnel was up first and the
+    // whole teardown plus handshake when it was not.
+    class SwitchTimeline
+    {
+    public:
+        SwitchTimeline(int64_t requested_ms, bool make_before_break);
+
+        // The old tunnel stopped carrying traffic: its teardown began, or
+        // it dropped by itself
+        void OldDown(int64_t now_ms);
+        void NewConnected(int64_t now_ms);
+        void TeardownStarted(int64_t now_ms);
+        void TeardownFinished(int64_t now_ms);
+
+        bool new_connected() const { return new_connected_ms_ >= 0; }
+
+        SwitchReport Report() const;
+
+    private:
+        const int64_t requested_ms_;
+        const bool make_before_break_;
+        int64_t old_down_ms_;
+        int64_t new_connected_ms_;
+        int64_t teardown_started_ms_;
+        int64_t teardown_finished_ms_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_SERVER_SWITCH_H_
@@ -0,0 +1,164 @@
+#include "session_journal.h"
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include "warm_standby.h"
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    constexpr char kMagic[4] = {'O', 'V', 'D', 'J'};
+    // Version 2 added the management password
+    constexpr uint16_t kVersion = 2;
+    constexpr size_t kMaxStatusLength = 64;
+    constexpr size_t kMaxPasswordLength = 64;
+    constexpr size_t kMaxJournalSize = 256;
+
+    template <typename T>
+    void Put(std::string *out, T value)
+    {
+      for (size_t i = 0; i < sizeof(T); i++)
+      {
+        out->push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff));
+      }
+    }
+
+    template <typename T>
+    bool Take(std::string_view *in, T *value)
+    {
+      if (in->size() < sizeof(T))
+      {
+        return false;
+      }
+      uint64_t result = 0;
+      for (size_t i = 0; i < sizeof(T); i++)
+      {
+        result |= static_cast<uint64_t>(static_cast<unsigned char>((*in)[i])) << (8 * i);
+      }
+      *value = static_cast<T>(result);
+      in->remove_prefix(sizeof(T));
+      return true;
+    }
+
+  } // namespace
+
+  std::string EncodeSessionRecord(const SessionRecord &record)
+  {
+    std::string out(kMagic, sizeof(kMagic));
+    Put(&out, kVersion);
+    Put(&out, record.pid);
+    Put(&out, record.creation_time);
+    Put(&out, record.config_hash);
+    Put(&out, record.management_port);
+    Put(&out, record.started_unix_ms);
+
+    const std::string_view status =
+        std::string_view(record.status).substr(0, kMaxStatusLength);
+    Put(&out, static_cast<uint8_t>(status.size()));
+    out.append(status);
+
+    const std::string_view password =
+        std::string_view(record.management_password).substr(0, kMaxPasswordLength);
+    Put(&out, static_cast<uint8_t>(password.size()));
+    out.append(password);
+
+    Put(&out, ConfigFingerprint(out));
+    return out;
+  }
+
+  bool DecodeSessionRecord(std::string_view data, SessionRecord *record)
+  {
+    if (data.size() < sizeof(kMagic) + sizeof(uint64_t) ||
+        data.substr(0, sizeof(kMagic)) != std::string_view(kMagic, sizeof(kMagic)))
+    {
+      return false;
+    }
+
+    std::string_view checksum_bytes = data.substr(data.size() - sizeof(uint64_t));
+    std::string_view payload = data.substr(0, data.size() - sizeof(uint64_t));
+    uint64_t checksum = 0;
+    if (!Take(&checksum_bytes, &checksum) || checksum != ConfigFingerprint(payload))
+    {
+      return false;
+    }
+
+    payload.remove_prefix(sizeof(kMagic));
+    SessionRecord parsed;
+    uint16_t version = 0;
+    uint8_t status_length = 0;
+    if (!Take(&payload, &version) || (version != 1 && version != kVersion) ||
+        !Take(&payload, &parsed.pid) ||
+        !Take(&payload, &parsed.creation_time) ||
+        !Take(&payload, &parsed.config_hash) ||
+        !Take(&payload, &parsed.management_port) ||
+        !Take(&payload, &parsed.started_unix_ms) ||
+        !Take(&payload, &status_length) ||
+        payload.size() < status_length)
+    {
+      return false;
+    }
+    parsed.status = std::string(payload.substr(0, status_length));
+    payload.remove_prefix(status_length);
+
+    // A process journaled by version 1 has no management password
+    uint8_t password_length = 0;
+    if ((version > 1 && !Take(&payload, &password_length)) || payload.size() != password_length)
+    {
+      return false;
+    }
+    parsed.management_password = std::string(payload);
+    *record = std::move(parsed);
+    return true;
+  }
+
+  bool WriteSessionJournal(const std::string &path, const SessionRecord &record)
+  {
+    const std::string temp_path = path + ".partial";
+    {
+      std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+      if (!out)
+      {
+        return false;
+      }
+      const std::string data = EncodeSessionRecord(record);
+      out.write(data.data(), static_cast<std::streamsize>(data.size()));
+      if (!out.flush())
+      {
+        return false;
+      }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec)
+    {
+      std::filesystem::remove(temp_path, ec);
+      return false;
+    }
+    return true;
+  }
+
+  bool ReadSessionJournal(const std::string &path, SessionRecord *record)
+  {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+      return false;
+    }
+    char buffer[kMaxJournalSize];
+    in.read(buffer, sizeof(buffer));
+    return DecodeSessionRecord(std::string_view(buffer, static_cast<size_t>(in.gcount())), record);
+  }
+
+  void ClearSessionJournal(const std::string &path)
+  {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+
+} // namespace openvpn_dart
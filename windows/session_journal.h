@@ -0,0 +1,41 @@
+#ifndef FLUTTER_PLUGIN_SESSION_JOURNAL_H_
+#define FLUTTER_PLUGIN_SESSION_JOURNAL_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace openvpn_dart
+{
+
+    // What a later plugin instance needs to take over a running session
+    // without reading the OpenVPN log.
+    struct SessionRecord
+    {
+        uint32_t pid = 0;
+        // Process creation time (FILETIME ticks). A reused PID has a
+        // different creation time, so PID plus this identifies our process.
+        uint64_t creation_time = 0;
+        uint64_t config_hash = 0;
+        uint16_t management_port = 0;
+        // From the process's --management password file; empty in journals
+        // written before the interface had one
+        std::string management_password;
+        int64_t started_unix_ms = 0; // Wall clock, survives plugin restarts
+        std::string status;          // Last status published to Dart
+    };
+
+    // Fixed little-endian layout with a magic, a version and a trailing
+    // checksum; a torn or foreign file fails to decode.
+    std::string EncodeSessionRecord(const SessionRecord &record);
+    bool DecodeSessionRecord(std::string_view data, SessionRecord *record);
+
+    // The journal is replaced via a temporary file and rename, so readers
+    // never observe a partial record.
+    bool WriteSessionJournal(const std::string &path, const SessionRecord &record);
+    bool ReadSessionJournal(const std::string &path, SessionRecord *record);
+    void ClearSessionJournal(const std::string &path);
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_SESSION_JOURNAL_H_
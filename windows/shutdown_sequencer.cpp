@@ -0,0 +1,66 @@
+#include "shutdown_sequencer.h"
+
+#include <chrono>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    int64_t ElapsedMs(std::chrono::steady_clock::time_point since)
+    {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::steady_clock::now() - since)
+          .count();
+    }
+
+  } // namespace
+
+  ShutdownSequencer::ShutdownSequencer(int graceful_timeout_ms, int kill_timeout_ms)
+      : graceful_timeout_ms_(graceful_timeout_ms),
+        kill_timeout_ms_(kill_timeout_ms),
+        phase_(Phase::kIdle)
+  {
+  }
+
+  ShutdownReport ShutdownSequencer::Run(const ShutdownSteps &steps)
+  {
+    ShutdownReport report;
+    const auto start = std::chrono::steady_clock::now();
+
+    phase_ = Phase::kSignalling;
+    report.exited = steps.wait_for_exit && steps.wait_for_exit(0);
+    if (!report.exited && steps.request_graceful && steps.request_graceful())
+    {
+      const auto signalled = std::chrono::steady_clock::now();
+      report.exited = steps.wait_for_exit && steps.wait_for_exit(graceful_timeout_ms_);
+      report.graceful = report.exited;
+      report.graceful_ms = ElapsedMs(signalled);
+    }
+
+    if (!report.exited)
+    {
+      phase_ = Phase::kKilling;
+      const auto killed = std::chrono::steady_clock::now();
+      if (steps.force_kill)
+      {
+        steps.force_kill();
+      }
+      report.killed = true;
+      report.exited = steps.wait_for_exit && steps.wait_for_exit(kill_timeout_ms_);
+      report.kill_ms = ElapsedMs(killed);
+    }
+
+    phase_ = Phase::kCleaningUp;
+    if (steps.cleanup)
+    {
+      steps.cleanup();
+    }
+
+    report.total_ms = ElapsedMs(start);
+    phase_ = Phase::kDone;
+    return report;
+  }
+
+} // namespace openvpn_dart
@@ -0,0 +1,63 @@
+#ifndef FLUTTER_PLUGIN_SHUTDOWN_SEQUENCER_H_
+#define FLUTTER_PLUGIN_SHUTDOWN_SEQUENCER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace openvpn_dart
+{
+
+    // Steps of a bounded-latency OpenVPN shutdown, supplied by the caller so
+    // the sequence can be exercised without a real process.
+    struct ShutdownSteps
+    {
+        // Asks OpenVPN to exit cleanly (management "signal SIGTERM"), so it
+        // removes its routes and DNS settings. False if no request was sent.
+        std::function<bool()> request_graceful;
+        // Blocks up to |timeout_ms| for the process to exit; true once gone.
+        std::function<bool(int timeout_ms)> wait_for_exit;
+        // Hard kill, used when the graceful deadline passes.
+        std::function<void()> force_kill;
+        // Releases handles, sockets and threads once the process is gone.
+        std::function<void()> cleanup;
+    };
+
+    struct ShutdownReport
+    {
+        bool graceful = false;    // Exited on its own after the request
+        bool killed = false;      // Needed force_kill
+        bool exited = false;      // Process confirmed gone
+        int64_t graceful_ms = 0;  // Time spent waiting for a clean exit
+        int64_t kill_ms = 0;      // Time spent waiting after force_kill
+        int64_t total_ms = 0;     // Including cleanup
+    };
+
+    // Runs signal -> wait -> kill -> cleanup with a deadline on each wait.
+    class ShutdownSequencer
+    {
+    public:
+        enum class Phase
+        {
+            kIdle,
+            kSignalling,
+            kKilling,
+            kCleaningUp,
+            kDone,
+        };
+
+        ShutdownSequencer(int graceful_timeout_ms, int kill_timeout_ms);
+
+        ShutdownReport Run(const ShutdownSteps &steps);
+
+        Phase phase() const { return phase_; }
+
+    private:
+        const int graceful_timeout_ms_;
+        const int kill_timeout_ms_;
+        std::atomic<Phase> phase_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_SHUTDOWN_SEQUENCER_H_
@@ -0,0 +1,393 @@
+#include "system_route_backend.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <iphlpapi.h>
+#include <netioapi.h>
+#elif defined(__linux__)
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+#ifdef _WIN32
+    void SetAddress(bool ipv6, const std::array<uint8_t, 16> &bytes, SOCKADDR_INET *out)
+    {
+      ZeroMemory(out, sizeof(*out));
+      if (ipv6)
+      {
+        out->Ipv6.sin6_family = AF_INET6;
+        memcpy(out->Ipv6.sin6_addr.s6_addr, bytes.data(), 16);
+      }
+      else
+      {
+        out->Ipv4.sin_family = AF_INET;
+        memcpy(&out->Ipv4.sin_addr, bytes.data(), 4);
+      }
+    }
+
+    // False if no interface could be found for the route
+    bool FillRow(const NativeRoute &route, MIB_IPFORWARD_ROW2 *row)
+    {
+      InitializeIpForwardEntry(row);
+      SetAddress(route.ipv6, route.destination.address, &row->DestinationPrefix.Prefix);
+      row->DestinationPrefix.PrefixLength = static_cast<UINT8>(route.destination.length);
+      if (route.gateway)
+      {
+        SetAddress(route.ipv6, route.gateway->bytes, &row->NextHop);
+      }
+      else
+      {
+        // Unspecified next hop: on-link
+        row->NextHop.si_family = route.ipv6 ? AF_INET6 : AF_INET;
+      }
+      row->InterfaceIndex = route.interface_index;
+      if (row->InterfaceIndex == 0 && route.gateway)
+      {
+        DWORD index = 0;
+        if (GetBestInterfaceEx(reinterpret_cast<sockaddr *>(&row->NextHop), &index) == NO_ERROR)
+        {
+          row->InterfaceIndex = index;
+        }
+      }
+      row->Metric = route.metric;
+      row->Protocol = MIB_IPPROTO_NETMGMT;
+      return row->InterfaceIndex != 0;
+    }
+#elif defined(__linux__)
+    constexpr int kAckTimeoutSeconds = 5;
+    // In |errors| of Transact() for a message the kernel did not answer
+    constexpr int kNoAck = -1;
+
+    void AddAttribute(std::vector<char> *buffer, uint16_t type, const void *data, size_t length)
+    {
+      rtattr attribute{};
+      attribute.rta_type = type;
+      attribute.rta_len = static_cast<unsigned short>(RTA_LENGTH(length));
+      const size_t start = buffer->size();
+      buffer->resize(start + RTA_SPACE(length));
+      memcpy(buffer->data() + start, &attribute, sizeof(attribute));
+      memcpy(buffer->data() + start + RTA_LENGTH(0), data, length);
+    }
+
+    // One message per route in a single send, then one ack per message.
+    // |errors| gets each route's errno, 0 for success, or kNoAck if the
+    // acks stopped coming (|error| then says why). False if nothing was
+    // sent.
+    bool Transact(uint16_t type, uint16_t flags, const std::vector<NativeRoute> &routes,
+                  std::vector<int> *errors, std::string *error)
+    {
+      errors->assign(routes.size(), kNoAck);
+      if (routes.empty())
+      {
+        return true;
+      }
+      const int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+      if (fd < 0)
+      {
+        *error = std::string("netlink socket: ") + strerror(errno);
+        return false;
+      }
+      timeval timeout{kAckTimeoutSeconds, 0};
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+      std::vector<char> buffer;
+      for (size_t i = 0; i < routes.size(); i++)
+      {
+        const NativeRoute &route = routes[i];
+        const size_t start = buffer.size();
+        buffer.resize(start + NLMSG_SPACE(sizeof(rtmsg)));
+
+        rtmsg message{};
+        message.rtm_family = route.ipv6 ? AF_INET6 : AF_INET;
+        message.rtm_dst_len = static_cast<unsigned char>(route.destination.length);
+        message.rtm_table = RT_TABLE_MAIN;
+        if (type == RTM_NEWROUTE)
+        {
+          message.rtm_protocol = RTPROT_STATIC;
+          message.rtm_scope = route.gateway ? RT_SCOPE_UNIVERSE : RT_SCOPE_LINK;
+          message.rtm_type = RTN_UNICAST;
+        }
+        else
+        {
+          message.rtm_scope = RT_SCOPE_NOWHERE;
+        }
+        memcpy(buffer.data() + start + NLMSG_LENGTH(0), &message, sizeof(message));
+
+        const size_t address_length = route.ipv6 ? 16 : 4;
+        AddAttribute(&buffer, RTA_DST, route.destination.address.data(), address_length);
+        if (route.gateway)
+        {
+          AddAttribute(&buffer, RTA_GATEWAY, route.gateway->bytes.data(), address_length);
+        }
+        if (route.interface_index != 0)
+        {
+          const uint32_t index = route.interface_index;
+          AddAttribute(&buffer, RTA_OIF, &index, sizeof(index));
+        }
+        if (route.metric != 0)
+        {
+          const uint32_t metric = route.metric;
+          AddAttribute(&buffer, RTA_PRIORITY, &metric, sizeof(metric));
+        }
+
+        nlmsghdr header{};
+        header.nlmsg_len = static_cast<uint32_t>(buffer.size() - start);
+        header.nlmsg_type = type;
+        header.nlmsg_flags = static_cast<uint16_t>(NLM_F_REQUEST | NLM_F_ACK | flags);
+        header.nlmsg_seq = static_cast<uint32_t>(i + 1);
+        memcpy(buffer.data() + start, &header, sizeof(header));
+      }
+
+      sockaddr_nl kernel{};
+      kernel.nl_family = AF_NETLINK;
+      if (sendto(fd, buffer.data(), buffer.size(), 0, reinterpret_cast<sockaddr *>(&kernel), sizeof(kernel)) !=
+          static_cast<ssize_t>(buffer.size()))
+      {
+        *error = std::string("netlink send: ") + strerror(errno);
+        close(fd);
+        return false;
+      }
+
+      size_t acked = 0;
+      std::vector<char> reply(64 * 1024);
+      while (acked < routes.size())
+      {
+        const ssize_t length = recv(fd, reply.data(), reply.size(), 0);
+        if (length < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          // The messages went out, so the kernel may have applied any
+          // of those still unanswered
+          *error = std::string("netlink receive: ") + strerror(errno);
+          break;
+        }
+        int remaining = static_cast<int>(length);
+        for (auto *header = reinterpret_cast<nlmsghdr *>(reply.data()); NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining))
+        {
+          if (header->nlmsg_type != NLMSG_ERROR || header->nlmsg_seq == 0 ||
+              header->nlmsg_seq > routes.size())
+          {
+            continue;
+          }
+          const auto *ack = static_cast<const nlmsgerr *>(NLMSG_DATA(header));
+          int &result = (*errors)[header->nlmsg_seq - 1];
+          if (result == kNoAck)
+          {
+            result = -ack->error;
+            acked++;
+          }
+        }
+      }
+      close(fd);
+      return true;
+    }
+#endif
+
+  } // namespace
+
+#ifdef _WIN32
+  void SystemRouteBackend::AddRoutes(const std::vector<NativeRoute> &routes,
+                                     std::vector<RouteResult> *results, std::string *error)
+  {
+    results->assign(routes.size(), RouteResult::kFailed);
+    for (size_t i = 0; i < routes.size(); i++)
+    {
+      MIB_IPFORWARD_ROW2 row;
+      if (!FillRow(routes[i], &row))
+      {
+        *error = "No interface for route " + DescribeRoute(routes[i]);
+        return;
+      }
+      const DWORD status = CreateIpForwardEntry2(&row);
+      if (status == NO_ERROR)
+      {
+        (*results)[i] = RouteResult::kAdded;
+      }
+      else if (status == ERROR_OBJECT_ALREADY_EXISTS)
+      {
+        (*results)[i] = RouteResult::kExisted;
+      }
+      else
+      {
+        // The rest are left unattempted; the caller rolls back
+        *error = "Adding route " + DescribeRoute(routes[i]) + " failed with error " + std::to_string(status);
+        return;
+      }
+    }
+  }
+
+  bool SystemRouteBackend::DeleteRoutes(const std::vector<NativeRoute> &routes, std::string *error)
+  {
+    bool ok = true;
+    for (const NativeRoute &route : routes)
+    {
+      MIB_IPFORWARD_ROW2 row;
+      if (!FillRow(route, &row))
+      {
+        continue; // Its interface is gone, and the route with it
+      }
+      const DWORD status = DeleteIpForwardEntry2(&row);
+      if (status != NO_ERROR && status != ERROR_NOT_FOUND && ok)
+      {
+        *error = "Removing route " + DescribeRoute(route) + " failed with error " + std::to_string(status);
+        ok = false;
+      }
+    }
+    return ok;
+  }
+
+  uint32_t SystemRouteBackend::InterfaceIndexForAddress(const IpAddress &address)
+  {
+    PMIB_UNICASTIPADDRESS_TABLE table = nullptr;
+    if (GetUnicastIpAddressTable(address.ipv6 ? AF_INET6 : AF_INET, &table) != NO_ERROR)
+    {
+      return 0;
+    }
+    uint32_t index = 0;
+    for (ULONG i = 0; i < table->NumEntries && index == 0; i++)
+    {
+      const SOCKADDR_INET &entry = table->Table[i].Address;
+      const bool match = address.ipv6
+                             ? memcmp(entry.Ipv6.sin6_addr.s6_addr, address.bytes.data(), 16) == 0
+                             : memcmp(&entry.Ipv4.sin_addr, address.bytes.data(), 4) == 0;
+      if (match)
+      {
+        index = table->Table[i].InterfaceIndex;
+      }
+    }
+    FreeMibTable(table);
+    return index;
+  }
+#elif defined(__linux__)
+  void SystemRouteBackend::AddRoutes(const std::vector<NativeRoute> &routes,
+                                     std::vector<RouteResult> *results, std::string *error)
+  {
+    results->assign(routes.size(), RouteResult::kFailed);
+    std::vector<int> errors;
+    if (!Transact(RTM_NEWROUTE, NLM_F_CREATE | NLM_F_EXCL, routes, &errors, error))
+    {
+      return;
+    }
+    for (size_t i = 0; i < routes.size(); i++)
+    {
+      if (errors[i] == 0)
+      {
+        (*results)[i] = RouteResult::kAdded;
+      }
+      else if (errors[i] == EEXIST)
+      {
+        (*results)[i] = RouteResult::kExisted;
+      }
+      else if (errors[i] == kNoAck)
+      {
+        (*results)[i] = RouteResult::kUnknown;
+      }
+      else if (error->empty())
+      {
+        *error = "Adding route " + DescribeRoute(routes[i]) + " failed: " + strerror(errors[i]);
+      }
+    }
+  }
+
+  bool SystemRouteBackend::DeleteRoutes(const std::vector<NativeRoute> &routes, std::string *error)
+  {
+    std::vector<int> errors;
+    if (!Transact(RTM_DELROUTE, 0, routes, &errors, error))
+    {
+      return false;
+    }
+    for (size_t i = 0; i < routes.size(); i++)
+    {
+      if (errors[i] == kNoAck)
+      {
+        return false; // |error| has the receive failure
+      }
+      if (errors[i] != 0 && errors[i] != ESRCH && errors[i] != ENODEV)
+      {
+        *error = "Removing route " + DescribeRoute(routes[i]) + " failed: " + strerror(errors[i]);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint32_t SystemRouteBackend::InterfaceIndexForAddress(const IpAddress &address)
+  {
+    ifaddrs *interfaces = nullptr;
+    if (getifaddrs(&interfaces) != 0)
+    {
+      return 0;
+    }
+    uint32_t index = 0;
+    for (ifaddrs *entry = interfaces; entry && index == 0; entry = entry->ifa_next)
+    {
+      if (!entry->ifa_addr)
+      {
+        continue;
+      }
+      bool match = false;
+      if (address.ipv6 && entry->ifa_addr->sa_family == AF_INET6)
+      {
+        const auto *ipv6 = reinterpret_cast<const sockaddr_in6 *>(entry->ifa_addr);
+        match = memcmp(ipv6->sin6_addr.s6_addr, address.bytes.data(), 16) == 0;
+      }
+      else if (!address.ipv6 && entry->ifa_addr->sa_family == AF_INET)
+      {
+        const auto *ipv4 = reinterpret_cast<const sockaddr_in *>(entry->ifa_addr);
+        match = memcmp(&ipv4->sin_addr, address.bytes.data(), 4) == 0;
+      }
+      if (match)
+      {
+        index = if_nametoindex(entry->ifa_name);
+      }
+    }
+    freeifaddrs(interfaces);
+    return index;
+  }
+#else
+  void SystemRouteBackend::AddRoutes(const std::vector<NativeRoute> &routes,
+                                     std::vector<RouteResult> *results, std::string *error)
+  {
+    results->assign(routes.size(), RouteResult::kFailed);
+    *error = "Routes cannot be installed natively on this platform";
+  }
+
+  bool SystemRouteBackend::DeleteRoutes(const std::vector<NativeRoute> &routes, std::string *error)
+  {
+    if (routes.empty())
+    {
+      return true;
+    }
+    *error = "Routes cannot be removed natively on this platform";
+    return false;
+  }
+
+  uint32_t SystemRouteBackend::InterfaceIndexForAddress(const IpAddress &)
+  {
+    return 0;
+  }
+#endif
+
+} // namespace openvpn_dart
@@ -0,0 +1,28 @@
+#ifndef FLUTTER_PLUGIN_SYSTEM_ROUTE_BACKEND_H_
+#define FLUTTER_PLUGIN_SYSTEM_ROUTE_BACKEND_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "route_programmer.h"
+
+namespace openvpn_dart
+{
+
+    // The machine's main routing table: the IP Helper API on Windows, and
+    // on Linux one netlink request per batch, acknowledged route by route.
+    // Needs administrator rights (CAP_NET_ADMIN on Linux). On Linux it acts
+    // in the network namespace of the calling thread.
+    class SystemRouteBackend : public RouteBackend
+    {
+    public:
+        void AddRoutes(const std::vector<NativeRoute> &routes, std::vector<RouteResult> *results,
+                       std::string *error) override;
+        bool DeleteRoutes(const std::vector<NativeRoute> &routes, std::string *error) override;
+        uint32_t InterfaceIndexForAddress(const IpAddress &address) override;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_SYSTEM_ROUTE_BACKEND_H_
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_logger.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // Collects what reaches the sink, thread-safe
+      struct CapturedLines
+      {
+        std::mutex mutex;
+        std::vector<std::string> lines;
+
+        AsyncLogger::Sink Sink()
+        {
+          return [this](LogLevel, const std::string &line)
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(line);
+          };
+        }
+
+        std::vector<std::string> Take()
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          return lines;
+        }
+      };
+
+      std::string MessageOf(const std::string &line)
+      {
+        // After "<date> <time> <LEVEL> [<thread>] "
+        const size_t bracket = line.find("] ");
+        return bracket == std::string::npos ? line : line.substr(bracket + 2);
+      }
+
+    } // namespace
+
+    TEST(AsyncLogger, FormatsArgumentsOnTheSinkThread)
+    {
+      AsyncLogger logger;
+      logger.set_level(LogLevel::kTrace);
+      CapturedLines captured;
+      logger.SetSinks({captured.Sink()});
+
+      const std::string path = "C:\\data\\openvpn.log";
+      logger.Log(LogLevel::kInfo, "Extracted {} files ({} ms) to {}", 6, int64_t{42}, path);
+      logger.Log(LogLevel::kWarning, "ratio {} ok {} missing {} {}", 0.5, true, "arg");
+      logger.Log(LogLevel::kError, "braces {x} stay", size_t{7});
+      logger.Start();
+      logger.Flush();
+      logger.Stop();
+
+      const std::vector<std::string> lines = captured.Take();
+      ASSERT_EQ(lines.size(), 3u);
+      EXPECT_EQ(MessageOf(lines[0]), "Extracted 6 files (42 ms) to C:\\data\\openvpn.log");
+      EXPECT_EQ(MessageOf(lines[1]), "ratio 0.5 ok true missing arg {}");
+      EXPECT_EQ(MessageOf(lines[2]), "braces {x} stay");
+      EXPECT_NE(lines[0].find(" INFO  ["), std::string::npos);
+      EXPECT_NE(lines[1].find(" WARN  ["), std::string::npos);
+      EXPECT_NE(lines[2].find(" ERROR ["), std::string::npos);
+    }
+
+    TEST(AsyncLogger, FormatsUtcTimestamps)
+    {
+      LogRecord record;
+      record.format = "hello";
+      record.level = LogLevel::kDebug;
+      record.thread_id = 3;
+      record.unix_ms = 1767323045678; // 2026-01-02 03:04:05.678 UTC
+      EXPECT_EQ(FormatLogLine(record), "2026-01-02 03:04:05.678Z DEBUG [3] hello");
+    }
+
+    TEST(AsyncLogger, SkipsLevelsBelowTheThreshold)
+    {
+      AsyncLogger logger;
+      logger.set_level(LogLevel::kWarning);
+      CapturedLines captured;
+      logger.SetSinks({captured.Sink()});
+
+      logger.Log(LogLevel::kDebug, "hidden {}", 1);
+      logger.Log(LogLevel::kInfo, "hidden");
+      logger.Log(LogLevel::kWarning, "shown");
+      logger.Log(LogLevel::kOff, "never");
+      logger.Flush();
+
+      const std::vector<std::string> lines = captured.Take();
+      ASSERT_EQ(lines.size(), 1u);
+      EXPECT_EQ(MessageOf(lines[0]), "shown");
+    }
+
+    TEST(AsyncLogger, ClipsLongText)
+    {
+      AsyncLogger logger;
+      CapturedLines captured;
+      logger.SetSinks({captured.Sink()});
+
+      const std::string long_text(LogRecord::kTextBytes + 50, 'x');
+      logger.Log(LogLevel::kError, "{}|{}", long_text, "tail");
+      logger.Flush();
+
+      const std::string message = MessageOf(captured.Take().at(0));
+      EXPECT_EQ(message, std::string(LogRecord::kTextBytes, 'x') + "...|...");
+    }
+
+    TEST(AsyncLogger, DropsAndReportsWhenTheRingIsFull)
+    {
+      AsyncLogger logger(4);
+      CapturedLines captured;
+      logger.SetSinks({captured.Sink()});
+
+      for (int i = 0; i < 10; i++)
+      {
+        logger.Log(LogLevel::kError, "record {}", i);
+      }
+      EXPECT_EQ(logger.dropped(), 6u);
+      logger.Flush();
+
+      const std::vector<std::string> lines = captured.Take();
+      ASSERT_EQ(lines.size(), 5u);
+      EXPECT_EQ(MessageOf(lines[0]), "record 0");
+      EXPECT_EQ(MessageOf(lines[3]), "record 3");
+      EXPECT_EQ(MessageOf(lines[4]), "6 log records dropped, ring full");
+
+      // Slots are free again once drained
+      logger.Log(LogLevel::kError, "after");
+      logger.Flush();
+      EXPECT_EQ(MessageOf(captured.Take().back()), "after");
+    }
+
+    TEST(AsyncLogger, ManyThreadsLogConcurrently)
+    {
+      AsyncLogger logger(256);
+      CapturedLines captured;
+      logger.SetSinks({captured.Sink()});
+      logger.Start();
+
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; t++)
+      {
+        threads.emplace_back([&logger, t]()
+                             {
+                               for (int i = 0; i < 200; i++)
+                               {
+                                 logger.Log(LogLevel::kError, "thread {} line {}", t, i);
+                               } });
+      }
+      for (auto &thread : threads)
+      {
+        thread.join();
+      }
+      logger.Flush();
+      logger.Stop();
+
+      // Each record arrives whole; the ring may have dropped some
+      const std::vector<std::string> lines = captured.Take();
+      size_t records = 0;
+      for (const auto &line : lines)
+      {
+        const std::string message = MessageOf(line);
+        if (message.find("dropped") != std::string::npos)
+        {
+          continue;
+        }
+        EXPECT_EQ(message.rfind("thread ", 0), 0u) << message;
+        records++;
+      }
+      EXPECT_EQ(records + logger.dropped(), 800u);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
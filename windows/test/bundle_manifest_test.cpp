@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "bundle_manifest.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // Stand-in for SHA-256: any stable 64-hex-digit function of the content
+      std::string FakeDigest(const std::string &content)
+      {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx",
+                      static_cast<unsigned long long>(std::hash<std::string>()(content)));
+        return std::string(hex) + std::string(hex) + std::string(hex) + std::string(hex);
+      }
+
+      class BundleManifestTest : public ::testing::Test
+      {
+      protected:
+        void SetUp() override
+        {
+          const auto stamp =
+              std::chrono::steady_clock::now().time_since_epoch().count();
+          root_ = std::filesystem::temp_directory_path() /
+                  ("openvpn_dart_bundle_" + std::to_string(stamp));
+          source_ = (root_ / "source").string();
+          dest_ = (root_ / "dest").string();
+          std::filesystem::create_directories(source_);
+          std::filesystem::create_directories(dest_);
+          hasher_ = [this](const std::string &path, std::string *digest)
+          {
+            hashed_++;
+            std::ifstream in(path, std::ios::binary);
+            if (!in)
+            {
+              return false;
+            }
+            *digest = FakeDigest(std::string(std::istreambuf_iterator<char>(in),
+                                             std::istreambuf_iterator<char>()));
+            return true;
+          };
+        }
+
+        void TearDown() override
+        {
+          std::error_code ec;
+          std::filesystem::remove_all(root_, ec);
+        }
+
+        static void Write(const std::string &dir, const std::string &name,
+                          const std::string &content)
+        {
+          std::ofstream out(std::filesystem::path(dir) / name, std::ios::binary | std::ios::trunc);
+          out << content;
+        }
+
+        static std::string Read(const std::string &dir, const std::string &name)
+        {
+          std::ifstream in(std::filesystem::path(dir) / name, std::ios::binary);
+          return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+
+        BundleEntry AddSource(const std::string &name, const std::string &content)
+        {
+          Write(source_, name, content);
+          BundleEntry entry;
+          entry.name = name;
+          entry.size = content.size();
+          entry.sha256 = FakeDigest(content);
+          return entry;
+        }
+
+        std::filesystem::path root_;
+        std::string source_;
+        std::string dest_;
+        FileHasher hasher_;
+        int hashed_ = 0;
+      };
+
+    } // namespace
+
+    TEST(BundleManifest, ParsesEntries)
+    {
+      const std::string digest(64, 'a');
+      std::vector<BundleEntry> entries;
+      ASSERT_TRUE(ParseBundleManifest("# generated\n" + digest + " 1044312 openvpn.exe\r\n\n" +
+                                          digest + " 12 tap windows.exe\n",
+                                      &entries));
+      ASSERT_EQ(entries.size(), 2u);
+      EXPECT_EQ(entries[0].name, "openvpn.exe");
+      EXPECT_EQ(entries[0].size, 1044312u);
+      EXPECT_EQ(entries[0].sha256, digest);
+      EXPECT_EQ(entries[1].name, "tap windows.exe");
+    }
+
+    TEST(BundleManifest, RejectsMalformedLines)
+    {
+      const std::string digest(64, 'a');
+      std::vector<BundleEntry> entries;
+      EXPECT_FALSE(ParseBundleManifest(digest + " openvpn.exe\n", &entries));
+      EXPECT_FALSE(ParseBundleManifest("abc 12 openvpn.exe\n", &entries));
+      EXPECT_FALSE(ParseBundleManifest(digest + " 12x openvpn.exe\n", &entries));
+      EXPECT_FALSE(ParseBundleManifest(digest + " 12 ../openvpn.exe\n", &entries));
+    }
+
+    TEST_F(BundleManifestTest, CopiesOnlyMissingOrChangedFiles)
+    {
+      std::vector<BundleEntry> manifest = {
+          AddSource("openvpn.exe", "openvpn binary"),
+          AddSource("libssl-3-x64.dll", "ssl"),
+          AddSource("vcruntime140.dll", "runtime"),
+      };
+      Write(dest_, "openvpn.exe", "openvpn binary");
+      Write(dest_, "libssl-3-x64.dll", "old"); // Same size, different content
+
+      ExtractionResult result = ExtractBundle(source_, dest_, manifest, hasher_, 4);
+      EXPECT_EQ(result.up_to_date, 1u);
+      EXPECT_EQ(result.copied, 2u);
+      EXPECT_EQ(result.failed, 0u);
+      EXPECT_EQ(Read(dest_, "libssl-3-x64.dll"), "ssl");
+      EXPECT_EQ(Read(dest_, "vcruntime140.dll"), "runtime");
+      EXPECT_FALSE(std::filesystem::exists(std::filesystem::path(dest_) / "vcruntime140.dll.partial"));
+
+      // Everything matches now; a size mismatch skips hashing altogether
+      hashed_ = 0;
+      result = ExtractBundle(source_, dest_, manifest, hasher_, 4);
+      EXPECT_EQ(result.up_to_date, 3u);
+      EXPECT_EQ(result.copied, 0u);
+      EXPECT_EQ(hashed_, 3);
+
+      Write(dest_, "openvpn.exe", "truncated");
+      hashed_ = 0;
+      EXPECT_EQ(PlanExtraction(manifest, dest_, hasher_).size(), 1u);
+      EXPECT_EQ(hashed_, 2);
+    }
+
+    TEST_F(BundleManifestTest, FailedCopyKeepsExistingFile)
+    {
+      BundleEntry entry = AddSource("openvpn.exe", "new binary");
+      entry.size += 1; // Source no longer matches what the build recorded
+      Write(dest_, "openvpn.exe", "old binary");
+
+      ExtractionResult result = ExtractBundle(source_, dest_, {entry}, hasher_, 2);
+      EXPECT_EQ(result.copied, 0u);
+      EXPECT_EQ(result.failed, 1u);
+      ASSERT_EQ(result.errors.size(), 1u);
+      EXPECT_EQ(Read(dest_, "openvpn.exe"), "old binary");
+      EXPECT_FALSE(std::filesystem::exists(std::filesystem::path(dest_) / "openvpn.exe.partial"));
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
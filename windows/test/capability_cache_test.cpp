@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "capability_cache.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      constexpr char kVersionWithDco[] =
+          "OpenVPN 2.6.9 [git:v2.6.9/6640a10bf6d84eee] Windows-MSVC [SSL (OpenSSL)] [LZO] [LZ4] "
+          "[PKCS11] [AEAD] [DCO] built on Feb 12 2024\r\n"
+          "library versions: OpenSSL 3.2.1 30 Jan 2024, LZO 2.10\r\n"
+          "DCO version: 1.0.0\r\n"
+          "Windows version 10.0 (Windows 10 or greater), amd64 executable\r\n";
+
+      constexpr char kVersionDcoUnavailable[] =
+          "OpenVPN 2.6.9 [git:v2.6.9/6640a10bf6d84eee] Windows-MSVC [SSL (OpenSSL)] [LZO] [DCO] built on Feb 12 2024\n"
+          "DCO version: N/A\n";
+
+      class CapabilityCacheTest : public ::testing::Test
+      {
+      protected:
+        void SetUp() override
+        {
+          const auto stamp =
+              std::chrono::steady_clock::now().time_since_epoch().count();
+          dir_ = std::filesystem::temp_directory_path() /
+                 ("openvpn_dart_caps_" + std::to_string(stamp));
+          std::filesystem::create_directories(dir_);
+          executable_ = (dir_ / "openvpn.exe").string();
+          cache_ = (dir_ / "capabilities.txt").string();
+          WriteExecutable("v1");
+        }
+
+        void TearDown() override
+        {
+          std::error_code ec;
+          std::filesystem::remove_all(dir_, ec);
+        }
+
+        void WriteExecutable(const std::string &contents)
+        {
+          std::ofstream out(executable_, std::ios::binary | std::ios::trunc);
+          out << contents;
+        }
+
+        CapabilityCache::Prober CountingProber(int *calls)
+        {
+          return [calls](const std::string &, std::string *output)
+          {
+            ++*calls;
+            *output = kVersionWithDco;
+            return true;
+          };
+        }
+
+        std::filesystem::path dir_;
+        std::string executable_;
+        std::string cache_;
+      };
+
+    } // namespace
+
+    TEST(OpenVPNCapabilities, ParsesVersionFeaturesAndDco)
+    {
+      OpenVPNCapabilities caps = ParseVersionOutput(kVersionWithDco);
+      EXPECT_TRUE(caps.probed);
+      EXPECT_EQ(caps.version, "2.6.9");
+      ASSERT_EQ(caps.features.size(), 6u);
+      EXPECT_EQ(caps.features[0], "SSL (OpenSSL)");
+      EXPECT_EQ(caps.features[5], "DCO");
+      EXPECT_EQ(caps.dco_version, "1.0.0");
+      EXPECT_TRUE(caps.SupportsDCO());
+
+      OpenVPNCapabilities unavailable = ParseVersionOutput(kVersionDcoUnavailable);
+      EXPECT_TRUE(unavailable.dco_compiled);
+      EXPECT_FALSE(unavailable.SupportsDCO());
+
+      EXPECT_FALSE(ParseVersionOutput("The system cannot find the file specified.").probed);
+    }
+
+    TEST(OpenVPNCapabilities, SerializationRoundTrips)
+    {
+      ExecutableStamp stamp;
+      stamp.path = "C:\\Users\\me\\AppData\\Local\\OpenVPNDart\\openvpn.exe";
+      stamp.size = 1044312;
+      stamp.mtime = 133520000000000000;
+      OpenVPNCapabilities caps = ParseVersionOutput(kVersionWithDco);
+
+      ExecutableStamp parsed_stamp;
+      OpenVPNCapabilities parsed;
+      ASSERT_TRUE(ParseCapabilities(SerializeCapabilities(stamp, caps), &parsed_stamp, &parsed));
+      EXPECT_EQ(parsed_stamp, stamp);
+      EXPECT_EQ(parsed.version, caps.version);
+      EXPECT_EQ(parsed.features, caps.features);
+      EXPECT_EQ(parsed.dco_version, caps.dco_version);
+      EXPECT_TRUE(parsed.SupportsDCO());
+
+      EXPECT_FALSE(ParseCapabilities("path=x\nversion=2.6.9\n", &parsed_stamp, &parsed));
+    }
+
+    TEST_F(CapabilityCacheTest, ProbesOncePerExecutable)
+    {
+      int calls = 0;
+      CapabilityCache cache(executable_, cache_, CountingProber(&calls));
+      cache.ProbeAsync();
+      EXPECT_TRUE(cache.Get().SupportsDCO());
+      EXPECT_TRUE(cache.Get().SupportsDCO());
+      EXPECT_EQ(calls, 1);
+
+      // Replaced bundle: different size, so the stamp no longer matches
+      WriteExecutable("v2 with a different size");
+      EXPECT_EQ(cache.Get().version, "2.6.9");
+      EXPECT_EQ(calls, 2);
+    }
+
+    TEST_F(CapabilityCacheTest, ReusesPersistedResult)
+    {
+      int calls = 0;
+      {
+        CapabilityCache cache(executable_, cache_, CountingProber(&calls));
+        cache.Get();
+      }
+      CapabilityCache reloaded(executable_, cache_, CountingProber(&calls));
+      EXPECT_TRUE(reloaded.Get().SupportsDCO());
+      EXPECT_EQ(calls, 1);
+    }
+
+    TEST_F(CapabilityCacheTest, DoesNotCacheFailedProbe)
+    {
+      int calls = 0;
+      CapabilityCache cache(executable_, cache_,
+                            [&calls](const std::string &, std::string *)
+                            {
+                              ++calls;
+                              return false;
+                            });
+      EXPECT_FALSE(cache.Get().probed);
+      EXPECT_FALSE(cache.Get().probed);
+      EXPECT_EQ(calls, 2);
+      EXPECT_FALSE(std::filesystem::exists(cache_));
+
+      std::filesystem::remove(executable_);
+      EXPECT_FALSE(cache.Get().probed);
+      EXPECT_EQ(calls, 2);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "command_executor.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      int64_t ElapsedMs(std::chrono::steady_clock::time_point since)
+      {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - since)
+            .count();
+      }
+
+    } // namespace
+
+    TEST(CommandExecutorTest, RunsCommandsInOrderOffTheCallingThread)
+    {
+      CommandExecutor executor;
+      std::vector<std::string> order;
+      std::vector<std::thread::id> threads;
+      for (const char *name : {"connect", "disconnect", "connect"})
+      {
+        executor.Submit(name, 0, [&, name](CommandContext &)
+                        {
+                          order.push_back(name);
+                          threads.push_back(std::this_thread::get_id());
+                        });
+      }
+      executor.WaitIdle();
+
+      EXPECT_EQ(order, (std::vector<std::string>{"connect", "disconnect", "connect"}));
+      ASSERT_EQ(threads.size(), 3u);
+      EXPECT_NE(threads[0], std::this_thread::get_id());
+      EXPECT_EQ(threads[0], threads[1]);
+      EXPECT_EQ(threads[1], threads[2]);
+    }
+
+    TEST(CommandExecutorTest, SubmitReturnsWhileCommandBlocks)
+    {
+      CommandExecutor executor;
+      std::promise<void> release;
+      std::shared_future<void> released = release.get_future().share();
+
+      const auto start = std::chrono::steady_clock::now();
+      executor.Submit("setupTunnel", 0, [released](CommandContext &)
+                      { released.wait(); });
+      EXPECT_LT(ElapsedMs(start), 100);
+
+      release.set_value();
+      executor.WaitIdle();
+    }
+
+    TEST(CommandExecutorTest, CancelWakesRunningCommand)
+    {
+      CommandExecutor executor;
+      std::promise<bool> slept;
+      std::promise<void> started;
+      executor.Submit("connect", 0, [&](CommandContext &context)
+                      {
+                        started.set_value();
+                        slept.set_value(context.SleepFor(10000));
+                      });
+      started.get_future().wait();
+
+      const auto start = std::chrono::steady_clock::now();
+      EXPECT_EQ(executor.Cancel("connect"), 1u);
+      EXPECT_FALSE(slept.get_future().get());
+      EXPECT_LT(ElapsedMs(start), 1000);
+      executor.WaitIdle();
+    }
+
+    TEST(CommandExecutorTest, CancelDropsQueuedCommandsByName)
+    {
+      CommandExecutor executor;
+      std::promise<void> started;
+      std::promise<void> release;
+      std::shared_future<void> released = release.get_future().share();
+      executor.Submit("disconnect", 0, [&started, released](CommandContext &)
+                      {
+                        started.set_value();
+                        released.wait();
+                      });
+      started.get_future().wait();
+
+      std::atomic<bool> connect_ran(false);
+      std::vector<CancelReason> dropped;
+      executor.Submit(
+          "connect", 0, [&](CommandContext &)
+          { connect_ran = true; },
+          [&](CancelReason reason)
+          { dropped.push_back(reason); });
+      std::atomic<bool> status_ran(false);
+      executor.Submit("status", 0, [&](CommandContext &)
+                      { status_ran = true; });
+      EXPECT_EQ(executor.queued(), 2u);
+
+      EXPECT_EQ(executor.Cancel("connect"), 1u);
+      EXPECT_EQ(dropped, std::vector<CancelReason>{CancelReason::kCancelled});
+      EXPECT_EQ(executor.running(), "disconnect");
+
+      release.set_value();
+      executor.WaitIdle();
+      EXPECT_FALSE(connect_ran);
+      EXPECT_TRUE(status_ran);
+    }
+
+    TEST(CommandExecutorTest, DeadlineEndsRunningCommand)
+    {
+      CommandExecutor executor;
+      std::promise<CancelReason> reason;
+      const auto start = std::chrono::steady_clock::now();
+      executor.Submit("connect", 100, [&](CommandContext &context)
+                      {
+                        EXPECT_GT(context.remaining_ms(), 0);
+                        while (context.SleepFor(20))
+                        {
+                        }
+                        reason.set_value(context.reason());
+                      });
+
+      EXPECT_EQ(reason.get_future().get(), CancelReason::kDeadlineExceeded);
+      const int64_t elapsed = ElapsedMs(start);
+      EXPECT_GE(elapsed, 90);
+      EXPECT_LT(elapsed, 1000);
+      executor.WaitIdle();
+    }
+
+    TEST(CommandExecutorTest, DeadlineCountsTimeSpentQueued)
+    {
+      CommandExecutor executor;
+      std::promise<void> release;
+      std::shared_future<void> released = release.get_future().share();
+      executor.Submit("disconnect", 0, [released](CommandContext &)
+                      { released.wait(); });
+
+      std::atomic<bool> ran(false);
+      std::promise<CancelReason> dropped;
+      executor.Submit(
+          "connect", 50, [&](CommandContext &)
+          { ran = true; },
+          [&](CancelReason reason)
+          { dropped.set_value(reason); });
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      release.set_value();
+      EXPECT_EQ(dropped.get_future().get(), CancelReason::kDeadlineExceeded);
+      executor.WaitIdle();
+      EXPECT_FALSE(ran);
+    }
+
+    TEST(CommandExecutorTest, ThrowIfCancelledUnwindsAndWorkerSurvives)
+    {
+      CommandExecutor executor;
+      std::promise<CancelReason> caught;
+      executor.Submit("connect", 0, [&](CommandContext &context)
+                      {
+                        context.Cancel(CancelReason::kCancelled);
+                        try
+                        {
+                          context.ThrowIfCancelled();
+                        }
+                        catch (const CommandCancelled &e)
+                        {
+                          caught.set_value(e.reason());
+                        }
+                      });
+      EXPECT_EQ(caught.get_future().get(), CancelReason::kCancelled);
+
+      executor.Submit("boom", 0, [](CommandContext &)
+                      { throw std::runtime_error("escaped"); });
+      std::atomic<bool> ran(false);
+      executor.Submit("after", 0, [&](CommandContext &)
+                      { ran = true; });
+      executor.WaitIdle();
+      EXPECT_TRUE(ran);
+    }
+
+    TEST(CommandExecutorTest, ShutdownCancelsRunningAndDropsTheRest)
+    {
+      std::promise<void> started;
+      std::atomic<bool> saw_shutdown(false);
+      std::vector<CancelReason> dropped;
+      {
+        CommandExecutor executor;
+        executor.Submit("connect", 0, [&](CommandContext &context)
+                        {
+                          started.set_value();
+                          context.SleepFor(10000);
+                          saw_shutdown = context.reason() == CancelReason::kShutdown;
+                        });
+        executor.Submit(
+            "disconnect", 0, [](CommandContext &) {},
+            [&](CancelReason reason)
+            { dropped.push_back(reason); });
+        started.get_future().wait();
+
+        executor.Shutdown();
+        executor.Submit(
+            "late", 0, [](CommandContext &) {},
+            [&](CancelReason reason)
+            { dropped.push_back(reason); });
+      }
+      EXPECT_TRUE(saw_shutdown);
+      EXPECT_EQ(dropped, (std::vector<CancelReason>{CancelReason::kShutdown, CancelReason::kShutdown}));
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
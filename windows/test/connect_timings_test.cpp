@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "connect_timings.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(ConnectTimings, StampsMilestonesRelativeToRequest)
+    {
+      ConnectTimingRecorder recorder;
+      recorder.Begin(1000, 1700000000000, false);
+      recorder.Mark(ConnectMilestone::kConfigWritten, 1002);
+      recorder.Mark(ConnectMilestone::kProcessStarted, 1030);
+      recorder.Mark(ConnectMilestone::kStartupChecked, 1530);
+      recorder.Mark(MilestoneForState(ManagementState::kAuth), 1700);
+      // Only the first time a milestone is reached counts
+      recorder.Mark(MilestoneForState(ManagementState::kAuth), 1900);
+      recorder.Mark(MilestoneForState(ManagementState::kAddRoutes), 3800);
+      EXPECT_TRUE(recorder.pending());
+      recorder.Finish(ConnectOutcome::kConnected, 4100);
+      EXPECT_FALSE(recorder.pending());
+
+      const std::vector<ConnectTimings> sessions = recorder.Sessions();
+      ASSERT_EQ(sessions.size(), 1u);
+      const ConnectTimings &timings = sessions[0];
+      EXPECT_EQ(timings.sequence, 1u);
+      EXPECT_EQ(timings.start_unix_ms, 1700000000000);
+      EXPECT_FALSE(timings.prewarmed);
+      EXPECT_EQ(timings.outcome, ConnectOutcome::kConnected);
+      EXPECT_EQ(timings.total_ms, 3100);
+      EXPECT_EQ(timings.at(ConnectMilestone::kConfigWritten), 2);
+      EXPECT_EQ(timings.at(ConnectMilestone::kProcessStarted), 30);
+      EXPECT_EQ(timings.at(ConnectMilestone::kStartupChecked), 530);
+      EXPECT_EQ(timings.at(ConnectMilestone::kAuth), 700);
+      EXPECT_EQ(timings.at(ConnectMilestone::kAddRoutes), 2800);
+      EXPECT_EQ(timings.at(ConnectMilestone::kConnected), 3100);
+      EXPECT_EQ(timings.at(ConnectMilestone::kResolve), -1);
+    }
+
+    TEST(ConnectTimings, MapsManagementStates)
+    {
+      EXPECT_EQ(MilestoneForState(ManagementState::kWait), ConnectMilestone::kWait);
+      EXPECT_EQ(MilestoneForState(ManagementState::kConnected), ConnectMilestone::kConnected);
+      EXPECT_EQ(MilestoneForState(ManagementState::kReconnecting), ConnectMilestone::kCount);
+      EXPECT_STREQ(ConnectMilestoneName(ConnectMilestone::kAddRoutes), "addRoutes");
+      EXPECT_STREQ(ConnectOutcomeName(ConnectOutcome::kCancelled), "cancelled");
+    }
+
+    TEST(ConnectTimings, IgnoresMarksOutsideAConnect)
+    {
+      ConnectTimingRecorder recorder;
+      recorder.Mark(ConnectMilestone::kAuth, 10);
+      recorder.Finish(ConnectOutcome::kFailed, 20);
+      EXPECT_TRUE(recorder.Sessions().empty());
+
+      recorder.Begin(100, 0, true);
+      recorder.Finish(ConnectOutcome::kFailed, 250);
+      // A reconnect after the session is up is not part of the connect
+      recorder.Mark(ConnectMilestone::kAuth, 300);
+      recorder.Finish(ConnectOutcome::kConnected, 400);
+
+      const ConnectTimings timings = recorder.Sessions()[0];
+      EXPECT_TRUE(timings.prewarmed);
+      EXPECT_EQ(timings.outcome, ConnectOutcome::kFailed);
+      EXPECT_EQ(timings.total_ms, 150);
+      EXPECT_EQ(timings.at(ConnectMilestone::kAuth), -1);
+      EXPECT_EQ(timings.at(ConnectMilestone::kConnected), -1);
+    }
+
+    TEST(ConnectTimings, NewConnectSupersedesPendingOne)
+    {
+      ConnectTimingRecorder recorder;
+      recorder.Begin(0, 0, false);
+      recorder.Begin(500, 0, false);
+
+      const std::vector<ConnectTimings> sessions = recorder.Sessions();
+      ASSERT_EQ(sessions.size(), 2u);
+      EXPECT_EQ(sessions[0].outcome, ConnectOutcome::kCancelled);
+      EXPECT_EQ(sessions[0].total_ms, 500);
+      EXPECT_EQ(sessions[1].outcome, ConnectOutcome::kPending);
+      EXPECT_EQ(sessions[1].sequence, 2u);
+    }
+
+    TEST(ConnectTimings, KeepsOnlyTheNewestSessions)
+    {
+      ConnectTimingRecorder recorder(3);
+      for (int i = 0; i < 5; i++)
+      {
+        recorder.Begin(i * 1000, 0, false);
+        recorder.Finish(ConnectOutcome::kConnected, i * 1000 + 100 * (i + 1));
+      }
+
+      const std::vector<ConnectTimings> sessions = recorder.Sessions();
+      ASSERT_EQ(sessions.size(), 3u);
+      EXPECT_EQ(sessions.front().sequence, 3u);
+      EXPECT_EQ(sessions.back().sequence, 5u);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event_queue.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(EventQueueTest, DrainsInPushOrder)
+    {
+      EventQueue<std::string> queue;
+      queue.Push("connecting");
+      queue.Push("connected");
+      queue.Push("disconnecting");
+
+      std::vector<std::string> batch;
+      EXPECT_EQ(queue.Drain(0, &batch), 3u);
+      EXPECT_EQ(batch, (std::vector<std::string>{"connecting", "connected", "disconnecting"}));
+      EXPECT_EQ(queue.depth(), 0u);
+
+      batch.clear();
+      EXPECT_EQ(queue.Drain(0, &batch), 0u);
+      EXPECT_TRUE(batch.empty());
+    }
+
+    TEST(EventQueueTest, AsksForOneDrainPerBurst)
+    {
+      EventQueue<int> queue;
+      EXPECT_TRUE(queue.Push(1));
+      EXPECT_FALSE(queue.Push(2));
+      EXPECT_FALSE(queue.Push(3));
+
+      std::vector<int> batch;
+      queue.Drain(0, &batch);
+      EXPECT_TRUE(queue.Push(4));
+      EXPECT_FALSE(queue.Push(5));
+    }
+
+    TEST(EventQueueTest, CoalescesKeyedEventsWithinBatch)
+    {
+      constexpr uint32_t kStats = 1;
+      EventQueue<std::string> queue;
+      queue.Push("stats 1", kStats);
+      queue.Push("connected");
+      queue.Push("stats 2", kStats);
+      queue.Push("log");
+      queue.Push("stats 3", kStats);
+
+      std::vector<std::string> batch;
+      EXPECT_EQ(queue.Drain(0, &batch), 3u);
+      EXPECT_EQ(batch, (std::vector<std::string>{"stats 3", "connected", "log"}));
+
+      // The next batch starts over
+      queue.Push("stats 4", kStats);
+      batch.clear();
+      queue.Drain(0, &batch);
+      EXPECT_EQ(batch, (std::vector<std::string>{"stats 4"}));
+
+      const EventQueueMetrics metrics = queue.Metrics();
+      EXPECT_EQ(metrics.published, 6u);
+      EXPECT_EQ(metrics.delivered, 4u);
+      EXPECT_EQ(metrics.coalesced, 2u);
+      EXPECT_EQ(metrics.batches, 2u);
+      EXPECT_EQ(metrics.max_depth, 5u);
+      EXPECT_EQ(metrics.depth, 0u);
+    }
+
+    TEST(EventQueueTest, MeasuresRatesPerWindow)
+    {
+      EventQueue<int> queue;
+      std::vector<int> batch;
+      for (int64_t now_ms = 0; now_ms <= 1000; now_ms += 250)
+      {
+        for (int i = 0; i < 10; i++)
+        {
+          queue.Push(i);
+        }
+        queue.Drain(now_ms, &batch);
+      }
+
+      const EventQueueMetrics metrics = queue.Metrics();
+      EXPECT_DOUBLE_EQ(metrics.events_per_second, 50.0);
+      EXPECT_DOUBLE_EQ(metrics.batches_per_second, 5.0);
+    }
+
+    TEST(EventQueueTest, ConcurrentProducersLoseNothing)
+    {
+      constexpr int kProducers = 4;
+      constexpr int kPerProducer = 20000;
+      EventQueue<int> queue;
+      std::atomic<int> wakeups(0);
+      std::vector<std::thread> producers;
+      for (int p = 0; p < kProducers; p++)
+      {
+        producers.emplace_back([&queue, &wakeups, p]()
+                               {
+                                 for (int i = 0; i < kPerProducer; i++)
+                                 {
+                                   if (queue.Push(p * kPerProducer + i))
+                                   {
+                                     wakeups++;
+                                   }
+                                 }
+                               });
+      }
+
+      std::vector<int> received;
+      std::vector<int> last(kProducers, -1);
+      bool ordered = true;
+      const size_t total = static_cast<size_t>(kProducers) * kPerProducer;
+      std::vector<int> batch;
+      while (received.size() < total)
+      {
+        batch.clear();
+        queue.Drain(0, &batch);
+        for (int value : batch)
+        {
+          // Each producer's events arrive in its own order
+          const int producer = value / kPerProducer;
+          ordered = ordered && value > last[producer];
+          last[producer] = value;
+          received.push_back(value);
+        }
+      }
+      for (auto &producer : producers)
+      {
+        producer.join();
+      }
+
+      EXPECT_TRUE(ordered);
+      EXPECT_EQ(received.size(), total);
+      EXPECT_EQ(queue.Metrics().published, total);
+      EXPECT_LE(static_cast<uint64_t>(wakeups.load()), queue.Metrics().batches + 1);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
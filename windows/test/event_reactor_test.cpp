@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "event_reactor.h"
+#include "loopback_socket.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // Runs the reactor until |done| is set or two seconds pass.
+      bool RunUntil(EventReactor &reactor, const bool &done)
+      {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (!done && std::chrono::steady_clock::now() < deadline)
+        {
+          reactor.RunOnce(100);
+        }
+        return done;
+      }
+
+    } // namespace
+
+    TEST(EventReactor, TimesOutWithNoSources)
+    {
+      EventReactor reactor;
+      ASSERT_TRUE(reactor.ok());
+      EXPECT_FALSE(reactor.RunOnce(10));
+    }
+
+    TEST(EventReactor, SignalFromAnotherThreadWakesLoop)
+    {
+      EventReactor reactor;
+      bool fired = false;
+      const auto id = reactor.AddSignal([&fired]()
+                                        { fired = true; });
+      ASSERT_NE(id, EventReactor::kInvalidSource);
+
+      std::thread signaller([&reactor, id]()
+                            {
+                              std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                              reactor.Signal(id); });
+      EXPECT_TRUE(RunUntil(reactor, fired));
+      signaller.join();
+    }
+
+    TEST(EventReactor, WakeInterruptsWithoutDispatch)
+    {
+      EventReactor reactor;
+      bool fired = false;
+      reactor.AddSignal([&fired]()
+                        { fired = true; });
+      reactor.RunOnce(0); // Drain the wake-up queued by AddSignal.
+
+      reactor.Wake();
+      EXPECT_FALSE(reactor.RunOnce(1000));
+      EXPECT_FALSE(fired);
+    }
+
+    TEST(EventReactor, RemovedSourceDoesNotFire)
+    {
+      EventReactor reactor;
+      bool fired = false;
+      const auto id = reactor.AddSignal([&fired]()
+                                        { fired = true; });
+      reactor.Remove(id);
+      reactor.Signal(id);
+      reactor.RunOnce(50);
+      EXPECT_FALSE(fired);
+    }
+
+    TEST(EventReactor, SocketFiresWhileReadableAndOnClose)
+    {
+      uint16_t port = 0;
+      const auto listener = loopback::Listen(0, &port);
+      ASSERT_NE(listener, loopback::kInvalidSocket);
+      const auto client = loopback::Connect(port, 1000);
+      ASSERT_NE(client, loopback::kInvalidSocket);
+      const auto server = loopback::Accept(listener);
+      ASSERT_NE(server, loopback::kInvalidSocket);
+
+      EventReactor reactor;
+      std::string received;
+      bool closed = false;
+      bool got_data = false;
+      const auto id = reactor.WatchSocket(client, [&]()
+                                          {
+        char buffer[2];
+        const long n = loopback::Receive(client, buffer, sizeof(buffer));
+        if (n > 0)
+        {
+          received.append(buffer, static_cast<size_t>(n));
+          got_data = received.size() == 5;
+        }
+        else if (n == 0)
+        {
+          closed = true;
+        } });
+      ASSERT_NE(id, EventReactor::kInvalidSource);
+
+      // Small reads: the source keeps firing until everything is consumed
+      ASSERT_TRUE(loopback::SendAll(server, "hello"));
+      EXPECT_TRUE(RunUntil(reactor, got_data));
+      EXPECT_EQ(received, "hello");
+
+      loopback::Close(server);
+      EXPECT_TRUE(RunUntil(reactor, closed));
+
+      reactor.Remove(id);
+      loopback::Close(client);
+      loopback::Close(listener);
+    }
+
+    TEST(EventReactor, ProcessExitFiresOnce)
+    {
+      EventReactor reactor;
+      int exits = 0;
+#ifdef _WIN32
+      STARTUPINFOA si = {0};
+      si.cb = sizeof(si);
+      PROCESS_INFORMATION pi = {0};
+      char command[] = "cmd.exe /c exit 0";
+      ASSERT_TRUE(CreateProcessA(nullptr, command, nullptr, nullptr, FALSE,
+                                 CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi));
+      const auto id = reactor.WatchProcess(pi.hProcess, [&exits]()
+                                           { ++exits; });
+#else
+      const pid_t child = fork();
+      ASSERT_GE(child, 0);
+      if (child == 0)
+      {
+        usleep(20000);
+        _exit(0);
+      }
+      const auto id = reactor.WatchProcess(child, [&exits]()
+                                           { ++exits; });
+#endif
+      ASSERT_NE(id, EventReactor::kInvalidSource);
+
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (exits == 0 && std::chrono::steady_clock::now() < deadline)
+      {
+        reactor.RunOnce(100);
+      }
+      reactor.RunOnce(20);
+      EXPECT_EQ(exits, 1);
+
+#ifdef _WIN32
+      CloseHandle(pi.hProcess);
+      CloseHandle(pi.hThread);
+#else
+      waitpid(child, nullptr, 0);
+#endif
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,186 @@
+#ifndef FLUTTER_PLUGIN_TEST_FAKE_MANAGEMENT_SERVER_H_
+#define FLUTTER_PLUGIN_TEST_FAKE_MANAGEMENT_SERVER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "loopback_socket.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    // Stands in for OpenVPN's --management listener on 127.0.0.1.
+    //
+    // Accepts one client, greets it like OpenVPN does, records every command
+    // it receives and answers each with a scripted reply ("SUCCESS: ok" by
+    // default). Tests push notifications with Send(). With a |password| the
+    // client is first prompted for it, as with a --management password
+    // file, and dropped if it is wrong.
+    class FakeManagementServer
+    {
+    public:
+      explicit FakeManagementServer(std::string password = std::string())
+          : port_(0),
+            password_(std::move(password)),
+            client_(loopback::kInvalidSocket)
+      {
+        listener_ = loopback::Listen(0, &port_);
+        if (listener_ != loopback::kInvalidSocket)
+        {
+          thread_ = std::thread(&FakeManagementServer::Serve, this);
+        }
+      }
+
+      ~FakeManagementServer()
+      {
+        DisconnectClient();
+        loopback::Shutdown(listener_);
+        if (thread_.joinable())
+        {
+          thread_.join();
+        }
+        loopback::Close(listener_);
+      }
+
+      uint16_t port() const { return port_; }
+
+      // Reply sent for |command| instead of "SUCCESS: ok". Multi-line replies
+      // are given with embedded "\n" and must end with "END".
+      void SetReply(const std::string &command, const std::string &reply)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        replies_[command] = reply;
+      }
+
+      bool WaitForClient(int timeout_ms = 2000)
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                            [this]()
+                            { return client_ != loopback::kInvalidSocket; });
+      }
+
+      bool Send(const std::string &line)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return loopback::SendAll(client_, line + "\r\n");
+      }
+
+      // Waits until at least |count| commands were received.
+      std::vector<std::string> WaitForCommands(size_t count, int timeout_ms = 2000)
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                     [this, count]()
+                     { return commands_.size() >= count; });
+        return commands_;
+      }
+
+      // True once a client gave the wrong password
+      bool WaitForRejection(int timeout_ms = 2000)
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                            [this]()
+                            { return rejected_; });
+      }
+
+      void DisconnectClient()
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loopback::Shutdown(client_);
+      }
+
+    private:
+      void Serve()
+      {
+        const loopback::SocketHandle client = loopback::Accept(listener_);
+        if (client == loopback::kInvalidSocket)
+        {
+          return;
+        }
+        char buffer[1024];
+        std::string partial;
+        long received;
+        if (!password_.empty())
+        {
+          loopback::SendAll(client, "ENTER PASSWORD:");
+          size_t newline = std::string::npos;
+          while (newline == std::string::npos &&
+                 (received = loopback::Receive(client, buffer, sizeof(buffer))) > 0)
+          {
+            partial.append(buffer, static_cast<size_t>(received));
+            newline = partial.find('\n');
+          }
+          if (newline == std::string::npos || partial.substr(0, newline) != password_)
+          {
+            loopback::SendAll(client, "ERROR: bad password\r\n");
+            loopback::Close(client);
+            std::lock_guard<std::mutex> lock(mutex_);
+            rejected_ = true;
+            cv_.notify_all();
+            return;
+          }
+          partial.erase(0, newline + 1);
+          loopback::SendAll(client, "SUCCESS: password is correct\r\n");
+        }
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          client_ = client;
+          loopback::SendAll(client_,
+                            ">INFO:OpenVPN Management Interface Version 5 -- type 'help' for more info\r\n");
+        }
+        cv_.notify_all();
+
+        while ((received = loopback::Receive(client, buffer, sizeof(buffer))) > 0)
+        {
+          partial.append(buffer, static_cast<size_t>(received));
+          size_t newline;
+          while ((newline = partial.find('\n')) != std::string::npos)
+          {
+            std::string command = partial.substr(0, newline);
+            partial.erase(0, newline + 1);
+            if (!command.empty() && command.back() == '\r')
+            {
+              command.pop_back();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            commands_.push_back(command);
+            const auto reply = replies_.find(command);
+            loopback::SendAll(client_, (reply == replies_.end() ? std::string("SUCCESS: ok")
+                                                                 : reply->second) +
+                                           "\r\n");
+            cv_.notify_all();
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        loopback::Close(client_);
+        client_ = loopback::kInvalidSocket;
+      }
+
+      uint16_t port_;
+      const std::string password_;
+      bool rejected_ = false;
+      loopback::SocketHandle listener_;
+      loopback::SocketHandle client_;
+      std::thread thread_;
+      std::mutex mutex_;
+      std::condition_variable cv_;
+      std::map<std::string, std::string> replies_;
+      std::vector<std::string> commands_;
+    };
+
+  } // namespace test
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_TEST_FAKE_MANAGEMENT_SERVER_H_
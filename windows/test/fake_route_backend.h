@@ -0,0 +1,91 @@
+#ifndef FLUTTER_PLUGIN_TEST_FAKE_ROUTE_BACKEND_H_
+#define FLUTTER_PLUGIN_TEST_FAKE_ROUTE_BACKEND_H_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "route_programmer.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    // An in-memory routing table.
+    //
+    // Adding a route already in |table| reports it as existing. Routes equal
+    // to |reject| fail, and the rest of their batch is still applied, as on
+    // netlink. Routes equal to |unanswered| are added but reported unknown,
+    // as after a lost netlink ack. Deletes fail, removing nothing, while
+    // |fail_deletes| is set.
+    // Every call is recorded.
+    class FakeRouteBackend : public RouteBackend
+    {
+    public:
+      void AddRoutes(const std::vector<NativeRoute> &routes, std::vector<RouteResult> *results,
+                     std::string *error) override
+      {
+        add_batches.push_back(routes.size());
+        results->assign(routes.size(), RouteResult::kFailed);
+        for (size_t i = 0; i < routes.size(); i++)
+        {
+          if (std::find(reject.begin(), reject.end(), routes[i]) != reject.end())
+          {
+            *error = "rejected " + DescribeRoute(routes[i]);
+          }
+          else if (Contains(routes[i]))
+          {
+            (*results)[i] = RouteResult::kExisted;
+          }
+          else
+          {
+            table.push_back(routes[i]);
+            const bool answered = std::find(unanswered.begin(), unanswered.end(), routes[i]) == unanswered.end();
+            (*results)[i] = answered ? RouteResult::kAdded : RouteResult::kUnknown;
+            if (!answered)
+            {
+              *error = "no answer for " + DescribeRoute(routes[i]);
+            }
+          }
+        }
+      }
+
+      bool DeleteRoutes(const std::vector<NativeRoute> &routes, std::string *error) override
+      {
+        delete_batches.push_back(routes.size());
+        if (fail_deletes)
+        {
+          *error = "delete failed";
+          return false;
+        }
+        for (const NativeRoute &route : routes)
+        {
+          table.erase(std::remove(table.begin(), table.end(), route), table.end());
+        }
+        return true;
+      }
+
+      uint32_t InterfaceIndexForAddress(const IpAddress &) override
+      {
+        return interface_index;
+      }
+
+      bool Contains(const NativeRoute &route) const
+      {
+        return std::find(table.begin(), table.end(), route) != table.end();
+      }
+
+      std::vector<NativeRoute> table;
+      std::vector<NativeRoute> reject;
+      std::vector<NativeRoute> unanswered;
+      std::vector<size_t> add_batches;
+      std::vector<size_t> delete_batches;
+      bool fail_deletes = false;
+      uint32_t interface_index = 0;
+    };
+
+  } // namespace test
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_TEST_FAKE_ROUTE_BACKEND_H_
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "log_line_parser.h"
+
+#ifdef __linux__
+namespace
+{
+  // Counts every heap allocation in the test binary while enabled.
+  std::atomic<bool> g_count_allocations{false};
+  std::atomic<uint64_t> g_allocations{0};
+} // namespace
+
+void *operator new(size_t size)
+{
+  if (g_count_allocations.load(std::memory_order_relaxed))
+  {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void *p = std::malloc(size == 0 ? 1 : size))
+  {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  std::free(p);
+}
+#endif
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(LineSplitter, SplitsAcrossFeeds)
+    {
+      LineSplitter splitter;
+      std::vector<std::string> lines;
+      const auto collect = [&lines](std::string_view line)
+      { lines.emplace_back(line); };
+
+      splitter.Feed("first li", collect);
+      EXPECT_EQ(splitter.pending_bytes(), 8u);
+      splitter.Feed("ne\r\nsecond\n\nthird", collect);
+      splitter.Finish(collect);
+      EXPECT_EQ(lines, (std::vector<std::string>{"first line", "second", "", "third"}));
+      EXPECT_EQ(splitter.pending_bytes(), 0u);
+    }
+
+    TEST(LineSplitter, HandsOutViewsIntoTheFedBuffer)
+    {
+      const std::string data = "one\ntwo\n";
+      std::vector<const char *> starts;
+      LineSplitter splitter;
+      splitter.Feed(data, [&starts](std::string_view line)
+                    { starts.push_back(line.data()); });
+      EXPECT_EQ(starts, (std::vector<const char *>{data.data(), data.data() + 4}));
+    }
+
+    TEST(LogRecord, ParsesTimestampSeverityAndClass)
+    {
+      LogRecord record = ParseLogRecord(
+          "2026-01-01 10:00:02 TLS Error: TLS handshake failed");
+      EXPECT_EQ(record.timestamp, "2026-01-01 10:00:02");
+      EXPECT_EQ(record.message, "TLS Error: TLS handshake failed");
+      EXPECT_EQ(record.severity, LogSeverity::kError);
+      EXPECT_EQ(record.events, LogEventBit(LogEvent::kTlsError));
+
+      record = ParseLogRecord("Thu Jan  1 10:00:07 2026 Exiting due to fatal error");
+      EXPECT_EQ(record.timestamp, "Thu Jan  1 10:00:07 2026");
+      EXPECT_EQ(record.message, "Exiting due to fatal error");
+      EXPECT_EQ(record.severity, LogSeverity::kFatal);
+
+      record = ParseLogRecord("WARNING: file 'auth.txt' is group or others accessible");
+      EXPECT_TRUE(record.timestamp.empty());
+      EXPECT_EQ(record.severity, LogSeverity::kWarning);
+
+      record = ParseLogRecord("2026-01-01 10:00:05 Initialization Sequence Completed");
+      EXPECT_EQ(record.severity, LogSeverity::kInfo);
+      EXPECT_EQ(record.events, LogEventBit(LogEvent::kConnected));
+    }
+
+    TEST(LogRecord, SanitizesNonAscii)
+    {
+      std::string out = "exit: ";
+      AppendSanitized("caf\xc3\xa9 ok", &out);
+      EXPECT_EQ(out, "exit: caf?? ok");
+    }
+
+#ifdef __linux__
+    TEST(LogRecord, ParsesMegabytesWithoutAllocating)
+    {
+      std::string log;
+      for (int i = 0; log.size() < 4 * 1024 * 1024; i++)
+      {
+        log += "2026-01-01 10:00:00 TLS: soft reset sec=3600/3600 bytes=" + std::to_string(i) + "/-1\r\n";
+        log += "2026-01-01 10:00:01 ERROR: Windows route add command failed [adaptive]: returned error code 1\n";
+        log += "2026-01-01 10:00:02 Initialization Sequence Completed\n";
+      }
+
+      LineSplitter splitter(4096);
+      uint64_t lines = 0;
+      uint64_t errors = 0;
+      const auto parse = [&lines, &errors](std::string_view line)
+      {
+        lines++;
+        if (ParseLogRecord(line).severity == LogSeverity::kError)
+        {
+          errors++;
+        }
+      };
+      // Odd-sized reads, so lines keep straddling the chunks
+      constexpr size_t kChunk = 4093;
+      constexpr size_t kWarmUp = 16 * kChunk;
+      const auto feed = [&](size_t begin, size_t end)
+      {
+        for (size_t offset = begin; offset < end; offset += kChunk)
+        {
+          splitter.Feed(std::string_view(log).substr(offset, std::min(kChunk, end - offset)), parse);
+        }
+      };
+      // Builds the signature table and grows the partial-line buffer to
+      // the longest line
+      feed(0, kWarmUp);
+
+      g_allocations = 0;
+      g_count_allocations = true;
+      feed(kWarmUp, log.size());
+      splitter.Finish(parse);
+      g_count_allocations = false;
+
+      const double megabytes = static_cast<double>(log.size()) / (1024 * 1024);
+      EXPECT_EQ(g_allocations.load(), 0u) << "allocations per MB: "
+                                          << static_cast<double>(g_allocations.load()) / megabytes;
+      EXPECT_EQ(lines * 1, errors * 3);
+    }
+#endif
+
+  } // namespace test
+} // namespace openvpn_dart
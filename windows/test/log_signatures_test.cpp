@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "log_signatures.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // What a find() per signature reports, the matcher's reference.
+      LogEventMask FindEach(std::string_view line)
+      {
+        LogEventMask mask = 0;
+        for (const LogSignature &signature : kLogSignatures)
+        {
+          if (line.find(signature.pattern) != std::string_view::npos)
+          {
+            mask |= LogEventBit(signature.event);
+          }
+        }
+        return mask;
+      }
+
+    } // namespace
+
+    TEST(LogSignatureMatcher, MatchesEverySignature)
+    {
+      const LogSignatureMatcher &matcher = LogSignatureMatcher::Default();
+      for (const LogSignature &signature : kLogSignatures)
+      {
+        const std::string line = "2026-01-01 10:00:00 x " + std::string(signature.pattern) + " y";
+        EXPECT_TRUE(HasLogEvent(matcher.Match(line), signature.event)) << signature.pattern;
+        EXPECT_TRUE(HasLogEvent(matcher.Match(signature.pattern), signature.event)) << signature.pattern;
+      }
+      EXPECT_EQ(matcher.Match(""), 0u);
+      EXPECT_EQ(matcher.Match("2026-01-01 10:00:00 TUN/TAP device ovpn-dco opened"), 0u);
+    }
+
+    TEST(LogSignatureMatcher, ReportsOverlappingSignatures)
+    {
+      const LogSignatureMatcher &matcher = LogSignatureMatcher::Default();
+      const LogEventMask mask = matcher.Match(
+          "VERIFY ERROR: depth=0, error=certificate has expired");
+      EXPECT_EQ(mask, LogEventBit(LogEvent::kTlsError) | LogEventBit(LogEvent::kError));
+
+      // A failed partial match must not hide a signature starting inside it
+      EXPECT_EQ(matcher.Match("TLS ErrTLS Error: TLS key negotiation failed"),
+                LogEventBit(LogEvent::kTlsError));
+      EXPECT_EQ(matcher.Match("AUTH_FAIAUTH_FAILED"), LogEventBit(LogEvent::kAuthFailed));
+    }
+
+    TEST(LogSignatureMatcher, AgreesWithFindOnOpenVPNOutput)
+    {
+      const std::vector<std::string> lines = {
+          "2026-01-01 10:00:00 OpenVPN 2.6.8 [git:v2.6.8/3b0d9489cc423da3] Windows-MSVC [SSL (OpenSSL)] [LZO] [LZ4] [PKCS11] [AEAD] [DCO]",
+          "2026-01-01 10:00:01 TCP/UDP: Preserving recently used remote address: [AF_INET]203.0.113.7:1194",
+          "2026-01-01 10:00:02 TLS Error: TLS key negotiation failed to occur within 60 seconds (check your network connectivity)",
+          "2026-01-01 10:00:02 TLS Error: TLS handshake failed",
+          "2026-01-01 10:00:02 SIGUSR1[soft,tls-error] received, process restarting",
+          "2026-01-01 10:00:03 Note: --mtu-test not supported by DCO, disabling data channel offload.",
+          "2026-01-01 10:00:04 ERROR: Windows route add command failed [adaptive]: returned error code 1",
+          "2026-01-01 10:00:04 Route addition via IPAPI failed [adaptive]",
+          "2026-01-01 10:00:05 Initialization Sequence Completed With Errors ( see http://openvpn.net/faq.html#dhcpclientserv )",
+          "2026-01-01 10:00:06 MANAGEMENT: >STATE:1767261606,CONNECTED,SUCCESS,10.8.0.2,203.0.113.7,1194,,",
+          "2026-01-01 10:00:07 AUTH: Received control message: AUTH_FAILED",
+          "2026-01-01 10:00:07 Exiting due to fatal error",
+          "2026-01-01 10:00:08 CONNECTION_TIMEOUT",
+          "2026-01-01 10:00:09 Data Channel: cipher 'AES-256-GCM', peer-id: 0",
+      };
+      const LogSignatureMatcher &matcher = LogSignatureMatcher::Default();
+      for (const std::string &line : lines)
+      {
+        EXPECT_EQ(matcher.Match(line), FindEach(line)) << line;
+      }
+    }
+
+    TEST(LogSignatureMatcher, CompilesCustomTable)
+    {
+      const LogSignature table[] = {
+          {"he", LogEvent::kConnected},
+          {"she", LogEvent::kError},
+          {"hers", LogEvent::kFatal},
+      };
+      LogSignatureMatcher matcher(table, std::size(table));
+      EXPECT_EQ(matcher.Match("ushers"),
+                LogEventBit(LogEvent::kConnected) | LogEventBit(LogEvent::kError) |
+                    LogEventBit(LogEvent::kFatal));
+      EXPECT_EQ(matcher.Match("hhe"), LogEventBit(LogEvent::kConnected));
+      EXPECT_EQ(matcher.Match("sh"), 0u);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include "log_status_tracker.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(LogStatusTracker, FollowsConnectAndReconnect)
+    {
+      LogStatusTracker tracker;
+      EXPECT_EQ(tracker.status(), "connecting");
+      EXPECT_FALSE(tracker.OnLine("TCP/UDP: Preserving recently used remote address"));
+      EXPECT_TRUE(tracker.OnLine("Initialization Sequence Completed"));
+      EXPECT_EQ(tracker.status(), "connected");
+      EXPECT_TRUE(tracker.OnLine("TCP/UDP: Preserving recently used remote address"));
+      EXPECT_EQ(tracker.status(), "connecting");
+      EXPECT_TRUE(tracker.OnLine("AUTH: Received control message: AUTH_FAILED"));
+      EXPECT_EQ(tracker.status(), "error");
+
+      tracker.Reset();
+      EXPECT_FALSE(tracker.connection_established());
+      EXPECT_EQ(tracker.status(), "connecting");
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
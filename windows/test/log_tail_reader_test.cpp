@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "log_tail_reader.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      class LogTailReaderTest : public ::testing::Test
+      {
+      protected:
+        void SetUp() override
+        {
+          const auto stamp =
+              std::chrono::steady_clock::now().time_since_epoch().count();
+          path_ = (std::filesystem::temp_directory_path() /
+                   ("openvpn_dart_tail_" + std::to_string(stamp) + ".log"))
+                      .string();
+        }
+
+        void TearDown() override
+        {
+          std::error_code ec;
+          std::filesystem::remove(path_, ec);
+        }
+
+        void Write(const std::string &data, bool append = true)
+        {
+          std::ofstream out(path_, std::ios::binary |
+                                       (append ? std::ios::app : std::ios::trunc));
+          out << data;
+        }
+
+        std::vector<std::string> Poll(LogTailReader &reader, bool *restarted = nullptr)
+        {
+          std::vector<std::string> lines;
+          reader.Poll(
+              [&lines](std::string_view line)
+              { lines.emplace_back(line); },
+              [restarted]()
+              {
+                if (restarted)
+                {
+                  *restarted = true;
+                }
+              });
+          return lines;
+        }
+
+        std::string path_;
+      };
+
+    } // namespace
+
+    TEST_F(LogTailReaderTest, MissingFileYieldsNothing)
+    {
+      LogTailReader reader(path_);
+      EXPECT_TRUE(Poll(reader).empty());
+      EXPECT_EQ(reader.offset(), 0u);
+    }
+
+    TEST_F(LogTailReaderTest, ReadsOnlyAppendedLines)
+    {
+      LogTailReader reader(path_);
+      Write("first\nsecond\n", false);
+      EXPECT_EQ(Poll(reader), (std::vector<std::string>{"first", "second"}));
+      EXPECT_TRUE(Poll(reader).empty());
+
+      Write("third\r\n");
+      EXPECT_EQ(Poll(reader), (std::vector<std::string>{"third"}));
+      EXPECT_EQ(reader.offset(), 20u);
+    }
+
+    TEST_F(LogTailReaderTest, CarriesPartialLineUntilNewline)
+    {
+      LogTailReader reader(path_);
+      Write("Initialization Seq", false);
+      EXPECT_TRUE(Poll(reader).empty());
+      EXPECT_EQ(reader.pending_bytes(), 18u);
+
+      Write("uence Completed\nnext");
+      EXPECT_EQ(Poll(reader),
+                (std::vector<std::string>{"Initialization Sequence Completed"}));
+      EXPECT_EQ(reader.pending_bytes(), 4u);
+    }
+
+    TEST_F(LogTailReaderTest, RestartsAfterTruncation)
+    {
+      LogTailReader reader(path_);
+      Write("old line one\nold line two\n", false);
+      Poll(reader);
+
+      bool restarted = false;
+      Write("new\n", false);
+      EXPECT_EQ(Poll(reader, &restarted), (std::vector<std::string>{"new"}));
+      EXPECT_TRUE(restarted);
+    }
+
+    TEST_F(LogTailReaderTest, RestartsAfterRotationToLargerFile)
+    {
+      LogTailReader reader(path_);
+      Write("2024-01-01 00:00:00 session A\n", false);
+      Poll(reader);
+
+      bool restarted = false;
+      Write("2024-01-02 00:00:00 session B started\n"
+            "2024-01-02 00:00:01 Initialization Sequence Completed\n",
+            false);
+      const auto lines = Poll(reader, &restarted);
+      EXPECT_TRUE(restarted);
+      ASSERT_EQ(lines.size(), 2u);
+      EXPECT_EQ(lines[0], "2024-01-02 00:00:00 session B started");
+    }
+
+    TEST_F(LogTailReaderTest, HandlesLinesSpanningReadChunks)
+    {
+      LogTailReader reader(path_);
+      const std::string long_line(200 * 1024, 'x');
+      Write(long_line + "\nshort\n", false);
+      const auto lines = Poll(reader);
+      ASSERT_EQ(lines.size(), 2u);
+      EXPECT_EQ(lines[0].size(), long_line.size());
+      EXPECT_EQ(lines[1], "short");
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,329 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_management_server.h"
+#include "management_client.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // Collects callbacks from the client's reader thread.
+      struct Recorder
+      {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<StateNotification> states;
+        std::vector<ByteCountNotification> counts;
+        std::vector<LogNotification> logs;
+        std::vector<std::string> holds;
+        std::vector<RemoteNotification> remotes;
+        bool connected = false;
+        bool disconnected = false;
+
+        ManagementClient::Handlers Handlers()
+        {
+          ManagementClient::Handlers handlers;
+          handlers.on_connected = [this]()
+          { Record([this]()
+                   { connected = true; }); };
+          handlers.on_state = [this](const StateNotification &state)
+          { Record([this, state]()
+                   { states.push_back(state); }); };
+          handlers.on_bytecount = [this](const ByteCountNotification &count)
+          { Record([this, count]()
+                   { counts.push_back(count); }); };
+          handlers.on_log = [this](const LogNotification &log)
+          { Record([this, log]()
+                   { logs.push_back(log); }); };
+          handlers.on_hold = [this](const std::string &message)
+          { Record([this, message]()
+                   { holds.push_back(message); }); };
+          handlers.on_remote = [this](const RemoteNotification &remote)
+          { Record([this, remote]()
+                   { remotes.push_back(remote); }); };
+          handlers.on_disconnected = [this]()
+          { Record([this]()
+                   { disconnected = true; }); };
+          return handlers;
+        }
+
+        template <typename F>
+        void Record(F update)
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            update();
+          }
+          cv.notify_all();
+        }
+
+        template <typename P>
+        bool WaitFor(P predicate)
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          return cv.wait_for(lock, std::chrono::seconds(2), predicate);
+        }
+      };
+
+      // Runs a shared EventReactor on its own thread, like the plugin's
+      // session reactor.
+      struct ReactorThread
+      {
+        EventReactor reactor;
+        std::atomic<bool> done{false};
+        std::thread loop{[this]()
+                         {
+                           while (!done)
+                           {
+                             reactor.RunOnce();
+                           }
+                         }};
+
+        ~ReactorThread()
+        {
+          done = true;
+          reactor.Wake();
+          loop.join();
+        }
+      };
+
+    } // namespace
+
+    TEST(ManagementParsing, StateLine)
+    {
+      StateNotification state;
+      ASSERT_TRUE(ParseStateLine("1700000000,CONNECTED,SUCCESS,10.8.0.2,203.0.113.5,1194,,", &state));
+      EXPECT_EQ(state.timestamp, 1700000000);
+      EXPECT_EQ(state.state, ManagementState::kConnected);
+      EXPECT_EQ(state.detail, "SUCCESS");
+      EXPECT_EQ(state.local_ip, "10.8.0.2");
+      EXPECT_EQ(state.remote_ip, "203.0.113.5");
+      EXPECT_STREQ(StatusForState(state), "connected");
+
+      ASSERT_TRUE(ParseStateLine("1700000001,RECONNECTING,auth-failure,,", &state));
+      EXPECT_STREQ(StatusForState(state), "error");
+
+      ASSERT_TRUE(ParseStateLine("1700000002,ASSIGN_IP,,10.8.0.2,", &state));
+      EXPECT_STREQ(StatusForState(state), "connecting");
+
+      EXPECT_FALSE(ParseStateLine("not a state", &state));
+    }
+
+    TEST(ManagementParsing, ByteCountAndLogLines)
+    {
+      ByteCountNotification count;
+      ASSERT_TRUE(ParseByteCountLine("12345,678", &count));
+      EXPECT_EQ(count.bytes_in, 12345u);
+      EXPECT_EQ(count.bytes_out, 678u);
+      EXPECT_FALSE(ParseByteCountLine("12,x", &count));
+
+      LogNotification log;
+      ASSERT_TRUE(ParseLogLine("1700000000,W,route: add failed, retrying", &log));
+      EXPECT_EQ(log.flag, 'W');
+      EXPECT_EQ(log.message, "route: add failed, retrying");
+    }
+
+    TEST(ManagementParsing, RemoteLine)
+    {
+      RemoteNotification remote;
+      ASSERT_TRUE(ParseRemoteLine("vpn.example.com,1194,udp", &remote));
+      EXPECT_EQ(remote.host, "vpn.example.com");
+      EXPECT_EQ(remote.port, "1194");
+      EXPECT_EQ(remote.proto, "udp");
+      EXPECT_FALSE(ParseRemoteLine("vpn.example.com,1194", &remote));
+      EXPECT_FALSE(ParseRemoteLine(",1194,udp", &remote));
+    }
+
+    TEST(ManagementClient, DeliversTypedNotifications)
+    {
+      FakeManagementServer server;
+      Recorder recorder;
+      ManagementClient client(recorder.Handlers());
+      ASSERT_TRUE(client.Start(server.port(), 2000));
+      ASSERT_TRUE(server.WaitForClient());
+      ASSERT_TRUE(recorder.WaitFor([&]()
+                                   { return recorder.connected; }));
+
+      server.Send(">HOLD:Waiting for hold release:0");
+      server.Send(">STATE:1700000000,WAIT,,,");
+      server.Send(">STATE:1700000003,CONNECTED,SUCCESS,10.8.0.2,203.0.113.5,1194,,");
+      server.Send(">BYTECOUNT:4096,1024");
+      server.Send(">REMOTE:vpn.example.com,1194,udp");
+      server.Send(">LOG:1700000004,I,Initialization Sequence Completed");
+
+      ASSERT_TRUE(recorder.WaitFor([&]()
+                                   { return !recorder.logs.empty(); }));
+      std::lock_guard<std::mutex> lock(recorder.mutex);
+      ASSERT_EQ(recorder.holds.size(), 1u);
+      EXPECT_EQ(recorder.holds[0], "Waiting for hold release:0");
+      ASSERT_EQ(recorder.states.size(), 2u);
+      EXPECT_EQ(recorder.states[0].state, ManagementState::kWait);
+      EXPECT_EQ(recorder.states[1].state, ManagementState::kConnected);
+      ASSERT_EQ(recorder.counts.size(), 1u);
+      EXPECT_EQ(recorder.counts[0].bytes_in, 4096u);
+      ASSERT_EQ(recorder.remotes.size(), 1u);
+      EXPECT_EQ(recorder.remotes[0].host, "vpn.example.com");
+      EXPECT_EQ(recorder.logs[0].message, "Initialization Sequence Completed");
+    }
+
+    TEST(ManagementClient, MatchesRepliesToCommandsInOrder)
+    {
+      FakeManagementServer server;
+      server.SetReply("state", "1700000003,CONNECTED,SUCCESS,10.8.0.2,203.0.113.5,1194,,\r\nEND");
+      server.SetReply("bogus", "ERROR: unknown command, enter 'help' for more options");
+
+      Recorder recorder;
+      ManagementClient client(recorder.Handlers());
+      ASSERT_TRUE(client.Start(server.port(), 2000));
+      ASSERT_TRUE(recorder.WaitFor([&]()
+                                   { return recorder.connected; }));
+
+      std::vector<std::pair<bool, std::string>> replies;
+      auto collect = [&](bool ok, const std::string &reply)
+      { recorder.Record([&]()
+                        { replies.emplace_back(ok, reply); }); };
+      ASSERT_TRUE(client.SendCommand("state on", collect));
+      ASSERT_TRUE(client.SendCommand("state", collect));
+      ASSERT_TRUE(client.SendCommand("bogus", collect));
+
+      ASSERT_TRUE(recorder.WaitFor([&]()
+                                   { return replies.size() == 3; }));
+      EXPECT_EQ(server.WaitForCommands(3),
+                (std::vector<std::string>{"state on", "state", "bogus"}));
+      EXPECT_TRUE(replies[0].first);
+      EXPECT_EQ(replies[0].second, "ok");
+
+      StateNotification state;
+      EXPECT_TRUE(replies[1].first);
+      ASSERT_TRUE(ParseStateLine(replies[1].second, &state));
+      EXPECT_EQ(state.state, ManagementState::kConnected);
+
+      EXPECT_FALSE(replies[2].first);
+    }
+
+    TEST(ManagementClient, ReportsDisconnectAndFailsPendingCommands)
+    {
+      FakeManagementServer server;
+      Recorder recorder;
+      ManagementClient client(recorder.Handlers());
+      ASSERT_TRUE(client.Start(server.port(), 2000));
+      ASSERT_TRUE(recorder.WaitFor([&]()
+                                   { return recorder.connected; }));
+
+      server.DisconnectClient();
+      ASSERT_TRUE(recorder.WaitFor([&]()
+                                   { return recorder.disconnected; }));
+      EXPECT_FALSE(client.connected());
+      EXPECT_FALSE(client.SendCommand("state"));
+    }
+
+    TEST(ManagementClient, GivesUpWhenNothingListens)
+    {
+      Recorder recorder;
+      ManagementClient client(recorder.Handlers());
+      ASSERT_TRUE(client.Start(loopback::PickFreePort(), 200));
+      ASSERT_TRUE(recorder.WaitFor([&]()
+                                   { return recorder.disconnected; }));
+      EXPECT_FALSE(recorder.connected);
+    }
+
+    TEST(ManagementClient, AnswersThePasswordPromptBeforeConnecting)
+    {
+      FakeManagementServer server("s3cret");
+      Recorder recorder;
+      ManagementClient client(recorder.Handlers(), "s3cret");
+      ASSERT_TRUE(client.Start(server.port(), 2000));
+      ASSERT_TRUE(recorder.WaitFor([&]()
+                                   { return recorder.connected; }));
+      ASSERT_TRUE(server.WaitForClient());
+
+      ASSERT_TRUE(client.SendCommand("state on"));
+      EXPECT_EQ(server.WaitForCommands(1), (std::vector<std::string>{"state on"}));
+    }
+
+    TEST(ManagementClient, DisconnectsOnAWrongPassword)
+    {
+      FakeManagementServer server("s3cret");
+      ReactorThread reactor;
+      Recorder recorder;
+      ManagementClient client(recorder.Handlers(), "guess");
+      // The socket connects; the password is only checked on the reactor
+      ASSERT_TRUE(client.Start(&reactor.reactor, server.port(), 2000));
+      EXPECT_FALSE(client.SendCommand("state on"));
+      ASSERT_TRUE(server.WaitForRejection());
+      ASSERT_TRUE(recorder.WaitFor([&]()
+                                   { return recorder.disconnected; }));
+      EXPECT_FALSE(recorder.connected);
+      EXPECT_FALSE(client.connected());
+    }
+
+    TEST(ManagementClient, RunsOnSharedReactor)
+    {
+      ReactorThread reactor;
+      FakeManagementServer first_server;
+      FakeManagementServer second_server;
+      Recorder first;
+      Recorder second;
+      ManagementClient first_client(first.Handlers());
+      ManagementClient second_client(second.Handlers());
+      ASSERT_TRUE(first_client.Start(&reactor.reactor, first_server.port(), 2000));
+      ASSERT_TRUE(second_client.Start(&reactor.reactor, second_server.port(), 2000));
+      EXPECT_TRUE(first.connected);
+      EXPECT_TRUE(second.connected);
+      ASSERT_TRUE(first_server.WaitForClient());
+      ASSERT_TRUE(second_server.WaitForClient());
+
+      first_server.Send(">STATE:1700000003,CONNECTED,SUCCESS,10.8.0.2,203.0.113.5,1194,,");
+      second_server.Send(">BYTECOUNT:4096,1024");
+      ASSERT_TRUE(first.WaitFor([&]()
+                                { return first.states.size() == 1; }));
+      ASSERT_TRUE(second.WaitFor([&]()
+                                 { return second.counts.size() == 1; }));
+
+      bool replied = false;
+      ASSERT_TRUE(first_client.SendCommand("state on", [&](bool ok, const std::string &)
+                                           { first.Record([&]()
+                                                          { replied = ok; }); }));
+      ASSERT_TRUE(first.WaitFor([&]()
+                                { return replied; }));
+
+      // A closed peer is noticed on the reactor; a stopped client detaches
+      second_server.DisconnectClient();
+      ASSERT_TRUE(second.WaitFor([&]()
+                                 { return second.disconnected; }));
+      first_client.Stop();
+      EXPECT_TRUE(first.disconnected);
+      EXPECT_FALSE(first_client.connected());
+    }
+
+    TEST(ManagementClient, ReactorStartFailsWhenNothingListens)
+    {
+      EventReactor reactor;
+      Recorder recorder;
+      ManagementClient client(recorder.Handlers());
+      EXPECT_FALSE(client.Start(&reactor, loopback::PickFreePort(), 200));
+      EXPECT_FALSE(recorder.connected);
+      EXPECT_TRUE(recorder.disconnected);
+
+      // Gives up before the timeout once told to, e.g. OpenVPN exited
+      ManagementClient quitter(recorder.Handlers());
+      const auto start = std::chrono::steady_clock::now();
+      EXPECT_FALSE(quitter.Start(&reactor, loopback::PickFreePort(), 5000, []()
+                                 { return false; }));
+      EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
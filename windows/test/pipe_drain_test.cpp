@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pipe_drain.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      std::string FloodLine(int i)
+      {
+        return "2026-01-01 00:00:00 flood line " + std::to_string(i) + " padding padding padding";
+      }
+
+      // A fake child writing |lines| lines into a pipe with blocking writes.
+      // It only finishes if the reading side keeps draining.
+      class Flooder
+      {
+      public:
+        explicit Flooder(int lines)
+        {
+#ifdef _WIN32
+          SECURITY_ATTRIBUTES sa = {sizeof(sa), nullptr, FALSE};
+          HANDLE write_end = nullptr;
+          EXPECT_TRUE(CreatePipe(&read_, &write_end, &sa, 0));
+          writer_ = std::thread([write_end, lines]()
+                                {
+                                  for (int i = 0; i < lines; i++)
+                                  {
+                                    std::string line = FloodLine(i) + "\r\n";
+                                    DWORD written = 0;
+                                    WriteFile(write_end, line.data(), static_cast<DWORD>(line.size()), &written, nullptr);
+                                  }
+                                  CloseHandle(write_end); });
+#else
+          int fds[2];
+          EXPECT_EQ(pipe(fds), 0);
+          child_ = fork();
+          if (child_ == 0)
+          {
+            close(fds[0]);
+            for (int i = 0; i < lines; i++)
+            {
+              std::string line = FloodLine(i) + "\n";
+              size_t off = 0;
+              while (off < line.size())
+              {
+                ssize_t n = write(fds[1], line.data() + off, line.size() - off);
+                if (n <= 0)
+                {
+                  _exit(1);
+                }
+                off += static_cast<size_t>(n);
+              }
+            }
+            _exit(0);
+          }
+          close(fds[1]);
+          read_ = fds[0];
+#endif
+        }
+
+        ~Flooder()
+        {
+#ifdef _WIN32
+          if (writer_.joinable())
+          {
+            writer_.join();
+          }
+          CloseHandle(read_);
+#else
+          close(read_);
+#endif
+        }
+
+        PipeDrain::ReadFn Reader()
+        {
+          return [this](char *buffer, size_t size) -> int64_t
+          {
+#ifdef _WIN32
+            DWORD n = 0;
+            if (!ReadFile(read_, buffer, static_cast<DWORD>(size), &n, nullptr))
+            {
+              return -1;
+            }
+            return n;
+#else
+            return read(read_, buffer, size);
+#endif
+          };
+        }
+
+        // True if the writer ran to completion within |timeout|.
+        bool Finished(std::chrono::seconds timeout)
+        {
+#ifdef _WIN32
+          (void)timeout;
+          writer_.join();
+          return true;
+#else
+          const auto deadline = std::chrono::steady_clock::now() + timeout;
+          int status = 0;
+          while (std::chrono::steady_clock::now() < deadline)
+          {
+            if (waitpid(child_, &status, WNOHANG) == child_)
+            {
+              return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          }
+          kill(child_, SIGKILL);
+          waitpid(child_, &status, 0);
+          return false;
+#endif
+        }
+
+      private:
+#ifdef _WIN32
+        HANDLE read_ = nullptr;
+        std::thread writer_;
+#else
+        int read_ = -1;
+        pid_t child_ = -1;
+#endif
+      };
+
+    } // namespace
+
+    TEST(LineRing, KeepsNewestLines)
+    {
+      LineRing ring(3);
+      for (int i = 0; i < 5; i++)
+      {
+        ring.Push(std::to_string(i));
+      }
+      EXPECT_EQ(ring.size(), 3u);
+      EXPECT_EQ(ring.Recent(10), (std::vector<std::string>{"2", "3", "4"}));
+      EXPECT_EQ(ring.Recent(1), (std::vector<std::string>{"4"}));
+    }
+
+    TEST(PipeDrain, SplitsLinesAcrossReads)
+    {
+      std::vector<std::string> chunks = {"first li", "ne\r\nsecond\n", "third-", "unterminated"};
+      size_t next = 0;
+      std::vector<std::string> lines;
+
+      PipeDrain drain(8, 64);
+      drain.Start(
+          [&chunks, &next](char *buffer, size_t size) -> int64_t
+          {
+            if (next == chunks.size())
+            {
+              return 0;
+            }
+            const std::string &chunk = chunks[next++];
+            chunk.copy(buffer, size);
+            return static_cast<int64_t>(chunk.size());
+          },
+          [&lines](std::string_view line)
+          { lines.emplace_back(line); });
+      ASSERT_TRUE(drain.WaitFor(2000));
+      drain.Join();
+
+      EXPECT_EQ(lines, (std::vector<std::string>{"first line", "second", "third-unterminated"}));
+      EXPECT_EQ(drain.lines_read(), 3u);
+    }
+
+    TEST(PipeDrain, CapsOverlongLines)
+    {
+      bool done = false;
+      std::vector<std::string> lines;
+      PipeDrain drain(8, 4);
+      drain.Start(
+          [&done](char *buffer, size_t) -> int64_t
+          {
+            if (done)
+            {
+              return 0;
+            }
+            done = true;
+            std::string data = "abcdefghij\nxy\n";
+            data.copy(buffer, data.size());
+            return static_cast<int64_t>(data.size());
+          },
+          [&lines](std::string_view line)
+          { lines.emplace_back(line); });
+      drain.Join();
+      EXPECT_EQ(lines, (std::vector<std::string>{"abcd", "efgh", "ij", "xy"}));
+    }
+
+    TEST(PipeDrain, KeepsFloodingChildUnblocked)
+    {
+      // Several MB, far beyond any pipe buffer
+      constexpr int kLines = 100000;
+      Flooder flooder(kLines);
+
+      uint64_t delivered = 0;
+      PipeDrain drain(256);
+      drain.Start(flooder.Reader(), [&delivered](std::string_view)
+                  { delivered++; });
+
+      EXPECT_TRUE(flooder.Finished(std::chrono::seconds(20)));
+      ASSERT_TRUE(drain.WaitFor(20000));
+      drain.Join();
+
+      EXPECT_EQ(delivered, static_cast<uint64_t>(kLines));
+      EXPECT_EQ(drain.lines_read(), static_cast<uint64_t>(kLines));
+      std::vector<std::string> recent = drain.RecentLines(1000);
+      ASSERT_EQ(recent.size(), 256u);
+      EXPECT_EQ(recent.back(), FloodLine(kLines - 1));
+      EXPECT_EQ(recent.front(), FloodLine(kLines - 256));
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
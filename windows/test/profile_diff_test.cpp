@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "profile_diff.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      const char *kProfile =
+          "client\n"
+          "dev tun\n"
+          "proto udp\n"
+          "remote vpn1.example.com 1194\n"
+          "# comment\n"
+          "<ca>\n"
+          "-----BEGIN CERTIFICATE-----\n"
+          "MIIB\n"
+          "-----END CERTIFICATE-----\n"
+          "</ca>\n";
+
+    } // namespace
+
+    TEST(ProfileDiff, ParsesRemotesWithDefaults)
+    {
+      const auto remotes = ParseRemotes("port 443\nproto tcp-client\n"
+                                        "remote a.example.com\n"
+                                        "remote b.example.com 1195 udp6\n"
+                                        "<connection>\nremote c.example.com\n</connection>\n");
+      ASSERT_EQ(remotes.size(), 2u);
+      EXPECT_EQ(remotes[0].host, "a.example.com");
+      EXPECT_EQ(remotes[0].port, "443");
+      EXPECT_EQ(remotes[0].proto, "tcp-client");
+      EXPECT_EQ(remotes[1].port, "1195");
+      EXPECT_EQ(remotes[1].proto, "udp6");
+
+      const auto defaults = ParseRemotes("remote a.example.com\nrport 8443\n");
+      ASSERT_EQ(defaults.size(), 1u);
+      EXPECT_EQ(defaults[0].port, "8443");
+      EXPECT_EQ(defaults[0].proto, "udp");
+    }
+
+    TEST(ProfileDiff, NormalizesProtoFamilies)
+    {
+      EXPECT_EQ(ProtoFamily("udp"), "udp");
+      EXPECT_EQ(ProtoFamily("udp6"), "udp");
+      EXPECT_EQ(ProtoFamily("tcp-client"), "tcp");
+      EXPECT_EQ(ProtoFamily("tcp4-client"), "tcp");
+    }
+
+    TEST(ProfileDiff, IgnoresCommentsAndWhitespace)
+    {
+      ProfileRemote target;
+      EXPECT_EQ(CompareProfiles(kProfile,
+                                "client\r\n; other comment\n\ndev   tun\nproto udp4\n"
+                                "remote vpn1.example.com 1194\n<ca>\n-----BEGIN CERTIFICATE-----\n"
+                                "MIIB\n-----END CERTIFICATE-----\n</ca>",
+                                &target),
+                ProfileChange::kSame);
+    }
+
+    TEST(ProfileDiff, DetectsRemoteOnlyChanges)
+    {
+      ProfileRemote target;
+      std::string updated = kProfile;
+      updated.replace(updated.find("vpn1.example.com 1194"), 21, "vpn2.example.com 443");
+      ASSERT_EQ(CompareProfiles(kProfile, updated, &target), ProfileChange::kRemoteOnly);
+      EXPECT_EQ(target.host, "vpn2.example.com");
+      EXPECT_EQ(target.port, "443");
+      EXPECT_EQ(target.proto, "udp");
+    }
+
+    TEST(ProfileDiff, OtherChangesNeedARestart)
+    {
+      ProfileRemote target;
+      std::string cipher = std::string(kProfile) + "cipher AES-256-GCM\n";
+      EXPECT_EQ(CompareProfiles(kProfile, cipher, &target), ProfileChange::kOther);
+
+      std::string cert = kProfile;
+      cert.replace(cert.find("MIIB"), 4, "MIIC");
+      EXPECT_EQ(CompareProfiles(kProfile, cert, &target), ProfileChange::kOther);
+
+      std::string no_remote = kProfile;
+      no_remote.erase(no_remote.find("remote"), 28);
+      EXPECT_EQ(CompareProfiles(kProfile, no_remote, &target), ProfileChange::kOther);
+    }
+
+    TEST(ProfileDiff, ProtocolChangeNeedsAMatchingRunningRemote)
+    {
+      ProfileRemote target;
+      std::string tcp = kProfile;
+      tcp.replace(tcp.find("proto udp"), 9, "proto tcp");
+      EXPECT_EQ(CompareProfiles(kProfile, tcp, &target), ProfileChange::kOther);
+
+      // The running process can already reach a TCP entry, so MOD works
+      const std::string both = std::string(kProfile) + "remote vpn1.example.com 443 tcp\n";
+      ASSERT_EQ(CompareProfiles(both, tcp, &target), ProfileChange::kRemoteOnly);
+      EXPECT_EQ(target.proto, "tcp");
+    }
+
+    TEST(ProfileDiff, RepliesToRemoteQueries)
+    {
+      ProfileRemote target{"vpn2.example.com", "443", "udp"};
+      EXPECT_EQ(RemoteQueryReply("udp", nullptr), "remote ACCEPT");
+      EXPECT_EQ(RemoteQueryReply("udp4", &target), "remote MOD vpn2.example.com 443");
+      EXPECT_EQ(RemoteQueryReply("tcp-client", &target), "remote SKIP");
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
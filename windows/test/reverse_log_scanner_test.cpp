@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "reverse_log_scanner.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      class ReverseLineScannerTest : public ::testing::Test
+      {
+      protected:
+        void SetUp() override
+        {
+          const auto stamp =
+              std::chrono::steady_clock::now().time_since_epoch().count();
+          path_ = (std::filesystem::temp_directory_path() /
+                   ("openvpn_dart_reverse_" + std::to_string(stamp) + ".log"))
+                      .string();
+        }
+
+        void TearDown() override
+        {
+          std::error_code ec;
+          std::filesystem::remove(path_, ec);
+        }
+
+        void Write(const std::string &data)
+        {
+          std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+          out << data;
+        }
+
+        std::vector<std::string> ScanAll(ReverseLineScanner &scanner)
+        {
+          std::vector<std::string> lines;
+          EXPECT_TRUE(scanner.Scan(path_, [&lines](std::string_view line)
+                                   {
+                                     lines.emplace_back(line);
+                                     return true; }));
+          return lines;
+        }
+
+        std::string path_;
+      };
+
+    } // namespace
+
+    TEST_F(ReverseLineScannerTest, YieldsLinesNewestFirst)
+    {
+      Write("first line\r\nsecond\n\nthe fourth line spans blocks\nlast");
+      const std::vector<std::string> expected = {
+          "last", "the fourth line spans blocks", "", "second", "first line"};
+
+      ReverseLineScanner blocks(7, UINT64_MAX);
+      EXPECT_EQ(ScanAll(blocks), expected);
+      EXPECT_FALSE(blocks.mapped());
+
+      ReverseLineScanner mapped(7, 0);
+      EXPECT_EQ(ScanAll(mapped), expected);
+      EXPECT_TRUE(mapped.mapped());
+
+      Write("only\n");
+      EXPECT_EQ(ScanAll(blocks), (std::vector<std::string>{"only"}));
+      EXPECT_EQ(ScanAll(mapped), (std::vector<std::string>{"only"}));
+    }
+
+    TEST_F(ReverseLineScannerTest, MissingOrEmptyFile)
+    {
+      ReverseLineScanner scanner;
+      EXPECT_FALSE(scanner.Scan(path_, [](std::string_view)
+                                { return true; }));
+      Write("");
+      EXPECT_TRUE(ScanAll(scanner).empty());
+    }
+
+    TEST_F(ReverseLineScannerTest, StopsNearTheEndOfALargeLog)
+    {
+      std::string log;
+      while (log.size() < 8 * 1024 * 1024)
+      {
+        log += "2026-01-01 10:00:00 Data Channel: cipher 'AES-256-GCM', peer-id: 0\n";
+      }
+      log += "2026-01-01 10:00:01 Initialization Sequence Completed\n";
+      log += "2026-01-01 10:00:02 MANAGEMENT: CMD 'bytecount 1'\n";
+      Write(log);
+
+      for (uint64_t threshold : {uint64_t(0), UINT64_MAX})
+      {
+        ReverseLineScanner scanner(64 * 1024, threshold);
+        int visited = 0;
+        scanner.Scan(path_, [&visited](std::string_view line)
+                     {
+                       visited++;
+                       return line.find("Initialization") == std::string_view::npos; });
+        EXPECT_EQ(visited, 2);
+        EXPECT_LE(scanner.bytes_examined(), 64u * 1024u);
+      }
+    }
+
+    TEST_F(ReverseLineScannerTest, FindsLastDecisiveLine)
+    {
+      Write("2026-01-01 10:00:01 Initialization Sequence Completed\n"
+            "2026-01-01 10:05:00 SIGTERM[hard,] received, process exiting\n"
+            "2026-01-01 10:06:00 Initialization Sequence Completed\n"
+            "2026-01-01 10:07:00 Data Channel: cipher 'AES-256-GCM', peer-id: 0\n");
+
+      const LogEventMask decisive = LogEventBit(LogEvent::kConnected) |
+                                    LogEventBit(LogEvent::kExiting) |
+                                    LogEventBit(LogEvent::kFatal);
+      LastLogLine last;
+      ASSERT_TRUE(FindLastLogLine(path_, decisive, &last));
+      EXPECT_EQ(last.events, LogEventBit(LogEvent::kConnected));
+      EXPECT_EQ(last.line, "2026-01-01 10:06:00 Initialization Sequence Completed");
+
+      ASSERT_TRUE(FindLastLogLine(path_, LogEventBit(LogEvent::kExiting), &last));
+      EXPECT_EQ(last.line, "2026-01-01 10:05:00 SIGTERM[hard,] received, process exiting");
+
+      EXPECT_FALSE(FindLastLogLine(path_, LogEventBit(LogEvent::kFatal), &last));
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
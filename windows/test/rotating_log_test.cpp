@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rotating_log.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      class RotatingLogTest : public ::testing::Test
+      {
+      protected:
+        void SetUp() override
+        {
+          const auto stamp =
+              std::chrono::steady_clock::now().time_since_epoch().count();
+          dir_ = std::filesystem::temp_directory_path() /
+                 ("openvpn_dart_rotating_" + std::to_string(stamp));
+          std::filesystem::create_directories(dir_);
+          path_ = (dir_ / "openvpn.log").string();
+        }
+
+        void TearDown() override
+        {
+          std::error_code ec;
+          std::filesystem::remove_all(dir_, ec);
+        }
+
+        std::string Read(const std::string &path)
+        {
+          std::ifstream in(path, std::ios::binary);
+          return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+
+        std::filesystem::path dir_;
+        std::string path_;
+      };
+
+    } // namespace
+
+    TEST_F(RotatingLogTest, RotatesBySizeAndKeepsArchiveBudget)
+    {
+      RotatingLog log(path_, 20, 2);
+      ASSERT_TRUE(log.Open());
+      for (int i = 0; i < 10; i++)
+      {
+        log.Write("line " + std::to_string(i) + " xx"); // 10 bytes with newline
+      }
+      log.Close();
+
+      EXPECT_EQ(log.rotations(), 4u);
+      EXPECT_EQ(Read(path_), "line 8 xx\nline 9 xx\n");
+      EXPECT_EQ(Read(RotatingLog::ArchivePath(path_, 1)), "line 6 xx\nline 7 xx\n");
+      EXPECT_EQ(Read(RotatingLog::ArchivePath(path_, 2)), "line 4 xx\nline 5 xx\n");
+      EXPECT_FALSE(std::filesystem::exists(RotatingLog::ArchivePath(path_, 3)));
+    }
+
+    TEST_F(RotatingLogTest, OpenArchivesThePreviousSession)
+    {
+      RotatingLog log(path_, 1024, 1);
+      ASSERT_TRUE(log.Open());
+      log.Write("previous session");
+      ASSERT_TRUE(log.Open());
+      log.Write("new session");
+      log.Close();
+
+      EXPECT_EQ(Read(path_), "new session\n");
+      EXPECT_EQ(Read(RotatingLog::ArchivePath(path_, 1)), "previous session\n");
+
+      // An empty segment is not worth an archive slot
+      ASSERT_TRUE(log.Open());
+      ASSERT_TRUE(log.Open());
+      EXPECT_EQ(Read(RotatingLog::ArchivePath(path_, 1)), "new session\n");
+    }
+
+    TEST_F(RotatingLogTest, ArchivesRotatedSegmentsInTheBackground)
+    {
+      std::mutex mutex;
+      std::vector<std::string> archived;
+      RotatingLog log(path_, 10, 3, [&](const std::string &segment)
+                      {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        archived.push_back(segment); });
+      ASSERT_TRUE(log.Open());
+      log.Write("123456789");
+      log.Write("abcdefghi");
+      log.WaitForArchiver();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      EXPECT_EQ(archived, (std::vector<std::string>{RotatingLog::ArchivePath(path_, 1)}));
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
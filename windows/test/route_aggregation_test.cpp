@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "route_aggregation.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(RouteAggregation, ParsesIpv4Routes)
+    {
+      RoutePrefix prefix;
+      ASSERT_TRUE(ParseIpv4Route("10.1.0.0", "255.255.0.0", &prefix));
+      EXPECT_EQ(prefix.length, 16);
+      EXPECT_EQ(FormatIpv4Address(prefix), "10.1.0.0");
+      EXPECT_EQ(FormatIpv4Netmask(prefix.length), "255.255.0.0");
+      ASSERT_TRUE(ParseIpv4Route("192.0.2.7", "", &prefix));
+      EXPECT_EQ(prefix.length, 32);
+
+      EXPECT_FALSE(ParseIpv4Route("10.1.0.1", "255.255.0.0", &prefix)); // Host bits
+      EXPECT_FALSE(ParseIpv4Route("10.0.0.0", "255.0.255.0", &prefix)); // Not contiguous
+      EXPECT_FALSE(ParseIpv4Route("vpn_gateway", "", &prefix));
+      EXPECT_FALSE(ParseIpv4Route("10.0.0", "255.0.0.0", &prefix));
+      EXPECT_FALSE(ParseIpv4Route("10.0.0.256", "", &prefix));
+    }
+
+    TEST(RouteAggregation, ParsesAndFormatsIpv6Routes)
+    {
+      RoutePrefix prefix;
+      ASSERT_TRUE(ParseIpv6Route("2001:DB8:0:0::/64", &prefix));
+      EXPECT_EQ(FormatIpv6Route(prefix), "2001:db8::/64");
+      ASSERT_TRUE(ParseIpv6Route("2001:db8:0:1:0:0:0:1", &prefix));
+      EXPECT_EQ(FormatIpv6Route(prefix), "2001:db8:0:1::1/128");
+      ASSERT_TRUE(ParseIpv6Route("::/0", &prefix));
+      EXPECT_EQ(FormatIpv6Route(prefix), "::/0");
+
+      EXPECT_FALSE(ParseIpv6Route("2001:db8::1/64", &prefix)); // Host bits
+      EXPECT_FALSE(ParseIpv6Route("2001::db8::/32", &prefix));
+      EXPECT_FALSE(ParseIpv6Route("2001:db8::/129", &prefix));
+      EXPECT_FALSE(ParseIpv6Route("1:2:3:4:5:6:7/128", &prefix));
+    }
+
+    TEST(RouteAggregation, MergesAdjacentAndCoveredPrefixes)
+    {
+      RouteTrie trie(32);
+      RoutePrefix prefix;
+      for (const char *network : {"10.0.0.0", "10.0.1.0", "10.0.2.0", "10.0.3.0"})
+      {
+        ASSERT_TRUE(ParseIpv4Route(network, "255.255.255.0", &prefix));
+        trie.Add(prefix, 0);
+      }
+      ASSERT_TRUE(ParseIpv4Route("10.0.2.128", "255.255.255.128", &prefix));
+      trie.Add(prefix, 0);
+
+      const auto routes = trie.Aggregate();
+      ASSERT_EQ(routes.size(), 1u);
+      EXPECT_EQ(FormatIpv4Address(routes[0].prefix), "10.0.0.0");
+      EXPECT_EQ(routes[0].prefix.length, 22);
+    }
+
+    TEST(RouteAggregation, KeepsRoutesThatChangeTheOutcome)
+    {
+      RouteTrie trie(32);
+      RoutePrefix prefix;
+      ASSERT_TRUE(ParseIpv4Route("10.0.0.0", "255.0.0.0", &prefix));
+      trie.Add(prefix, 0);
+      // Through another gateway inside the /8, then back to the first
+      ASSERT_TRUE(ParseIpv4Route("10.1.0.0", "255.255.0.0", &prefix));
+      trie.Add(prefix, 1);
+      ASSERT_TRUE(ParseIpv4Route("10.1.2.0", "255.255.255.0", &prefix));
+      trie.Add(prefix, 0);
+      // Only one half under each label
+      ASSERT_TRUE(ParseIpv4Route("192.168.0.0", "255.255.255.128", &prefix));
+      trie.Add(prefix, 0);
+      ASSERT_TRUE(ParseIpv4Route("192.168.0.128", "255.255.255.128", &prefix));
+      trie.Add(prefix, 1);
+
+      EXPECT_EQ(trie.Aggregate().size(), 5u);
+    }
+
+    TEST(RouteAggregation, NeverMergesIntoTheDefaultRoute)
+    {
+      RouteTrie trie(32);
+      RoutePrefix prefix;
+      ASSERT_TRUE(ParseIpv4Route("0.0.0.0", "128.0.0.0", &prefix));
+      trie.Add(prefix, 0);
+      ASSERT_TRUE(ParseIpv4Route("128.0.0.0", "128.0.0.0", &prefix));
+      trie.Add(prefix, 0);
+      EXPECT_EQ(trie.Aggregate().size(), 2u);
+    }
+
+    TEST(RouteAggregation, RewritesTheProfile)
+    {
+      const std::string profile =
+          "client\n"
+          "route 10.0.0.0 255.255.255.0\n"
+          "# route 10.9.0.0 255.255.0.0\n"
+          "route 10.0.1.0 255.255.255.0\n"
+          "route 10.0.0.0 255.255.255.0\n"
+          "route 10.0.2.0 255.255.255.0 net_gateway\n"
+          "route vpn.example.com\n"
+          "route-ipv6 2001:db8::/33\n"
+          "route-ipv6 2001:db8:8000::/33\n"
+          "dev tun\n";
+      RouteAggregationReport report;
+      EXPECT_EQ(AggregateRoutes(profile, &report),
+                "client\n"
+                "route 10.0.0.0 255.255.254.0\n"
+                "route 10.0.2.0 255.255.255.0 net_gateway\n"
+                "# route 10.9.0.0 255.255.0.0\n"
+                "route vpn.example.com\n"
+                "route-ipv6 2001:db8::/32\n"
+                "dev tun\n");
+      EXPECT_EQ(report.ipv4_before, 4u);
+      EXPECT_EQ(report.ipv4_after, 2u);
+      EXPECT_EQ(report.ipv6_before, 2u);
+      EXPECT_EQ(report.ipv6_after, 1u);
+    }
+
+    TEST(RouteAggregation, LeavesConflictsAndInlineBlocksAlone)
+    {
+      const std::string profile =
+          "route 10.0.0.0 255.255.255.0 10.8.0.1\r\n"
+          "route 10.0.0.0 255.255.255.0 10.8.0.2\r\n"
+          "route 10.0.1.0 255.255.255.0 10.8.0.1\r\n"
+          "<ca>\r\n"
+          "route 10.0.0.0 255.255.255.0\r\n"
+          "</ca>\r\n";
+      RouteAggregationReport report;
+      EXPECT_EQ(AggregateRoutes(profile, &report), profile);
+      EXPECT_EQ(report.ipv4_before, 3u);
+      EXPECT_EQ(report.ipv4_after, 3u);
+      EXPECT_EQ(report.ipv6_before, 0u);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
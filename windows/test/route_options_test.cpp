@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "route_options.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(RouteOptions, ParsesPushReplyLogLines)
+    {
+      RouteOptions options;
+      bool more = true;
+      ASSERT_TRUE(ParsePushReply(
+          "PUSH: Received control message: 'PUSH_REPLY,route 10.1.0.0 255.255.0.0,"
+          "route-ipv6 2001:db8:1::/48,route-gateway 10.8.0.1,topology subnet,ping 10,"
+          "ifconfig 10.8.0.2 255.255.255.0,ifconfig-ipv6 2001:db8::2/64 2001:db8::1,peer-id 0'",
+          &options, &more));
+      EXPECT_FALSE(more);
+      ASSERT_EQ(options.routes.size(), 1u);
+      EXPECT_EQ(options.routes[0], (std::vector<std::string>{"10.1.0.0", "255.255.0.0"}));
+      ASSERT_EQ(options.ipv6_routes.size(), 1u);
+      EXPECT_EQ(options.route_gateway, "10.8.0.1");
+      EXPECT_EQ(options.topology, "subnet");
+      EXPECT_EQ(options.ifconfig_ipv6_remote, "2001:db8::1");
+
+      EXPECT_FALSE(ParsePushReply("PUSH: Received control message: 'AUTH_FAILED'", &options, &more));
+    }
+
+    TEST(RouteOptions, FollowsPushContinuation)
+    {
+      RouteOptions options;
+      bool more = false;
+      ASSERT_TRUE(ParsePushReply("PUSH_REPLY,route 10.1.0.0 255.255.0.0,push-continuation 2", &options, &more));
+      EXPECT_TRUE(more);
+      ASSERT_TRUE(ParsePushReply("PUSH_REPLY,route 10.2.0.0 255.255.0.0,push-continuation 1", &options, &more));
+      EXPECT_FALSE(more);
+      EXPECT_EQ(options.routes.size(), 2u);
+    }
+
+    TEST(RouteOptions, TakesInstallableProfileRoutes)
+    {
+      const std::string profile =
+          "client\n"
+          "route 10.0.0.0 255.0.0.0\n"
+          "route 192.168.5.0 255.255.255.0 192.168.1.1 20\n"
+          "route vpn.example.com\n"
+          "route 172.16.0.0 255.240.0.0 net_gateway\n"
+          "route-ipv6 2001:db8:5::/48\n"
+          "route-metric 7\n"
+          "<ca>\n"
+          "route 10.0.0.0 255.0.0.0\n"
+          "</ca>";
+      std::string rewritten;
+      std::string reason;
+      RouteOptions options;
+      ASSERT_TRUE(TakeProfileRoutes(profile, &rewritten, &options, &reason));
+      EXPECT_EQ(rewritten,
+                "client\n"
+                "route vpn.example.com\n"
+                "route 172.16.0.0 255.240.0.0 net_gateway\n"
+                "route-metric 7\n"
+                "<ca>\n"
+                "route 10.0.0.0 255.0.0.0\n"
+                "</ca>\n"
+                "pull-filter ignore \"route 0\"\n"
+                "pull-filter ignore \"route 1\"\n"
+                "pull-filter ignore \"route 2\"\n"
+                "pull-filter ignore \"route 3\"\n"
+                "pull-filter ignore \"route 4\"\n"
+                "pull-filter ignore \"route 5\"\n"
+                "pull-filter ignore \"route 6\"\n"
+                "pull-filter ignore \"route 7\"\n"
+                "pull-filter ignore \"route 8\"\n"
+                "pull-filter ignore \"route 9\"\n"
+                "pull-filter ignore \"route-ipv6 \"\n");
+      EXPECT_EQ(options.routes.size(), 2u);
+      EXPECT_EQ(options.ipv6_routes.size(), 1u);
+      EXPECT_EQ(options.route_metric, "7");
+    }
+
+    TEST(RouteOptions, RefusesProfilesThatFilterRoutes)
+    {
+      std::string rewritten;
+      std::string reason;
+      RouteOptions options;
+      EXPECT_FALSE(TakeProfileRoutes("client\nroute-nopull\n", &rewritten, &options, &reason));
+      EXPECT_EQ(reason, "the profile uses route-nopull");
+      EXPECT_FALSE(TakeProfileRoutes("pull-filter ignore \"route 10.\"\n", &rewritten, &options, &reason));
+    }
+
+    TEST(RouteOptions, ResolvesGatewaysAndMetrics)
+    {
+      RouteOptions profile;
+      profile.routes = {{"192.168.5.0", "255.255.255.0", "192.168.1.1", "20"}};
+      profile.route_metric = "7";
+      RouteOptions pushed;
+      bool more = false;
+      ASSERT_TRUE(ParsePushReply("PUSH_REPLY,route 10.1.0.0 255.255.0.0,route 10.2.0.0 255.255.0.0 vpn_gateway 3,"
+                                 "route-ipv6 2001:db8:1::/48,route remote_host 255.255.255.255 net_gateway,"
+                                 "route 10.3.0.0 255.255.0.0 net_gateway,"
+                                 "route-gateway 10.8.0.1,ifconfig-ipv6 2001:db8::2/64 2001:db8::1",
+                                 &pushed, &more));
+
+      std::vector<std::string> skipped;
+      const std::vector<NativeRoute> routes = ResolveRoutes(profile, pushed, NetGateway(), 12, &skipped);
+      ASSERT_EQ(routes.size(), 4u);
+      EXPECT_EQ(DescribeRoute(routes[0]), "192.168.5.0/24 via 192.168.1.1 metric 20");
+      EXPECT_EQ(DescribeRoute(routes[1]), "10.1.0.0/16 via 10.8.0.1 if 12 metric 7");
+      EXPECT_EQ(DescribeRoute(routes[2]), "10.2.0.0/16 via 10.8.0.1 if 12 metric 3");
+      EXPECT_EQ(DescribeRoute(routes[3]), "2001:db8:1::/48 via 2001:db8::1 if 12 metric 7");
+      // remote_host passes the pull-filter, so OpenVPN installs it
+      EXPECT_EQ(skipped, (std::vector<std::string>{"route 10.3.0.0 255.255.0.0 net_gateway"}));
+    }
+
+    TEST(RouteOptions, ResolvesNetGatewayFromTheLog)
+    {
+      NetGateway net_gateway;
+      EXPECT_FALSE(ParseNetGateway("PUSH_REPLY,ping 10", &net_gateway));
+      ASSERT_TRUE(ParseNetGateway("ROUTE_GATEWAY 192.168.1.1/255.255.255.0 I=7 HWADDR=00:11:22:33:44:55",
+                                  &net_gateway));
+      ASSERT_TRUE(ParseNetGateway("2024-05-01 10:00:00 ROUTE6_GATEWAY fe80::1 I=7", &net_gateway));
+
+      RouteOptions pushed;
+      bool more = false;
+      ASSERT_TRUE(ParsePushReply("PUSH_REPLY,route 10.3.0.0 255.255.0.0 net_gateway,"
+                                 "route-ipv6 2001:db8:9::/48 net_gateway,route vpn.example.com",
+                                 &pushed, &more));
+      std::vector<std::string> skipped;
+      const std::vector<NativeRoute> routes = ResolveRoutes(RouteOptions(), pushed, net_gateway, 12, &skipped);
+      ASSERT_EQ(routes.size(), 2u);
+      EXPECT_EQ(DescribeRoute(routes[0]), "10.3.0.0/16 via 192.168.1.1 if 7");
+      EXPECT_EQ(DescribeRoute(routes[1]), "2001:db8:9::/48 via fe80::1 if 7");
+      EXPECT_TRUE(skipped.empty());
+
+      // No default route: net_gateway is unknown, as it is to OpenVPN
+      ASSERT_TRUE(ParseNetGateway("ROUTE_GATEWAY ON_LINK", &net_gateway));
+      skipped.clear();
+      EXPECT_EQ(ResolveRoutes(RouteOptions(), pushed, net_gateway, 12, &skipped).size(), 1u);
+      EXPECT_EQ(skipped, (std::vector<std::string>{"route 10.3.0.0 255.255.0.0 net_gateway"}));
+    }
+
+    TEST(RouteOptions, Net30RoutesUseTheIfconfigPeer)
+    {
+      RouteOptions pushed;
+      bool more = false;
+      ASSERT_TRUE(ParsePushReply("PUSH_REPLY,route 10.1.0.0 255.255.0.0,topology net30,ifconfig 10.8.0.6 10.8.0.5",
+                                 &pushed, &more));
+      std::vector<std::string> skipped;
+      auto routes = ResolveRoutes(RouteOptions(), pushed, NetGateway(), 4, &skipped);
+      ASSERT_EQ(routes.size(), 1u);
+      EXPECT_EQ(DescribeRoute(routes[0]), "10.1.0.0/16 via 10.8.0.5 if 4");
+
+      // Subnet topology without route-gateway: on-link through the tunnel
+      pushed.topology = "subnet";
+      routes = ResolveRoutes(RouteOptions(), pushed, NetGateway(), 4, &skipped);
+      ASSERT_EQ(routes.size(), 1u);
+      EXPECT_EQ(DescribeRoute(routes[0]), "10.1.0.0/16 if 4");
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "fake_route_backend.h"
+#include "route_programmer.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // 10.<n / 256>.<n % 256>.0/24 via 10.8.0.1
+      NativeRoute Route(int n)
+      {
+        NativeRoute route;
+        EXPECT_TRUE(ParseIpv4Route("10." + std::to_string(n / 256) + "." + std::to_string(n % 256) + ".0",
+                                   "255.255.255.0", &route.destination));
+        IpAddress gateway;
+        EXPECT_TRUE(ParseIpAddress("10.8.0.1", &gateway));
+        route.gateway = gateway;
+        route.interface_index = 7;
+        return route;
+      }
+
+      std::vector<NativeRoute> Routes(int count)
+      {
+        std::vector<NativeRoute> routes;
+        for (int i = 0; i < count; i++)
+        {
+          routes.push_back(Route(i));
+        }
+        return routes;
+      }
+
+    } // namespace
+
+    TEST(RouteProgrammer, ParsesAndDescribesAddresses)
+    {
+      IpAddress address;
+      ASSERT_TRUE(ParseIpAddress("2001:db8::1", &address));
+      EXPECT_TRUE(address.ipv6);
+      EXPECT_EQ(FormatIpAddress(address), "2001:db8::1");
+      ASSERT_TRUE(ParseIpAddress("10.8.0.1", &address));
+      EXPECT_FALSE(address.ipv6);
+      EXPECT_FALSE(ParseIpAddress("2001:db8::/32", &address));
+      EXPECT_FALSE(ParseIpAddress("vpn_gateway", &address));
+
+      NativeRoute route = Route(1);
+      route.metric = 5;
+      EXPECT_EQ(DescribeRoute(route), "10.0.1.0/24 via 10.8.0.1 if 7 metric 5");
+    }
+
+    TEST(RouteProgrammer, InstallsInBatches)
+    {
+      FakeRouteBackend backend;
+      RouteProgrammer programmer(&backend, 100);
+      std::string error;
+      ASSERT_TRUE(programmer.Install(Routes(250), &error)) << error;
+      EXPECT_EQ(backend.add_batches, (std::vector<size_t>{100, 100, 50}));
+      EXPECT_EQ(backend.table.size(), 250u);
+      EXPECT_EQ(programmer.installed(), 250u);
+
+      ASSERT_TRUE(programmer.RemoveAll(&error));
+      EXPECT_TRUE(backend.table.empty());
+      EXPECT_EQ(programmer.installed(), 0u);
+    }
+
+    TEST(RouteProgrammer, RollsBackEveryBatchOnFailure)
+    {
+      FakeRouteBackend backend;
+      backend.reject.push_back(Route(150));
+      RouteProgrammer programmer(&backend, 100);
+      std::string error;
+      EXPECT_FALSE(programmer.Install(Routes(250), &error));
+      EXPECT_EQ(error, "rejected 10.0.150.0/24 via 10.8.0.1 if 7");
+      // Stopped after the failing batch, and took out both it and the first
+      EXPECT_EQ(backend.add_batches.size(), 2u);
+      EXPECT_TRUE(backend.table.empty());
+      EXPECT_EQ(programmer.installed(), 0u);
+    }
+
+    TEST(RouteProgrammer, RollbackKeepsEarlierInstallsAndForeignRoutes)
+    {
+      FakeRouteBackend backend;
+      backend.table.push_back(Route(500)); // Someone else's
+      RouteProgrammer programmer(&backend);
+      std::string error;
+      ASSERT_TRUE(programmer.Install(Routes(2), &error));
+
+      std::vector<NativeRoute> more{Route(500), Route(10), Route(11)};
+      backend.reject.push_back(Route(11));
+      EXPECT_FALSE(programmer.Install(more, &error));
+      EXPECT_EQ(programmer.installed(), 2u);
+      EXPECT_TRUE(backend.Contains(Route(500)));
+      EXPECT_FALSE(backend.Contains(Route(10)));
+
+      // The existing route was never ours to remove
+      ASSERT_TRUE(programmer.RemoveAll(&error));
+      EXPECT_EQ(backend.table.size(), 1u);
+      EXPECT_TRUE(backend.Contains(Route(500)));
+    }
+
+    TEST(RouteProgrammer, KeepsRoutesWhoseRemovalFailed)
+    {
+      FakeRouteBackend backend;
+      RouteProgrammer programmer(&backend, 2);
+      std::string error;
+      ASSERT_TRUE(programmer.Install(Routes(3), &error));
+
+      backend.fail_deletes = true;
+      EXPECT_FALSE(programmer.RemoveAll(&error));
+      EXPECT_EQ(error, "delete failed");
+      EXPECT_EQ(programmer.installed(), 3u);
+
+      // A failed rollback leaves its routes for the next RemoveAll()
+      backend.reject.push_back(Route(11));
+      EXPECT_FALSE(programmer.Install({Route(10), Route(11)}, &error));
+      EXPECT_EQ(error, "rejected 10.0.11.0/24 via 10.8.0.1 if 7; rollback failed: delete failed");
+      EXPECT_EQ(programmer.installed(), 4u);
+
+      backend.fail_deletes = false;
+      EXPECT_TRUE(programmer.RemoveAll(&error));
+      EXPECT_EQ(programmer.installed(), 0u);
+      EXPECT_TRUE(backend.table.empty());
+    }
+
+    TEST(RouteProgrammer, RollsBackRoutesWithoutAnAnswer)
+    {
+      FakeRouteBackend backend;
+      backend.unanswered.push_back(Route(1));
+      RouteProgrammer programmer(&backend);
+      std::string error;
+      EXPECT_FALSE(programmer.Install(Routes(3), &error));
+      EXPECT_EQ(error, "no answer for 10.0.1.0/24 via 10.8.0.1 if 7");
+      // The kernel added it, so the rollback takes it out as well
+      EXPECT_TRUE(backend.table.empty());
+      EXPECT_EQ(programmer.installed(), 0u);
+    }
+
+    TEST(RouteProgrammer, SkipsRepeatedRoutes)
+    {
+      FakeRouteBackend backend;
+      RouteProgrammer programmer(&backend);
+      std::string error;
+      std::vector<NativeRoute> routes = Routes(3);
+      routes.push_back(Route(1));
+      ASSERT_TRUE(programmer.Install(routes, &error));
+      ASSERT_TRUE(programmer.Install(Routes(4), &error));
+      EXPECT_EQ(backend.add_batches, (std::vector<size_t>{3, 1}));
+      EXPECT_EQ(programmer.installed(), 4u);
+
+      // Same destination, different metric: a different route
+      NativeRoute metric = Route(0);
+      metric.metric = 10;
+      ASSERT_TRUE(programmer.Install({metric}, &error));
+      EXPECT_EQ(programmer.installed(), 5u);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
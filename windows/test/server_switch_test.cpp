@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include "server_switch.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(SwitchTimeline, MakeBeforeBreakHasNoGap)
+    {
+      SwitchTimeline timeline(1000, true);
+      timeline.NewConnected(4000);
+      timeline.TeardownStarted(4100);
+      timeline.TeardownFinished(4600);
+
+      const SwitchReport report = timeline.Report();
+      EXPECT_TRUE(report.make_before_break);
+      EXPECT_EQ(report.connect_ms, 3000);
+      EXPECT_EQ(report.overlap_ms, 100);
+      EXPECT_EQ(report.gap_ms, 0);
+      EXPECT_EQ(report.teardown_ms, 500);
+    }
+
+    TEST(SwitchTimeline, BreakBeforeMakeGapCoversTeardownAndHandshake)
+    {
+      SwitchTimeline timeline(1000, false);
+      timeline.TeardownStarted(1000);
+      timeline.TeardownFinished(1800);
+      timeline.NewConnected(5000);
+
+      const SwitchReport report = timeline.Report();
+      EXPECT_FALSE(report.make_before_break);
+      EXPECT_EQ(report.gap_ms, 4000);
+      EXPECT_EQ(report.overlap_ms, 0);
+      EXPECT_EQ(report.teardown_ms, 800);
+    }
+
+    TEST(SwitchTimeline, OldTunnelDroppingEarlyOpensTheGap)
+    {
+      SwitchTimeline timeline(0, true);
+      timeline.OldDown(2000);
+      timeline.NewConnected(3500);
+      // Teardown of a tunnel already down does not move the gap
+      timeline.TeardownStarted(3600);
+      timeline.TeardownFinished(3700);
+
+      EXPECT_EQ(timeline.Report().gap_ms, 1500);
+    }
+
+    TEST(SwitchTimeline, FirstReportOfEachPointCounts)
+    {
+      SwitchTimeline timeline(0, true);
+      timeline.NewConnected(100);
+      timeline.NewConnected(900);
+      timeline.TeardownStarted(200);
+      timeline.TeardownStarted(300);
+      timeline.TeardownFinished(400);
+
+      const SwitchReport report = timeline.Report();
+      EXPECT_EQ(report.connect_ms, 100);
+      EXPECT_EQ(report.teardown_ms, 200);
+    }
+
+    TEST(SwitchTimeline, NeverConnectedLeavesGapUnknown)
+    {
+      SwitchTimeline timeline(0, false);
+      timeline.TeardownStarted(10);
+      EXPECT_FALSE(timeline.new_connected());
+
+      const SwitchReport report = timeline.Report();
+      EXPECT_EQ(report.connect_ms, -1);
+      EXPECT_EQ(report.gap_ms, -1);
+      EXPECT_EQ(report.teardown_ms, -1);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "session_journal.h"
+#include "warm_standby.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      SessionRecord ConnectedRecord()
+      {
+        SessionRecord record;
+        record.pid = 4242;
+        record.creation_time = 133520000012345678ull;
+        record.config_hash = 0x1234567890abcdefull;
+        record.management_port = 51234;
+        record.management_password = "0123456789abcdef0123456789abcdef";
+        record.started_unix_ms = 1760000000000;
+        record.status = "connected";
+        return record;
+      }
+
+      void ExpectSameRecord(const SessionRecord &actual, const SessionRecord &expected)
+      {
+        EXPECT_EQ(actual.pid, expected.pid);
+        EXPECT_EQ(actual.creation_time, expected.creation_time);
+        EXPECT_EQ(actual.config_hash, expected.config_hash);
+        EXPECT_EQ(actual.management_port, expected.management_port);
+        EXPECT_EQ(actual.management_password, expected.management_password);
+        EXPECT_EQ(actual.started_unix_ms, expected.started_unix_ms);
+        EXPECT_EQ(actual.status, expected.status);
+      }
+
+    } // namespace
+
+    TEST(SessionJournal, RoundTripsRecord)
+    {
+      SessionRecord decoded;
+      ASSERT_TRUE(DecodeSessionRecord(EncodeSessionRecord(ConnectedRecord()), &decoded));
+      ExpectSameRecord(decoded, ConnectedRecord());
+    }
+
+    TEST(SessionJournal, ReadsVersionOneRecordsWithoutPassword)
+    {
+      SessionRecord record = ConnectedRecord();
+      record.management_password.clear();
+      std::string encoded = EncodeSessionRecord(record);
+      // Version 1: same layout without the trailing password length
+      encoded[4] = 1;
+      encoded.erase(encoded.size() - sizeof(uint64_t) - 1);
+      const uint64_t checksum = ConfigFingerprint(encoded);
+      for (size_t i = 0; i < sizeof(checksum); i++)
+      {
+        encoded.push_back(static_cast<char>((checksum >> (8 * i)) & 0xff));
+      }
+
+      SessionRecord decoded;
+      ASSERT_TRUE(DecodeSessionRecord(encoded, &decoded));
+      ExpectSameRecord(decoded, record);
+    }
+
+    TEST(SessionJournal, RejectsCorruptData)
+    {
+      const std::string encoded = EncodeSessionRecord(ConnectedRecord());
+      SessionRecord decoded;
+
+      std::string flipped = encoded;
+      flipped[8] ^= 0x01; // Inside the PID
+      EXPECT_FALSE(DecodeSessionRecord(flipped, &decoded));
+      EXPECT_FALSE(DecodeSessionRecord(encoded.substr(0, encoded.size() - 3), &decoded));
+      EXPECT_FALSE(DecodeSessionRecord("not a journal", &decoded));
+      EXPECT_FALSE(DecodeSessionRecord("", &decoded));
+    }
+
+    TEST(SessionJournal, WritesReadsAndClearsFile)
+    {
+      const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+      const std::string path = (std::filesystem::temp_directory_path() /
+                                ("openvpn_dart_journal_" + std::to_string(stamp)))
+                                   .string();
+
+      SessionRecord record = ConnectedRecord();
+      ASSERT_TRUE(WriteSessionJournal(path, record));
+      record.status = "reconnecting";
+      ASSERT_TRUE(WriteSessionJournal(path, record));
+      EXPECT_FALSE(std::filesystem::exists(path + ".partial"));
+
+      SessionRecord read;
+      ASSERT_TRUE(ReadSessionJournal(path, &read));
+      ExpectSameRecord(read, record);
+
+      ClearSessionJournal(path);
+      EXPECT_FALSE(ReadSessionJournal(path, &read));
+      ClearSessionJournal(path); // Clearing twice is harmless
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
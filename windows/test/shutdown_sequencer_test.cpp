@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "shutdown_sequencer.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      // Scripted process: exits after |exit_after_waits| non-zero waits, or
+      // immediately once killed.
+      struct FakeProcess
+      {
+        int exit_after_waits = -1;
+        bool accept_signal = true;
+        bool alive = true;
+        int waits = 0;
+        std::vector<std::string> calls;
+
+        ShutdownSteps Steps()
+        {
+          ShutdownSteps steps;
+          steps.request_graceful = [this]()
+          {
+            calls.push_back("signal");
+            return accept_signal;
+          };
+          steps.wait_for_exit = [this](int timeout_ms)
+          {
+            calls.push_back("wait " + std::to_string(timeout_ms));
+            if (timeout_ms > 0 && alive && ++waits == exit_after_waits)
+            {
+              alive = false;
+            }
+            return !alive;
+          };
+          steps.force_kill = [this]()
+          {
+            calls.push_back("kill");
+            alive = false;
+          };
+          steps.cleanup = [this]()
+          { calls.push_back("cleanup"); };
+          return steps;
+        }
+      };
+
+    } // namespace
+
+    TEST(ShutdownSequencer, GracefulExitSkipsKill)
+    {
+      FakeProcess process;
+      process.exit_after_waits = 1;
+      ShutdownSequencer sequencer(3000, 2000);
+      const ShutdownReport report = sequencer.Run(process.Steps());
+
+      EXPECT_TRUE(report.graceful);
+      EXPECT_FALSE(report.killed);
+      EXPECT_TRUE(report.exited);
+      EXPECT_EQ(process.calls,
+                (std::vector<std::string>{"wait 0", "signal", "wait 3000", "cleanup"}));
+      EXPECT_EQ(sequencer.phase(), ShutdownSequencer::Phase::kDone);
+    }
+
+    TEST(ShutdownSequencer, FallsBackToKillAfterDeadline)
+    {
+      FakeProcess process; // Ignores the signal
+      ShutdownSequencer sequencer(3000, 2000);
+      const ShutdownReport report = sequencer.Run(process.Steps());
+
+      EXPECT_FALSE(report.graceful);
+      EXPECT_TRUE(report.killed);
+      EXPECT_TRUE(report.exited);
+      EXPECT_EQ(process.calls,
+                (std::vector<std::string>{"wait 0", "signal", "wait 3000", "kill", "wait 2000", "cleanup"}));
+    }
+
+    TEST(ShutdownSequencer, KillsImmediatelyWithoutManagement)
+    {
+      FakeProcess process;
+      process.accept_signal = false;
+      ShutdownSequencer sequencer(3000, 2000);
+      const ShutdownReport report = sequencer.Run(process.Steps());
+
+      EXPECT_TRUE(report.killed);
+      EXPECT_EQ(process.calls,
+                (std::vector<std::string>{"wait 0", "signal", "kill", "wait 2000", "cleanup"}));
+    }
+
+    TEST(ShutdownSequencer, AlreadyExitedProcessOnlyCleansUp)
+    {
+      FakeProcess process;
+      process.alive = false;
+      ShutdownSequencer sequencer(3000, 2000);
+      const ShutdownReport report = sequencer.Run(process.Steps());
+
+      EXPECT_TRUE(report.exited);
+      EXPECT_FALSE(report.killed);
+      EXPECT_EQ(process.calls, (std::vector<std::string>{"wait 0", "cleanup"}));
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
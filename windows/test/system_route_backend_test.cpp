@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "route_programmer.h"
+#include "system_route_backend.h"
+
+#ifdef __linux__
+#include <net/if.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#endif
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+#ifdef __linux__
+    namespace
+    {
+
+      // Runs |body| on a thread in a fresh network namespace with only "lo",
+      // brought up. False if namespaces are not available (needs root).
+      template <typename F>
+      bool InNetworkNamespace(F body)
+      {
+        bool entered = false;
+        std::thread thread([&]()
+                           {
+                             if (unshare(CLONE_NEWNET) != 0)
+                             {
+                               return;
+                             }
+                             const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+                             ifreq request{};
+                             std::strncpy(request.ifr_name, "lo", IFNAMSIZ - 1);
+                             const bool up = fd >= 0 && ioctl(fd, SIOCGIFFLAGS, &request) == 0 &&
+                                             (request.ifr_flags |= IFF_UP, ioctl(fd, SIOCSIFFLAGS, &request) == 0);
+                             if (fd >= 0)
+                             {
+                               close(fd);
+                             }
+                             if (up)
+                             {
+                               entered = true;
+                               body();
+                             } });
+        thread.join();
+        return entered;
+      }
+
+      // The calling thread's routing tables, as the kernel prints them
+      std::string RouteTables()
+      {
+        std::ostringstream text;
+        for (const char *path : {"/proc/thread-self/net/route", "/proc/thread-self/net/ipv6_route"})
+        {
+          std::ifstream in(path);
+          text << in.rdbuf();
+        }
+        return text.str();
+      }
+
+      NativeRoute OnLink(const char *destination, uint32_t interface_index)
+      {
+        NativeRoute route;
+        const std::string text = destination;
+        const size_t slash = text.find('/');
+        if (text.find(':') != std::string::npos)
+        {
+          route.ipv6 = true;
+          EXPECT_TRUE(ParseIpv6Route(text, &route.destination));
+        }
+        else
+        {
+          EXPECT_TRUE(ParseIpv4Route(text.substr(0, slash), text.substr(slash + 1), &route.destination));
+        }
+        route.interface_index = interface_index;
+        return route;
+      }
+
+    } // namespace
+
+    TEST(SystemRouteBackend, InstallsAndRemovesRoutesInANamespace)
+    {
+      const bool ran = InNetworkNamespace([]()
+                                          {
+                                            SystemRouteBackend backend;
+                                            IpAddress loopback;
+                                            ASSERT_TRUE(ParseIpAddress("127.0.0.1", &loopback));
+                                            const uint32_t lo = backend.InterfaceIndexForAddress(loopback);
+                                            ASSERT_NE(lo, 0u);
+
+                                            std::vector<NativeRoute> routes{
+                                                OnLink("10.1.0.0/255.255.0.0", lo),
+                                                OnLink("10.2.0.0/255.255.0.0", lo),
+                                                OnLink("2001:db8:1::/48", lo),
+                                            };
+                                            routes[1].metric = 30;
+                                            RouteProgrammer programmer(&backend);
+                                            std::string error;
+                                            ASSERT_TRUE(programmer.Install(routes, &error)) << error;
+                                            const std::string tables = RouteTables();
+                                            EXPECT_NE(tables.find("lo\t0000010A\t00000000\t0001\t0\t0\t0\t0000FFFF"), std::string::npos) << tables;
+                                            EXPECT_NE(tables.find("lo\t0000020A\t00000000\t0001\t0\t0\t30\t0000FFFF"), std::string::npos) << tables;
+                                            EXPECT_NE(tables.find("20010db8000100000000000000000000 30"), std::string::npos) << tables;
+
+                                            // Adding again finds them in place
+                                            std::vector<RouteResult> results;
+                                            backend.AddRoutes(routes, &results, &error);
+                                            EXPECT_EQ(results, std::vector<RouteResult>(3, RouteResult::kExisted));
+
+                                            ASSERT_TRUE(programmer.RemoveAll(&error)) << error;
+                                            EXPECT_EQ(RouteTables().find("0000010A"), std::string::npos);
+                                            EXPECT_EQ(RouteTables().find("20010db80001"), std::string::npos);
+                                            // Already gone is fine
+                                            EXPECT_TRUE(backend.DeleteRoutes(routes, &error)); });
+      if (!ran)
+      {
+        GTEST_SKIP() << "Network namespaces need root";
+      }
+    }
+
+    TEST(SystemRouteBackend, RollsBackABatchWithAFailedRoute)
+    {
+      const bool ran = InNetworkNamespace([]()
+                                          {
+                                            SystemRouteBackend backend;
+                                            IpAddress loopback;
+                                            ASSERT_TRUE(ParseIpAddress("127.0.0.1", &loopback));
+                                            const uint32_t lo = backend.InterfaceIndexForAddress(loopback);
+
+                                            // No such interface for the middle one
+                                            std::vector<NativeRoute> routes{
+                                                OnLink("10.1.0.0/255.255.0.0", lo),
+                                                OnLink("10.2.0.0/255.255.0.0", 9999),
+                                                OnLink("10.3.0.0/255.255.0.0", lo),
+                                            };
+                                            RouteProgrammer programmer(&backend);
+                                            std::string error;
+                                            EXPECT_FALSE(programmer.Install(routes, &error));
+                                            EXPECT_NE(error.find("10.2.0.0/16"), std::string::npos) << error;
+                                            const std::string tables = RouteTables();
+                                            EXPECT_EQ(tables.find("0000010A"), std::string::npos) << tables;
+                                            EXPECT_EQ(tables.find("0000030A"), std::string::npos) << tables;
+                                            EXPECT_EQ(programmer.installed(), 0u); });
+      if (!ran)
+      {
+        GTEST_SKIP() << "Network namespaces need root";
+      }
+    }
+#endif
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace_recorder.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(TraceRecorder, RecordsSpansInStartOrder)
+    {
+      TraceRecorder recorder;
+      {
+        TraceSpan span(recorder, "registry", "scan");
+      }
+      // Both start after the live span has ended, whatever the clock reads
+      const int64_t now = recorder.NowUs();
+      recorder.Record("process", "spawn", now + 300, now + 450);
+      recorder.Record("method", "connect", now + 100, now + 900);
+
+      const std::vector<TraceSpanRecord> spans = recorder.Snapshot();
+      ASSERT_EQ(spans.size(), 3u);
+      EXPECT_STREQ(spans[0].name, "scan");
+      EXPECT_GE(spans[0].duration_us, 0);
+      EXPECT_STREQ(spans[1].name, "connect");
+      EXPECT_EQ(spans[1].start_us, now + 100);
+      EXPECT_EQ(spans[1].duration_us, 800);
+      EXPECT_STREQ(spans[2].category, "process");
+      EXPECT_EQ(spans[2].duration_us, 150);
+      EXPECT_EQ(spans[0].thread_id, spans[1].thread_id);
+    }
+
+    TEST(TraceRecorder, DisabledRecorderSkipsSpans)
+    {
+      TraceRecorder recorder;
+      recorder.set_enabled(false);
+      {
+        TraceSpan span(recorder, "method", "status");
+      }
+      EXPECT_TRUE(recorder.Snapshot().empty());
+    }
+
+    TEST(TraceRecorder, KeepsTheNewestSpansPerThread)
+    {
+      TraceRecorder recorder(4);
+      for (int i = 0; i < 10; i++)
+      {
+        recorder.Record("monitor", "iteration", i * 10, i * 10 + 1);
+      }
+
+      const std::vector<TraceSpanRecord> spans = recorder.Snapshot();
+      ASSERT_EQ(spans.size(), 4u);
+      EXPECT_EQ(spans.front().start_us, 60);
+      EXPECT_EQ(spans.back().start_us, 90);
+    }
+
+    TEST(TraceRecorder, ClearHidesEarlierSpans)
+    {
+      TraceRecorder recorder;
+      recorder.Record("method", "old", 0, 1);
+      recorder.Clear();
+      const int64_t now = recorder.NowUs() + 1;
+      recorder.Record("method", "new", now, now + 5);
+
+      const std::vector<TraceSpanRecord> spans = recorder.Snapshot();
+      ASSERT_EQ(spans.size(), 1u);
+      EXPECT_STREQ(spans[0].name, "new");
+    }
+
+    TEST(TraceRecorder, ThreadsRecordIndependently)
+    {
+      TraceRecorder recorder(2000);
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; t++)
+      {
+        threads.emplace_back([&recorder]()
+                             {
+                               for (int i = 0; i < 500; i++)
+                               {
+                                 TraceSpan span(recorder, "events", "flush");
+                               } });
+      }
+      // Reading while the threads write only ever sees whole spans
+      for (int i = 0; i < 20; i++)
+      {
+        for (const auto &span : recorder.Snapshot())
+        {
+          ASSERT_STREQ(span.name, "flush");
+        }
+      }
+      for (auto &thread : threads)
+      {
+        thread.join();
+      }
+
+      const std::vector<TraceSpanRecord> spans = recorder.Snapshot();
+      EXPECT_EQ(spans.size(), 2000u);
+      std::set<uint32_t> thread_ids;
+      for (const auto &span : spans)
+      {
+        thread_ids.insert(span.thread_id);
+      }
+      EXPECT_EQ(thread_ids.size(), 4u);
+    }
+
+    TEST(TraceRecorder, ReusesRingsOfExitedThreads)
+    {
+      TraceRecorder recorder(8);
+      for (int t = 0; t < 3; t++)
+      {
+        std::thread([&recorder]()
+                    { recorder.Record("process", "teardown", 0, 1); })
+            .join();
+      }
+
+      const std::vector<TraceSpanRecord> spans = recorder.Snapshot();
+      ASSERT_EQ(spans.size(), 3u);
+      // One ring, but each thread keeps its own id
+      std::set<uint32_t> thread_ids;
+      for (const auto &span : spans)
+      {
+        thread_ids.insert(span.thread_id);
+      }
+      EXPECT_EQ(thread_ids.size(), 3u);
+    }
+
+    TEST(TraceRecorder, ExportsChromeTraceJson)
+    {
+      TraceRecorder recorder;
+      recorder.SetThreadName("platform");
+      recorder.Record("method", recorder.Intern("get\"Logs\""), 1000, 1250);
+
+      const std::string json = recorder.ExportChromeTrace();
+      EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+      EXPECT_NE(json.find("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+                          "\"args\":{\"name\":\"platform\"}}"),
+                std::string::npos);
+      EXPECT_NE(json.find("{\"name\":\"get\\\"Logs\\\"\",\"cat\":\"method\",\"ph\":\"X\","
+                          "\"ts\":1000,\"dur\":250,\"pid\":1,\"tid\":1}"),
+                std::string::npos);
+      EXPECT_NE(json.find("\"displayTimeUnit\":\"ms\"}"), std::string::npos);
+    }
+
+    TEST(TraceRecorder, InternReturnsStableCopies)
+    {
+      TraceRecorder recorder;
+      std::string name = "connect";
+      const char *interned = recorder.Intern(name);
+      name = "disconnect";
+      EXPECT_STREQ(interned, "connect");
+      EXPECT_EQ(recorder.Intern("connect"), interned);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "traffic_stats.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(TrafficStats, EmptySessionReportsDurationOnly)
+    {
+      TrafficStats stats;
+      stats.Start(1000);
+      const TrafficSnapshot snapshot = stats.Snapshot(4000);
+      EXPECT_EQ(snapshot.duration_ms, 3000);
+      EXPECT_EQ(snapshot.bytes_in, 0u);
+      EXPECT_EQ(snapshot.rate_in, 0);
+    }
+
+    TEST(TrafficStats, RateIsAveragedOverWindow)
+    {
+      TrafficStats stats(3);
+      stats.Start(0);
+      stats.AddSample(1000, 1000, 100);
+      stats.AddSample(2000, 3000, 200);
+      stats.AddSample(3000, 5000, 300);
+      stats.AddSample(4000, 11000, 400);
+
+      // Window of three samples: (11000 - 3000) bytes over 2 seconds.
+      const TrafficSnapshot snapshot = stats.Snapshot(4000);
+      EXPECT_EQ(snapshot.bytes_in, 11000u);
+      EXPECT_EQ(snapshot.bytes_out, 400u);
+      EXPECT_DOUBLE_EQ(snapshot.rate_in, 4000.0);
+      EXPECT_DOUBLE_EQ(snapshot.rate_out, 100.0);
+    }
+
+    TEST(TrafficStats, RingStaysBounded)
+    {
+      TrafficStats stats;
+      stats.Start(0);
+      for (int64_t i = 1; i <= 1000; ++i)
+      {
+        stats.AddSample(i * 1000, static_cast<uint64_t>(i) * 10, 0);
+      }
+      EXPECT_EQ(stats.sample_count(), TrafficStats::kCapacity);
+      EXPECT_DOUBLE_EQ(stats.Snapshot(1000000).rate_in, 10.0);
+    }
+
+    TEST(TrafficStats, CounterRestartKeepsTotals)
+    {
+      TrafficStats stats;
+      stats.Start(0);
+      stats.AddSample(1000, 5000, 500);
+      stats.AddSample(2000, 200, 20); // SIGUSR1 restarted the counters
+
+      const TrafficSnapshot snapshot = stats.Snapshot(2000);
+      EXPECT_EQ(snapshot.bytes_in, 5200u);
+      EXPECT_EQ(snapshot.bytes_out, 520u);
+      EXPECT_DOUBLE_EQ(snapshot.rate_in, 200.0);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
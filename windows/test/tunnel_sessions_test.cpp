@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tunnel_sessions.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    TEST(TunnelSessions, ValidatesSessionIds)
+    {
+      EXPECT_TRUE(IsValidSessionId("work"));
+      EXPECT_TRUE(IsValidSessionId("eu-west_2"));
+      EXPECT_TRUE(IsValidSessionId(std::string(32, 'a')));
+      EXPECT_FALSE(IsValidSessionId(""));
+      EXPECT_FALSE(IsValidSessionId(std::string(33, 'a')));
+      EXPECT_FALSE(IsValidSessionId("default"));
+      EXPECT_FALSE(IsValidSessionId("../config"));
+      EXPECT_FALSE(IsValidSessionId("a b"));
+    }
+
+    TEST(TunnelSessions, CreatesSessionsInTheirOwnDirectories)
+    {
+      TunnelSessionManager manager;
+      manager.set_root_directory("sessions");
+      TunnelSessionManager::CreateResult result;
+      auto session = manager.Create("work", &result);
+      ASSERT_TRUE(session);
+      EXPECT_EQ(result, TunnelSessionManager::CreateResult::kCreated);
+      EXPECT_EQ(session->id(), "work");
+      EXPECT_EQ(session->status(), "disconnected");
+
+      const std::filesystem::path directory = std::filesystem::path("sessions") / "work";
+      EXPECT_EQ(session->directory(), directory.string());
+      EXPECT_EQ(session->config_path(), (directory / "client.ovpn").string());
+      EXPECT_EQ(session->log_path(), (directory / "openvpn.log").string());
+      EXPECT_EQ(manager.Find("work"), session);
+      EXPECT_FALSE(manager.Find("home"));
+    }
+
+    TEST(TunnelSessions, RejectsDuplicatesInvalidIdsAndOverflow)
+    {
+      TunnelSessionManager manager(2);
+      TunnelSessionManager::CreateResult result;
+      ASSERT_TRUE(manager.Create("a", &result));
+      EXPECT_FALSE(manager.Create("a", &result));
+      EXPECT_EQ(result, TunnelSessionManager::CreateResult::kExists);
+      EXPECT_FALSE(manager.Create("default", &result));
+      EXPECT_EQ(result, TunnelSessionManager::CreateResult::kInvalidId);
+      ASSERT_TRUE(manager.Create("b", &result));
+      EXPECT_FALSE(manager.Create("c", &result));
+      EXPECT_EQ(result, TunnelSessionManager::CreateResult::kFull);
+      EXPECT_EQ(manager.size(), 2u);
+    }
+
+    TEST(TunnelSessions, InternalSessionsSkipIdValidation)
+    {
+      TunnelSessionManager manager;
+      TunnelSessionManager::CreateResult result;
+      EXPECT_FALSE(manager.Create(".switch", &result));
+      ASSERT_TRUE(manager.Create(".switch", &result, true));
+      EXPECT_FALSE(manager.Create(".switch", &result, true));
+      EXPECT_EQ(result, TunnelSessionManager::CreateResult::kExists);
+    }
+
+    TEST(TunnelSessions, ReusesKeysOfRemovedSessions)
+    {
+      TunnelSessionManager manager;
+      TunnelSessionManager::CreateResult result;
+      auto a = manager.Create("a", &result);
+      auto b = manager.Create("b", &result);
+      EXPECT_EQ(a->key(), 1u);
+      EXPECT_EQ(b->key(), 2u);
+
+      EXPECT_TRUE(manager.Remove(a));
+      EXPECT_FALSE(manager.Remove(a));
+      auto c = manager.Create("c", &result);
+      EXPECT_EQ(c->key(), 1u);
+    }
+
+    TEST(TunnelSessions, RemoveIgnoresAReplacedSession)
+    {
+      TunnelSessionManager manager;
+      TunnelSessionManager::CreateResult result;
+      auto old_session = manager.Create("work", &result);
+      ASSERT_TRUE(manager.Remove(old_session));
+      auto new_session = manager.Create("work", &result);
+
+      // A late exit callback for the old process must not drop the new one
+      EXPECT_FALSE(manager.Remove(old_session));
+      EXPECT_EQ(manager.Find("work"), new_session);
+    }
+
+    TEST(TunnelSessions, ListsSessionsById)
+    {
+      TunnelSessionManager manager;
+      TunnelSessionManager::CreateResult result;
+      manager.Create("zulu", &result);
+      manager.Create("alpha", &result);
+
+      const auto sessions = manager.List();
+      ASSERT_EQ(sessions.size(), 2u);
+      EXPECT_EQ(sessions[0]->id(), "alpha");
+      EXPECT_EQ(sessions[1]->id(), "zulu");
+    }
+
+    TEST(TunnelSessions, ReportsOnlyStatusChanges)
+    {
+      TunnelSession session("work", 1, "work");
+      EXPECT_FALSE(session.SetStatus("disconnected"));
+      EXPECT_TRUE(session.SetStatus("connecting"));
+      EXPECT_FALSE(session.SetStatus("connecting"));
+      EXPECT_TRUE(session.SetStatus("connected"));
+      EXPECT_EQ(session.status(), "connected");
+    }
+
+    TEST(TunnelSessions, DetachesOnlyOnce)
+    {
+      TunnelSession session("work", 1, "work");
+      EventReactor::ProcessRef process = EventReactor::ProcessRef();
+      std::unique_ptr<ManagementClient> management;
+      EXPECT_FALSE(session.Detach(&process, &management));
+
+      session.Attach(EventReactor::ProcessRef(), 42, 7505, "s3cret",
+                     std::make_unique<ManagementClient>(ManagementClient::Handlers()));
+      EXPECT_TRUE(session.attached());
+      EXPECT_EQ(session.pid(), 42u);
+      EXPECT_EQ(session.management_port(), 7505);
+      EXPECT_EQ(session.management_password(), "s3cret");
+      // Not connected, so nothing is sent
+      EXPECT_FALSE(session.SendCommand("signal SIGTERM"));
+
+      // Process exit and a disconnect race; exactly one gets the handles
+      int detached = 0;
+      std::vector<std::thread> threads;
+      for (int i = 0; i < 4; i++)
+      {
+        threads.emplace_back([&session, &detached]()
+                             {
+                               EventReactor::ProcessRef p;
+                               std::unique_ptr<ManagementClient> m;
+                               if (session.Detach(&p, &m))
+                               {
+                                 EXPECT_TRUE(m);
+                                 detached++;
+                               } });
+      }
+      for (auto &thread : threads)
+      {
+        thread.join();
+      }
+      EXPECT_EQ(detached, 1);
+      EXPECT_FALSE(session.attached());
+    }
+
+    TEST(TunnelSessions, TracksTrafficAndExitCode)
+    {
+      TunnelSession session("work", 1, "work");
+      session.StartTraffic(0);
+      session.AddTraffic(1000, 100, 50);
+      const TrafficSnapshot snapshot = session.AddTraffic(2000, 300, 150);
+      EXPECT_EQ(snapshot.bytes_in, 300u);
+      EXPECT_EQ(snapshot.bytes_out, 150u);
+      EXPECT_EQ(session.Traffic(2000).duration_ms, 2000);
+
+      uint32_t code = 0;
+      EXPECT_FALSE(session.exit_code(&code));
+      session.set_exit_code(1);
+      EXPECT_TRUE(session.exit_code(&code));
+      EXPECT_EQ(code, 1u);
+    }
+
+    TEST(TunnelSessions, WritesOutputToARotatingLog)
+    {
+      const auto directory = std::filesystem::temp_directory_path() / "openvpn_dart_session_output";
+      std::filesystem::create_directories(directory);
+      TunnelSession session("work", 1, directory.string());
+
+      // Stands in for the output pipe; 0 is end of stream
+      std::vector<std::string> chunks = {"Initialization Sequence ", "Completed\r\nExiting\n"};
+      size_t next = 0;
+      session.StartOutput(
+          [&chunks, &next](char *buffer, size_t) -> int64_t
+          {
+            if (next == chunks.size())
+            {
+              return 0;
+            }
+            const std::string &chunk = chunks[next++];
+            std::memcpy(buffer, chunk.data(), chunk.size());
+            return static_cast<int64_t>(chunk.size());
+          },
+          std::make_unique<RotatingLog>(session.log_path(), 1024, 1));
+      session.StopOutput(1000, nullptr);
+      session.StopOutput(1000, nullptr);
+
+      std::ifstream log(session.log_path());
+      std::string line;
+      std::vector<std::string> lines;
+      while (std::getline(log, line))
+      {
+        lines.push_back(line);
+      }
+      EXPECT_EQ(lines, (std::vector<std::string>{"Initialization Sequence Completed", "Exiting"}));
+      EXPECT_EQ(session.RecentOutput(1), (std::vector<std::string>{"Exiting"}));
+
+      std::error_code ec;
+      std::filesystem::remove_all(directory, ec);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include "warm_standby.h"
+
+namespace openvpn_dart
+{
+  namespace test
+  {
+
+    namespace
+    {
+
+      constexpr int64_t kMaxAgeMs = 60000;
+
+      StandbyState ParkedStandby(uint64_t fingerprint)
+      {
+        StandbyState standby;
+        standby.present = true;
+        standby.alive = true;
+        standby.held = true;
+        standby.fingerprint = fingerprint;
+        standby.spawned_ms = 1000;
+        return standby;
+      }
+
+    } // namespace
+
+    TEST(WarmStandby, FingerprintIsStableAndContentSensitive)
+    {
+      EXPECT_EQ(ConfigFingerprint(""), 14695981039346656037ull);
+      EXPECT_EQ(ConfigFingerprint("remote a 1194"), ConfigFingerprint("remote a 1194"));
+      EXPECT_NE(ConfigFingerprint("remote a 1194"), ConfigFingerprint("remote b 1194"));
+    }
+
+    TEST(WarmStandby, AdoptsParkedProcessForSameProfile)
+    {
+      const uint64_t fingerprint = ConfigFingerprint("client\nremote a 1194\n");
+      EXPECT_EQ(EvaluateStandby(ParkedStandby(fingerprint), fingerprint, 5000, kMaxAgeMs),
+                StandbyVerdict::kAdopt);
+      EXPECT_EQ(EvaluateStandby(StandbyState(), fingerprint, 5000, kMaxAgeMs),
+                StandbyVerdict::kNone);
+    }
+
+    TEST(WarmStandby, RecyclesUnusableProcesses)
+    {
+      const uint64_t fingerprint = ConfigFingerprint("client\nremote a 1194\n");
+
+      EXPECT_EQ(EvaluateStandby(ParkedStandby(fingerprint + 1), fingerprint, 5000, kMaxAgeMs),
+                StandbyVerdict::kMismatched);
+      EXPECT_EQ(EvaluateStandby(ParkedStandby(fingerprint), fingerprint, 1000 + kMaxAgeMs + 1, kMaxAgeMs),
+                StandbyVerdict::kStale);
+
+      StandbyState exited = ParkedStandby(fingerprint);
+      exited.alive = false;
+      EXPECT_EQ(EvaluateStandby(exited, fingerprint, 5000, kMaxAgeMs), StandbyVerdict::kExited);
+
+      StandbyState detached = ParkedStandby(fingerprint);
+      detached.held = false;
+      EXPECT_EQ(EvaluateStandby(detached, fingerprint, 5000, kMaxAgeMs), StandbyVerdict::kNotHeld);
+    }
+
+    TEST(ConnectTimer, RecordsFirstPacketAndConnect)
+    {
+      ConnectTimer timer;
+      timer.Start(1000, true);
+      EXPECT_FALSE(timer.OnState(ManagementState::kResolve, 1010));
+      EXPECT_EQ(timer.first_packet_ms(), -1);
+      EXPECT_FALSE(timer.OnState(ManagementState::kWait, 1040));
+      EXPECT_FALSE(timer.OnState(ManagementState::kAuth, 1200));
+      EXPECT_TRUE(timer.OnState(ManagementState::kConnected, 1900));
+      EXPECT_FALSE(timer.OnState(ManagementState::kConnected, 2500));
+
+      EXPECT_TRUE(timer.prewarmed());
+      EXPECT_EQ(timer.first_packet_ms(), 40);
+      EXPECT_EQ(timer.connected_ms(), 900);
+
+      timer.Start(5000, false);
+      EXPECT_FALSE(timer.prewarmed());
+      EXPECT_EQ(timer.connected_ms(), -1);
+    }
+
+  } // namespace test
+} // namespace openvpn_dart
@@ -0,0 +1,277 @@
+#include "trace_recorder.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    // Thread names kept for the export; the oldest threads go first
+    constexpr size_t kMaxThreadNames = 256;
+
+    std::atomic<uint64_t> g_next_recorder_id{1};
+
+    void AppendJsonString(std::string *out, const char *text)
+    {
+      out->push_back('"');
+      for (const char *p = text != nullptr ? text : ""; *p != '\0'; p++)
+      {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\')
+        {
+          out->push_back('\\');
+          out->push_back(static_cast<char>(c));
+        }
+        else if (c < 0x20)
+        {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out->append(escaped);
+        }
+        else
+        {
+          out->push_back(static_cast<char>(c));
+        }
+      }
+      out->push_back('"');
+    }
+
+  } // namespace
+
+  // One slot of a thread's ring. The owning thread is the only writer;
+  // |sequence| is zero while a span is being written and otherwise the
+  // index + 1 of the span held, so readers can tell a torn copy.
+  struct TraceRecorder::ThreadBuffer
+  {
+    struct Slot
+    {
+      std::atomic<uint64_t> sequence{0};
+      std::atomic<const char *> category{nullptr};
+      std::atomic<const char *> name{nullptr};
+      std::atomic<int64_t> start_us{0};
+      std::atomic<int64_t> duration_us{0};
+      std::atomic<uint32_t> thread_id{0};
+    };
+
+    explicit ThreadBuffer(size_t capacity)
+        : slots(new Slot[capacity]), capacity(capacity)
+    {
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    const size_t capacity;
+    std::atomic<uint64_t> written{0};
+    std::atomic<bool> in_use{false};
+    // Owner only; set under the recorder's mutex when handed out
+    uint32_t thread_id = 0;
+  };
+
+  // The calling thread's ring; given back when the thread exits
+  struct TraceRecorder::ThreadSlot
+  {
+    uint64_t recorder_id = 0;
+    std::shared_ptr<ThreadBuffer> buffer;
+
+    ~ThreadSlot()
+    {
+      if (buffer)
+      {
+        buffer->in_use.store(false, std::memory_order_release);
+      }
+    }
+  };
+
+  TraceRecorder::TraceRecorder(size_t spans_per_thread)
+      : spans_per_thread_(std::max<size_t>(spans_per_thread, 1)),
+        id_(g_next_recorder_id.fetch_add(1, std::memory_order_relaxed)),
+        origin_(std::chrono::steady_clock::now()),
+        enabled_(true),
+        cleared_us_(-1),
+        next_thread_id_(1)
+  {
+  }
+
+  TraceRecorder::~TraceRecorder() = default;
+
+  TraceRecorder &TraceRecorder::Global()
+  {
+    // Never destroyed: threads may still record while the process exits
+    static TraceRecorder *recorder = new TraceRecorder();
+    return *recorder;
+  }
+
+  int64_t TraceRecorder::NowUs() const
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - origin_)
+        .count();
+  }
+
+  TraceRecorder::ThreadBuffer *TraceRecorder::BufferForThisThread()
+  {
+    thread_local ThreadSlot slot;
+    if (slot.recorder_id != id_)
+    {
+      if (slot.buffer)
+      {
+        slot.buffer->in_use.store(false, std::memory_order_release);
+      }
+      slot.buffer = AcquireBuffer();
+      slot.recorder_id = id_;
+    }
+    return slot.buffer.get();
+  }
+
+  std::shared_ptr<TraceRecorder::ThreadBuffer> TraceRecorder::AcquireBuffer()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_ptr<ThreadBuffer> buffer;
+    for (const auto &candidate : buffers_)
+    {
+      bool expected = false;
+      if (candidate->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+      {
+        buffer = candidate;
+        break;
+      }
+    }
+    if (!buffer)
+    {
+      buffer = std::make_shared<ThreadBuffer>(spans_per_thread_);
+      buffer->in_use.store(true, std::memory_order_relaxed);
+      buffers_.push_back(buffer);
+    }
+    buffer->thread_id = next_thread_id_++;
+    return buffer;
+  }
+
+  void TraceRecorder::Record(const char *category, const char *name, int64_t start_us, int64_t end_us)
+  {
+    ThreadBuffer *buffer = BufferForThisThread();
+    const uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    ThreadBuffer::Slot &slot = buffer->slots[index % buffer->capacity];
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_us.store(start_us, std::memory_order_relaxed);
+    slot.duration_us.store(std::max<int64_t>(end_us - start_us, 0), std::memory_order_relaxed);
+    slot.thread_id.store(buffer->thread_id, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+    buffer->written.store(index + 1, std::memory_order_release);
+  }
+
+  void TraceRecorder::SetThreadName(const std::string &name)
+  {
+    const uint32_t thread_id = BufferForThisThread()->thread_id;
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_names_[thread_id] = name;
+    while (thread_names_.size() > kMaxThreadNames)
+    {
+      thread_names_.erase(thread_names_.begin());
+    }
+  }
+
+  const char *TraceRecorder::Intern(std::string_view text)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = interned_.find(text);
+    if (it == interned_.end())
+    {
+      it = interned_.emplace(text).first;
+    }
+    return it->c_str();
+  }
+
+  void TraceRecorder::Clear()
+  {
+    cleared_us_.store(NowUs(), std::memory_order_relaxed);
+  }
+
+  std::vector<TraceSpanRecord> TraceRecorder::Snapshot() const
+  {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffers = buffers_;
+    }
+    const int64_t cleared_us = cleared_us_.load(std::memory_order_relaxed);
+
+    std::vector<TraceSpanRecord> spans;
+    for (const auto &buffer : buffers)
+    {
+      const uint64_t written = buffer->written.load(std::memory_order_acquire);
+      const uint64_t first = written > buffer->capacity ? written - buffer->capacity : 0;
+      for (uint64_t index = first; index < written; index++)
+      {
+        const ThreadBuffer::Slot &slot = buffer->slots[index % buffer->capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+        {
+          continue;
+        }
+        TraceSpanRecord span;
+        span.category = slot.category.load(std::memory_order_relaxed);
+        span.name = slot.name.load(std::memory_order_relaxed);
+        span.start_us = slot.start_us.load(std::memory_order_relaxed);
+        span.duration_us = slot.duration_us.load(std::memory_order_relaxed);
+        span.thread_id = slot.thread_id.load(std::memory_order_relaxed);
+        // Overwritten while copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != index + 1)
+        {
+          continue;
+        }
+        if (span.start_us > cleared_us)
+        {
+          spans.push_back(span);
+        }
+      }
+    }
+
+    std::sort(spans.begin(), spans.end(),
+              [](const TraceSpanRecord &a, const TraceSpanRecord &b)
+              { return a.start_us < b.start_us; });
+    return spans;
+  }
+
+  std::string TraceRecorder::ExportChromeTrace() const
+  {
+    const std::vector<TraceSpanRecord> spans = Snapshot();
+    std::map<uint32_t, std::string> thread_names;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      thread_names = thread_names_;
+    }
+
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto &entry : thread_names)
+    {
+      out += first ? "\n" : ",\n";
+      first = false;
+      out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" +
+             std::to_string(entry.first) + ",\"args\":{\"name\":";
+      AppendJsonString(&out, entry.second.c_str());
+      out += "}}";
+    }
+    for (const auto &span : spans)
+    {
+      out += first ? "\n" : ",\n";
+      first = false;
+      out += "{\"name\":";
+      AppendJsonString(&out, span.name);
+      out += ",\"cat\":";
+      AppendJsonString(&out, span.category);
+      out += ",\"ph\":\"X\",\"ts\":" + std::to_string(span.start_us) +
+             ",\"dur\":" + std::to_string(span.duration_us) +
+             ",\"pid\":1,\"tid\":" + std::to_string(span.thread_id) + "}";
+    }
+    out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return out;
+  }
+
+} // namespace openvpn_dart
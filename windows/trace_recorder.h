@@ -0,0 +1,133 @@
+#ifndef FLUTTER_PLUGIN_TRACE_RECORDER_H_
+#define FLUTTER_PLUGIN_TRACE_RECORDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openvpn_dart
+{
+
+    struct TraceSpanRecord
+    {
+        const char *category = nullptr;
+        const char *name = nullptr;
+        // Since the recorder was created
+        int64_t start_us = 0;
+        int64_t duration_us = 0;
+        uint32_t thread_id = 0;
+    };
+
+    // Timed spans of plugin work, exported as Chrome trace-event JSON
+    // (chrome://tracing, Perfetto).
+    //
+    // Each thread records into a ring of its own, so Record() takes no lock
+    // and does not allocate once the thread has its ring; the oldest spans
+    // of a busy thread are overwritten. Rings of exited threads are handed
+    // to new threads, so memory follows the number of live threads.
+    //
+    // Categories and names are kept by pointer: pass string literals or
+    // Intern() the text first.
+    class TraceRecorder
+    {
+    public:
+        static constexpr size_t kDefaultSpansPerThread = 2048;
+
+        explicit TraceRecorder(size_t spans_per_thread = kDefaultSpansPerThread);
+        ~TraceRecorder();
+
+        TraceRecorder(const TraceRecorder &) = delete;
+        TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+        // The recorder the plugin instruments; enabled from the start.
+        static TraceRecorder &Global();
+
+        void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+        int64_t NowUs() const;
+
+        void Record(const char *category, const char *name, int64_t start_us, int64_t end_us);
+
+        // Labels the calling thread's spans in the export.
+        void SetThreadName(const std::string &name);
+
+        // A copy of |text| that lives as long as the recorder.
+        const char *Intern(std::string_view text);
+
+        // Drops everything recorded so far from later exports.
+        void Clear();
+
+        // Spans still held, by start time.
+        std::vector<TraceSpanRecord> Snapshot() const;
+
+        // {"traceEvents":[...]} with complete ("X") events and thread names.
+        std::string ExportChromeTrace() const;
+
+    private:
+        struct ThreadBuffer;
+        struct ThreadSlot;
+
+        ThreadBuffer *BufferForThisThread();
+        std::shared_ptr<ThreadBuffer> AcquireBuffer();
+
+        const size_t spans_per_thread_;
+        const uint64_t id_;
+        const std::chrono::steady_clock::time_point origin_;
+        std::atomic<bool> enabled_;
+        std::atomic<int64_t> cleared_us_;
+
+        mutable std::mutex mutex_;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+        std::map<uint32_t, std::string> thread_names_;
+        std::set<std::string, std::less<>> interned_;
+        uint32_t next_thread_id_;
+    };
+
+    // Records the time from construction to destruction as one span, or
+    // nothing if the recorder was disabled at construction.
+    class TraceSpan
+    {
+    public:
+        TraceSpan(const char *category, const char *name)
+            : TraceSpan(TraceRecorder::Global(), category, name)
+        {
+        }
+
+        TraceSpan(TraceRecorder &recorder, const char *category, const char *name)
+            : recorder_(recorder.enabled() ? &recorder : nullptr),
+              category_(category),
+              name_(name),
+              start_us_(recorder_ != nullptr ? recorder.NowUs() : 0)
+        {
+        }
+
+        ~TraceSpan()
+        {
+            if (recorder_ != nullptr)
+            {
+                recorder_->Record(category_, name_, start_us_, recorder_->NowUs());
+            }
+        }
+
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan &operator=(const TraceSpan &) = delete;
+
+    private:
+        TraceRecorder *recorder_;
+        const char *category_;
+        const char *name_;
+        int64_t start_us_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_TRACE_RECORDER_H_
@@ -0,0 +1,80 @@
+#include "traffic_stats.h"
+
+#include <algorithm>
+
+namespace openvpn_dart
+{
+
+  TrafficStats::TrafficStats(size_t window)
+      : ring_(),
+        head_(0),
+        count_(0),
+        window_(std::min(std::max<size_t>(window, 2), kCapacity)),
+        start_ms_(0),
+        base_in_(0),
+        base_out_(0),
+        last_raw_in_(0),
+        last_raw_out_(0)
+  {
+  }
+
+  void TrafficStats::Start(int64_t now_ms)
+  {
+    head_ = 0;
+    count_ = 0;
+    start_ms_ = now_ms;
+    base_in_ = 0;
+    base_out_ = 0;
+    last_raw_in_ = 0;
+    last_raw_out_ = 0;
+  }
+
+  void TrafficStats::AddSample(int64_t now_ms, uint64_t bytes_in, uint64_t bytes_out)
+  {
+    // Counters restarted underneath us: keep what was counted so far
+    if (bytes_in < last_raw_in_ || bytes_out < last_raw_out_)
+    {
+      base_in_ += last_raw_in_;
+      base_out_ += last_raw_out_;
+    }
+    last_raw_in_ = bytes_in;
+    last_raw_out_ = bytes_out;
+
+    head_ = (head_ + 1) % kCapacity;
+    ring_[head_] = Sample{now_ms, base_in_ + bytes_in, base_out_ + bytes_out};
+    count_ = std::min(count_ + 1, kCapacity);
+  }
+
+  const TrafficStats::Sample &TrafficStats::SampleAt(size_t age) const
+  {
+    return ring_[(head_ + kCapacity - age) % kCapacity];
+  }
+
+  TrafficSnapshot TrafficStats::Snapshot(int64_t now_ms) const
+  {
+    TrafficSnapshot snapshot;
+    snapshot.duration_ms = std::max<int64_t>(0, now_ms - start_ms_);
+    if (count_ == 0)
+    {
+      return snapshot;
+    }
+
+    const Sample &newest = SampleAt(0);
+    snapshot.bytes_in = newest.total_in;
+    snapshot.bytes_out = newest.total_out;
+
+    if (count_ >= 2)
+    {
+      const Sample &oldest = SampleAt(std::min(count_, window_) - 1);
+      const int64_t elapsed_ms = newest.time_ms - oldest.time_ms;
+      if (elapsed_ms > 0)
+      {
+        const double seconds = static_cast<double>(elapsed_ms) / 1000.0;
+        snapshot.rate_in = static_cast<double>(newest.total_in - oldest.total_in) / seconds;
+        snapshot.rate_out = static_cast<double>(newest.total_out - oldest.total_out) / seconds;
+      }
+    }
+    return snapshot;
+  }
+
+} // namespace openvpn_dart
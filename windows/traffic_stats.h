@@ -0,0 +1,66 @@
+#ifndef FLUTTER_PLUGIN_TRAFFIC_STATS_H_
+#define FLUTTER_PLUGIN_TRAFFIC_STATS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace openvpn_dart
+{
+
+    struct TrafficSnapshot
+    {
+        uint64_t bytes_in = 0;
+        uint64_t bytes_out = 0;
+        double rate_in = 0;  // bytes per second
+        double rate_out = 0; // bytes per second
+        int64_t duration_ms = 0;
+    };
+
+    // Turns OpenVPN's cumulative byte counters into totals and rates.
+    //
+    // Samples go into a fixed-size ring, so memory stays constant for the
+    // whole session. Rates are averaged over the newest |window| samples.
+    // OpenVPN restarts its counters on a soft restart (SIGUSR1); a counter
+    // going backwards is folded into the running totals instead of producing
+    // a negative rate.
+    class TrafficStats
+    {
+    public:
+        static constexpr size_t kCapacity = 16;
+
+        explicit TrafficStats(size_t window = 5);
+
+        // Begins a new session at |now_ms| (monotonic milliseconds).
+        void Start(int64_t now_ms);
+
+        void AddSample(int64_t now_ms, uint64_t bytes_in, uint64_t bytes_out);
+
+        TrafficSnapshot Snapshot(int64_t now_ms) const;
+
+        size_t sample_count() const { return count_; }
+
+    private:
+        struct Sample
+        {
+            int64_t time_ms;
+            uint64_t total_in;
+            uint64_t total_out;
+        };
+
+        const Sample &SampleAt(size_t age) const;
+
+        std::array<Sample, kCapacity> ring_;
+        size_t head_;
+        size_t count_;
+        size_t window_;
+        int64_t start_ms_;
+        uint64_t base_in_;
+        uint64_t base_out_;
+        uint64_t last_raw_in_;
+        uint64_t last_raw_out_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_TRAFFIC_STATS_H_
@@ -0,0 +1,335 @@
+#include "tunnel_sessions.h"
+
+#include <filesystem>
+#include <set>
+#include <utility>
+
+namespace openvpn_dart
+{
+
+  namespace
+  {
+
+    constexpr size_t kMaxSessionIdLength = 32;
+
+    std::string JoinPath(const std::string &directory, const char *name)
+    {
+      return (std::filesystem::path(directory) / name).string();
+    }
+
+  } // namespace
+
+  bool IsValidSessionId(std::string_view id)
+  {
+    if (id.empty() || id.size() > kMaxSessionIdLength || id == "default")
+    {
+      return false;
+    }
+    for (char c : id)
+    {
+      const bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                      (c >= '0' && c <= '9') || c == '_' || c == '-';
+      if (!ok)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  TunnelSession::TunnelSession(std::string id, uint32_t key, std::string directory)
+      : id_(std::move(id)),
+        key_(key),
+        directory_(std::move(directory)),
+        status_("disconnected"),
+        stats_interval_(0),
+        process_(),
+        pid_(0),
+        management_port_(0),
+        attached_(false),
+        exit_source_(EventReactor::kInvalidSource),
+        exited_(false),
+        exit_code_(0)
+  {
+  }
+
+  std::string TunnelSession::config_path() const
+  {
+    return JoinPath(directory_, "client.ovpn");
+  }
+
+  std::string TunnelSession::log_path() const
+  {
+    return JoinPath(directory_, "openvpn.log");
+  }
+
+  std::string TunnelSession::status() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_;
+  }
+
+  bool TunnelSession::SetStatus(const std::string &status)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (status_ == status)
+    {
+      return false;
+    }
+    status_ = status;
+    return true;
+  }
+
+  void TunnelSession::StartTraffic(int64_t now_ms)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    traffic_.Start(now_ms);
+  }
+
+  TrafficSnapshot TunnelSession::AddTraffic(int64_t now_ms, uint64_t bytes_in, uint64_t bytes_out)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    traffic_.AddSample(now_ms, bytes_in, bytes_out);
+    return traffic_.Snapshot(now_ms);
+  }
+
+  TrafficSnapshot TunnelSession::Traffic(int64_t now_ms) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return traffic_.Snapshot(now_ms);
+  }
+
+  void TunnelSession::set_stats_interval(int seconds)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_interval_ = seconds;
+  }
+
+  int TunnelSession::stats_interval() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_interval_;
+  }
+
+  void TunnelSession::Attach(EventReactor::ProcessRef process, uint32_t pid, uint16_t management_port,
+                             std::string management_password,
+                             std::unique_ptr<ManagementClient> management)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    process_ = process;
+    pid_ = pid;
+    management_port_ = management_port;
+    management_password_ = std::move(management_password);
+    management_ = std::move(management);
+    attached_ = true;
+  }
+
+  bool TunnelSession::Detach(EventReactor::ProcessRef *process,
+                             std::unique_ptr<ManagementClient> *management)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!attached_)
+    {
+      return false;
+    }
+    attached_ = false;
+    *process = process_;
+    *management = std::move(management_);
+    process_ = EventReactor::ProcessRef();
+    return true;
+  }
+
+  bool TunnelSession::attached() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return attached_;
+  }
+
+  uint32_t TunnelSession::pid() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pid_;
+  }
+
+  uint16_t TunnelSession::management_port() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return management_port_;
+  }
+
+  std::string TunnelSession::management_password() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return management_password_;
+  }
+
+  bool TunnelSession::SendCommand(const std::string &command)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!attached_ || !management_ || !management_->connected())
+    {
+      return false;
+    }
+    return management_->SendCommand(command);
+  }
+
+  void TunnelSession::StartOutput(PipeDrain::ReadFn read, std::unique_ptr<RotatingLog> log)
+  {
+    output_log_ = std::move(log);
+    output_log_->Open();
+    output_drain_.Start(std::move(read), [log = output_log_.get()](std::string_view line)
+                        { log->Write(line); });
+  }
+
+  void TunnelSession::StopOutput(int timeout_ms,
+                                 const std::function<void(std::thread::native_handle_type)> &cancel)
+  {
+    if (!output_log_)
+    {
+      return;
+    }
+    // Helpers spawned by OpenVPN may still hold the pipe open
+    if (!output_drain_.WaitFor(timeout_ms) && cancel)
+    {
+      cancel(output_drain_.native_handle());
+    }
+    output_drain_.Join();
+    output_log_->Close();
+  }
+
+  std::vector<std::string> TunnelSession::RecentOutput(size_t count) const
+  {
+    return output_drain_.RecentLines(count);
+  }
+
+  void TunnelSession::set_exit_source(EventReactor::SourceId source)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exit_source_ = source;
+  }
+
+  EventReactor::SourceId TunnelSession::exit_source() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return exit_source_;
+  }
+
+  void TunnelSession::set_exit_code(uint32_t code)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exited_ = true;
+    exit_code_ = code;
+  }
+
+  bool TunnelSession::exit_code(uint32_t *code) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!exited_)
+    {
+      return false;
+    }
+    *code = exit_code_;
+    return true;
+  }
+
+  TunnelSessionManager::TunnelSessionManager(size_t max_sessions)
+      : max_sessions_(max_sessions)
+  {
+  }
+
+  std::shared_ptr<TunnelSession> TunnelSessionManager::Create(const std::string &id,
+                                                              CreateResult *result, bool internal)
+  {
+    if (!internal && !IsValidSessionId(id))
+    {
+      *result = CreateResult::kInvalidId;
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sessions_.count(id) != 0)
+    {
+      *result = CreateResult::kExists;
+      return nullptr;
+    }
+    if (sessions_.size() >= max_sessions_)
+    {
+      *result = CreateResult::kFull;
+      return nullptr;
+    }
+
+    // Lowest key not held by a live session
+    std::set<uint32_t> used;
+    for (const auto &entry : sessions_)
+    {
+      used.insert(entry.second->key());
+    }
+    uint32_t key = 1;
+    while (used.count(key) != 0)
+    {
+      key++;
+    }
+
+    auto session = std::make_shared<TunnelSession>(id, key, JoinPath(root_, id.c_str()));
+    sessions_[id] = session;
+    *result = CreateResult::kCreated;
+    return session;
+  }
+
+  std::shared_ptr<TunnelSession> TunnelSessionManager::Find(const std::string &id) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(id);
+    return it != sessions_.end() ? it->second : nullptr;
+  }
+
+  bool TunnelSessionManager::Remove(const std::shared_ptr<TunnelSession> &session)
+  {
+    if (!session)
+    {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(session->id());
+    if (it == sessions_.end() || it->second != session)
+    {
+      return false;
+    }
+    sessions_.erase(it);
+    return true;
+  }
+
+  std::vector<std::shared_ptr<TunnelSession>> TunnelSessionManager::List() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::shared_ptr<TunnelSession>> sessions;
+    sessions.reserve(sessions_.size());
+    for (const auto &entry : sessions_)
+    {
+      sessions.push_back(entry.second);
+    }
+    return sessions;
+  }
+
+  size_t TunnelSessionManager::size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+  }
+
+  const char *CreateResultMessage(TunnelSessionManager::CreateResult result)
+  {
+    switch (result)
+    {
+    case TunnelSessionManager::CreateResult::kCreated:
+      return "Session created";
+    case TunnelSessionManager::CreateResult::kInvalidId:
+      return "Session IDs are 1-32 letters, digits, '_' or '-', and not \"default\"";
+    case TunnelSessionManager::CreateResult::kExists:
+      return "A session with this ID is already running";
+    case TunnelSessionManager::CreateResult::kFull:
+      return "Too many sessions";
+    }
+    return "Unknown result";
+  }
+
+} // namespace openvpn_dart
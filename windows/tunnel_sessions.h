@@ -0,0 +1,154 @@
+#ifndef FLUTTER_PLUGIN_TUNNEL_SESSIONS_H_
+#define FLUTTER_PLUGIN_TUNNEL_SESSIONS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "event_reactor.h"
+#include "management_client.h"
+#include "pipe_drain.h"
+#include "rotating_log.h"
+#include "traffic_stats.h"
+
+namespace openvpn_dart
+{
+
+    // 1 to 32 of [A-Za-z0-9_-], so an id is safe as a directory name.
+    // "default" names the plugin's original tunnel and is not available.
+    bool IsValidSessionId(std::string_view id);
+
+    // A named tunnel running next to the default one, with its own OpenVPN
+    // process, directory, management client and counters.
+    //
+    // Status and counters may be read and updated from any thread. The
+    // process and management client are handed out once through Detach(),
+    // so whoever detaches first (process exit or a disconnect) cleans up.
+    class TunnelSession
+    {
+    public:
+        TunnelSession(std::string id, uint32_t key, std::string directory);
+
+        const std::string &id() const { return id_; }
+        // Small number unique among live sessions; tells their stats apart
+        // when events are coalesced
+        uint32_t key() const { return key_; }
+        const std::string &directory() const { return directory_; }
+        std::string config_path() const;
+        std::string log_path() const;
+
+        std::string status() const;
+        // Returns false if |status| was already the status.
+        bool SetStatus(const std::string &status);
+
+        void StartTraffic(int64_t now_ms);
+        TrafficSnapshot AddTraffic(int64_t now_ms, uint64_t bytes_in, uint64_t bytes_out);
+        TrafficSnapshot Traffic(int64_t now_ms) const;
+
+        void set_stats_interval(int seconds);
+        int stats_interval() const;
+
+        void Attach(EventReactor::ProcessRef process, uint32_t pid, uint16_t management_port,
+                    std::string management_password,
+                    std::unique_ptr<ManagementClient> management);
+        // Moves the process and client out; false if already detached.
+        bool Detach(EventReactor::ProcessRef *process, std::unique_ptr<ManagementClient> *management);
+        bool attached() const;
+        uint32_t pid() const;
+        uint16_t management_port() const;
+        std::string management_password() const;
+
+        // Sends |command| to the management client while attached
+        bool SendCommand(const std::string &command);
+
+        // Reads OpenVPN's stdout and stderr through |read| on a thread of
+        // their own into |log|, so the log is size-bounded and rotated like
+        // the default tunnel's.
+        void StartOutput(PipeDrain::ReadFn read, std::unique_ptr<RotatingLog> log);
+        // Waits up to |timeout_ms| for the output to end, else has |cancel|
+        // unblock the read, then closes the log. Safe to call again.
+        void StopOutput(int timeout_ms,
+                        const std::function<void(std::thread::native_handle_type)> &cancel);
+        // Up to |count| newest output lines, oldest first
+        std::vector<std::string> RecentOutput(size_t count) const;
+
+        void set_exit_source(EventReactor::SourceId source);
+        EventReactor::SourceId exit_source() const;
+
+        void set_exit_code(uint32_t code);
+        // False while the process has not been seen to exit
+        bool exit_code(uint32_t *code) const;
+
+    private:
+        const std::string id_;
+        const uint32_t key_;
+        const std::string directory_;
+
+        mutable std::mutex mutex_;
+        std::string status_;
+        TrafficStats traffic_;
+        int stats_interval_;
+        EventReactor::ProcessRef process_;
+        uint32_t pid_;
+        uint16_t management_port_;
+        std::string management_password_;
+        bool attached_;
+        std::unique_ptr<ManagementClient> management_;
+        EventReactor::SourceId exit_source_;
+        bool exited_;
+        uint32_t exit_code_;
+
+        // Written only by the drain thread, which is joined first
+        std::unique_ptr<RotatingLog> output_log_;
+        PipeDrain output_drain_;
+    };
+
+    // The named tunnels, each in <root>/<id>. Thread-safe.
+    class TunnelSessionManager
+    {
+    public:
+        static constexpr size_t kDefaultMaxSessions = 8;
+
+        enum class CreateResult
+        {
+            kCreated,
+            kInvalidId,
+            kExists,
+            kFull,
+        };
+
+        explicit TunnelSessionManager(size_t max_sessions = kDefaultMaxSessions);
+
+        // Set before the first Create()
+        void set_root_directory(const std::string &root) { root_ = root; }
+
+        // |internal| sessions are the plugin's own and skip ID validation,
+        // so they can use IDs no caller is allowed to take.
+        std::shared_ptr<TunnelSession> Create(const std::string &id, CreateResult *result,
+                                              bool internal = false);
+        std::shared_ptr<TunnelSession> Find(const std::string &id) const;
+        // Removes |session| if it is still the one registered under its id.
+        bool Remove(const std::shared_ptr<TunnelSession> &session);
+        // By id
+        std::vector<std::shared_ptr<TunnelSession>> List() const;
+        size_t size() const;
+
+    private:
+        const size_t max_sessions_;
+        std::string root_;
+        mutable std::mutex mutex_;
+        std::map<std::string, std::shared_ptr<TunnelSession>> sessions_;
+    };
+
+    const char *CreateResultMessage(TunnelSessionManager::CreateResult result);
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_TUNNEL_SESSIONS_H_
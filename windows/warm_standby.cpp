@@ -0,0 +1,103 @@
+#include "warm_standby.h"
+
+namespace openvpn_dart
+{
+
+  uint64_t ConfigFingerprint(std::string_view config)
+  {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : config)
+    {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  const char *StandbyVerdictName(StandbyVerdict verdict)
+  {
+    switch (verdict)
+    {
+    case StandbyVerdict::kNone:
+      return "none";
+    case StandbyVerdict::kAdopt:
+      return "adopt";
+    case StandbyVerdict::kMismatched:
+      return "mismatched";
+    case StandbyVerdict::kStale:
+      return "stale";
+    case StandbyVerdict::kExited:
+      return "exited";
+    case StandbyVerdict::kNotHeld:
+      return "not held";
+    }
+    return "unknown";
+  }
+
+  StandbyVerdict EvaluateStandby(const StandbyState &standby, uint64_t fingerprint,
+                                 int64_t now_ms, int64_t max_age_ms)
+  {
+    if (!standby.present)
+    {
+      return StandbyVerdict::kNone;
+    }
+    if (!standby.alive)
+    {
+      return StandbyVerdict::kExited;
+    }
+    if (standby.fingerprint != fingerprint)
+    {
+      return StandbyVerdict::kMismatched;
+    }
+    if (now_ms - standby.spawned_ms > max_age_ms)
+    {
+      return StandbyVerdict::kStale;
+    }
+    if (!standby.held)
+    {
+      return StandbyVerdict::kNotHeld;
+    }
+    return StandbyVerdict::kAdopt;
+  }
+
+  ConnectTimer::ConnectTimer()
+      : start_ms_(0),
+        prewarmed_(false),
+        first_packet_ms_(-1),
+        connected_ms_(-1)
+  {
+  }
+
+  void ConnectTimer::Start(int64_t now_ms, bool prewarmed)
+  {
+    start_ms_ = now_ms;
+    prewarmed_ = prewarmed;
+    first_packet_ms_ = -1;
+    connected_ms_ = -1;
+  }
+
+  bool ConnectTimer::OnState(ManagementState state, int64_t now_ms)
+  {
+    switch (state)
+    {
+    case ManagementState::kTcpConnect:
+    case ManagementState::kWait:
+    case ManagementState::kAuth:
+      if (first_packet_ms_ < 0)
+      {
+        first_packet_ms_ = now_ms - start_ms_;
+      }
+      return false;
+    case ManagementState::kConnected:
+      if (connected_ms_ >= 0)
+      {
+        return false;
+      }
+      connected_ms_ = now_ms - start_ms_;
+      return true;
+    default:
+      return false;
+    }
+  }
+
+} // namespace openvpn_dart
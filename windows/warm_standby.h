@@ -0,0 +1,72 @@
+#ifndef FLUTTER_PLUGIN_WARM_STANDBY_H_
+#define FLUTTER_PLUGIN_WARM_STANDBY_H_
+
+#include <cstdint>
+#include <string_view>
+
+#include "management_client.h"
+
+namespace openvpn_dart
+{
+
+    // Stable 64-bit FNV-1a digest of a profile. Identifies which profile a
+    // warm standby process was started for without keeping extra copies.
+    uint64_t ConfigFingerprint(std::string_view config);
+
+    // What a connect should do with the warm standby process, if any.
+    enum class StandbyVerdict
+    {
+        kNone,       // No standby process
+        kAdopt,      // Parked for this profile: release the hold
+        kMismatched, // Started for another profile
+        kStale,      // Parked for longer than the allowed age
+        kExited,     // Process died while parked
+        kNotHeld,    // Not parked in the hold, or its management link is gone
+    };
+
+    const char *StandbyVerdictName(StandbyVerdict verdict);
+
+    struct StandbyState
+    {
+        bool present = false;
+        bool alive = false;    // Process has not exited
+        bool held = false;     // >HOLD seen and management client still attached
+        uint64_t fingerprint = 0;
+        int64_t spawned_ms = 0; // Monotonic milliseconds
+    };
+
+    // Decides whether |standby| may serve a connect for the profile with
+    // |fingerprint|. Anything but kAdopt and kNone means it must be recycled.
+    StandbyVerdict EvaluateStandby(const StandbyState &standby, uint64_t fingerprint,
+                                   int64_t now_ms, int64_t max_age_ms);
+
+    // Connect latency milestones derived from management state changes.
+    //
+    // "First packet" is the first state that implies OpenVPN has put traffic
+    // on the wire: TCP_CONNECT, WAIT (initial packet sent, awaiting the
+    // server) or AUTH. Times are relative to Start() and -1 until observed.
+    class ConnectTimer
+    {
+    public:
+        ConnectTimer();
+
+        void Start(int64_t now_ms, bool prewarmed);
+
+        // Returns true for the state that completes the connect, i.e. the
+        // first CONNECTED since Start().
+        bool OnState(ManagementState state, int64_t now_ms);
+
+        bool prewarmed() const { return prewarmed_; }
+        int64_t first_packet_ms() const { return first_packet_ms_; }
+        int64_t connected_ms() const { return connected_ms_; }
+
+    private:
+        int64_t start_ms_;
+        bool prewarmed_;
+        int64_t first_packet_ms_;
+        int64_t connected_ms_;
+    };
+
+} // namespace openvpn_dart
+
+#endif // FLUTTER_PLUGIN_WARM_STANDBY_H_